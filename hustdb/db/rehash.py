@@ -0,0 +1,105 @@
+#/usr/bin/python
+import sys
+import os
+import re
+import json
+import zlib
+import struct
+import base64
+import requests
+
+USER = 'huststore'
+PASSWD = 'huststore'
+
+SIZE_LEN = 8
+
+def manual():
+    print """
+    usage:
+        python rehash.py [export_dir] [host]
+            [export_dir]
+                EXPORT directory of the source hustdb, filled by
+                /hustdb/export?file=N&noval=false for every file
+            [host]
+                ip:port of the target hustdb, started with an empty
+                DATA directory and the new [md5db] inner_hash
+    sample:
+        python rehash.py /data/hustdb/EXPORT 192.168.1.101:8085
+
+    queue items are not replayed, drain or re-publish them separately.
+        """
+
+def load_items(index_path):
+    data_path = '%s.data' % index_path
+    with open(index_path, 'rb') as f:
+        raw = f.read()
+    offsets = [struct.unpack('<Q', raw[i:i + SIZE_LEN])[0] for i in range(0, len(raw), SIZE_LEN)]
+    with open(data_path, 'rb') as f:
+        data = f.read()
+    offsets.append(len(data))
+    for i in range(len(offsets) - 1):
+        yield json.loads(data[offsets[i]:offsets[i + 1]])
+
+def decode_val(item):
+    if 'val' not in item:
+        return ''
+    # zset members carry the score as plain text
+    if item.get('ty') == 'Z':
+        return item['val']
+    val = base64.b64decode(item['val'])
+    if item.get('gz', 0) > 0:
+        val = zlib.decompress(val, -zlib.MAX_WBITS)
+    return val
+
+def replay(sess, host, item):
+    key = base64.b64decode(item['key'])
+    val = decode_val(item)
+    args = {'ver': item['ver'], 'is_dup': 'true'}
+    if item.get('ttl', 0) > 0:
+        args['ttl'] = item['ttl']
+    ty = item.get('ty')
+    if ty is None:
+        args['key'] = key
+        return sess.post('http://%s/hustdb/put' % host, val, params=args, auth=(USER, PASSWD))
+    if 'tb' not in item:
+        return None
+    args['tb'] = item['tb']
+    if 'H' == ty:
+        args['key'] = key
+        return sess.post('http://%s/hustdb/hset' % host, val, params=args, auth=(USER, PASSWD))
+    if 'S' == ty:
+        return sess.post('http://%s/hustdb/sadd' % host, key, params=args, auth=(USER, PASSWD))
+    if 'Z' == ty:
+        args['score'] = int(val)
+        return sess.post('http://%s/hustdb/zadd' % host, key, params=args, auth=(USER, PASSWD))
+    return None
+
+def rehash(export_dir, host):
+    pattern = re.compile(r'^db\.all@\d+\[\d+-\d+\]\.kv$')
+    files = sorted(filter(lambda name: pattern.match(name), os.listdir(export_dir)))
+    if len(files) < 1:
+        print 'no full export found in %s' % export_dir
+        return False
+    ok = 0
+    skipped = 0
+    failed = 0
+    sess = requests.Session()
+    for name in files:
+        for item in load_items(os.path.join(export_dir, name)):
+            r = replay(sess, host, item)
+            if r is None:
+                skipped = skipped + 1
+            elif 200 == r.status_code:
+                ok = ok + 1
+            else:
+                failed = failed + 1
+                print '[%s] %s: %d' % (name, item['key'], r.status_code)
+        print '[%s] done' % name
+    print 'replayed: %d, skipped: %d, failed: %d' % (ok, skipped, failed)
+    return 0 == failed
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        manual()
+        sys.exit(1)
+    sys.exit(0 if rehash(sys.argv[1], sys.argv[2]) else 1)
@@ -803,6 +803,17 @@ public:
         InterlockedIncrement ( & m_nReaders );
     }
 
+    bool try_rlock ( ) const
+    {
+        if ( m_nWriters > 0 )
+        {
+            return false;
+        }
+
+        InterlockedIncrement ( & m_nReaders );
+        return true;
+    }
+
     void runlock ( ) const
     {
         long n = InterlockedDecrement ( & m_nReaders );
@@ -869,6 +880,11 @@ public:
         pthread_rwlock_rdlock ( & m_lock );
     }
 
+    bool try_rlock ( ) const
+    {
+        return 0 == pthread_rwlock_tryrdlock ( & m_lock );
+    }
+
     void runlock ( ) const
     {
         pthread_rwlock_unlock ( & m_lock );
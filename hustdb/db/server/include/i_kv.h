@@ -1,9 +1,11 @@
 #ifndef _i_kv_h_
 #define _i_kv_h_
 
+#include <stdint.h>
 #include <sstream>
 #include <map>
 #include <string>
+#include <vector>
 
 struct kv_config_t
 {
@@ -63,6 +65,33 @@ private:
     static void operator delete( void * p );
 };
 
+// writes a sorted table file for i_kv_t::ingest
+class i_kv_builder_t
+{
+public:
+    virtual void kill_me ( ) = 0;
+
+    // keys are added in ascending order, without duplicates
+    virtual int add (
+                      const void * key,
+                      unsigned int key_len,
+                      const void * data,
+                      unsigned int data_len
+                      ) = 0;
+
+    virtual uint64_t file_size ( ) const = 0;
+
+    virtual int finish ( ) = 0;
+
+protected:
+    // released by kill_me only
+    ~i_kv_builder_t ( ) { }
+
+private:
+    // disable
+    static void operator delete( void * p );
+};
+
 class i_kv_t
 {
 public:
@@ -105,6 +134,17 @@ public:
 
     virtual i_iterator_t * iterator ( ) = 0;
 
+    // a builder of a table file in the directory of the db, see ingest
+    virtual i_kv_builder_t * builder (
+                                       const char * file
+                                       ) = 0;
+
+    // takes the table files written by builder into the db, their keys
+    // must not be in the db yet. the file is unavailable in the meantime
+    virtual int ingest (
+                         const std::vector< std::string > & files
+                         ) = 0;
+
 private:
     // disable
     static void operator delete( void * p );
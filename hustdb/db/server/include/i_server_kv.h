@@ -204,6 +204,24 @@ struct binlog_done_cb_param_t
 
 } __attribute__ ( ( aligned ( 64 ) ) );
 
+// takes the records of the new keys of a conn in place of the data files,
+// see i_server_kv_t::set_inner_stage
+class i_kv_stage_t
+{
+public:
+
+    virtual ~i_kv_stage_t ( ) { }
+
+    // 0 if the record is taken, otherwise it is put to the file as usual
+    virtual int add (
+                      i_kv_t * file,
+                      const char * key,
+                      size_t key_len,
+                      const char * val,
+                      size_t val_len
+                      ) = 0;
+};
+
 class i_server_kv_t
 {
 public:
@@ -218,6 +236,11 @@ public:
                         std::stringstream & ss
                         ) = 0;
 
+    // open progress for /hustdb/ready, false while the store is still warming up
+    virtual bool ready (
+                         std::stringstream & ss
+                         ) = 0;
+
     virtual int get_user_file_count ( ) = 0;
 
     virtual int flush ( ) = 0;
@@ -286,6 +309,18 @@ public:
                                 void * callback_param
                                 ) = 0;
 
+    // user keys ( and values unless noval ) of the table set by set_inner_table,
+    // size of them after skipping offset, the score index of a zset is read in
+    // score order and limited to [ min, max ] with byscore
+    virtual int table_keys (
+                             conn_ctxt_t conn,
+                             item_ctxt_t * & ctxt,
+                             export_record_callback_t callback,
+                             void * callback_param,
+                             std::vector< std::string > & keys,
+                             std::vector< std::string > & vals
+                             ) = 0;
+
     virtual int ttl_scan (
                            export_record_callback_t callback,
                            void * callback_param
@@ -345,6 +380,38 @@ public:
         return NULL;
     }
 
+    // the data files the records are kept in, see load_stage_t::replay
+    virtual int get_data_count ( )
+    {
+        return 0;
+    }
+
+    virtual i_kv_t * get_data (
+                                int file_id
+                                )
+    {
+        return NULL;
+    }
+
+    // the writes of the conn that create a key without ttl go to the stage,
+    // NULL writes to the data files again
+    virtual void set_inner_stage (
+                                   i_kv_stage_t * stage,
+                                   conn_ctxt_t conn
+                                   )
+    {
+    }
+
+    // takes every lock the files are written under, for the snapshot of
+    // task_backup_t. the caller stops its own writers first
+    virtual void freeze ( )
+    {
+    }
+
+    virtual void thaw ( )
+    {
+    }
+
 private:
     // disable
     static void operator delete( void * p );
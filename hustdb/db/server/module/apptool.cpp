@@ -1201,8 +1201,9 @@ void apptool_t::fmap_init (
     o->fd       = INVALID_HANDLE_VALUE;
     o->mfd      = NULL;
 #endif
-    o->ptr      = NULL;
-    o->ptr_len  = 0;
+    o->ptr          = NULL;
+    o->ptr_len      = 0;
+    o->reserve_len  = 0;
 }
 
 bool apptool_t::fmap_open (
@@ -1372,12 +1373,145 @@ void apptool_t::fmap_close ( fmap_t * o )
         o->fd = INVALID_HANDLE_VALUE;
     }
 #else
-    if ( o->ptr && o->ptr_len )
+    if ( o->ptr && o->reserve_len )
+    {
+        munmap ( o->ptr, o->reserve_len );
+    }
+    else if ( o->ptr && o->ptr_len )
     {
         munmap ( o->ptr, o->ptr_len );
     }
     o->ptr = NULL;
     o->ptr_len = 0;
+    o->reserve_len = 0;
+#endif
+}
+
+bool apptool_t::fmap_open_reserved (
+                                     fmap_t *        o,
+                                     const char *    path,
+                                     size_t          reserve_len,
+                                     bool            read_write
+                                     )
+{
+#if defined( WIN32 ) || defined( WIN64 )
+    return fmap_open ( o, path, 0, 0, read_write );
+#else
+    off_t   sz;
+    int     fd;
+    void *  base;
+    void *  p;
+
+    fmap_init ( o );
+
+#if defined( __linux )
+    fd = open ( path, O_RDWR
+#if ! defined( _OPENWRT )
+        | O_LARGEFILE
+#endif
+        );
+#else
+    fd = open ( path, O_RDWR );
+#endif
+    if ( - 1 == fd )
+    {
+        return false;
+    }
+
+    sz = lseek ( fd, 0, SEEK_END );
+    if ( ( off_t ) - 1 == sz || ( uint64_t ) sz > ( uint64_t ) reserve_len )
+    {
+        close ( fd );
+        return false;
+    }
+
+    // address space only: PROT_NONE and MAP_NORESERVE commit no memory
+    base = mmap ( NULL, reserve_len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, - 1, 0 );
+    if ( MAP_FAILED == base )
+    {
+        close ( fd );
+        return fmap_open ( o, path, 0, 0, read_write );
+    }
+
+    if ( sz > 0 )
+    {
+        p = mmap ( base,
+                   ( size_t ) sz,
+                   read_write ? ( PROT_READ | PROT_WRITE ) : PROT_READ,
+                   MAP_SHARED | MAP_FIXED,
+                   fd,
+                   0 );
+        if ( MAP_FAILED == p )
+        {
+            munmap ( base, reserve_len );
+            close ( fd );
+            return false;
+        }
+    }
+
+    close ( fd );
+
+    o->ptr          = ( byte_t * ) base;
+    o->ptr_len      = ( size_t ) sz;
+    o->reserve_len  = reserve_len;
+
+    return true;
+#endif
+}
+
+bool apptool_t::fmap_extend (
+                              fmap_t *        o,
+                              const char *    path,
+                              size_t          from,
+                              size_t          to,
+                              bool            read_write
+                              )
+{
+#if defined( WIN32 ) || defined( WIN64 )
+    return false;
+#else
+    size_t  page;
+    size_t  start;
+    int     fd;
+    void *  p;
+
+    if ( NULL == o->ptr || 0 == o->reserve_len || from > to || to > o->reserve_len )
+    {
+        return false;
+    }
+
+    // the page holding from is mapped already, the map covers whole pages
+    page  = ( size_t ) sysconf ( _SC_PAGESIZE );
+    start = ( from + page - 1 ) / page * page;
+    if ( start >= to )
+    {
+        return true;
+    }
+
+#if defined( __linux )
+    fd = open ( path, O_RDWR
+#if ! defined( _OPENWRT )
+        | O_LARGEFILE
+#endif
+        );
+#else
+    fd = open ( path, O_RDWR );
+#endif
+    if ( - 1 == fd )
+    {
+        return false;
+    }
+
+    p = mmap ( o->ptr + start,
+               to - start,
+               read_write ? ( PROT_READ | PROT_WRITE ) : PROT_READ,
+               MAP_SHARED | MAP_FIXED,
+               fd,
+               ( off_t ) start );
+
+    close ( fd );
+
+    return MAP_FAILED != p;
 #endif
 }
 
@@ -1636,6 +1770,21 @@ void apptool_t::md5 (
     MD5Final ( & ctx, ( unsigned char * ) digest );
 }
 
+void apptool_t::murmur3 (
+                          const void * data,
+                          size_t data_len,
+                          char * digest
+                          )
+{
+    if ( unlikely ( NULL == data || 0 == data_len ) )
+    {
+        memset ( digest, 0, 16 );
+        return;
+    }
+
+    MurmurHash3_x64_128 ( data, data_len, 0, digest );
+}
+
 bool apptool_t::check_endian ()
 {
   	int i = 1;
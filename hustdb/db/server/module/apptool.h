@@ -4,6 +4,7 @@
 #include "db_stdinc.h"
 #include "db_lib.h"
 #include "utils/md5.h"
+#include "utils/murmur3.h"
 
 #if ! defined( WIN32 ) && ! defined( WIN64 )
 #include <semaphore.h>
@@ -34,6 +35,8 @@ typedef struct fmap_t
 #endif
     unsigned char * ptr;
     size_t ptr_len;
+    // not 0 if ptr is the start of a reserved range, see fmap_open_reserved
+    size_t reserve_len;
 
 } fmap_t;
 
@@ -200,6 +203,26 @@ public:
                      bool read_write
                      );
 
+    // maps the file at the start of reserve_len bytes of reserved address
+    // space, fmap_extend then grows the map in place. falls back to
+    // fmap_open ( reserve_len left 0 ) where the platform cannot reserve
+    bool fmap_open_reserved (
+                              fmap_t * o,
+                              const char * path,
+                              size_t reserve_len,
+                              bool read_write
+                              );
+
+    // maps [ from, to ) of the file into the reserved range, the pages
+    // already mapped are not touched. ptr_len is left to the caller
+    bool fmap_extend (
+                       fmap_t * o,
+                       const char * path,
+                       size_t from,
+                       size_t to,
+                       bool read_write
+                       );
+
     bool fmap_flush (
                       fmap_t * o
                       );
@@ -255,6 +278,12 @@ public:
                char * digest
                );
 
+    void murmur3 (
+                   const void * data,
+                   size_t data_len,
+                   char * digest
+                   );
+
     bool check_endian ( );
 
 private:
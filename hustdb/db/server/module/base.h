@@ -34,6 +34,8 @@
 #define HUSTMQ_QUEUE                    "./DATA/meta_index/mq_queue"
 #define HUSTDB_TABLE                    "./DATA/meta_index/db_table"
 #define HUSTSTORE_INVARIANT             "./DATA/meta_index/invariant"
+#define HUSTDB_HINCRBY_JOURNAL          "./DATA/meta_index/hincrby_journal"
+#define HUSTDB_HINCRBY_JOURNAL_OLD      "./DATA/meta_index/hincrby_journal.old"
 
 #define PAGE                            1024
 
@@ -0,0 +1,479 @@
+#include "hincrby_buffer.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+#define HINCRBY_JOURNAL_MAGIC         0x48494e44
+
+typedef struct hincrby_journal_head_s
+{
+    uint32_t    magic;
+    uint8_t     clear;
+    uint8_t     _reserved;
+    uint16_t    host_len;
+    uint16_t    table_len;
+    uint16_t    inner_table_len;
+    uint32_t    key_len;
+    uint32_t    ttl;
+    uint32_t    ver;
+    int64_t     value;
+} __attribute__ ( ( packed ) ) hincrby_journal_head_t;
+
+// a missing file reads as empty
+static bool load_file (
+                        const char *  path,
+                        std::string & content
+                        )
+{
+    content.clear ();
+
+    int fd = :: open ( path, O_RDONLY );
+    if ( fd < 0 )
+    {
+        if ( ENOENT == errno )
+        {
+            return true;
+        }
+
+        LOG_ERROR ( "[hincrby_buffer][load_file][file=%s][errno=%d]open failed",
+                    path, errno );
+        return false;
+    }
+
+    char buf[ 65536 ];
+    ssize_t r = 0;
+    while ( ( r = read ( fd, buf, sizeof ( buf ) ) ) > 0 )
+    {
+        content.append ( buf, r );
+    }
+    :: close ( fd );
+
+    if ( r < 0 )
+    {
+        LOG_ERROR ( "[hincrby_buffer][load_file][file=%s][errno=%d]read failed",
+                    path, errno );
+        return false;
+    }
+
+    return true;
+}
+
+hincrby_buffer_t::hincrby_buffer_t ( )
+: m_size ( 0 )
+, m_journal ( false )
+, m_fd ( - 1 )
+, m_epoch ( 1 )
+, m_rotated ( 1 )
+, m_clean ( 0 )
+, m_journal_locker ( )
+{
+}
+
+hincrby_buffer_t::~ hincrby_buffer_t ( )
+{
+    close ();
+}
+
+bool hincrby_buffer_t::open (
+                              bool journal
+                              )
+{
+    m_journal = journal;
+
+    if ( ! m_journal )
+    {
+        return true;
+    }
+
+    m_fd = :: open ( HUSTDB_HINCRBY_JOURNAL, O_WRONLY | O_CREAT | O_APPEND, 0644 );
+    if ( m_fd < 0 )
+    {
+        LOG_ERROR ( "[hincrby_buffer][open][file=%s][errno=%d]journal open failed",
+                    HUSTDB_HINCRBY_JOURNAL, errno );
+        return false;
+    }
+
+    return true;
+}
+
+void hincrby_buffer_t::close ( )
+{
+    scope_lock_t locker ( m_journal_locker );
+
+    if ( m_fd >= 0 )
+    {
+        :: close ( m_fd );
+        m_fd = - 1;
+    }
+}
+
+uint32_t hincrby_buffer_t::shard_of (
+                                      const std::string & id
+                                      )
+{
+    uint32_t h = 2166136261u;
+
+    for ( size_t i = 0; i < id.size (); i ++ )
+    {
+        h = ( h ^ ( uint8_t ) id [ i ] ) * 16777619u;
+    }
+
+    return h % HINCRBY_SHARD_NUM;
+}
+
+void hincrby_buffer_t::make_id (
+                                 const std::string & inner_table,
+                                 const char *        key,
+                                 size_t              key_len,
+                                 std::string &       id
+                                 )
+{
+    id.reserve ( inner_table.size () + key_len + 1 );
+    id.assign ( inner_table );
+    id.push_back ( '\0' );
+    id.append ( key, key_len );
+}
+
+hincrby_item_t * hincrby_buffer_t::find (
+                                          const std::string & inner_table,
+                                          const char *        key,
+                                          size_t              key_len
+                                          )
+{
+    std::string id;
+    make_id ( inner_table, key, key_len, id );
+
+    shard_t & shard = m_shards [ shard_of ( id ) ];
+    scope_lock_t locker ( shard.locker );
+
+    item_map_t::iterator it = shard.items.find ( id );
+
+    return ( it == shard.items.end () ) ? NULL : & it->second;
+}
+
+hincrby_item_t * hincrby_buffer_t::insert (
+                                            const std::string & inner_table,
+                                            const char *        key,
+                                            size_t              key_len
+                                            )
+{
+    std::string id;
+    make_id ( inner_table, key, key_len, id );
+
+    shard_t & shard = m_shards [ shard_of ( id ) ];
+    scope_lock_t locker ( shard.locker );
+
+    try
+    {
+        std::pair< item_map_t::iterator, bool > r = shard.items.insert ( std::make_pair ( id, hincrby_item_t () ) );
+        if ( r.second )
+        {
+            r.first->second.inner_table = inner_table;
+            r.first->second.key.assign ( key, key_len );
+            __sync_add_and_fetch ( & m_size, 1 );
+        }
+
+        return & r.first->second;
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[hincrby_buffer][insert]bad_alloc" );
+    }
+
+    return NULL;
+}
+
+void hincrby_buffer_t::erase (
+                               const std::string & inner_table,
+                               const char *        key,
+                               size_t              key_len
+                               )
+{
+    std::string id;
+    make_id ( inner_table, key, key_len, id );
+
+    shard_t & shard = m_shards [ shard_of ( id ) ];
+    scope_lock_t locker ( shard.locker );
+
+    if ( shard.items.erase ( id ) > 0 )
+    {
+        __sync_sub_and_fetch ( & m_size, 1 );
+    }
+}
+
+size_t hincrby_buffer_t::size ( )
+{
+    return ( size_t ) m_size;
+}
+
+void hincrby_buffer_t::keys (
+                              hincrby_keys_t & keys
+                              )
+{
+    keys.reserve ( size () );
+
+    for ( int i = 0; i < HINCRBY_SHARD_NUM; i ++ )
+    {
+        shard_t & shard = m_shards [ i ];
+        scope_lock_t locker ( shard.locker );
+
+        for ( item_map_t::iterator it = shard.items.begin (); it != shard.items.end (); ++ it )
+        {
+            keys.push_back ( std::make_pair ( it->second.inner_table, it->second.key ) );
+        }
+    }
+}
+
+bool hincrby_buffer_t::idle (
+                              hincrby_item_t * item
+                              )
+{
+    return 0 == item->delta && item->epoch < m_clean;
+}
+
+bool hincrby_buffer_t::append (
+                                hincrby_item_t * item,
+                                int64_t          value,
+                                bool             clear
+                                )
+{
+    if ( ! m_journal )
+    {
+        item->epoch = m_epoch;
+        return true;
+    }
+
+    scope_lock_t locker ( m_journal_locker );
+
+    item->epoch = m_epoch;
+
+    if ( m_fd < 0 )
+    {
+        return false;
+    }
+
+    hincrby_journal_head_t head;
+    head.magic           = HINCRBY_JOURNAL_MAGIC;
+    head.clear           = clear ? 1 : 0;
+    head._reserved       = 0;
+    head.host_len        = ( uint16_t ) item->host.size ();
+    head.table_len       = ( uint16_t ) item->table.size ();
+    head.inner_table_len = ( uint16_t ) item->inner_table.size ();
+    head.key_len         = ( uint32_t ) item->key.size ();
+    head.ttl             = item->ttl;
+    head.ver             = item->ver;
+    head.value           = value;
+
+    std::string buf;
+    buf.reserve ( sizeof ( head ) + head.host_len + head.table_len + head.inner_table_len + head.key_len );
+    buf.append ( ( const char * ) & head, sizeof ( head ) );
+    buf.append ( item->host );
+    buf.append ( item->table );
+    buf.append ( item->inner_table );
+    buf.append ( item->key );
+
+    // O_APPEND, one write per record
+    ssize_t r = write ( m_fd, buf.c_str (), buf.size () );
+    if ( r != ( ssize_t ) buf.size () )
+    {
+        LOG_ERROR ( "[hincrby_buffer][append][r=%d][errno=%d]journal write failed",
+                    ( int ) r, errno );
+        return false;
+    }
+
+    return true;
+}
+
+bool hincrby_buffer_t::journal_value (
+                                       hincrby_item_t * item,
+                                       int64_t          value
+                                       )
+{
+    return append ( item, value, false );
+}
+
+bool hincrby_buffer_t::journal_clear (
+                                       hincrby_item_t * item
+                                       )
+{
+    return append ( item, 0, true );
+}
+
+bool hincrby_buffer_t::rotate ( )
+{
+    scope_lock_t locker ( m_journal_locker );
+
+    m_rotated = ++ m_epoch;
+
+    if ( ! m_journal || m_fd < 0 )
+    {
+        return true;
+    }
+
+    if ( 0 != access ( HUSTDB_HINCRBY_JOURNAL_OLD, F_OK ) )
+    {
+        :: close ( m_fd );
+        m_fd = - 1;
+
+        if ( 0 != rename ( HUSTDB_HINCRBY_JOURNAL, HUSTDB_HINCRBY_JOURNAL_OLD ) )
+        {
+            LOG_ERROR ( "[hincrby_buffer][rotate][errno=%d]journal rename failed",
+                        errno );
+        }
+
+        m_fd = :: open ( HUSTDB_HINCRBY_JOURNAL, O_WRONLY | O_CREAT | O_APPEND, 0644 );
+        if ( m_fd < 0 )
+        {
+            LOG_ERROR ( "[hincrby_buffer][rotate][errno=%d]journal open failed",
+                        errno );
+            return false;
+        }
+
+        return true;
+    }
+
+    // the last flush did not finish, the current records are moved
+    // behind the ones still waiting in the rotated file
+    std::string content;
+    if ( ! load_file ( HUSTDB_HINCRBY_JOURNAL, content ) )
+    {
+        return false;
+    }
+
+    int fd = :: open ( HUSTDB_HINCRBY_JOURNAL_OLD, O_WRONLY | O_APPEND );
+    if ( fd < 0 )
+    {
+        LOG_ERROR ( "[hincrby_buffer][rotate][errno=%d]rotated journal open failed",
+                    errno );
+        return false;
+    }
+
+    ssize_t r = write ( fd, content.c_str (), content.size () );
+    :: close ( fd );
+    if ( r != ( ssize_t ) content.size () )
+    {
+        LOG_ERROR ( "[hincrby_buffer][rotate][errno=%d]rotated journal write failed",
+                    errno );
+        return false;
+    }
+
+    if ( 0 != ftruncate ( m_fd, 0 ) )
+    {
+        LOG_ERROR ( "[hincrby_buffer][rotate][errno=%d]journal truncate failed",
+                    errno );
+        return false;
+    }
+
+    return true;
+}
+
+void hincrby_buffer_t::commit ( )
+{
+    scope_lock_t locker ( m_journal_locker );
+
+    if ( m_journal && 0 != unlink ( HUSTDB_HINCRBY_JOURNAL_OLD ) && ENOENT != errno )
+    {
+        LOG_ERROR ( "[hincrby_buffer][commit][errno=%d]rotated journal unlink failed",
+                    errno );
+        return;
+    }
+
+    m_clean = m_rotated;
+}
+
+void hincrby_buffer_t::hold ( )
+{
+    m_journal_locker.lock ();
+}
+
+void hincrby_buffer_t::release ( )
+{
+    m_journal_locker.unlock ();
+}
+
+bool hincrby_buffer_t::read_file (
+                                   const char *        path,
+                                   hincrby_records_t & records
+                                   )
+{
+    std::string content;
+    if ( ! load_file ( path, content ) )
+    {
+        return false;
+    }
+
+    size_t pos = 0;
+    while ( pos + sizeof ( hincrby_journal_head_t ) <= content.size () )
+    {
+        hincrby_journal_head_t head;
+        memcpy ( & head, content.c_str () + pos, sizeof ( head ) );
+
+        size_t len = sizeof ( head ) + head.host_len + head.table_len + head.inner_table_len + head.key_len;
+        if ( HINCRBY_JOURNAL_MAGIC != head.magic || pos + len > content.size () )
+        {
+            break;
+        }
+
+        const char * p = content.c_str () + pos + sizeof ( head );
+
+        hincrby_record_t record;
+        record.host.assign ( p, head.host_len );
+        p += head.host_len;
+        record.table.assign ( p, head.table_len );
+        p += head.table_len;
+        record.inner_table.assign ( p, head.inner_table_len );
+        p += head.inner_table_len;
+        record.key.assign ( p, head.key_len );
+        record.value = head.value;
+        record.ttl   = head.ttl;
+        record.ver   = head.ver;
+        record.clear = ( 0 != head.clear );
+
+        records.push_back ( record );
+        pos += len;
+    }
+
+    if ( pos != content.size () )
+    {
+        LOG_ERROR ( "[hincrby_buffer][read_file][file=%s][offset=%d]journal truncated",
+                    path, ( int ) pos );
+    }
+
+    return true;
+}
+
+bool hincrby_buffer_t::replay (
+                                hincrby_records_t & records
+                                )
+{
+    try
+    {
+        return read_file ( HUSTDB_HINCRBY_JOURNAL_OLD, records ) &&
+               read_file ( HUSTDB_HINCRBY_JOURNAL, records );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[hincrby_buffer][replay]bad_alloc" );
+    }
+
+    return false;
+}
+
+void hincrby_buffer_t::reset ( )
+{
+    scope_lock_t locker ( m_journal_locker );
+
+    unlink ( HUSTDB_HINCRBY_JOURNAL_OLD );
+
+    if ( m_fd >= 0 )
+    {
+        if ( 0 != ftruncate ( m_fd, 0 ) )
+        {
+            LOG_ERROR ( "[hincrby_buffer][reset][errno=%d]journal truncate failed",
+                        errno );
+        }
+    }
+    else
+    {
+        unlink ( HUSTDB_HINCRBY_JOURNAL );
+    }
+}
@@ -0,0 +1,191 @@
+#ifndef _hincrby_buffer_h_
+#define _hincrby_buffer_h_
+
+#include "db_stdinc.h"
+#include "db_lib.h"
+#include "base.h"
+#include <map>
+#include <vector>
+
+#define HINCRBY_SHARD_NUM             64
+
+// a counter whose increments are merged in memory: base is the value held by
+// the storage, delta the sum of the increments not written yet and ver the
+// version returned by the last one, the flush writes the value with it
+typedef struct hincrby_item_s
+{
+    std::string   table;
+    std::string   inner_table;
+    std::string   key;
+    std::string   host;
+    int64_t       base;
+    int64_t       delta;
+    uint32_t      ver;
+    uint32_t      ttl;
+    uint32_t      count;
+    // journal epoch of the last increment, see hincrby_buffer_t::idle
+    uint32_t      epoch;
+
+    hincrby_item_s ( )
+    : table ( )
+    , inner_table ( )
+    , key ( )
+    , host ( )
+    , base ( 0 )
+    , delta ( 0 )
+    , ver ( 0 )
+    , ttl ( 0 )
+    , count ( 0 )
+    , epoch ( 0 )
+    {
+    }
+
+} hincrby_item_t;
+
+// a record read back from the journal, clear drops the records before it
+typedef struct hincrby_record_s
+{
+    std::string   table;
+    std::string   inner_table;
+    std::string   key;
+    std::string   host;
+    int64_t       value;
+    uint32_t      ttl;
+    // the version the increment returned
+    uint32_t      ver;
+    bool          clear;
+
+} hincrby_record_t;
+
+typedef std::vector< hincrby_record_t > hincrby_records_t;
+
+// ( inner_table, key )
+typedef std::vector< std::pair< std::string, std::string > > hincrby_keys_t;
+
+// the items are sharded by key, a shard lock only guards the map itself:
+// an item is read and written under the key lock of hustdb_t.
+//
+// the journal holds the value a counter had after every increment, and the
+// version that increment returned, so that replaying it is idempotent. it is rotated at the start of every flush and
+// the rotated file is removed once the flush is done; an item is kept until
+// no journal file refers to it, which lets hset / hdel clear its records.
+class hincrby_buffer_t
+{
+public:
+
+    hincrby_buffer_t ( );
+    ~hincrby_buffer_t ( );
+
+    bool open (
+                bool journal
+                );
+
+    void close ( );
+
+    hincrby_item_t * find (
+                            const std::string & inner_table,
+                            const char *        key,
+                            size_t              key_len
+                            );
+
+    hincrby_item_t * insert (
+                              const std::string & inner_table,
+                              const char *        key,
+                              size_t              key_len
+                              );
+
+    void erase (
+                 const std::string & inner_table,
+                 const char *        key,
+                 size_t              key_len
+                 );
+
+    size_t size ( );
+
+    void keys (
+                hincrby_keys_t & keys
+                );
+
+    // true if the item may be erased, no journal file left refers to it
+    bool idle (
+                hincrby_item_t * item
+                );
+
+    // sets item->epoch
+    bool journal_value (
+                         hincrby_item_t * item,
+                         int64_t          value
+                         );
+
+    bool journal_clear (
+                         hincrby_item_t * item
+                         );
+
+    bool rotate ( );
+
+    void commit ( );
+
+    // the journal files are neither written nor rotated until release
+    void hold ( );
+
+    void release ( );
+
+    // the rotated journal first, then the current one
+    bool replay (
+                  hincrby_records_t & records
+                  );
+
+    void reset ( );
+
+private:
+
+    typedef std::map< std::string, hincrby_item_t > item_map_t;
+
+    typedef struct shard_s
+    {
+        lockable_t      locker;
+        item_map_t      items;
+    } shard_t;
+
+    uint32_t shard_of (
+                        const std::string & id
+                        );
+
+    void make_id (
+                   const std::string & inner_table,
+                   const char *        key,
+                   size_t              key_len,
+                   std::string &       id
+                   );
+
+    bool append (
+                  hincrby_item_t * item,
+                  int64_t          value,
+                  bool             clear
+                  );
+
+    bool read_file (
+                     const char *        path,
+                     hincrby_records_t & records
+                     );
+
+private:
+
+    shard_t             m_shards [ HINCRBY_SHARD_NUM ];
+    volatile int64_t    m_size;
+
+    bool                m_journal;
+    int                 m_fd;
+    uint32_t            m_epoch;
+    // epoch of the last rotation, and of the last one whose file is gone
+    uint32_t            m_rotated;
+    uint32_t            m_clean;
+    lockable_t          m_journal_locker;
+
+private:
+    // disable
+    hincrby_buffer_t ( const hincrby_buffer_t & );
+    const hincrby_buffer_t & operator= ( const hincrby_buffer_t & );
+};
+
+#endif
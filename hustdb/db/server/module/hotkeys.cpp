@@ -0,0 +1,455 @@
+#include "hotkeys.h"
+#include "../network/hustdb_utils.h"
+#include <algorithm>
+#include <map>
+#include <sys/time.h>
+
+// weight of the rates of the previous windows
+#define HOTKEYS_DECAY                 0.5
+// rates below are dropped
+#define HOTKEYS_MIN_QPS               0.01
+
+static const char * g_op_names[] =
+{
+    "get",
+    "put",
+    "hget",
+    "hset",
+    "hincrby",
+    "zadd",
+    "mq_put",
+    "mq_get"
+};
+
+// FNV-1a over ( op, table, key )
+static uint64_t hotkey_hash (
+                              uint32_t     op,
+                              const char * table,
+                              size_t       table_len,
+                              const char * key,
+                              size_t       key_len
+                              )
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    h = ( h ^ op ) * 1099511628211ULL;
+    for ( size_t i = 0; i < table_len; ++ i )
+    {
+        h = ( h ^ ( uint8_t ) table[ i ] ) * 1099511628211ULL;
+    }
+    h = ( h ^ 0xff ) * 1099511628211ULL;
+    for ( size_t i = 0; i < key_len; ++ i )
+    {
+        h = ( h ^ ( uint8_t ) key[ i ] ) * 1099511628211ULL;
+    }
+
+    return h;
+}
+
+static bool hotkey_item_less (
+                               const hotkey_item_t & a,
+                               const hotkey_item_t & b
+                               )
+{
+    if ( a.op != b.op )
+    {
+        return a.op < b.op;
+    }
+    if ( a.table != b.table )
+    {
+        return a.table < b.table;
+    }
+    return a.key < b.key;
+}
+
+static bool rate_greater (
+                           const hotkeys_t::rate_t & a,
+                           const hotkeys_t::rate_t & b
+                           )
+{
+    return a.qps > b.qps;
+}
+
+static double elapsed_seconds (
+                                const struct timeval & from,
+                                const struct timeval & to
+                                )
+{
+    double s = ( double ) ( to.tv_sec - from.tv_sec ) + ( double ) ( to.tv_usec - from.tv_usec ) / 1000000.0;
+    return s > 0.001 ? s : 0.001;
+}
+
+hotkeys_t::hotkeys_t ( )
+: m_slots ( NULL )
+, m_slot_count ( 0 )
+, m_top_k ( 0 )
+, m_rates ( )
+, m_rates_locker ( )
+{
+    m_last_merge.tv_sec  = 0;
+    m_last_merge.tv_usec = 0;
+}
+
+hotkeys_t::~hotkeys_t ( )
+{
+    close ();
+}
+
+bool hotkeys_t::open (
+                       int32_t slots,
+                       int32_t top_k
+                       )
+{
+    if ( slots <= 0 || top_k <= 0 || top_k > HOTKEYS_TOP_MAX )
+    {
+        LOG_ERROR ( "[hotkeys][open][slots=%d][top_k=%d]params error",
+                    slots, top_k );
+        return false;
+    }
+
+    try
+    {
+        m_slots = new slot_t [ slots ];
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[hotkeys][open]bad_alloc" );
+        return false;
+    }
+
+    for ( int32_t i = 0; i < slots; ++ i )
+    {
+        memset ( m_slots[ i ].sketch, 0, sizeof ( m_slots[ i ].sketch ) );
+        m_slots[ i ].items.reserve ( top_k );
+        m_slots[ i ].floor = 0;
+    }
+
+    m_slot_count = slots;
+    m_top_k      = top_k;
+    gettimeofday ( & m_last_merge, NULL );
+
+    return true;
+}
+
+void hotkeys_t::close ( )
+{
+    if ( m_slots )
+    {
+        delete [] m_slots;
+        m_slots = NULL;
+    }
+    m_slot_count = 0;
+}
+
+void hotkeys_t::record (
+                         uint32_t     slot,
+                         uint32_t     op,
+                         const char * table,
+                         size_t       table_len,
+                         const char * key,
+                         size_t       key_len,
+                         size_t       bytes
+                         )
+{
+    if ( unlikely ( ! m_slots || slot >= ( uint32_t ) m_slot_count ) )
+    {
+        return;
+    }
+
+    if ( ! table )
+    {
+        table     = "";
+        table_len = 0;
+    }
+
+    slot_t & s = m_slots[ slot ];
+
+    scope_lock_t locker ( s.locker );
+
+    if ( key_len > 0 )
+    {
+        record_item ( s, op, table, table_len, key, key_len, bytes );
+    }
+    if ( table_len > 0 )
+    {
+        record_item ( s, op, table, table_len, "", 0, bytes );
+    }
+}
+
+void hotkeys_t::record_item (
+                              slot_t &     slot,
+                              uint32_t     op,
+                              const char * table,
+                              size_t       table_len,
+                              const char * key,
+                              size_t       key_len,
+                              size_t       bytes
+                              )
+{
+    uint64_t h   = hotkey_hash ( op, table, table_len, key, key_len );
+    uint32_t h1  = ( uint32_t ) h;
+    uint32_t h2  = ( uint32_t ) ( h >> 32 ) | 1;
+    uint64_t est = ( uint64_t ) - 1;
+
+    for ( uint32_t r = 0; r < HOTKEYS_SKETCH_DEPTH; ++ r )
+    {
+        uint32_t & c = slot.sketch[ r ][ ( h1 + r * h2 ) & ( HOTKEYS_SKETCH_WIDTH - 1 ) ];
+        if ( likely ( c < ( uint32_t ) - 1 ) )
+        {
+            ++ c;
+        }
+        if ( c < est )
+        {
+            est = c;
+        }
+    }
+
+    // the items kept all have a count above the floor: an estimate that
+    // does not pass it is neither kept nor able to replace one
+    if ( slot.floor > 0 && est <= slot.floor )
+    {
+        return;
+    }
+
+    size_t size = slot.items.size ();
+    for ( size_t i = 0; i < size; ++ i )
+    {
+        hotkey_item_t & it = slot.items[ i ];
+        if ( it.hash != h ||
+             it.op != op ||
+             it.table.size () != table_len ||
+             it.key.size () != key_len ||
+             0 != memcmp ( it.table.c_str (), table, table_len ) ||
+             0 != memcmp ( it.key.c_str (), key, key_len )
+            )
+        {
+            continue;
+        }
+
+        bool at_floor = ( it.count == slot.floor );
+        it.count  = est;
+        it.hits  += 1;
+        it.bytes += bytes;
+        if ( at_floor && size >= ( size_t ) m_top_k )
+        {
+            update_floor ( slot );
+        }
+        return;
+    }
+
+    hotkey_item_t * target = NULL;
+    if ( size < ( size_t ) m_top_k )
+    {
+        slot.items.push_back ( hotkey_item_t () );
+        target = & slot.items.back ();
+    }
+    else
+    {
+        // space-saving: the new item takes the place of the smallest one
+        target = & slot.items[ 0 ];
+        for ( size_t i = 1; i < size; ++ i )
+        {
+            if ( slot.items[ i ].count < target->count )
+            {
+                target = & slot.items[ i ];
+            }
+        }
+    }
+
+    target->table.assign ( table, table_len );
+    if ( key_len > 0 )
+    {
+        target->key.assign ( key, key_len );
+    }
+    else
+    {
+        target->key.clear ();
+    }
+    target->hash  = h;
+    target->op    = op;
+    target->count = est;
+    target->hits  = 1;
+    target->bytes = bytes;
+
+    if ( slot.items.size () >= ( size_t ) m_top_k )
+    {
+        update_floor ( slot );
+    }
+}
+
+void hotkeys_t::update_floor (
+                               slot_t & slot
+                               )
+{
+    uint64_t floor = ( uint64_t ) - 1;
+    for ( size_t i = 0; i < slot.items.size (); ++ i )
+    {
+        if ( slot.items[ i ].count < floor )
+        {
+            floor = slot.items[ i ].count;
+        }
+    }
+    slot.floor = floor;
+}
+
+void hotkeys_t::merge ( )
+{
+    if ( ! m_slots )
+    {
+        return;
+    }
+
+    struct timeval now;
+    gettimeofday ( & now, NULL );
+
+    hotkey_items_t window;
+    for ( int32_t i = 0; i < m_slot_count; ++ i )
+    {
+        slot_t & s = m_slots[ i ];
+
+        scope_lock_t locker ( s.locker );
+
+        window.insert ( window.end (), s.items.begin (), s.items.end () );
+        s.items.clear ();
+        memset ( s.sketch, 0, sizeof ( s.sketch ) );
+        s.floor = 0;
+    }
+
+    std::sort ( window.begin (), window.end (), hotkey_item_less );
+
+    scope_lock_t locker ( m_rates_locker );
+
+    double elapsed = elapsed_seconds ( m_last_merge, now );
+    m_last_merge = now;
+
+    typedef std::map< std::string, size_t > index_t;
+    index_t index;
+    for ( size_t i = 0; i < m_rates.size (); ++ i )
+    {
+        rate_t & rate = m_rates[ i ];
+        rate.qps   *= HOTKEYS_DECAY;
+        rate.bytes *= HOTKEYS_DECAY;
+
+        std::string id ( 1, ( char ) rate.op );
+        id += rate.table;
+        id += '\0';
+        id += rate.key;
+        index[ id ] = i;
+    }
+
+    // the same item seen by several workers is added up
+    size_t i = 0;
+    while ( i < window.size () )
+    {
+        const hotkey_item_t & first = window[ i ];
+        double count = 0;
+        double bytes = 0;
+
+        size_t j = i;
+        for ( ; j < window.size () && ! hotkey_item_less ( first, window[ j ] ); ++ j )
+        {
+            const hotkey_item_t & it = window[ j ];
+            count += ( double ) it.count;
+            // the bytes of the requests seen before the item was kept are
+            // taken at the average size
+            bytes += it.hits > 0 ? ( double ) it.bytes / ( double ) it.hits * ( double ) it.count : 0;
+        }
+
+        std::string id ( 1, ( char ) first.op );
+        id += first.table;
+        id += '\0';
+        id += first.key;
+
+        index_t::iterator found = index.find ( id );
+        if ( found == index.end () )
+        {
+            rate_t rate;
+            rate.table = first.table;
+            rate.key   = first.key;
+            rate.op    = first.op;
+            rate.qps   = 0;
+            rate.bytes = 0;
+            m_rates.push_back ( rate );
+            found = index.insert ( std::make_pair ( id, m_rates.size () - 1 ) ).first;
+        }
+
+        rate_t & rate = m_rates[ found->second ];
+        rate.qps   += ( 1 - HOTKEYS_DECAY ) * count / elapsed;
+        rate.bytes += ( 1 - HOTKEYS_DECAY ) * bytes / elapsed;
+
+        i = j;
+    }
+
+    rates_t kept;
+    kept.reserve ( m_rates.size () );
+    for ( size_t k = 0; k < m_rates.size (); ++ k )
+    {
+        if ( m_rates[ k ].qps >= HOTKEYS_MIN_QPS )
+        {
+            kept.push_back ( m_rates[ k ] );
+        }
+    }
+
+    // hottest first, twice the top-K is kept so that an item does not drop
+    // out on one quiet window
+    std::sort ( kept.begin (), kept.end (), rate_greater );
+    if ( kept.size () > ( size_t ) m_top_k * 2 )
+    {
+        kept.resize ( m_top_k * 2 );
+    }
+
+    m_rates.swap ( kept );
+}
+
+void hotkeys_t::query (
+                        int32_t       n,
+                        std::string & rsp
+                        )
+{
+    char          num[ 64 ];
+    c_str_t       base64_src;
+    c_str_t       base64_dst;
+    std::string   base64_item;
+
+    rsp = "[";
+
+    scope_lock_t locker ( m_rates_locker );
+
+    if ( n <= 0 || n > m_top_k )
+    {
+        n = m_top_k;
+    }
+
+    for ( size_t i = 0; i < m_rates.size () && i < ( size_t ) n; ++ i )
+    {
+        const rate_t & rate = m_rates[ i ];
+
+        rsp += "{\"op\":\"";
+        rsp += g_op_names[ rate.op ];
+        rsp += "\",\"table\":\"";
+        rsp += rate.table;
+        rsp += "\",\"key\":\"";
+
+        if ( ! rate.key.empty () )
+        {
+            base64_src.len  = rate.key.size ();
+            base64_src.data = ( char * ) rate.key.c_str ();
+
+            base64_dst.len  = c_base64_encoded_length ( base64_src.len );
+            base64_item.resize ( base64_dst.len );
+            base64_dst.data = ( char * ) base64_item.c_str ();
+
+            hustdb_base64_encode ( & base64_src, & base64_dst );
+            rsp.append ( base64_dst.data, base64_dst.len );
+        }
+
+        snprintf ( num, sizeof ( num ), "\",\"qps\":%.2f,\"bytes\":%.2f},", rate.qps, rate.bytes );
+        rsp += num;
+    }
+
+    if ( rsp.size () > 1 )
+    {
+        rsp.erase ( rsp.end () - 1, rsp.end () );
+    }
+    rsp += "]";
+}
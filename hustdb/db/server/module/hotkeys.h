@@ -0,0 +1,149 @@
+#ifndef _hotkeys_h_
+#define _hotkeys_h_
+
+#include "db_stdinc.h"
+#include "db_lib.h"
+#include "base.h"
+#include <vector>
+
+#define HOTKEYS_SKETCH_DEPTH          4
+#define HOTKEYS_SKETCH_WIDTH          1024
+#define HOTKEYS_TOP_MAX               256
+
+// op types
+#define HOTKEY_GET                    0
+#define HOTKEY_PUT                    1
+#define HOTKEY_HGET                   2
+#define HOTKEY_HSET                   3
+#define HOTKEY_HINCRBY                4
+#define HOTKEY_ZADD                   5
+#define HOTKEY_MQ_PUT                 6
+#define HOTKEY_MQ_GET                 7
+
+// a key ( or a table / queue, with an empty key ) of the top-K
+typedef struct hotkey_item_s
+{
+    std::string   table;
+    std::string   key;
+    uint64_t      hash;
+    uint32_t      op;
+    // count-min estimate of the requests in the window
+    uint64_t      count;
+    // requests and bytes seen since the item entered the top-K
+    uint64_t      hits;
+    uint64_t      bytes;
+
+    hotkey_item_s ( )
+    : table ( )
+    , key ( )
+    , hash ( 0 )
+    , op ( 0 )
+    , count ( 0 )
+    , hits ( 0 )
+    , bytes ( 0 )
+    {
+    }
+
+} hotkey_item_t;
+
+typedef std::vector< hotkey_item_t > hotkey_items_t;
+
+// heavy hitters per op type.
+//
+// every conn slot ( a worker, see hustdb_t::get_conn_count ) owns a
+// count-min sketch and a space-saving top-K: a request only touches the
+// top-K once its sketch estimate reaches the smallest count kept there.
+// merge runs on the timer, it takes the window of every slot, adds them up
+// and folds them into the rates with exponential decay.
+class hotkeys_t
+{
+public:
+
+    hotkeys_t ( );
+    ~hotkeys_t ( );
+
+    bool open (
+                int32_t slots,
+                int32_t top_k
+                );
+
+    void close ( );
+
+    bool ok ( )
+    {
+        return NULL != m_slots;
+    }
+
+    // a table / queue request counts for the table as well
+    void record (
+                  uint32_t     slot,
+                  uint32_t     op,
+                  const char * table,
+                  size_t       table_len,
+                  const char * key,
+                  size_t       key_len,
+                  size_t       bytes
+                  );
+
+    void merge ( );
+
+    typedef struct rate_s
+    {
+        std::string   table;
+        std::string   key;
+        uint32_t      op;
+        double        qps;
+        double        bytes;
+    } rate_t;
+
+    // [{"op","table","key","qps","bytes"}], key in base64, bytes per
+    // second, the n hottest by qps
+    void query (
+                 int32_t       n,
+                 std::string & rsp
+                 );
+
+private:
+
+    typedef struct slot_s
+    {
+        lockable_t      locker;
+        uint32_t        sketch [ HOTKEYS_SKETCH_DEPTH ][ HOTKEYS_SKETCH_WIDTH ];
+        hotkey_items_t  items;
+        // smallest count in items once it is full, 0 before
+        uint64_t        floor;
+    } __attribute__ ( ( aligned ( 64 ) ) ) slot_t;
+
+    typedef std::vector< rate_t > rates_t;
+
+    void record_item (
+                       slot_t &     slot,
+                       uint32_t     op,
+                       const char * table,
+                       size_t       table_len,
+                       const char * key,
+                       size_t       key_len,
+                       size_t       bytes
+                       );
+
+    void update_floor (
+                        slot_t & slot
+                        );
+
+private:
+
+    slot_t *            m_slots;
+    int32_t             m_slot_count;
+    int32_t             m_top_k;
+
+    rates_t             m_rates;
+    struct timeval      m_last_merge;
+    lockable_t          m_rates_locker;
+
+private:
+    // disable
+    hotkeys_t ( const hotkeys_t & );
+    const hotkeys_t & operator= ( const hotkeys_t & );
+};
+
+#endif
@@ -1,10 +1,16 @@
 #include "hustdb.h"
 #include "tasks/task_export.h"
+#include "tasks/task_load.h"
+#include "tasks/load_stage.h"
+#include "tasks/task_backup.h"
 #include "tasks/task_ttl_scan.h"
 #include "tasks/task_binlog_scan.h"
+#include "tasks/task_drop_scan.h"
 #include "kv/kv_array/key_hash.h"
 #include "perf_target.h"
 #include "kv/md5db/bucket.h"
+#include "utils/numa.h"
+#include "../network/hustdb_utils.h"
 #include <sstream>
 
 void hustdb_t::kill_me ( )
@@ -26,8 +32,16 @@ hustdb_t::hustdb_t ( )
 , m_rdb_ok ( false )
 , m_timer ( )
 , m_slow_tasks ( )
+, m_inner_hash ( INNER_HASH_MD5 )
 , m_mq_locker ( )
+, m_mq_watch_locker ( )
+, m_mq_changes ( )
+, m_mq_seq ( ( uint64_t ) time ( NULL ) << 20 ) // a restart never reuses a seq the ha holds
+, m_mq_notify ( NULL )
+, m_mq_notify_arg ( NULL )
 , m_tb_locker ( )
+, m_hincrby ( )
+, m_hotkeys ( )
 , m_server_conf ( )
 , m_store_conf ( )
 {
@@ -56,6 +70,14 @@ void hustdb_t::destroy ( )
     m_timer.kill_me ();
     LOG_INFO ( "[hustdb][destroy]timer closed" );
 
+    if ( m_storage_ok && m_store_conf.db_hincrby_combine )
+    {
+        LOG_INFO ( "[hustdb][destroy]hincrby flushing" );
+        hustdb_hincrby_flush ();
+        m_hincrby.close ();
+        LOG_INFO ( "[hustdb][destroy]hincrby flushed" );
+    }
+
     if ( m_storage )
     {
         m_storage_ok = false;
@@ -195,27 +217,59 @@ bool hustdb_t::open ( )
         return false;
     }
 
+    return true;
+}
+
+bool hustdb_t::open_storage ( )
+{
+    // before any storage thread starts, so that they inherit both
+    if ( m_server_conf.numa_interleave && ! hustdb::numa_interleave () )
+    {
+        LOG_ERROR ( "[hustdb][open_storage]numa interleave failed" );
+        return false;
+    }
+
+    if ( ! hustdb::hw_counters_open () )
+    {
+        LOG_INFO ( "[hustdb][open_storage]perf events not available, no dTLB and node load counters" );
+    }
+
     if ( ! init_data_engine () )
     {
-        LOG_ERROR ( "[hustdb][open]init_data_engine failed" );
+        LOG_ERROR ( "[hustdb][open_storage]init_data_engine failed" );
         return false;
     }
 
+    // the buckets point to the records of a load that stopped, the data
+    // files get them before anything reads them
+    if ( 0 != load_stage_t::replay ( m_storage, ( size_t ) m_store_conf.db_load_buffer_m * 1024 * 1024 ) )
+    {
+        LOG_ERROR ( "[hustdb][open_storage]load replay failed, the logs are kept" );
+    }
+
     if ( ! init_queue_index () )
     {
-        LOG_ERROR ( "[hustdb][open]init_queue_index failed" );
+        LOG_ERROR ( "[hustdb][open_storage]init_queue_index failed" );
         return false;
     }
 
     if ( ! init_table_index () )
     {
-        LOG_ERROR ( "[hustdb][open]init_table_index failed" );
+        LOG_ERROR ( "[hustdb][open_storage]init_table_index failed" );
         return false;
     }
     
     if ( ! m_slow_tasks.start () )
     {
-        LOG_ERROR ( "[hustdb][open]slow_tasks start failed" );
+        LOG_ERROR ( "[hustdb][open_storage]slow_tasks start failed" );
+        return false;
+    }
+
+    if ( m_store_conf.db_hotkeys_enable &&
+         ! m_hotkeys.open ( get_conn_count (), m_store_conf.db_hotkeys_top_k )
+        )
+    {
+        LOG_ERROR ( "[hustdb][open_storage]hotkeys open failed" );
         return false;
     }
 
@@ -223,11 +277,16 @@ bool hustdb_t::open ( )
              m_timer.register_task ( hustdb::timer_task_t ( 5, over_threshold_cb, this ) ) &&
              m_timer.register_task ( hustdb::timer_task_t ( m_store_conf.db_ttl_scan_interval, ttl_scan_cb, this ) ) &&
              m_timer.register_task ( hustdb::timer_task_t ( m_store_conf.db_binlog_scan_interval, binlog_scan_cb, this ) ) &&
+             m_timer.register_task ( hustdb::timer_task_t ( m_store_conf.db_drop_scan_interval, drop_scan_cb, this ) ) &&
+             ( ! m_store_conf.db_hincrby_combine ||
+               m_timer.register_task ( hustdb::timer_task_t ( m_store_conf.db_hincrby_flush_interval, hincrby_flush_cb, this ) ) ) &&
+             ( ! m_store_conf.db_hotkeys_enable ||
+               m_timer.register_task ( hustdb::timer_task_t ( m_store_conf.db_hotkeys_interval, hotkeys_merge_cb, this ) ) ) &&
              m_timer.open ( )
              )
          )
     {
-        LOG_ERROR ( "[hustdb][open]timer register task failed" );
+        LOG_ERROR ( "[hustdb][open_storage]timer register task failed" );
         return false;
     }
 
@@ -241,10 +300,22 @@ bool hustdb_t::open ( )
     }
     catch ( ... )
     {
-        LOG_ERROR ( "[hustdb][open]hustdb new locker failed" );
+        LOG_ERROR ( "[hustdb][open_storage]hustdb new locker failed" );
+        return false;
+    }
+
+    // counters journaled before a crash are written back first, whatever
+    // the current setting
+    if ( ! m_hincrby.open ( m_store_conf.db_hincrby_combine && m_store_conf.db_hincrby_journal ) ||
+         ! hincrby_replay ()
+        )
+    {
+        LOG_ERROR ( "[hustdb][open_storage]hincrby journal replay failed" );
         return false;
     }
 
+    // everything above is seen by the workers that see ok ()
+    __sync_synchronize ();
     m_storage_ok = true;
 
     return true;
@@ -320,6 +391,22 @@ bool hustdb_t::init_server_config ( )
         return false;
     }
 
+    m_server_conf.tcp_async_read_threads = m_appini->ini_get_int ( m_ini, "server", "tcp.async_read.threads", 0 );
+    if ( m_server_conf.tcp_async_read_threads < 0 || m_server_conf.tcp_async_read_threads > 64 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][async_read.threads=%d]server tcp.async_read.threads invalid", 
+                    m_server_conf.tcp_async_read_threads );
+        return false;
+    }
+
+    m_server_conf.tcp_async_read_depth = m_appini->ini_get_int ( m_ini, "server", "tcp.async_read.depth", 16 );
+    if ( m_server_conf.tcp_async_read_depth <= 0 || m_server_conf.tcp_async_read_depth > 4096 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][async_read.depth=%d]server tcp.async_read.depth invalid", 
+                    m_server_conf.tcp_async_read_depth );
+        return false;
+    }
+
     const char * s = NULL;
 
     s = m_appini->ini_get_string ( m_ini, "server", "http.security.user", "" );
@@ -347,6 +434,34 @@ bool hustdb_t::init_server_config ( )
         return false;
     }
 
+    s = m_appini->ini_get_string ( m_ini, "server", "numa.policy", "none" );
+    if ( s && 0 == strcmp ( s, "interleave" ) )
+    {
+        m_server_conf.numa_interleave = true;
+    }
+    else if ( s && 0 != strcmp ( s, "none" ) )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][numa.policy=%s]server numa.policy invalid", 
+                    s );
+        return false;
+    }
+
+    s = m_appini->ini_get_string ( m_ini, "server", "tcp.worker_affinity", "none" );
+    if ( s && 0 == strcmp ( s, "numa" ) )
+    {
+        m_server_conf.tcp_worker_affinity = WORKER_AFFINITY_NUMA;
+    }
+    else if ( s && 0 == strcmp ( s, "core" ) )
+    {
+        m_server_conf.tcp_worker_affinity = WORKER_AFFINITY_CORE;
+    }
+    else if ( s && 0 != strcmp ( s, "none" ) )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][worker_affinity=%s]server tcp.worker_affinity invalid", 
+                    s );
+        return false;
+    }
+
     m_store_conf.db_disk_storage_capacity = m_appini->ini_get_int ( m_ini, "store", "db.disk.storage_capacity", 512 );
     if ( m_store_conf.db_disk_storage_capacity <= 0 || m_store_conf.db_disk_storage_capacity > 60000 )
     {
@@ -452,15 +567,134 @@ bool hustdb_t::init_server_config ( )
         return false;
     }
 
+    m_store_conf.db_drop_scan_interval = m_appini->ini_get_int ( m_ini, "store", "db.drop.scan_interval", 1 );
+    if ( m_store_conf.db_drop_scan_interval <= 0 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][drop.scan_interval=%d]store db.drop.scan_interval invalid", 
+                    m_store_conf.db_drop_scan_interval );
+        return false;
+    }
+
+    m_store_conf.db_drop_scan_count = m_appini->ini_get_int ( m_ini, "store", "db.drop.scan_count", 1000 );
+    if ( m_store_conf.db_drop_scan_count <= 0 || m_store_conf.db_drop_scan_count > 10000 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][drop.scan_count=%d]store db.drop.scan_count invalid", 
+                    m_store_conf.db_drop_scan_count );
+        return false;
+    }
+
+    m_store_conf.db_hincrby_combine = m_appini->ini_get_bool ( m_ini, "store", "db.hincrby.combine", false );
+    m_store_conf.db_hincrby_journal = m_appini->ini_get_bool ( m_ini, "store", "db.hincrby.journal", false );
+
+    m_store_conf.db_hincrby_flush_interval = m_appini->ini_get_int ( m_ini, "store", "db.hincrby.flush_interval", 1 );
+    if ( m_store_conf.db_hincrby_flush_interval <= 0 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][hincrby.flush_interval=%d]store db.hincrby.flush_interval invalid", 
+                    m_store_conf.db_hincrby_flush_interval );
+        return false;
+    }
+
+    m_store_conf.db_hincrby_flush_count = m_appini->ini_get_int ( m_ini, "store", "db.hincrby.flush_count", 1000 );
+    if ( m_store_conf.db_hincrby_flush_count <= 0 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][hincrby.flush_count=%d]store db.hincrby.flush_count invalid", 
+                    m_store_conf.db_hincrby_flush_count );
+        return false;
+    }
+
+    m_store_conf.db_hincrby_max_keys = m_appini->ini_get_int ( m_ini, "store", "db.hincrby.max_keys", 65536 );
+    if ( m_store_conf.db_hincrby_max_keys <= 0 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][hincrby.max_keys=%d]store db.hincrby.max_keys invalid", 
+                    m_store_conf.db_hincrby_max_keys );
+        return false;
+    }
+
+    m_store_conf.db_hotkeys_enable = m_appini->ini_get_bool ( m_ini, "store", "db.hotkeys.enable", false );
+
+    m_store_conf.db_hotkeys_top_k = m_appini->ini_get_int ( m_ini, "store", "db.hotkeys.top_k", 32 );
+    if ( m_store_conf.db_hotkeys_top_k <= 0 || m_store_conf.db_hotkeys_top_k > HOTKEYS_TOP_MAX )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][hotkeys.top_k=%d]store db.hotkeys.top_k invalid", 
+                    m_store_conf.db_hotkeys_top_k );
+        return false;
+    }
+
+    m_store_conf.db_hotkeys_interval = m_appini->ini_get_int ( m_ini, "store", "db.hotkeys.interval", 10 );
+    if ( m_store_conf.db_hotkeys_interval <= 0 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][hotkeys.interval=%d]store db.hotkeys.interval invalid", 
+                    m_store_conf.db_hotkeys_interval );
+        return false;
+    }
+
+    m_store_conf.db_load_buffer_m = m_appini->ini_get_int ( m_ini, "store", "db.load.buffer_m", 256 );
+    if ( m_store_conf.db_load_buffer_m <= 0 || m_store_conf.db_load_buffer_m > 65536 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][load.buffer_m=%d]store db.load.buffer_m invalid", 
+                    m_store_conf.db_load_buffer_m );
+        return false;
+    }
+
+    m_store_conf.db_backup_rate_limit = m_appini->ini_get_int ( m_ini, "store", "db.backup.rate_limit", 64 );
+    if ( m_store_conf.db_backup_rate_limit < 0 )
+    {
+        LOG_ERROR ( "[hustdb][init_server_config][backup.rate_limit=%d]store db.backup.rate_limit invalid", 
+                    m_store_conf.db_backup_rate_limit );
+        return false;
+    }
+
     return true;
 }
 
+int hustdb_t::inner_hash_from_string (
+                                       const char * s
+                                       )
+{
+    if ( NULL == s || '\0' == * s || 0 == stricmp ( s, "md5" ) )
+    {
+        return INNER_HASH_MD5;
+    }
+    else if ( 0 == stricmp ( s, "murmur3" ) )
+    {
+        return INNER_HASH_MURMUR3;
+    }
+
+    return - 1;
+}
+
+const char * hustdb_t::inner_hash_to_string (
+                                              uint32_t inner_hash
+                                              )
+{
+    switch ( inner_hash )
+    {
+        case INNER_HASH_MD5:
+            return "md5";
+
+        case INNER_HASH_MURMUR3:
+            return "murmur3";
+
+        default:
+            return "unknown";
+    }
+}
+
 bool hustdb_t::check_invariant_config ( )
 {
     bool first     = false;
     char ph[ 260 ] = { };
     fast_memcpy ( ph, HUSTSTORE_INVARIANT, sizeof ( HUSTSTORE_INVARIANT ) );
 
+    const char * hash_name = m_appini->ini_get_string ( m_ini, "md5db", "inner_hash", "md5" );
+    int inner_hash         = inner_hash_from_string ( hash_name );
+    if ( inner_hash < 0 )
+    {
+        LOG_ERROR ( "[hustdb][check_invariant_config][inner_hash=%s]invalid inner_hash", 
+                    hash_name );
+        return false;
+    }
+
     if ( ! m_apptool->is_file ( ph ) )
     {
         first = true;
@@ -489,6 +723,39 @@ bool hustdb_t::check_invariant_config ( )
             return false;
         }
     }
+    else
+    {
+        struct stat st;
+        if ( 0 == stat ( ph, & st ) && HUSTSTORE_INVARIANT_V0_LEN == st.st_size )
+        {
+            // format 0 store, extend it in place, the zeroed tail reads back as md5
+            FILE * fp = fopen ( ph, "ab" );
+            if ( ! fp )
+            {
+                LOG_ERROR ( "[hustdb][check_invariant_config][file=%s]fopen failed", 
+                            ph );
+                return false;
+            }
+
+            bool ok = true;
+            char buf[ sizeof ( invariant_t ) - HUSTSTORE_INVARIANT_V0_LEN ];
+            memset ( buf, 0, sizeof ( buf ) );
+            if ( sizeof ( buf ) != fwrite ( buf, 1, sizeof ( buf ), fp ) )
+            {
+                LOG_ERROR ( "[hustdb][check_invariant_config]upgrade fwrite failed" );
+                ok = false;
+            }
+
+            fclose ( fp );
+            if ( ! ok )
+            {
+                return false;
+            }
+
+            LOG_INFO ( "[hustdb][check_invariant_config][format=0]upgraded to format %d", 
+                       HUSTSTORE_FORMAT_VERSION );
+        }
+    }
     
     int r = 0;
     G_APPTOOL->fmap_init ( & m_invariant );
@@ -535,11 +802,36 @@ bool hustdb_t::check_invariant_config ( )
                         invar->fast_conflictdb, fast_conflictdb_count );
             break;
         }
+
+        if ( invar->format > HUSTSTORE_FORMAT_VERSION )
+        {
+            r = EINVAL;
+            LOG_ERROR ( "[hustdb][check_invariant_config][format=%u][supported=%d]store format too new", 
+                        invar->format, HUSTSTORE_FORMAT_VERSION );
+            break;
+        }
+
+        // the inner hash decides the placement of every record, it can only be
+        // changed by exporting and replaying the data into a fresh store (rehash.py)
+        if ( ! first && invar->inner_hash != ( uint32_t ) inner_hash )
+        {
+            r = EINVAL;
+            LOG_ERROR ( "[hustdb][check_invariant_config][inner_hash=%s,%s]inner_hash mismatch, convert the store with rehash.py", 
+                        inner_hash_to_string ( invar->inner_hash ), inner_hash_to_string ( inner_hash ) );
+            break;
+        }
         
         invar->md5db              = md5db_count;
         invar->conflictdb         = conflictdb_count;
         invar->contentdb          = contentdb_count;
         invar->fast_conflictdb    = fast_conflictdb_count;
+        invar->format             = HUSTSTORE_FORMAT_VERSION;
+        invar->inner_hash         = inner_hash;
+
+        m_inner_hash              = inner_hash;
+
+        LOG_INFO ( "[hustdb][check_invariant_config][format=%u][inner_hash=%s]", 
+                   invar->format, inner_hash_to_string ( m_inner_hash ) );
         
     }
     while ( 0 );
@@ -643,11 +935,29 @@ bool hustdb_t::init_data_engine ( )
     {
         int mdb_cache_size = m_appini->ini_get_int ( m_ini, "md5db", "l2_cache", 1024 );
 
+        int          mdb_hugepage = MDB_HUGEPAGE_NONE;
+        const char * s            = m_appini->ini_get_string ( m_ini, "md5db", "l2_cache.hugepage", "none" );
+        if ( s && 0 == strcmp ( s, "transparent" ) )
+        {
+            mdb_hugepage = MDB_HUGEPAGE_TRANSPARENT;
+        }
+        else if ( s && 0 == strcmp ( s, "explicit" ) )
+        {
+            mdb_hugepage = MDB_HUGEPAGE_EXPLICIT;
+        }
+        else if ( s && 0 != strcmp ( s, "none" ) )
+        {
+            LOG_ERROR ( "[hustdb][init_data_engine][l2_cache.hugepage=%s]invalid l2_cache.hugepage", 
+                        s );
+            return false;
+        }
+
         m_mdb = new mdb_t ();
 
         if (
-             ! m_mdb->open ( m_server_conf.tcp_worker_count + 1,
-                            mdb_cache_size
+             ! m_mdb->open ( get_conn_count (),
+                            mdb_cache_size,
+                            mdb_hugepage
                             )
              )
         {
@@ -1173,6 +1483,12 @@ void hustdb_t::set_table_meta (
     {
         scope_wlock_t tb_locker ( m_tb_locker );
 
+        // the slot keeps the generations of a dropped table until they are reclaimed
+        if ( tstat->reclaimed != tstat->generation )
+        {
+            return;
+        }
+
         table_map_t::iterator it = m_table_map.find ( tstat->table );
         if ( it != m_table_map.end () )
         {
@@ -1182,6 +1498,65 @@ void hustdb_t::set_table_meta (
     }
 }
 
+uint32_t hustdb_t::table_generation (
+                                      int           offset,
+                                      std::string & table
+                                      )
+{
+    table_stat_t * tstat      = ( table_stat_t * ) ( m_table_index.ptr + offset );
+    uint32_t       generation = tstat->generation;
+
+    append_generation ( table, generation );
+
+    return generation;
+}
+
+void hustdb_t::append_generation (
+                                   std::string & table,
+                                   uint32_t      generation
+                                   )
+{
+    if ( generation > 0 )
+    {
+        char suffix[ 16 ] = { };
+        sprintf ( suffix, "%c%u", TABLE_GENERATION_SEP, generation );
+        table += suffix;
+    }
+}
+
+bool hustdb_t::tb_generation_check (
+                                     const char * table,
+                                     size_t       table_len,
+                                     size_t &     name_len
+                                     )
+{
+    uint32_t       generation   = 0;
+    table_stat_t * tstat        = NULL;
+    const char *   sep          = ( const char * ) memchr ( table, TABLE_GENERATION_SEP, table_len );
+
+    name_len = table_len;
+
+    if ( sep )
+    {
+        name_len = sep - table;
+        generation = strtoul ( std::string ( sep + 1, table + table_len ).c_str (), NULL, 10 );
+    }
+
+    std::string inner_table ( table, name_len );
+
+    scope_rlock_t tb_locker ( m_tb_locker );
+
+    table_map_t::iterator it = m_table_map.find ( inner_table );
+    if ( it == m_table_map.end () )
+    {
+        return ! sep;
+    }
+
+    tstat = ( table_stat_t * ) ( m_table_index.ptr + it->second );
+
+    return tstat->generation == generation;
+}
+
 uint32_t hustdb_t::clac_real_item (
                                     const uint32_t start,
                                     const uint32_t end
@@ -1413,6 +1788,35 @@ void hustdb_t::hustdb_info (
     info = ss.str ();
 }
 
+bool hustdb_t::hustdb_ready (
+                              std::string & info
+                              )
+{
+    std::stringstream ss;
+    std::stringstream progress;
+    bool ready = false;
+
+    if ( likely ( NULL != m_storage ) && m_storage_ok )
+    {
+        ready = m_storage->ready ( progress );
+    }
+    else
+    {
+        progress << "\"opening\":true";
+    }
+
+    ss << "{\"ready\":" << ( ready ? "true" : "false" );
+    if ( ! progress.str ().empty () )
+    {
+        ss << "," << progress.str ();
+    }
+    ss << "}";
+
+    info = ss.str ();
+
+    return ready;
+}
+
 int hustdb_t::hustdb_file_count ( )
 {
     return m_storage->get_user_file_count ();
@@ -1444,7 +1848,8 @@ int hustdb_t::hustdb_get (
                            int &            rsp_len,
                            uint32_t &       ver,
                            conn_ctxt_t      conn,
-                           item_ctxt_t * &  ctxt
+                           item_ctxt_t * &  ctxt,
+                           bool             mdb_missed
                            )
 {
     int             r           = 0;
@@ -1462,24 +1867,9 @@ int hustdb_t::hustdb_get (
     
     m_storage->set_inner_table ( NULL, 0, KV_ALL, conn );
 
-    if ( m_mdb_ok && key_len < MDB_KEY_LEN )
+    if ( ! mdb_missed )
     {
-        r = m_mdb->get ( key, key_len, conn, rsp, & rsp_len );
-        if ( r == 0 &&
-             rsp_len > sizeof ( mdb_data_item_t )
-            )
-        {
-            m_storage->get_item_buffer ( conn, ctxt );
-            
-            mdb_data_item_t mdb_idx;
-            fast_memcpy ( & mdb_idx, rsp->c_str () + rsp_len - sizeof ( mdb_data_item_t ), sizeof ( mdb_data_item_t ) );
-            
-            ver = mdb_idx.version;
-            ctxt->kv_data.compress_type = mdb_idx.compress_type;
-
-            rsp_len -= sizeof ( mdb_data_item_t );
-            get_ok = true;
-        }
+        get_ok = get_from_mdb ( key, key_len, rsp, rsp_len, ver, conn, ctxt );
     }
 
     if ( ! get_ok )
@@ -1493,6 +1883,8 @@ int hustdb_t::hustdb_get (
                             r );
             }
 
+            hotkey ( HOTKEY_GET, NULL, 0, key, key_len, 0, conn );
+
             return r;
         }
 
@@ -1543,6 +1935,77 @@ int hustdb_t::hustdb_get (
         }
     }
 
+    hotkey ( HOTKEY_GET, NULL, 0, key, key_len, rsp_len, conn );
+
+    return 0;
+}
+
+bool hustdb_t::get_from_mdb (
+                             const char *    key,
+                             size_t          key_len,
+                             std::string * & rsp,
+                             int &           rsp_len,
+                             uint32_t &      ver,
+                             conn_ctxt_t     conn,
+                             item_ctxt_t * & ctxt
+                             )
+{
+    int             r           = 0;
+
+    if ( ! m_mdb_ok || key_len >= MDB_KEY_LEN )
+    {
+        return false;
+    }
+
+    r = m_mdb->get ( key, key_len, conn, rsp, & rsp_len );
+    if ( r != 0 ||
+         rsp_len <= sizeof ( mdb_data_item_t )
+        )
+    {
+        return false;
+    }
+
+    m_storage->get_item_buffer ( conn, ctxt );
+
+    mdb_data_item_t mdb_idx;
+    fast_memcpy ( & mdb_idx, rsp->c_str () + rsp_len - sizeof ( mdb_data_item_t ), sizeof ( mdb_data_item_t ) );
+
+    ver = mdb_idx.version;
+    ctxt->kv_data.compress_type = mdb_idx.compress_type;
+
+    rsp_len -= sizeof ( mdb_data_item_t );
+
+    return true;
+}
+
+int hustdb_t::hustdb_get_cached (
+                                  const char *     key,
+                                  size_t           key_len,
+                                  std::string * &  rsp,
+                                  int &            rsp_len,
+                                  uint32_t &       ver,
+                                  conn_ctxt_t      conn,
+                                  item_ctxt_t * &  ctxt
+                                  )
+{
+    if ( unlikely ( CHECK_STRING ( key ) ) )
+    {
+        LOG_DEBUG ( "[hustdb][db_get_cached]params error" );
+        return EKEYREJECTED;
+    }
+
+    LOCKERS_RLOCK ( key )
+
+    m_storage->set_inner_table ( NULL, 0, KV_ALL, conn );
+
+    if ( ! get_from_mdb ( key, key_len, rsp, rsp_len, ver, conn, ctxt ) )
+    {
+        // counted by hustdb_get, which takes the miss
+        return ENOENT;
+    }
+
+    hotkey ( HOTKEY_GET, NULL, 0, key, key_len, rsp_len, conn );
+
     return 0;
 }
 
@@ -1577,6 +2040,8 @@ int hustdb_t::hustdb_put (
         return ENOMEM;
     }
     
+    hotkey ( HOTKEY_PUT, NULL, 0, key, key_len, val_len, conn );
+
     LOCKERS_WLOCK ( key )
 
     m_storage->set_inner_table ( NULL, 0, KV_ALL, conn );
@@ -1845,9 +2310,28 @@ int hustdb_t::hustdb_stat (
     return 0;
 }
 
-void hustdb_t::hustdb_stat_all (
-                                 std::string & stats
-                                 )
+void hustdb_t::hustdb_hotkeys (
+                                int32_t       n,
+                                std::string & rsp
+                                )
+{
+    if ( ! m_store_conf.db_hotkeys_enable )
+    {
+        rsp = "[]";
+        return;
+    }
+
+    m_hotkeys.query ( n, rsp );
+}
+
+void hustdb_t::hustdb_hotkeys_merge ( )
+{
+    m_hotkeys.merge ();
+}
+
+void hustdb_t::hustdb_stat_all (
+                                 std::string & stats
+                                 )
 {
     char    stat[ 256 ]  = { };
     table_stat_t * tstat = NULL;
@@ -1940,14 +2424,17 @@ int hustdb_t::hustdb_export (
 
     if ( table && table_len > 0 )
     {
+        int         offset = - 1;
         std::string inner_table ( table, table_len );
 
-        if ( ( ! tb_name_check ( table, table_len ) || find_table_type ( inner_table, type ) < 0 ) )
+        if ( ( ! tb_name_check ( table, table_len ) || ( offset = find_table_type ( inner_table, type ) ) < 0 ) )
         {
             LOG_DEBUG ( "[hustdb][db_export]params error" );
             return EKEYREJECTED;
         }
 
+        table_generation ( offset, inner_table );
+
         sprintf ( path, "%s%c", inner_table.c_str (), type );
         inner_file_id = m_apptool->hust_hash_key ( path, strlen ( path ) ) % file_count;
     }
@@ -2014,6 +2501,142 @@ int hustdb_t::hustdb_export (
     return 0;
 }
 
+int hustdb_t::hustdb_load (
+                            int          file_id,
+                            int          start,
+                            int          end,
+                            void * &     token
+                            )
+{
+    int file_count = m_storage->get_user_file_count ();
+
+    if ( unlikely ( file_id < -1 || file_id >= file_count ||
+                    start < 0 || end < 0 || start >= end || end > MAX_BUCKET_NUM
+                   )
+         )
+    {
+        LOG_DEBUG ( "[hustdb][db_load]params error" );
+        return EKEYREJECTED;
+    }
+
+    // -1 loads the exports of every file found, in one task
+    int found = 0;
+    for ( int i = 0; i < file_count; ++ i )
+    {
+        if ( -1 != file_id && i != file_id )
+        {
+            continue;
+        }
+
+        char i_ph[ 256 ] = { };
+        char d_ph[ 256 ] = { };
+
+        sprintf ( i_ph, "./EXPORT/%s%d[%d-%d].kv", EXPORT_DB_ALL, i, start, end );
+        m_apptool->path_to_os ( i_ph );
+
+        sprintf ( d_ph, "./EXPORT/%s%d[%d-%d].kv.data", EXPORT_DB_ALL, i, start, end );
+        m_apptool->path_to_os ( d_ph );
+
+        if ( m_apptool->is_file ( i_ph ) && m_apptool->is_file ( d_ph ) )
+        {
+            ++ found;
+        }
+    }
+
+    if ( unlikely ( 0 == found ) )
+    {
+        LOG_ERROR ( "[hustdb][db_load][file_id=%d][start=%d][end=%d]export not found", 
+                    file_id, start, end );
+        return ENOENT;
+    }
+
+    if ( ! m_slow_tasks.empty () )
+    {
+        LOG_ERROR ( "[hustdb][db_load]slow_tasks not empty" );
+        return EPERM;
+    }
+
+    task_load_t * task = task_load_t::create ( file_id, start, end,
+                                               ( size_t ) m_store_conf.db_load_buffer_m * 1024 * 1024 );
+    if ( NULL == task )
+    {
+        LOG_ERROR ( "[hustdb][db_load]task create failed" );
+        return EPERM;
+    }
+
+    if ( ! m_slow_tasks.push ( task ) )
+    {
+        task->release ();
+
+        LOG_ERROR ( "[hustdb][db_load]push task failed" );
+        return EPERM;
+    }
+
+    token = task;
+
+    return 0;
+}
+
+int hustdb_t::hustdb_backup (
+                              void * &     token
+                              )
+{
+    if ( ! m_slow_tasks.empty () )
+    {
+        LOG_ERROR ( "[hustdb][db_backup]slow_tasks not empty" );
+        return EPERM;
+    }
+
+    task_backup_t * task = task_backup_t::create ( ( uint64_t ) m_store_conf.db_backup_rate_limit * 1024 * 1024 );
+    if ( NULL == task )
+    {
+        LOG_ERROR ( "[hustdb][db_backup]task create failed" );
+        return EPERM;
+    }
+
+    if ( ! m_slow_tasks.push ( task ) )
+    {
+        task->release ();
+
+        LOG_ERROR ( "[hustdb][db_backup]push task failed" );
+        return EPERM;
+    }
+
+    token = task;
+
+    return 0;
+}
+
+// in the order the writers take them: a key lock, then the table or the
+// queue index, the hincrby journal and the buckets of the storage
+void hustdb_t::freeze ( )
+{
+    for ( wrlocker_vec_t::iterator it = m_lockers.begin (); it != m_lockers.end (); ++ it )
+    {
+        ( * it )->wlock ();
+    }
+
+    m_tb_locker.wlock ();
+    m_mq_locker.wlock ();
+    m_hincrby.hold ();
+
+    m_storage->freeze ();
+}
+
+void hustdb_t::thaw ( )
+{
+    m_storage->thaw ();
+
+    m_hincrby.release ();
+    m_mq_locker.wunlock ();
+    m_tb_locker.wunlock ();
+
+    for ( wrlocker_vec_t::reverse_iterator it = m_lockers.rbegin (); it != m_lockers.rend (); ++ it )
+    {
+        ( * it )->wunlock ();
+    }
+}
+
 int hustdb_t::hustdb_ttl_scan ( )
 {
     if ( ! m_slow_tasks.empty () )
@@ -2066,6 +2689,199 @@ int hustdb_t::hustdb_binlog_scan ( )
     return 0;
 }
 
+int hustdb_t::hustdb_drop_scan ( )
+{
+    bool pending = false;
+
+    do
+    {
+        scope_rlock_t tb_locker ( m_tb_locker );
+
+        for ( table_map_t::iterator it = m_table_map.begin (); it != m_table_map.end (); it ++ )
+        {
+            table_stat_t * tstat = ( table_stat_t * ) ( m_table_index.ptr + it->second );
+
+            if ( tstat->reclaimed != tstat->generation )
+            {
+                pending = true;
+                break;
+            }
+        }
+    }
+    while ( 0 );
+
+    if ( ! pending )
+    {
+        return 0;
+    }
+
+    if ( ! m_slow_tasks.empty () )
+    {
+        LOG_DEBUG ( "[hustdb][db_drop_scan]slow_tasks not empty" );
+        return EPERM;
+    }
+
+    task_drop_scan_t * task = task_drop_scan_t::create ( m_store_conf.db_drop_scan_count );
+    if ( NULL == task )
+    {
+        LOG_ERROR ( "[hustdb][db_drop_scan]task create failed" );
+        return EPERM;
+    }
+
+    if ( ! m_slow_tasks.push ( task ) )
+    {
+        task->release ();
+
+        LOG_ERROR ( "[hustdb][db_drop_scan]push task failed" );
+        return EPERM;
+    }
+
+    return 0;
+}
+
+int hustdb_t::hustdb_drop_reclaim (
+                                    uint32_t size
+                                    )
+{
+    int                         r            = 0;
+    int                         offset       = - 1;
+    uint8_t                     type         = 0;
+    uint8_t                     inner_type   = 0;
+    uint32_t                    generation   = 0;
+    uint32_t                    ver          = 0;
+    int64_t                     score        = 0;
+    size_t                      mkey_len     = 0;
+    const char *                mkey         = NULL;
+    char                        val21[ 32 ]  = { };
+    table_stat_t *              tstat        = NULL;
+    item_ctxt_t *               ctxt         = NULL;
+    conn_ctxt_t                 conn;
+    std::string                 inner_table;
+    std::vector< std::string >  keys;
+    std::vector< std::string >  vals;
+
+    do
+    {
+        scope_rlock_t tb_locker ( m_tb_locker );
+
+        for ( table_map_t::iterator it = m_table_map.begin (); it != m_table_map.end (); it ++ )
+        {
+            tstat = ( table_stat_t * ) ( m_table_index.ptr + it->second );
+
+            if ( tstat->reclaimed != tstat->generation )
+            {
+                offset      = it->second;
+                type        = tstat->type;
+                generation  = tstat->reclaimed;
+                inner_table = tstat->table;
+                break;
+            }
+        }
+    }
+    while ( 0 );
+
+    if ( offset < 0 )
+    {
+        return 0;
+    }
+
+    append_generation ( inner_table, generation );
+
+    // zset members are listed from ZSET_IN, whose value is the score
+    // needed to address the ZSET_TB record
+    inner_type     = ( type == ZSET_TB ) ? ZSET_IN : type;
+    conn.worker_id = m_server_conf.tcp_worker_count;
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), inner_type, conn );
+
+    struct export_cb_param_t cb_pm;
+    cb_pm.start             = 0;
+    cb_pm.end               = MAX_BUCKET_NUM;
+    cb_pm.offset            = 0;
+    cb_pm.size              = size;
+    cb_pm.file_id           = - 1;
+    cb_pm.noval             = ( type != ZSET_TB );
+    cb_pm.async             = false;
+    cb_pm.total             = 0;
+    cb_pm.min               = 0;
+    cb_pm.max               = 0;
+    cb_pm.byscore           = false;
+
+    r = m_storage->table_keys ( conn, ctxt, NULL, & cb_pm, keys, vals );
+    if ( 0 != r )
+    {
+        LOG_ERROR ( "[hustdb][db_drop_reclaim][table=%s][r=%d]table_keys failed", 
+                    inner_table.c_str (), r );
+        return r;
+    }
+
+    for ( size_t i = 0; i < keys.size (); i ++ )
+    {
+        const char * key     = keys[ i ].c_str ();
+        size_t       key_len = keys[ i ].size ();
+
+        m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), inner_type, conn );
+
+        ver = 0;
+        r = m_storage->del ( key, key_len, ver, false, conn, ctxt );
+        if ( 0 != r && ENOENT != r )
+        {
+            LOG_ERROR ( "[hustdb][db_drop_reclaim][table=%s][r=%d]del failed", 
+                        inner_table.c_str (), r );
+            continue;
+        }
+
+        if ( m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
+        {
+            mkey_len = key_len;
+            mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
+
+            m_mdb->del ( mkey, mkey_len );
+        }
+
+        if ( type != ZSET_TB || ! db_strtoll ( vals[ i ].c_str (), & score ) )
+        {
+            continue;
+        }
+
+        sprintf ( val21, "%021li", score );
+        m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_TB, conn, val21 );
+
+        ver = 0;
+        r = m_storage->del ( key, key_len, ver, false, conn, ctxt );
+        if ( 0 != r && ENOENT != r )
+        {
+            LOG_ERROR ( "[hustdb][db_drop_reclaim][table=%s][r=%d]del failed", 
+                        inner_table.c_str (), r );
+        }
+    }
+
+    if ( keys.size () >= size )
+    {
+        return 0;
+    }
+
+    scope_wlock_t tb_locker ( m_tb_locker );
+
+    tstat = ( table_stat_t * ) ( m_table_index.ptr + offset );
+    tstat->reclaimed ++;
+
+    LOG_INFO ( "[hustdb][db_drop_reclaim][table=%s]generation reclaimed", 
+               inner_table.c_str () );
+
+    if ( tstat->count <= 0 && tstat->reclaimed == tstat->generation )
+    {
+        table_map_t::iterator it = m_table_map.find ( tstat->table );
+        if ( it != m_table_map.end () )
+        {
+            m_table_map.erase ( it );
+            memset ( tstat, 0, TABLE_STAT_LEN );
+        }
+    }
+
+    return 0;
+}
+
 int hustdb_t::hustdb_hexist (
                               const char *    table,
                               size_t          table_len,
@@ -2097,7 +2913,21 @@ int hustdb_t::hustdb_hexist (
         return EPERM;
     }
 
-    m_storage->set_inner_table ( table, table_len, HASH_TB, conn );
+    table_generation ( offset, inner_table );
+
+    if ( m_store_conf.db_hincrby_combine )
+    {
+        LOCKERS_RLOCK ( key )
+
+        hincrby_item_t * item = m_hincrby.find ( inner_table, key, key_len );
+        if ( item && 0 != item->delta )
+        {
+            ver = item->ver;
+            return 0;
+        }
+    }
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
 
     r = m_storage->exists ( key, key_len, ver, conn, ctxt );
     if ( 0 != r )
@@ -2149,12 +2979,22 @@ int hustdb_t::hustdb_hget (
         LOG_ERROR ( "[hustdb][db_hget]find table failed" );
         return EPERM;
     }
+
+    table_generation ( offset, inner_table );
     
     LOCKERS_RLOCK ( key )
 
-    m_storage->set_inner_table ( table, table_len, HASH_TB, conn );
+    if ( m_store_conf.db_hincrby_combine &&
+         hincrby_pending ( inner_table, key, key_len, rsp, rsp_len, ver, conn, ctxt )
+        )
+    {
+        hotkey ( HOTKEY_HGET, table, table_len, key, key_len, rsp_len, conn );
+        return 0;
+    }
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
 
-    if ( m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
         mkey_len = key_len;
         mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
@@ -2188,6 +3028,8 @@ int hustdb_t::hustdb_hget (
                             r );
             }
 
+            hotkey ( HOTKEY_HGET, table, table_len, key, key_len, 0, conn );
+
             return r;
         }
 
@@ -2227,7 +3069,7 @@ int hustdb_t::hustdb_hget (
 
         rsp_len = rsp->size ();
 
-        if ( m_mdb_ok && alive >= 0 && table_len + key_len + 2 < MDB_KEY_LEN && rsp_len < MDB_VAL_LEN )
+        if ( m_mdb_ok && alive >= 0 && inner_table.size () + key_len + 2 < MDB_KEY_LEN && rsp_len < MDB_VAL_LEN )
         {
             mdb_data_item_t mdb_idx;
             mdb_idx.version       = ver;
@@ -2238,6 +3080,8 @@ int hustdb_t::hustdb_hget (
         }
     }
 
+    hotkey ( HOTKEY_HGET, table, table_len, key, key_len, rsp_len, conn );
+
     return 0;
 }
 
@@ -2286,10 +3130,20 @@ int hustdb_t::hustdb_hset (
         LOG_ERROR ( "[hustdb][db_hset]find table failed" );
         return EPERM;
     }
-    
+
+    hotkey ( HOTKEY_HSET, table, table_len, key, key_len, val_len, conn );
+
     LOCKERS_WLOCK ( key )
 
-    m_storage->set_inner_table ( table, table_len, HASH_TB, conn );
+    table_generation ( offset, inner_table );
+
+    r = hincrby_settle ( inner_table, key, key_len, conn );
+    if ( 0 != r )
+    {
+        return r;
+    }
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
 
     if ( ttl <= 0 || ttl > m_store_conf.db_ttl_maximum )
     {
@@ -2331,7 +3185,7 @@ int hustdb_t::hustdb_hset (
         set_table_meta ( offset, 1, data_size );
     }
 
-    if ( ( ! is_dup && ver > 1 || is_dup && user_ver == ver && ! ctxt->is_version_error ) && m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( ( ! is_dup && ver > 1 || is_dup && user_ver == ver && ! ctxt->is_version_error ) && m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
         mkey_len = key_len;
         mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
@@ -2357,64 +3211,26 @@ int hustdb_t::hustdb_hset (
     return 0;
 }
 
-int hustdb_t::hustdb_hincrby (
-                               const char *    table,
-                               size_t          table_len,
-                               const char *    key,
-                               size_t          key_len,
-                               int64_t         score,
-                               const char *    host,
-                               size_t          host_len,
-                               std::string * & rsp,
-                               int &           rsp_len,
-                               uint32_t &      ver,
-                               uint32_t        ttl,
-                               bool            is_dup,
-                               conn_ctxt_t     conn,
-                               item_ctxt_t * & ctxt
-                               )
+int hustdb_t::hincrby_read (
+                             const std::string & inner_table,
+                             const char *        key,
+                             size_t              key_len,
+                             int64_t &           cur_score,
+                             uint32_t &          cur_ver,
+                             std::string * &     rsp,
+                             int &               rsp_len,
+                             conn_ctxt_t         conn,
+                             item_ctxt_t * &     ctxt
+                             )
 {
     int             r            = 0;
-    uint32_t        user_ver     = ver;
     size_t          mkey_len     = 0;
     const char *    mkey         = NULL;
     bool            get_ok       = false;
-    size_t          val_len      = 0;
-    char            val[ 32 ]    = { };
-    uint32_t        cur_ver      = 0;
-    int64_t         cur_score    = 0;
-    int             offset       = - 1;
-
-    if ( unlikely ( ! tb_name_check ( table, table_len ) ||
-                    CHECK_VERSION ||
-                    CHECK_STRING ( key )
-                   )
-         )
-    {
-        LOG_DEBUG ( "[hustdb][db_hincrby]params error" );
-        return EKEYREJECTED;
-    }
 
-    if ( unlikely ( m_over_threshold ) )
-    {
-        LOG_DEBUG ( "[hustdb][db_hincrby]memory over threshold" );
-        return ENOMEM;
-    }
+    cur_score = 0;
 
-    std::string inner_table ( table, table_len );
-
-    offset = find_table_offset ( inner_table, true, HASH_TB );
-    if ( unlikely ( offset < 0 ) )
-    {
-        LOG_ERROR ( "[hustdb][db_hincrby]find table failed" );
-        return EPERM;
-    }
-    
-    LOCKERS_WLOCK ( key )
-
-    m_storage->set_inner_table ( table, table_len, HASH_TB, conn );
-    
-    if ( m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
         mkey_len = key_len;
         mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
@@ -2424,6 +3240,10 @@ int hustdb_t::hustdb_hincrby (
              rsp_len > sizeof ( mdb_data_item_t )
             )
         {
+            mdb_data_item_t mdb_idx;
+            fast_memcpy ( & mdb_idx, rsp->c_str () + rsp_len - sizeof ( mdb_data_item_t ), sizeof ( mdb_data_item_t ) );
+            cur_ver = mdb_idx.version;
+
             rsp_len -= sizeof ( mdb_data_item_t );
             ( * rsp ) [ rsp_len ] = '\0';
             get_ok = true;
@@ -2443,6 +3263,45 @@ int hustdb_t::hustdb_hincrby (
             return ENOMEM;
         }
     }
+
+    return 0;
+}
+
+int hustdb_t::hincrby_write (
+                              int                 offset,
+                              const std::string & inner_table,
+                              const char *        table,
+                              size_t              table_len,
+                              const char *        key,
+                              size_t              key_len,
+                              int64_t &           score,
+                              const char *        host,
+                              size_t              host_len,
+                              std::string * &     rsp,
+                              int &               rsp_len,
+                              uint32_t &          ver,
+                              uint32_t            ttl,
+                              bool                is_dup,
+                              conn_ctxt_t         conn,
+                              item_ctxt_t * &     ctxt
+                              )
+{
+    int             r            = 0;
+    uint32_t        user_ver     = ver;
+    size_t          mkey_len     = 0;
+    const char *    mkey         = NULL;
+    size_t          val_len      = 0;
+    char            val[ 32 ]    = { };
+    uint32_t        cur_ver      = 0;
+    int64_t         cur_score    = 0;
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
+    
+    r = hincrby_read ( inner_table, key, key_len, cur_score, cur_ver, rsp, rsp_len, conn, ctxt );
+    if ( 0 != r )
+    {
+        return r;
+    }
     
     score += cur_score;
     
@@ -2489,8 +3348,11 @@ int hustdb_t::hustdb_hincrby (
         set_table_meta ( offset, 1, data_size );
     }
 
-    if ( ( ! is_dup && ver > 1 || is_dup && user_ver == ver && ! ctxt->is_version_error ) && m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( ( ! is_dup && ver > 1 || is_dup && user_ver == ver && ! ctxt->is_version_error ) && m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
+        mkey_len = key_len;
+        mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
+
         if ( val_len < MDB_VAL_LEN )
         {
             mdb_data_item_t mdb_idx;
@@ -2505,28 +3367,461 @@ int hustdb_t::hustdb_hincrby (
         }
         else
         {
-            m_mdb->del ( mkey, mkey_len );
+            m_mdb->del ( mkey, mkey_len );
+        }
+    }
+    
+    rsp = m_mdb->buffer ( conn );
+    fast_memcpy ( ( char * ) & ( * rsp ) [ 0 ], val, val_len );
+    rsp_len = val_len;
+
+    if ( ! CHECK_STRING ( host ) && host_len <= 32 )
+    {
+        hustdb_binlog ( table,
+                       table_len,
+                       key,
+                       key_len,
+                       host,
+                       host_len,
+                       HUSTDB_METHOD_HSET,
+                       conn
+                       );
+    }
+
+    return 0;
+}
+
+int hustdb_t::hincrby_combine (
+                                hincrby_item_t *    item,
+                                const std::string & inner_table,
+                                const char *        table,
+                                size_t              table_len,
+                                const char *        key,
+                                size_t              key_len,
+                                int64_t             score,
+                                const char *        host,
+                                size_t              host_len,
+                                std::string * &     rsp,
+                                int &               rsp_len,
+                                uint32_t &          ver,
+                                uint32_t            ttl,
+                                conn_ctxt_t         conn
+                                )
+{
+    int             r            = 0;
+    int64_t         value        = 0;
+    uint32_t        last_ver     = 0;
+    size_t          val_len      = 0;
+    char            val[ 32 ]    = { };
+
+    if ( ! item )
+    {
+        int64_t         cur_score    = 0;
+        uint32_t        cur_ver      = 0;
+        item_ctxt_t *   ctxt         = NULL;
+
+        m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
+
+        r = hincrby_read ( inner_table, key, key_len, cur_score, cur_ver, rsp, rsp_len, conn, ctxt );
+        if ( 0 != r )
+        {
+            return r;
+        }
+
+        item = m_hincrby.insert ( inner_table, key, key_len );
+        if ( unlikely ( ! item ) )
+        {
+            return ENOMEM;
+        }
+
+        item->table.assign ( table, table_len );
+        item->base = cur_score;
+        item->ver  = cur_ver;
+    }
+
+    value     = item->base + item->delta + score;
+    item->ttl = ttl;
+    if ( ! CHECK_STRING ( host ) && host_len <= 32 )
+    {
+        item->host.assign ( host, host_len );
+    }
+
+    // a version of its own, as the storage would give a written increment
+    last_ver  = item->ver;
+    item->ver = item->ver < BUCKET_DATA_MAX_VERSION ? item->ver + 1 : 1;
+
+    if ( unlikely ( ! m_hincrby.journal_value ( item, value ) ) )
+    {
+        LOG_ERROR ( "[hustdb][db_hincrby][key_len=%d]journal failed", 
+                    ( int ) key_len );
+        item->ver = last_ver;
+        return EIO;
+    }
+
+    item->delta += score;
+    item->count ++;
+
+    if ( item->count >= ( uint32_t ) m_store_conf.db_hincrby_flush_count )
+    {
+        // the increment is journaled, a failed write is retried by the flush
+        hincrby_flush_item ( item, conn );
+    }
+
+    sprintf ( val, "%li", value );
+    val_len = strlen ( val );
+
+    ver = item->ver;
+    rsp = m_mdb->buffer ( conn );
+    fast_memcpy ( ( char * ) & ( * rsp ) [ 0 ], val, val_len );
+    rsp_len = val_len;
+
+    return 0;
+}
+
+int hustdb_t::hincrby_flush_item (
+                                   hincrby_item_t * item,
+                                   conn_ctxt_t      conn
+                                   )
+{
+    int             r            = 0;
+    int             offset       = - 1;
+    int64_t         score        = item->delta;
+    uint32_t        ver          = item->ver;
+    int             rsp_len      = 0;
+    std::string *   rsp          = NULL;
+    item_ctxt_t *   ctxt         = NULL;
+
+    if ( 0 == item->delta )
+    {
+        return 0;
+    }
+
+    // the pending increments of a dropped table are dropped as well
+    std::string inner_table ( item->table );
+    offset = find_table_offset ( inner_table, false, HASH_TB );
+    if ( offset >= 0 )
+    {
+        table_generation ( offset, inner_table );
+    }
+
+    if ( offset < 0 || inner_table != item->inner_table )
+    {
+        item->delta = 0;
+        item->count = 0;
+        return 0;
+    }
+
+    // with the version the last increment returned, as a synced write
+    r = hincrby_write ( offset, inner_table, item->table.c_str (), item->table.size (),
+                        item->key.c_str (), item->key.size (), score,
+                        item->host.c_str (), item->host.size (),
+                        rsp, rsp_len, ver, item->ttl, true, conn, ctxt );
+    if ( 0 != r )
+    {
+        LOG_ERROR ( "[hustdb][db_hincrby_flush][table=%s][r=%d]write failed", 
+                    item->table.c_str (), r );
+        return r;
+    }
+
+    item->base  = score;
+    item->delta = 0;
+    item->count = 0;
+    item->ver   = ver;
+
+    return 0;
+}
+
+int hustdb_t::hincrby_settle (
+                               const std::string & inner_table,
+                               const char *        key,
+                               size_t              key_len,
+                               conn_ctxt_t         conn
+                               )
+{
+    int                 r            = 0;
+    hincrby_item_t *    item         = NULL;
+
+    if ( ! m_store_conf.db_hincrby_combine )
+    {
+        return 0;
+    }
+
+    item = m_hincrby.find ( inner_table, key, key_len );
+    if ( ! item )
+    {
+        return 0;
+    }
+
+    r = hincrby_flush_item ( item, conn );
+    if ( 0 != r )
+    {
+        return r;
+    }
+
+    if ( unlikely ( ! m_hincrby.journal_clear ( item ) ) )
+    {
+        LOG_ERROR ( "[hustdb][db_hincrby_settle][key_len=%d]journal failed", 
+                    ( int ) key_len );
+        return EIO;
+    }
+
+    m_hincrby.erase ( inner_table, key, key_len );
+
+    return 0;
+}
+
+bool hustdb_t::hincrby_pending (
+                                 const std::string & inner_table,
+                                 const char *        key,
+                                 size_t              key_len,
+                                 std::string * &     rsp,
+                                 int &               rsp_len,
+                                 uint32_t &          ver,
+                                 conn_ctxt_t         conn,
+                                 item_ctxt_t * &     ctxt
+                                 )
+{
+    size_t              val_len      = 0;
+    char                val[ 32 ]    = { };
+    hincrby_item_t *    item         = NULL;
+
+    item = m_hincrby.find ( inner_table, key, key_len );
+    if ( ! item || 0 == item->delta )
+    {
+        return false;
+    }
+
+    sprintf ( val, "%li", item->base + item->delta );
+    val_len = strlen ( val );
+
+    m_storage->get_item_buffer ( conn, ctxt );
+    ctxt->kv_data.compress_type = NOCOMPRESS;
+
+    ver = item->ver;
+    rsp = m_mdb->buffer ( conn );
+    fast_memcpy ( ( char * ) & ( * rsp ) [ 0 ], val, val_len );
+    rsp_len = val_len;
+
+    return true;
+}
+
+int hustdb_t::hustdb_hincrby_flush ( )
+{
+    int                 r            = 0;
+    bool                ok           = true;
+    hincrby_item_t *    item         = NULL;
+    conn_ctxt_t         conn;
+    hincrby_keys_t      keys;
+
+    if ( ! m_storage_ok )
+    {
+        return 0;
+    }
+
+    conn.worker_id = m_server_conf.tcp_worker_count + 1;
+
+    ok = m_hincrby.rotate ();
+
+    try
+    {
+        m_hincrby.keys ( keys );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[hustdb][db_hincrby_flush]bad_alloc" );
+        return ENOMEM;
+    }
+
+    for ( hincrby_keys_t::iterator it = keys.begin (); it != keys.end (); ++ it )
+    {
+        const char *    key          = it->second.c_str ();
+        size_t          key_len      = it->second.size ();
+
+        LOCKERS_WLOCK ( key )
+
+        item = m_hincrby.find ( it->first, key, key_len );
+        if ( ! item )
+        {
+            continue;
+        }
+
+        r = hincrby_flush_item ( item, conn );
+        if ( 0 != r )
+        {
+            ok = false;
+            continue;
+        }
+
+        if ( m_hincrby.idle ( item ) )
+        {
+            m_hincrby.erase ( it->first, key, key_len );
+        }
+    }
+
+    // the rotated journal is kept until every value in it is written
+    if ( ok )
+    {
+        m_hincrby.commit ();
+    }
+
+    return ok ? 0 : EIO;
+}
+
+bool hustdb_t::hincrby_replay ( )
+{
+    int                 r            = 0;
+    int                 offset       = - 1;
+    uint32_t            ver          = 0;
+    size_t              count        = 0;
+    char                val[ 32 ]    = { };
+    item_ctxt_t *       ctxt         = NULL;
+    conn_ctxt_t         conn;
+    hincrby_records_t   records;
+    std::map< std::string, size_t > last;
+
+    if ( ! m_hincrby.replay ( records ) )
+    {
+        return false;
+    }
+
+    // the last value of a counter wins, a clear drops what came before
+    for ( size_t i = 0; i < records.size (); i ++ )
+    {
+        std::string id ( records[ i ].inner_table );
+        id.push_back ( '\0' );
+        id.append ( records[ i ].key );
+
+        if ( records[ i ].clear )
+        {
+            last.erase ( id );
+        }
+        else
+        {
+            last[ id ] = i;
+        }
+    }
+
+    conn.worker_id      = m_server_conf.tcp_worker_count + 1;
+    m_current_timestamp = time ( NULL );
+
+    for ( std::map< std::string, size_t >::iterator it = last.begin (); it != last.end (); ++ it )
+    {
+        hincrby_record_t & record = records[ it->second ];
+
+        std::string inner_table ( record.table );
+        offset = find_table_offset ( inner_table, false, HASH_TB );
+        if ( offset >= 0 )
+        {
+            table_generation ( offset, inner_table );
+        }
+
+        if ( offset < 0 || inner_table != record.inner_table )
+        {
+            continue;
+        }
+
+        sprintf ( val, "%li", record.value );
+        ver = record.ver;
+
+        r = hustdb_hset ( record.table.c_str (), record.table.size (), record.key.c_str (), record.key.size (),
+                          val, strlen ( val ), ver, record.ttl, true, conn, ctxt );
+        if ( 0 != r )
+        {
+            LOG_ERROR ( "[hustdb][db_hincrby_replay][table=%s][r=%d]hset failed", 
+                        record.table.c_str (), r );
+            return false;
+        }
+
+        if ( ! record.host.empty () )
+        {
+            hustdb_binlog ( record.table.c_str (), record.table.size (), record.key.c_str (), record.key.size (),
+                            record.host.c_str (), record.host.size (), HUSTDB_METHOD_HSET, conn );
+        }
+
+        count ++;
+    }
+
+    LOG_INFO ( "[hustdb][db_hincrby_replay][records=%d][counters=%d]journal replayed", 
+               ( int ) records.size (), ( int ) count );
+
+    m_hincrby.reset ();
+
+    return true;
+}
+
+int hustdb_t::hustdb_hincrby (
+                               const char *    table,
+                               size_t          table_len,
+                               const char *    key,
+                               size_t          key_len,
+                               int64_t         score,
+                               const char *    host,
+                               size_t          host_len,
+                               std::string * & rsp,
+                               int &           rsp_len,
+                               uint32_t &      ver,
+                               uint32_t        ttl,
+                               bool            is_dup,
+                               conn_ctxt_t     conn,
+                               item_ctxt_t * & ctxt
+                               )
+{
+    int                 r            = 0;
+    int                 offset       = - 1;
+    hincrby_item_t *    item         = NULL;
+
+    if ( unlikely ( ! tb_name_check ( table, table_len ) ||
+                    CHECK_VERSION ||
+                    CHECK_STRING ( key )
+                   )
+         )
+    {
+        LOG_DEBUG ( "[hustdb][db_hincrby]params error" );
+        return EKEYREJECTED;
+    }
+
+    if ( unlikely ( m_over_threshold ) )
+    {
+        LOG_DEBUG ( "[hustdb][db_hincrby]memory over threshold" );
+        return ENOMEM;
+    }
+
+    std::string inner_table ( table, table_len );
+
+    offset = find_table_offset ( inner_table, true, HASH_TB );
+    if ( unlikely ( offset < 0 ) )
+    {
+        LOG_ERROR ( "[hustdb][db_hincrby]find table failed" );
+        return EPERM;
+    }
+
+    hotkey ( HOTKEY_HINCRBY, table, table_len, key, key_len, 0, conn );
+
+    LOCKERS_WLOCK ( key )
+
+    table_generation ( offset, inner_table );
+
+    if ( m_store_conf.db_hincrby_combine )
+    {
+        // a versioned or synced increment is written through
+        item = m_hincrby.find ( inner_table, key, key_len );
+        if ( 0 == ver && ! is_dup &&
+             ( item || m_hincrby.size () < ( size_t ) m_store_conf.db_hincrby_max_keys )
+            )
+        {
+            return hincrby_combine ( item, inner_table, table, table_len, key, key_len, score,
+                                     host, host_len, rsp, rsp_len, ver, ttl, conn );
         }
-    }
-    
-    rsp = m_mdb->buffer ( conn );
-    fast_memcpy ( ( char * ) & ( * rsp ) [ 0 ], val, val_len );
-    rsp_len = val_len;
 
-    if ( ! CHECK_STRING ( host ) && host_len <= 32 )
-    {
-        hustdb_binlog ( table,
-                       table_len,
-                       key,
-                       key_len,
-                       host,
-                       host_len,
-                       HUSTDB_METHOD_HSET,
-                       conn
-                       );
+        r = hincrby_settle ( inner_table, key, key_len, conn );
+        if ( 0 != r )
+        {
+            return r;
+        }
     }
 
-    return 0;
+    return hincrby_write ( offset, inner_table, table, table_len, key, key_len, score,
+                           host, host_len, rsp, rsp_len, ver, ttl, is_dup, conn, ctxt );
 }
 
 int hustdb_t::hustdb_hdel (
@@ -2563,10 +3858,18 @@ int hustdb_t::hustdb_hdel (
         LOG_ERROR ( "[hustdb][db_hdel]find table failed" );
         return EPERM;
     }
-    
+
     LOCKERS_WLOCK ( key )
 
-    m_storage->set_inner_table ( table, table_len, HASH_TB, conn );
+    table_generation ( offset, inner_table );
+
+    r = hincrby_settle ( inner_table, key, key_len, conn );
+    if ( 0 != r )
+    {
+        return r;
+    }
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
 
     r = m_storage->del ( key, key_len, ver, is_dup, conn, ctxt );
     if ( 0 != r )
@@ -2590,7 +3893,7 @@ int hustdb_t::hustdb_hdel (
         set_table_meta ( offset, - 1, data_size );
     }
 
-    if ( ! ctxt->is_version_error && m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( ! ctxt->is_version_error && m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
         mkey_len = key_len;
         mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
@@ -2641,7 +3944,9 @@ int hustdb_t::hustdb_hkeys (
         return EPERM;
     }
 
-    m_storage->set_inner_table ( table, table_len, HASH_TB, conn );
+    table_generation ( _offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
 
     struct export_cb_param_t cb_pm;
     cb_pm.start             = start;
@@ -2700,7 +4005,9 @@ int hustdb_t::hustdb_sismember (
         return EPERM;
     }
 
-    m_storage->set_inner_table ( table, table_len, SET_TB, conn );
+    table_generation ( offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), SET_TB, conn );
 
     r = m_storage->exists ( key, key_len, ver, conn, ctxt );
     if ( 0 != r )
@@ -2756,7 +4063,11 @@ int hustdb_t::hustdb_sadd (
         return EPERM;
     }
 
-    m_storage->set_inner_table ( table, table_len, SET_TB, conn );
+    LOCKERS_WLOCK ( key )
+
+    table_generation ( offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), SET_TB, conn );
 
     if ( ttl <= 0 || ttl > m_store_conf.db_ttl_maximum )
     {
@@ -2833,7 +4144,11 @@ int hustdb_t::hustdb_srem (
         return EPERM;
     }
 
-    m_storage->set_inner_table ( table, table_len, SET_TB, conn );
+    LOCKERS_WLOCK ( key )
+
+    table_generation ( offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), SET_TB, conn );
 
     r = m_storage->del ( key, key_len, ver, is_dup, conn, ctxt );
     if ( 0 != r )
@@ -2899,7 +4214,9 @@ int hustdb_t::hustdb_smembers (
         return EPERM;
     }
 
-    m_storage->set_inner_table ( table, table_len, SET_TB, conn );
+    table_generation ( _offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), SET_TB, conn );
 
     struct export_cb_param_t cb_pm;
     cb_pm.start             = start;
@@ -2958,7 +4275,9 @@ int hustdb_t::hustdb_zismember (
         return EPERM;
     }
 
-    m_storage->set_inner_table ( table, table_len, ZSET_IN, conn );
+    table_generation ( offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_IN, conn );
 
     r = m_storage->exists ( key, key_len, ver, conn, ctxt );
     if ( 0 != r )
@@ -3029,12 +4348,16 @@ int hustdb_t::hustdb_zadd (
         return EPERM;
     }
 
+    hotkey ( HOTKEY_ZADD, table, table_len, key, key_len, 0, conn );
+
     LOCKERS_WLOCK ( key )
 
+    table_generation ( offset, inner_table );
+
     m_storage->set_inner_ttl ( 0, conn );
-    m_storage->set_inner_table ( table, table_len, ZSET_IN, conn );
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_IN, conn );
     
-    if ( m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
         mkey_len = key_len;
         mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
@@ -3129,7 +4452,7 @@ int hustdb_t::hustdb_zadd (
         set_table_meta ( offset, 1 );
     }
     
-    if ( ( ! is_dup && ver > 1 || is_dup && user_ver == ver && ! ctxt->is_version_error ) && m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( ( ! is_dup && ver > 1 || is_dup && user_ver == ver && ! ctxt->is_version_error ) && m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
         if ( val_len < MDB_VAL_LEN )
         {
@@ -3154,7 +4477,7 @@ int hustdb_t::hustdb_zadd (
     if ( has_been )
     {
         sprintf ( val21, "%021li", cur_score );
-        m_storage->set_inner_table ( table, table_len, ZSET_TB, conn, val21 );
+        m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_TB, conn, val21 );
 
         user_ver = 0;
         r = m_storage->del ( key, key_len, user_ver, false, conn, ctxt );
@@ -3173,7 +4496,7 @@ int hustdb_t::hustdb_zadd (
     }
 
     sprintf ( val21, "%021li", score );
-    m_storage->set_inner_table ( table, table_len, ZSET_TB, conn, val21 );
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_TB, conn, val21 );
 
     user_ver = ver;
     r = m_storage->put ( key, key_len, val, val_len, user_ver, true, conn, ctxt );
@@ -3228,12 +4551,14 @@ int hustdb_t::hustdb_zscore (
         LOG_ERROR ( "[hustdb][db_zscore]find table failed" );
         return EPERM;
     }
+
+    table_generation ( offset, inner_table );
     
     LOCKERS_RLOCK ( key )
 
-    m_storage->set_inner_table ( table, table_len, ZSET_IN, conn );
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_IN, conn );
     
-    if ( m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
+    if ( m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
     {
         mkey_len = key_len;
         mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
@@ -3280,7 +4605,7 @@ int hustdb_t::hustdb_zscore (
         
         rsp_len = rsp->size ();
         
-        if ( m_mdb_ok && alive >= 0 && table_len + key_len + 2 < MDB_KEY_LEN && rsp_len < MDB_VAL_LEN )
+        if ( m_mdb_ok && alive >= 0 && inner_table.size () + key_len + 2 < MDB_KEY_LEN && rsp_len < MDB_VAL_LEN )
         {
             mdb_data_item_t mdb_idx;
             mdb_idx.version       = ver;
@@ -3335,7 +4660,9 @@ int hustdb_t::hustdb_zrem (
 
     LOCKERS_WLOCK ( key )
 
-    m_storage->set_inner_table ( table, table_len, ZSET_IN, conn );
+    table_generation ( offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_IN, conn );
 
     r = m_storage->get ( key, key_len, cur_ver, conn, rsp, ctxt );
     if ( 0 == r )
@@ -3356,132 +4683,407 @@ int hustdb_t::hustdb_zrem (
         }
         else
         {
-            LOG_ERROR ( "[hustdb][db_zrem][r=%d]", 
+            LOG_ERROR ( "[hustdb][db_zrem][r=%d]", 
+                        r );
+        }
+
+        return r;
+    }
+
+    if ( ! ctxt->is_version_error )
+    {
+        set_table_meta ( offset, - 1 );
+    }
+    
+    if ( ! ctxt->is_version_error && m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
+    {
+        mkey_len = key_len;
+        mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
+
+        m_mdb->del ( mkey, mkey_len );
+    }
+
+    sprintf ( val21, "%021li", cur_score );
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_TB, conn, val21 );
+
+    cur_ver = 0;
+    r = m_storage->del ( key, key_len, cur_ver, false, conn, ctxt );
+    if ( 0 != r )
+    {
+        if ( ENOENT == r )
+        {
+            LOG_DEBUG ( "[hustdb][db_zrem][r=ENOENT]" );
+        }
+        else
+        {
+            LOG_ERROR ( "[hustdb][db_zrem][r=%d]", 
+                        r );
+        }
+    }
+
+    return 0;
+}
+
+int hustdb_t::hustdb_zrange (
+                              const char *    table,
+                              size_t          table_len,
+                              int64_t         min,
+                              int64_t         max,
+                              int             offset,
+                              int             size,
+                              int             start,
+                              int             end,
+                              bool            async,
+                              bool            noval,
+                              bool            byscore,
+                              uint32_t &      hits,
+                              uint32_t &      total,
+                              std::string * & rsp,
+                              conn_ctxt_t     conn,
+                              item_ctxt_t * & ctxt
+                              )
+{
+    int             r            = 0;
+    int             _offset      = - 1;
+    uint16_t        hash         = 0;
+
+    if ( byscore )
+    {
+        async = false;
+    }
+
+    if ( unlikely ( ! tb_name_check ( table, table_len ) ||
+                    offset < 0 || offset > MAX_EXPORT_OFFSET ||
+                    size < 0 || size > MEM_EXPORT_SIZE ||
+                    ! async && offset > SYNC_EXPORT_OFFSET ||
+                    byscore && min > max ||
+                    start < 0 || end < 0 || start >= end || end > MAX_BUCKET_NUM
+                   )
+         )
+    {
+        LOG_DEBUG ( "[hustdb][db_zrange][byscore=%d]params error", 
+                    byscore );
+        return EKEYREJECTED;
+    }
+
+    std::string inner_table ( table, table_len );
+
+    _offset = find_table_offset ( inner_table, false, ZSET_TB );
+    if ( unlikely ( _offset < 0 ) )
+    {
+        LOG_ERROR ( "[hustdb][db_zrange]find table failed" );
+        return EPERM;
+    }
+
+    table_generation ( _offset, inner_table );
+
+    hash = m_apptool->bucket_hash ( table, table_len );
+    if ( hash < start || hash >= end )
+    {
+        LOG_ERROR ( "[hustdb][db_zrange][byscore=%d][table=%s][%d-%d]bucket_hash out of range", 
+                    byscore, inner_table.c_str (), start, end );
+        return EPERM;
+    }
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_TB, conn );
+
+    struct export_cb_param_t cb_pm;
+    cb_pm.start             = 0;
+    cb_pm.end               = MAX_BUCKET_NUM;
+    cb_pm.offset            = offset;
+    cb_pm.size              = size;
+    cb_pm.file_id           = - 1;
+    cb_pm.noval             = noval;
+    cb_pm.async             = async;
+    cb_pm.total             = 0;
+    cb_pm.min               = min;
+    cb_pm.max               = max;
+    cb_pm.byscore           = byscore;
+
+    r = m_storage->export_db_mem ( conn, rsp, ctxt, NULL, & cb_pm );
+    if ( 0 != r )
+    {
+        LOG_ERROR ( "[hustdb][db_zrange][byscore=%d][r=%d]", 
+                    byscore, r );
+    }
+
+    hits                    = cb_pm.size;
+    total                   = cb_pm.total;
+
+    return r;
+}
+
+int hustdb_t::hustdb_zremrange (
+                                 const char *    table,
+                                 size_t          table_len,
+                                 int64_t         min,
+                                 int64_t         max,
+                                 int             offset,
+                                 int             size,
+                                 bool            byscore,
+                                 const char *    host,
+                                 size_t          host_len,
+                                 uint32_t &      hits,
+                                 std::string &   rsp,
+                                 conn_ctxt_t     conn
+                                 )
+{
+    int                         r            = 0;
+    int                         _offset      = - 1;
+    int64_t                     score        = 0;
+    int64_t                     cur_score    = 0;
+    int64_t                     removed      = 0;
+    uint32_t                    ver          = 0;
+    size_t                      mkey_len     = 0;
+    const char *                mkey         = NULL;
+    char                        val21[ 32 ]  = { };
+    std::string *               val          = NULL;
+    item_ctxt_t *               ctxt         = NULL;
+    c_str_t                     base64_src;
+    c_str_t                     base64_dst;
+    std::string                 base64_item;
+    std::vector< std::string >  keys;
+    std::vector< std::string >  vals;
+
+    hits = 0;
+    rsp.resize ( 0 );
+
+    if ( unlikely ( ! tb_name_check ( table, table_len ) ||
+                    offset < 0 || offset > SYNC_EXPORT_OFFSET ||
+                    size <= 0 || size > MEM_EXPORT_SIZE ||
+                    byscore && min > max ||
+                    host && ( host_len <= 0 || host_len > 32 )
+                   )
+         )
+    {
+        LOG_DEBUG ( "[hustdb][db_zremrange][byscore=%d]params error", 
+                    byscore );
+        return EKEYREJECTED;
+    }
+
+    std::string inner_table ( table, table_len );
+
+    _offset = find_table_offset ( inner_table, false, ZSET_TB );
+    if ( unlikely ( _offset < 0 ) )
+    {
+        LOG_ERROR ( "[hustdb][db_zremrange]find table failed" );
+        return EPERM;
+    }
+
+    uint32_t generation = table_generation ( _offset, inner_table );
+
+    m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_TB, conn );
+
+    struct export_cb_param_t cb_pm;
+    cb_pm.start             = 0;
+    cb_pm.end               = MAX_BUCKET_NUM;
+    cb_pm.offset            = offset;
+    cb_pm.size              = size;
+    cb_pm.file_id           = - 1;
+    cb_pm.noval             = false;
+    cb_pm.async             = false;
+    cb_pm.total             = 0;
+    cb_pm.min               = min;
+    cb_pm.max               = max;
+    cb_pm.byscore           = byscore;
+
+    r = m_storage->table_keys ( conn, ctxt, NULL, & cb_pm, keys, vals );
+    if ( 0 != r )
+    {
+        LOG_ERROR ( "[hustdb][db_zremrange][byscore=%d][r=%d]table_keys failed", 
+                    byscore, r );
+        return r;
+    }
+
+    rsp += "[";
+
+    for ( size_t i = 0; i < keys.size (); i ++ )
+    {
+        const char * key     = keys[ i ].c_str ();
+        size_t       key_len = keys[ i ].size ();
+
+        if ( ! db_strtoll ( vals[ i ].c_str (), & score ) )
+        {
+            continue;
+        }
+
+        LOCKERS_WLOCK ( key )
+
+        // dropped since the index was read, what is left is the reclaimer's
+        if ( ( ( table_stat_t * ) ( m_table_index.ptr + _offset ) )->generation != generation )
+        {
+            break;
+        }
+
+        m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_IN, conn );
+
+        // the member may have been moved or removed since the index was read
+        r = m_storage->get ( key, key_len, ver, conn, val, ctxt );
+        if ( 0 != r ||
+             ! db_strtoll ( val->c_str (), & cur_score ) ||
+             cur_score != score
+             )
+        {
+            continue;
+        }
+
+        ver = 0;
+        r = m_storage->del ( key, key_len, ver, false, conn, ctxt );
+        if ( 0 != r )
+        {
+            if ( ENOENT != r )
+            {
+                LOG_ERROR ( "[hustdb][db_zremrange][r=%d]", 
+                            r );
+            }
+
+            continue;
+        }
+
+        removed ++;
+
+        if ( m_mdb_ok && inner_table.size () + key_len + 2 < MDB_KEY_LEN )
+        {
+            mkey_len = key_len;
+            mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
+
+            m_mdb->del ( mkey, mkey_len );
+        }
+
+        if ( host )
+        {
+            r = m_storage->binlog ( key, key_len, host, host_len, m_current_timestamp, HUSTDB_METHOD_ZREM, true, conn );
+            if ( 0 != r )
+            {
+                LOG_ERROR ( "[hustdb][db_zremrange][r=%d]binlog failed", 
+                            r );
+            }
+        }
+
+        sprintf ( val21, "%021li", score );
+        m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_TB, conn, val21 );
+
+        ver = 0;
+        r = m_storage->del ( key, key_len, ver, false, conn, ctxt );
+        if ( 0 != r && ENOENT != r )
+        {
+            LOG_ERROR ( "[hustdb][db_zremrange][r=%d]", 
                         r );
         }
 
-        return r;
-    }
+        base64_src.len  = key_len;
+        base64_src.data = ( char * ) key;
 
-    if ( ! ctxt->is_version_error )
-    {
-        set_table_meta ( offset, - 1 );
-    }
-    
-    if ( ! ctxt->is_version_error && m_mdb_ok && table_len + key_len + 2 < MDB_KEY_LEN )
-    {
-        mkey_len = key_len;
-        mkey = m_storage->get_inner_tbkey ( key, mkey_len, conn );
+        base64_dst.len  = c_base64_encoded_length ( base64_src.len );
+        base64_item.resize ( base64_dst.len );
+        base64_dst.data = ( char * ) base64_item.c_str ();
 
-        m_mdb->del ( mkey, mkey_len );
+        hustdb_base64_encode ( & base64_src, & base64_dst );
+
+        rsp += "{\"key\":\"";
+        rsp.append ( base64_dst.data, base64_dst.len );
+        rsp += "\",\"val\":\"";
+        rsp += vals[ i ];
+        rsp += "\"},";
     }
 
-    sprintf ( val21, "%021li", cur_score );
-    m_storage->set_inner_table ( table, table_len, ZSET_TB, conn, val21 );
+    if ( rsp.size () > 1 )
+    {
+        rsp.erase ( rsp.end () - 1, rsp.end () );
+    }
+    rsp += "]";
 
-    cur_ver = 0;
-    r = m_storage->del ( key, key_len, cur_ver, false, conn, ctxt );
-    if ( 0 != r )
+    if ( removed > 0 )
     {
-        if ( ENOENT == r )
-        {
-            LOG_DEBUG ( "[hustdb][db_zrem][r=ENOENT]" );
-        }
-        else
-        {
-            LOG_ERROR ( "[hustdb][db_zrem][r=%d]", 
-                        r );
-        }
+        set_table_meta ( _offset, - removed );
     }
 
+    hits = ( uint32_t ) removed;
+
     return 0;
 }
 
-int hustdb_t::hustdb_zrange (
-                              const char *    table,
-                              size_t          table_len,
-                              int64_t         min,
-                              int64_t         max,
-                              int             offset,
-                              int             size,
-                              int             start,
-                              int             end,
-                              bool            async,
-                              bool            noval,
-                              bool            byscore,
-                              uint32_t &      hits,
-                              uint32_t &      total,
-                              std::string * & rsp,
-                              conn_ctxt_t     conn,
-                              item_ctxt_t * & ctxt
-                              )
+int hustdb_t::hustdb_drop (
+                            const char *    table,
+                            size_t          table_len,
+                            uint8_t         type
+                            )
 {
     int             r            = 0;
-    int             _offset      = - 1;
-    uint16_t        hash         = 0;
 
-    if ( byscore )
+    if ( unlikely ( ! tb_name_check ( table, table_len ) ) )
     {
-        async = false;
+        LOG_DEBUG ( "[hustdb][db_drop]params error" );
+        return EKEYREJECTED;
     }
 
-    if ( unlikely ( ! tb_name_check ( table, table_len ) ||
-                    offset < 0 || offset > MAX_EXPORT_OFFSET ||
-                    size < 0 || size > MEM_EXPORT_SIZE ||
-                    ! async && offset > SYNC_EXPORT_OFFSET ||
-                    byscore && min > max ||
-                    start < 0 || end < 0 || start >= end || end > MAX_BUCKET_NUM
-                   )
-         )
+    std::string inner_table ( table, table_len );
+
+    // a writer reads the generation under its key lock, so none of them
+    // writes to the old one once its stats are zeroed
+    for ( wrlocker_vec_t::iterator it = m_lockers.begin (); it != m_lockers.end (); ++ it )
     {
-        LOG_DEBUG ( "[hustdb][db_zrange][byscore=%d]params error", 
-                    byscore );
-        return EKEYREJECTED;
+        ( * it )->wlock ();
     }
 
-    std::string inner_table ( table, table_len );
+    r = drop_generation ( inner_table, type );
 
-    _offset = find_table_offset ( inner_table, false, ZSET_TB );
-    if ( unlikely ( _offset < 0 ) )
+    for ( wrlocker_vec_t::reverse_iterator it = m_lockers.rbegin (); it != m_lockers.rend (); ++ it )
     {
-        LOG_ERROR ( "[hustdb][db_zrange]find table failed" );
-        return EPERM;
+        ( * it )->wunlock ();
     }
 
-    hash = m_apptool->bucket_hash ( table, table_len );
-    if ( hash < start || hash >= end )
+    return r;
+}
+
+int hustdb_t::drop_generation (
+                                const std::string & inner_table,
+                                uint8_t             type
+                                )
+{
+    int64_t         count        = 0;
+    int64_t         size         = 0;
+    int64_t         capacity     = 0;
+    table_stat_t *  tstat        = NULL;
+
+    scope_wlock_t tb_locker ( m_tb_locker );
+
+    table_map_t::iterator it = m_table_map.find ( inner_table );
+    if ( it == m_table_map.end () )
     {
-        LOG_ERROR ( "[hustdb][db_zrange][byscore=%d][table=%s][%d-%d]bucket_hash out of range", 
-                    byscore, inner_table.c_str (), start, end );
-        return EPERM;
+        LOG_DEBUG ( "[hustdb][db_drop][r=ENOENT]" );
+        return ENOENT;
     }
 
-    m_storage->set_inner_table ( table, table_len, ZSET_TB, conn );
+    tstat = ( table_stat_t * ) ( m_table_index.ptr + it->second );
+    if ( unlikely ( tstat->type != type ) )
+    {
+        LOG_ERROR ( "[hustdb][db_drop][table=%s]table type mismatch", 
+                    tstat->table );
+        return EPERM;
+    }
 
-    struct export_cb_param_t cb_pm;
-    cb_pm.start             = 0;
-    cb_pm.end               = MAX_BUCKET_NUM;
-    cb_pm.offset            = offset;
-    cb_pm.size              = size;
-    cb_pm.file_id           = - 1;
-    cb_pm.noval             = noval;
-    cb_pm.async             = async;
-    cb_pm.total             = 0;
-    cb_pm.min               = min;
-    cb_pm.max               = max;
-    cb_pm.byscore           = byscore;
+    // the records stay where they are, bumping the generation hides them
+    // from every table op and hands them over to the reclaimer
+    count    = __sync_lock_test_and_set ( & tstat->count, 0 );
+    size     = __sync_lock_test_and_set ( & tstat->size, 0 );
+    capacity = __sync_lock_test_and_set ( & tstat->capacity, 0 );
 
-    r = m_storage->export_db_mem ( conn, rsp, ctxt, NULL, & cb_pm );
-    if ( 0 != r )
+    if ( type == HASH_TB )
     {
-        LOG_ERROR ( "[hustdb][db_zrange][byscore=%d][r=%d]", 
-                    byscore, r );
+        table_stat_t * tstat_hash = ( table_stat_t * ) ( m_table_index.ptr + TABLE_STAT_LEN );
+
+        __sync_sub_and_fetch ( & tstat_hash->count, count );
+        __sync_sub_and_fetch ( & tstat_hash->size, size );
+        __sync_sub_and_fetch ( & tstat_hash->capacity, capacity );
     }
 
-    hits                    = cb_pm.size;
-    total                   = cb_pm.total;
+    tstat->generation ++;
 
-    return r;
+    LOG_INFO ( "[hustdb][db_drop][table=%s][generation=%u][count=%lld]table dropped", 
+               tstat->table, tstat->generation, count );
+
+    return 0;
 }
 
 int hustdb_t::hustdb_binlog (
@@ -3508,6 +5110,21 @@ int hustdb_t::hustdb_binlog (
         LOG_DEBUG ( "[hustdb][db_binlog]params error" );
         return EKEYREJECTED;
     }
+
+    std::string inner_table;
+    if ( table && table_len > 0 )
+    {
+        uint8_t type   = 0;
+        int     offset = - 1;
+
+        inner_table.assign ( table, table_len );
+
+        offset = find_table_type ( inner_table, type );
+        if ( offset >= 0 )
+        {
+            table_generation ( offset, inner_table );
+        }
+    }
     
     switch ( cmd_type )
     {
@@ -3520,19 +5137,19 @@ int hustdb_t::hustdb_binlog (
         case HUSTDB_METHOD_HDEL:
             is_rem = true;
         case HUSTDB_METHOD_HSET:
-            m_storage->set_inner_table ( table, table_len, HASH_TB, conn );
+            m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), HASH_TB, conn );
             break;
             
         case HUSTDB_METHOD_SREM:
             is_rem = true;
         case HUSTDB_METHOD_SADD:
-            m_storage->set_inner_table ( table, table_len, SET_TB, conn );
+            m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), SET_TB, conn );
             break;
             
         case HUSTDB_METHOD_ZREM:
             is_rem = true;
         case HUSTDB_METHOD_ZADD:
-            m_storage->set_inner_table ( table, table_len, ZSET_IN, conn );
+            m_storage->set_inner_table ( inner_table.c_str (), inner_table.size (), ZSET_IN, conn );
             break;
             
         default:
@@ -3587,6 +5204,8 @@ int hustdb_t::hustmq_put (
         return ENOMEM;
     }
 
+    hotkey ( HOTKEY_MQ_PUT, queue, queue_len, NULL, 0, item_len, conn );
+
     LOCKERS_WLOCK ( queue )
 
     std::string inner_queue ( queue, queue_len );
@@ -3628,6 +5247,11 @@ int hustdb_t::hustmq_put (
 
     fast_memcpy ( qstat_val + SIZEOF_UINT32 * ( priori * 2 + 1 ), & tag, SIZEOF_UINT32 );
 
+    if ( 0 == real )
+    {
+        hustmq_changed ( inner_queue );
+    }
+
     return 0;
 }
 
@@ -3717,6 +5341,11 @@ int hustdb_t::hustmq_get (
 
         sprintf ( qkey, "%s|%u:%u", inner_queue.c_str (), priori, tag );
         qkey_len = strlen ( qkey );
+
+        if ( 0 == clac_real_item ( qstat->sp, qstat->ep ) + clac_real_item ( qstat->sp1, qstat->ep1 ) + clac_real_item ( qstat->sp2, qstat->ep2 ) )
+        {
+            hustmq_changed ( inner_queue );
+        }
     }
 
     ack = qkey;
@@ -3739,6 +5368,8 @@ int hustdb_t::hustmq_get (
         queue_info->redelivery->insert ( std::pair<uint32_t, std::string>( m_current_timestamp, unacked ) );
     }
 
+    hotkey ( HOTKEY_MQ_GET, queue, queue_len, NULL, 0, rsp->size (), conn );
+
     return 0;
 }
 
@@ -3950,14 +5581,49 @@ int hustdb_t::hustmq_stat (
     return 0;
 }
 
+void hustdb_t::hustmq_stat_item (
+                                  const std::string & queue,
+                                  queue_info_t *      queue_info,
+                                  std::string &       stats
+                                  )
+{
+    char            stat[ 1024 ]            = { };
+
+    // a purged queue is reported empty so the ha drops what it cached
+    if ( NULL == queue_info )
+    {
+        sprintf ( stat,
+                 "{\"queue\":\"%s\",\"ready\":[0,0,0],\"unacked\":0,\"max\":0,\"lock\":0,\"type\":0,\"timeout\":0,\"si\":0,\"ci\":0,\"tm\":0},",
+                 queue.c_str ()
+                 );
+        stats += stat;
+        return;
+    }
+
+    queue_stat_t * qstat = ( queue_stat_t * ) ( m_queue_index.ptr + queue_info->offset );
+
+    sprintf ( stat,
+             "{\"queue\":\"%s\",\"ready\":[%u,%u,%u],\"unacked\":%u,\"max\":%u,\"lock\":%u,\"type\":%u,\"timeout\":%u,\"si\":%u,\"ci\":%u,\"tm\":%u},",
+             queue.c_str (),
+             clac_real_item ( qstat->sp, qstat->ep ),
+             clac_real_item ( qstat->sp1, qstat->ep1 ),
+             clac_real_item ( qstat->sp2, qstat->ep2 ),
+             queue_info->unacked->size (),
+             qstat->max,
+             qstat->lock,
+             qstat->type,
+             qstat->timeout,
+             qstat->sp,
+             qstat->ep,
+             qstat->ctime
+             );
+    stats += stat;
+}
+
 void hustdb_t::hustmq_stat_all (
                                  std::string & stats
                                  )
 {
-    queue_stat_t *  qstat                   = NULL;
-    char            stat[ 1024 ]            = { };
-    queue_info_t *  queue_info              = NULL;
-
     stats.resize ( 0 );
     stats.reserve ( 1048576 );
     stats += "[";
@@ -3966,27 +5632,98 @@ void hustdb_t::hustmq_stat_all (
 
     for ( queue_map_t::iterator it = m_queue_map.begin (); it != m_queue_map.end (); it ++ )
     {
-        queue_info = & it->second;
+        hustmq_stat_item ( it->first, & it->second, stats );
+    }
+
+    if ( stats.size () > 2 )
+    {
+        stats.erase ( stats.end () - 1, stats.end () );
+    }
+    stats += "]";
+}
 
-        qstat = ( queue_stat_t * ) ( m_queue_index.ptr + queue_info->offset );
+void hustdb_t::hustmq_changed (
+                                const std::string & queue
+                                )
+{
+    {
+        scope_lock_t watch_locker ( m_mq_watch_locker );
 
-        memset ( stat, 0, sizeof ( stat ) );
-        sprintf ( stat,
-                 "{\"queue\":\"%s\",\"ready\":[%u,%u,%u],\"unacked\":%u,\"max\":%u,\"lock\":%u,\"type\":%u,\"timeout\":%u,\"si\":%u,\"ci\":%u,\"tm\":%u},",
-                 it->first.c_str (),
-                 clac_real_item ( qstat->sp, qstat->ep ),
-                 clac_real_item ( qstat->sp1, qstat->ep1 ),
-                 clac_real_item ( qstat->sp2, qstat->ep2 ),
-                 queue_info->unacked->size (),
-                 qstat->max,
-                 qstat->lock,
-                 qstat->type,
-                 qstat->timeout,
-                 qstat->sp,
-                 qstat->ep,
-                 qstat->ctime
-                 );
-        stats += stat;
+        mq_change_t change;
+        change.seq   = ++ m_mq_seq;
+        change.queue = queue;
+        m_mq_changes.push_back ( change );
+
+        if ( m_mq_changes.size () > MQ_WATCH_CHANGES )
+        {
+            m_mq_changes.pop_front ();
+        }
+
+        if ( m_mq_notify )
+        {
+            m_mq_notify ( m_mq_notify_arg );
+        }
+    }
+}
+
+void hustdb_t::hustmq_set_notify (
+                                   mq_notify_t notify,
+                                   void *      arg
+                                   )
+{
+    scope_lock_t watch_locker ( m_mq_watch_locker );
+
+    m_mq_notify_arg = arg;
+    m_mq_notify     = notify;
+}
+
+bool hustdb_t::hustmq_watch (
+                              uint64_t      since,
+                              uint64_t &    seq,
+                              std::string & stats
+                              )
+{
+    bool                    full            = false;
+    std::set<std::string>   queues;
+
+    {
+        scope_lock_t watch_locker ( m_mq_watch_locker );
+
+        seq = m_mq_seq;
+        if ( since == seq )
+        {
+            return false;
+        }
+
+        // a seq from another run of the server, or older than the changes kept
+        if ( since > seq || m_mq_changes.empty () || m_mq_changes.front ().seq > since + 1 )
+        {
+            full = true;
+        }
+        else
+        {
+            for ( mq_change_list_t::reverse_iterator it = m_mq_changes.rbegin (); it != m_mq_changes.rend () && it->seq > since; ++ it )
+            {
+                queues.insert ( it->queue );
+            }
+        }
+    }
+
+    if ( full )
+    {
+        hustmq_stat_all ( stats );
+        return true;
+    }
+
+    stats.resize ( 0 );
+    stats += "[";
+
+    scope_rlock_t mq_locker ( m_mq_locker );
+
+    for ( std::set<std::string>::iterator it = queues.begin (); it != queues.end (); ++ it )
+    {
+        queue_map_t::iterator qit = m_queue_map.find ( * it );
+        hustmq_stat_item ( * it, qit != m_queue_map.end () ? & qit->second : NULL, stats );
     }
 
     if ( stats.size () > 2 )
@@ -3994,6 +5731,15 @@ void hustdb_t::hustmq_stat_all (
         stats.erase ( stats.end () - 1, stats.end () );
     }
     stats += "]";
+
+    return true;
+}
+
+uint64_t hustdb_t::hustmq_watch_seq ( )
+{
+    scope_lock_t watch_locker ( m_mq_watch_locker );
+
+    return m_mq_seq;
 }
 
 int hustdb_t::hustmq_max (
@@ -4208,6 +5954,8 @@ int hustdb_t::hustmq_purge (
         fast_memcpy ( qstat_val + SIZEOF_UINT32 * ( priori * 2 + 1 ), & etag, SIZEOF_UINT32 );
     }
 
+    hustmq_changed ( inner_queue );
+
     return 0;
 }
 
@@ -4346,6 +6094,9 @@ int hustdb_t::hustmq_pub (
     fast_memcpy ( qstat_val + SIZEOF_UINT32 * priori * 2, & stag, SIZEOF_UINT32 );
     fast_memcpy ( qstat_val + SIZEOF_UINT32 * ( priori * 2 + 1 ), & etag, SIZEOF_UINT32 );
 
+    // every publish moves the index the subscribers wait on
+    hustmq_changed ( inner_queue );
+
     return 0;
 }
 
@@ -4492,3 +6243,42 @@ static void binlog_scan_cb (
     hustdb_t * db = ( hustdb_t * ) ctx;
     db->hustdb_binlog_scan ( );
 }
+
+static void drop_scan_cb (
+                           void * ctx
+                           )
+{
+    if ( unlikely ( ! ctx ) )
+    {
+        return ;
+    }
+
+    hustdb_t * db = ( hustdb_t * ) ctx;
+    db->hustdb_drop_scan ( );
+}
+
+static void hincrby_flush_cb (
+                               void * ctx
+                               )
+{
+    if ( unlikely ( ! ctx ) )
+    {
+        return ;
+    }
+
+    hustdb_t * db = ( hustdb_t * ) ctx;
+    db->hustdb_hincrby_flush ( );
+}
+
+static void hotkeys_merge_cb (
+                               void * ctx
+                               )
+{
+    if ( unlikely ( ! ctx ) )
+    {
+        return ;
+    }
+
+    hustdb_t * db = ( hustdb_t * ) ctx;
+    db->hustdb_hotkeys_merge ( );
+}
@@ -10,7 +10,10 @@
 #include "utils/timer.h"
 #include "mdb/mdb.h"
 #include "rdb/rdb.h"
+#include "hincrby_buffer.h"
+#include "hotkeys.h"
 #include <set>
+#include <deque>
 #include <vector>
 
 #define SIZEOF_UINT32                 4
@@ -26,6 +29,7 @@
 
 #define TABLE_STAT_LEN                sizeof ( table_stat_t )
 #define TABLE_INDEX_FILE_LEN          ( sizeof ( table_stat_t ) * m_store_conf.db_table_maximum )
+#define TABLE_GENERATION_SEP          '@'
 
 #define MIN_WORKER_LEN                4
 #define MAX_WORKER_LEN                32
@@ -36,6 +40,8 @@
 #define MAX_QUEUE_ITEM_NUM            5000000
 #define CYCLE_QUEUE_ITEM_NUM          11000000
 
+#define MQ_WATCH_CHANGES              65536
+
 #define MAX_EXPORT_OFFSET             100000000
 #define SYNC_EXPORT_OFFSET            1000000
 #define MEM_EXPORT_SIZE               1000
@@ -63,12 +69,26 @@ enum table_type_t
     ZSET_TB     = 124
 };
 
+enum inner_hash_t
+{
+    INNER_HASH_MD5      = 0,
+    INNER_HASH_MURMUR3  = 1
+};
+
+// format 0: md5db/conflictdb/contentdb/fast_conflictdb only (legacy, always md5)
+// format 1: + format, inner_hash
+// format 2: contentdb free space kept as a page bitmap (.free.bitmap), converted from .free.block on open
+#define HUSTSTORE_FORMAT_VERSION        2
+#define HUSTSTORE_INVARIANT_V0_LEN      ( sizeof ( uint32_t ) * 4 )
+
 typedef struct invariant_s
 {
     uint32_t    md5db;
     uint32_t    conflictdb;
     uint32_t    contentdb;
     uint32_t    fast_conflictdb;
+    uint32_t    format;
+    uint32_t    inner_hash;
 
 } invariant_t;
 
@@ -107,6 +127,16 @@ typedef struct queue_info_s
 
 typedef std::map < std::string, queue_info_t > queue_map_t;
 
+typedef struct mq_change_s
+{
+    uint64_t          seq;
+    std::string       queue;
+} mq_change_t;
+
+typedef std::deque < mq_change_t > mq_change_list_t;
+
+typedef void ( * mq_notify_t ) ( void * arg );
+
 struct table_stat_s
 {
     volatile int64_t  count;
@@ -118,6 +148,11 @@ struct table_stat_s
     uint32_t          _reserved : 23;
 
     char              table [ MAX_QUEUE_NAME_LEN + 2 ];
+
+    // records of generations in [ reclaimed, generation ) were dropped
+    // and are waiting for the reclaimer
+    volatile uint32_t generation;
+    volatile uint32_t reclaimed;
 } __attribute__ ( ( aligned ( 64 ) ) );
 typedef struct table_stat_s table_stat_t;
 
@@ -125,6 +160,11 @@ typedef std::map< std::string, uint32_t > table_map_t;
 
 typedef std::vector< rwlockable_t * > wrlocker_vec_t;
 
+// tcp.worker_affinity
+#define WORKER_AFFINITY_NONE        0
+#define WORKER_AFFINITY_NUMA        1
+#define WORKER_AFFINITY_CORE        2
+
 typedef struct server_conf_s
 {
     int32_t tcp_port;
@@ -138,11 +178,15 @@ typedef struct server_conf_s
     int32_t tcp_recv_timeout;
     int32_t tcp_send_timeout;
     int32_t tcp_worker_count;
+    int32_t tcp_async_read_threads;
+    int32_t tcp_async_read_depth;
     std::string http_security_user;
     std::string http_security_passwd;
     std::string http_access_allow;
     int32_t memory_process_threshold;
     int32_t memory_system_threshold;
+    bool numa_interleave;
+    int32_t tcp_worker_affinity;
 
     server_conf_s ( )
     : tcp_port ( 0 )
@@ -156,11 +200,15 @@ typedef struct server_conf_s
     , tcp_recv_timeout ( 0 )
     , tcp_send_timeout ( 0 )
     , tcp_worker_count ( 0 )
+    , tcp_async_read_threads ( 0 )
+    , tcp_async_read_depth ( 0 )
     , http_security_user ( )
     , http_security_passwd ( )
     , http_access_allow ( )
     , memory_process_threshold ( 0 )
     , memory_system_threshold ( 0 )
+    , numa_interleave ( false )
+    , tcp_worker_affinity ( WORKER_AFFINITY_NONE )
     {
     }
 
@@ -181,6 +229,18 @@ typedef struct store_conf_s
     int32_t mq_queue_maximum;
     int32_t db_table_maximum;
     int32_t db_ttl_scan_count;
+    int32_t db_drop_scan_interval;
+    int32_t db_drop_scan_count;
+    bool    db_hincrby_combine;
+    int32_t db_hincrby_flush_interval;
+    int32_t db_hincrby_flush_count;
+    int32_t db_hincrby_max_keys;
+    bool    db_hincrby_journal;
+    bool    db_hotkeys_enable;
+    int32_t db_hotkeys_top_k;
+    int32_t db_hotkeys_interval;
+    int32_t db_load_buffer_m;
+    int32_t db_backup_rate_limit;
     
     store_conf_s ( )
     : db_disk_storage_capacity ( 0 )
@@ -196,6 +256,18 @@ typedef struct store_conf_s
     , mq_queue_maximum ( 0 )
     , db_table_maximum ( 0 )
     , db_ttl_scan_count ( 0 )
+    , db_drop_scan_interval ( 0 )
+    , db_drop_scan_count ( 0 )
+    , db_hincrby_combine ( false )
+    , db_hincrby_flush_interval ( 0 )
+    , db_hincrby_flush_count ( 0 )
+    , db_hincrby_max_keys ( 0 )
+    , db_hincrby_journal ( false )
+    , db_hotkeys_enable ( false )
+    , db_hotkeys_top_k ( 0 )
+    , db_hotkeys_interval ( 0 )
+    , db_load_buffer_m ( 0 )
+    , db_backup_rate_limit ( 0 )
     {
     }
 
@@ -205,6 +277,9 @@ static void timestamp_cb         ( void * ctx );
 static void over_threshold_cb    ( void * ctx );
 static void ttl_scan_cb          ( void * ctx );
 static void binlog_scan_cb       ( void * ctx );
+static void drop_scan_cb         ( void * ctx );
+static void hincrby_flush_cb     ( void * ctx );
+static void hotkeys_merge_cb     ( void * ctx );
 
 class hustdb_t
 {
@@ -212,8 +287,13 @@ public:
 
     void kill_me ( );
     
+    // the config and the directories, enough to start the listener
     bool open ( );
 
+    // the storage and everything behind it, ok () once it returns true.
+    // runs while the workers serve, see run_server
+    bool open_storage ( );
+
     bool ok ( )
     {
         return m_storage_ok;
@@ -234,6 +314,11 @@ public:
         return m_storage;
     }
 
+    // stops every writer of ./DATA until thaw, see task_backup_t
+    void freeze ( );
+
+    void thaw ( );
+
     mdb_t * get_mdb ( )
     {
         return m_mdb;
@@ -249,6 +334,17 @@ public:
         return m_server_conf.tcp_worker_count;
     }
 
+    // per-conn buffers: workers, export / background tasks, async read threads
+    int32_t get_conn_count ( )
+    {
+        return m_server_conf.tcp_worker_count + 2 + m_server_conf.tcp_async_read_threads;
+    }
+
+    uint32_t get_inner_hash ( )
+    {
+        return m_inner_hash;
+    }
+
     server_conf_t & get_server_conf ( )
     {
         return m_server_conf;
@@ -324,6 +420,11 @@ public:
                        std::string & info
                        );
 
+    // false until the storage is open and warmed up
+    bool hustdb_ready (
+                        std::string & info
+                        );
+
     int hustdb_file_count ( );
 
     int hustdb_exist (
@@ -334,6 +435,7 @@ public:
                        item_ctxt_t * & ctxt
                        );
 
+    // mdb_missed: hustdb_get_cached missed already, mdb is not probed again
     int hustdb_get (
                      const char *    key,
                      size_t          key_len,
@@ -341,9 +443,21 @@ public:
                      int &           rsp_len,
                      uint32_t &      ver,
                      conn_ctxt_t     conn,
-                     item_ctxt_t * & ctxt
+                     item_ctxt_t * & ctxt,
+                     bool            mdb_missed = false
                      );
 
+    // mdb (l2_cache) only, ENOENT on miss, never touches disk
+    int hustdb_get_cached (
+                            const char *    key,
+                            size_t          key_len,
+                            std::string * & rsp,
+                            int &           rsp_len,
+                            uint32_t &      ver,
+                            conn_ctxt_t     conn,
+                            item_ctxt_t * & ctxt
+                            );
+
     int hustdb_put (
                      const char *    key,
                      size_t          key_len,
@@ -390,6 +504,11 @@ public:
                            std::string & stats
                            );
 
+    void hustdb_hotkeys (
+                          int32_t       n,
+                          std::string & rsp
+                          );
+
     int hustdb_export (
                         const char * table,
                         size_t       table_len,
@@ -403,10 +522,37 @@ public:
                         void * &     token
                         );
 
+    int hustdb_load (
+                      int          file_id,
+                      int          start,
+                      int          end,
+                      void * &     token
+                      );
+
+    int hustdb_backup (
+                        void * &     token
+                        );
+
     int hustdb_ttl_scan ( );
     
     int hustdb_binlog_scan ( );
 
+    int hustdb_drop_scan ( );
+
+    int hustdb_hincrby_flush ( );
+
+    void hustdb_hotkeys_merge ( );
+
+    int hustdb_drop_reclaim (
+                              uint32_t size
+                              );
+
+    bool tb_generation_check (
+                               const char * table,
+                               size_t       table_len,
+                               size_t &     name_len
+                               );
+
 public:
 
     int hustdb_hexist (
@@ -609,6 +755,37 @@ public:
                         conn_ctxt_t     conn,
                         item_ctxt_t * & ctxt
                         );
+
+    // removes up to size members of a zset in one pass over its score index,
+    // ranks [ offset, offset + size ) or the lowest scores in [ min, max ];
+    // with host, a zrem binlog record is left for that replica
+    int hustdb_zremrange (
+                           const char *    table,
+                           size_t          table_len,
+                           int64_t         min,
+                           int64_t         max,
+                           int             offset,
+                           int             size,
+                           bool            byscore,
+                           const char *    host,
+                           size_t          host_len,
+                           uint32_t &      hits,
+                           std::string &   rsp,
+                           conn_ctxt_t     conn
+                           );
+
+    int hustdb_drop (
+                      const char *    table,
+                      size_t          table_len,
+                      uint8_t         type
+                      );
+
+private:
+
+    int drop_generation (
+                          const std::string & inner_table,
+                          uint8_t             type
+                          );
     
 public:
 
@@ -720,6 +897,25 @@ public:
                      conn_ctxt_t     conn
                      );
 
+    // stats of the queues that became ready or empty after since, in the
+    // format of hustmq_stat_all ( every queue when since is too old ).
+    // returns false when nothing changed, seq is the sequence to wait on next
+    bool hustmq_watch (
+                        uint64_t      since,
+                        uint64_t &    seq,
+                        std::string & stats
+                        );
+
+    // the sequence of the last change, hustmq_watch has news for any other
+    uint64_t hustmq_watch_seq ( );
+
+    // notify is run by the thread that recorded a change, with the queue
+    // lock and the watch lock held. it is not running once this returns
+    void hustmq_set_notify (
+                             mq_notify_t notify,
+                             void *      arg
+                             );
+
 public:
 
     static
@@ -743,8 +939,28 @@ private:
     
     bool check_invariant_config ( );
 
+    static
+    int inner_hash_from_string (
+                                 const char * s
+                                 );
+
+    static
+    const char * inner_hash_to_string (
+                                        uint32_t inner_hash
+                                        );
+
     bool init_hash_config ( );
 
+    bool get_from_mdb (
+                        const char *    key,
+                        size_t          key_len,
+                        std::string * & rsp,
+                        int &           rsp_len,
+                        uint32_t &      ver,
+                        conn_ctxt_t     conn,
+                        item_ctxt_t * & ctxt
+                        );
+
     bool init_data_engine ( );
     
     bool init_queue_index ( );
@@ -779,6 +995,105 @@ private:
                           int64_t  size = 0
                           );
 
+    uint32_t table_generation (
+                                int           offset,
+                                std::string & table
+                                );
+
+    void append_generation (
+                             std::string & table,
+                             uint32_t      generation
+                             );
+
+    int hincrby_read (
+                       const std::string & inner_table,
+                       const char *        key,
+                       size_t              key_len,
+                       int64_t &           cur_score,
+                       uint32_t &          cur_ver,
+                       std::string * &     rsp,
+                       int &               rsp_len,
+                       conn_ctxt_t         conn,
+                       item_ctxt_t * &     ctxt
+                       );
+
+    int hincrby_write (
+                        int                 offset,
+                        const std::string & inner_table,
+                        const char *        table,
+                        size_t              table_len,
+                        const char *        key,
+                        size_t              key_len,
+                        int64_t &           score,
+                        const char *        host,
+                        size_t              host_len,
+                        std::string * &     rsp,
+                        int &               rsp_len,
+                        uint32_t &          ver,
+                        uint32_t            ttl,
+                        bool                is_dup,
+                        conn_ctxt_t         conn,
+                        item_ctxt_t * &     ctxt
+                        );
+
+    int hincrby_combine (
+                          hincrby_item_t *    item,
+                          const std::string & inner_table,
+                          const char *        table,
+                          size_t              table_len,
+                          const char *        key,
+                          size_t              key_len,
+                          int64_t             score,
+                          const char *        host,
+                          size_t              host_len,
+                          std::string * &     rsp,
+                          int &               rsp_len,
+                          uint32_t &          ver,
+                          uint32_t            ttl,
+                          conn_ctxt_t         conn
+                          );
+
+    int hincrby_flush_item (
+                             hincrby_item_t * item,
+                             conn_ctxt_t      conn
+                             );
+
+    int hincrby_settle (
+                         const std::string & inner_table,
+                         const char *        key,
+                         size_t              key_len,
+                         conn_ctxt_t         conn
+                         );
+
+    bool hincrby_pending (
+                           const std::string & inner_table,
+                           const char *        key,
+                           size_t              key_len,
+                           std::string * &     rsp,
+                           int &               rsp_len,
+                           uint32_t &          ver,
+                           conn_ctxt_t         conn,
+                           item_ctxt_t * &     ctxt
+                           );
+
+    bool hincrby_replay ( );
+
+    void hotkey (
+                  uint32_t        op,
+                  const char *    table,
+                  size_t          table_len,
+                  const char *    key,
+                  size_t          key_len,
+                  size_t          bytes,
+                  conn_ctxt_t &   conn
+                  )
+    {
+        if ( m_store_conf.db_hotkeys_enable )
+        {
+            m_hotkeys.record ( conn.worker_id, op, table, table_len, key, key_len, bytes );
+        }
+    }
+
     uint32_t clac_real_item (
                               const uint32_t start,
                               const uint32_t end
@@ -792,6 +1107,16 @@ private:
                             const char *     worker = NULL,
                             size_t           worker_len = 0
                             );
+
+    void hustmq_stat_item (
+                            const std::string & queue,
+                            queue_info_t *      queue_info,
+                            std::string &       stats
+                            );
+
+    void hustmq_changed (
+                          const std::string & queue
+                          );
     
 private:
 
@@ -805,7 +1130,7 @@ private:
     bool               m_over_threshold;
     
     i_server_kv_t *    m_storage;
-    bool               m_storage_ok;
+    volatile bool      m_storage_ok;
     
     mdb_t *            m_mdb;
     bool               m_mdb_ok;
@@ -818,10 +1143,17 @@ private:
     slow_task_thread_t m_slow_tasks;
 
     fmap_t             m_invariant;
+    uint32_t           m_inner_hash;
     
     fmap_t             m_queue_index;
     queue_map_t        m_queue_map;
     rwlockable_t       m_mq_locker;
+
+    lockable_t         m_mq_watch_locker;
+    mq_change_list_t   m_mq_changes;
+    uint64_t           m_mq_seq;
+    mq_notify_t        m_mq_notify;
+    void *             m_mq_notify_arg;
     
     wrlocker_vec_t     m_lockers;
 
@@ -829,6 +1161,9 @@ private:
     table_map_t        m_table_map;
     rwlockable_t       m_tb_locker;
 
+    hincrby_buffer_t   m_hincrby;
+    hotkeys_t          m_hotkeys;
+
     server_conf_t      m_server_conf;
     store_conf_t       m_store_conf;
 
@@ -3,6 +3,14 @@
 #include "../../hustdb.h"
 #include "../md5db/bucket.h"
 #include "../../../network/hustdb_utils.h"
+#include "../../utils/parallel.h"
+#include "../leveldb/ldb_env.h"
+
+struct kv_array_t::open_ctx_t
+{
+    kv_array_t *    self;
+    config_t *      config;
+};
 
 void kv_array_t::kill_me ( )
 {
@@ -65,7 +73,7 @@ bool kv_array_t::open ( config_t & config )
 {
     try
     {
-        int count = ( ( hustdb_t * ) G_APPTOOL->get_hustdb () )->get_worker_count () + 2;
+        int count = ( ( hustdb_t * ) G_APPTOOL->get_hustdb () )->get_conn_count ();
 
         m_get_buffers.resize ( count );
         for ( int i = 0; i < count; ++ i )
@@ -96,57 +104,69 @@ bool kv_array_t::open ( config_t & config )
         return false;
     }
 
-    for ( int i = 0; i < m_file_count + 2; ++ i )
+    open_ctx_t ctx = { this, & config };
+
+    if ( ! hustdb::parallel_run ( ( size_t ) ( m_file_count + 2 ), 0, kv_array_t::open_file, & ctx ) )
     {
-        const char * path = config.get_file_path ( i );
-        if ( NULL == path )
-        {
-            LOG_ERROR ( "[kv_array][open][i=%d]config.get_file_path failed", 
-                        i );
-            return false;
-        }
+        return false;
+    }
 
-        if ( '\0' == * path )
-        {
-            continue;
-        }
+    m_ok = true;
 
-        i_kv_t * o = NULL;
-        try
-        {
-            o = create_file ();
-        }
-        catch ( ... )
-        {
-            LOG_ERROR ( "[kv_array][open]bad_alloc" );
-            return false;
-        }
+    m_ttl_seek.reserve ( RESERVE_BYTES_FOR_RSP_BUFER );
+    m_ttl_seek.resize ( 0 );
 
-        if ( NULL == o )
-        {
-            LOG_ERROR ( "[kv_array][open]create_file return NULL" );
-            return false;
-        }
+    return true;
+}
 
-        const kv_config_t & kv_cfg = config.get_kv_config ();
-        if ( ! o->open ( path, kv_cfg, i ) )
-        {
-            LOG_ERROR ( "[kv_array][open][file=%s]open failed", 
-                        path );
-            o->kill_me ();
-            return false;
-        }
+bool kv_array_t::open_file ( void * arg, size_t index )
+{
+    open_ctx_t * ctx  = ( open_ctx_t * ) arg;
+    int          i    = ( int ) index;
 
-        LOG_DEBUG ( "[kv_array][open][i=%u][p=%p][file_id=%u][file=%s]file opened", 
-                    i, o, o->get_id (), o->get_path () );
+    const char * path = ctx->config->get_file_path ( i );
+    if ( NULL == path )
+    {
+        LOG_ERROR ( "[kv_array][open][i=%d]config.get_file_path failed", 
+                    i );
+        return false;
+    }
 
-        m_files[ i ] = o;
+    if ( '\0' == * path )
+    {
+        return true;
     }
 
-    m_ok = true;
+    i_kv_t * o = NULL;
+    try
+    {
+        o = ctx->self->create_file ();
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[kv_array][open]bad_alloc" );
+        return false;
+    }
 
-    m_ttl_seek.reserve ( RESERVE_BYTES_FOR_RSP_BUFER );
-    m_ttl_seek.resize ( 0 );
+    if ( NULL == o )
+    {
+        LOG_ERROR ( "[kv_array][open]create_file return NULL" );
+        return false;
+    }
+
+    const kv_config_t & kv_cfg = ctx->config->get_kv_config ();
+    if ( ! o->open ( path, kv_cfg, i ) )
+    {
+        LOG_ERROR ( "[kv_array][open][file=%s]open failed", 
+                    path );
+        o->kill_me ();
+        return false;
+    }
+
+    LOG_DEBUG ( "[kv_array][open][i=%u][p=%p][file_id=%u][file=%s]file opened", 
+                i, o, o->get_id (), o->get_path () );
+
+    ctx->self->m_files[ i ] = o;
 
     return true;
 }
@@ -298,7 +318,8 @@ int kv_array_t::put_from_md5db (
                                  const char *                val,
                                  size_t                      val_len,
                                  uint32_t                    ttl,
-                                 item_ctxt_t * &             ctxt
+                                 item_ctxt_t * &             ctxt,
+                                 i_kv_stage_t *              stage
                                  )
 {
     const char * key        = NULL;
@@ -339,6 +360,14 @@ int kv_array_t::put_from_md5db (
         key_len = ctxt->key.size ();
     }
 
+    if ( stage && 0 == ttl )
+    {
+        if ( 0 == stage->add ( kv, key, key_len, val, val_len ) )
+        {
+            return 0;
+        }
+    }
+
     int r = kv->put ( key, key_len, val, val_len );
     if ( unlikely ( 0 != r ) )
     {
@@ -501,6 +530,11 @@ int kv_array_t::del_from_binlog (
     return 0;
 }
 
+bool kv_array_t::ready ( std::stringstream & ss )
+{
+    return m_ok;
+}
+
 void kv_array_t::info ( std::stringstream & ss )
 {
     unsigned int count = file_count ();
@@ -519,6 +553,13 @@ void kv_array_t::info ( std::stringstream & ss )
             }
         }
     }
+
+    ldb_env_t * env = ldb_env_t::current ();
+    if ( env && count > 0 )
+    {
+        ss << ",";
+        env->info ( ss );
+    }
 }
 
 typedef struct
@@ -572,11 +613,14 @@ int kv_array_t::export_db (
     char                d_ph[ 256 ]           = { };
     char                json_numeric[ 32 ]    = { };
     i_kv_t *            kv                    = NULL;
+    i_kv_t *            kv_ttl                = m_files[ m_file_count ];
+    hustdb_t *          g_hustdb              = ( hustdb_t * ) G_APPTOOL->get_hustdb ();
     c_str_t             base64_src;
     c_str_t             base64_dst;
     std::string         base64_item;
     std::string         json_item;
     std::string         content;
+    std::string         ttl_val;
     md5db::block_id_t   block_id;
 
     if ( unlikely ( file_id >= m_file_count || ! path || ! * path ) )
@@ -702,6 +746,11 @@ int kv_array_t::export_db (
 
                     type[ 0 ] = hustdb_t::real_table_type ( key [ table_len ] );
                     type_len  = 1;
+
+                    if ( ! g_hustdb->tb_generation_check ( table, table_len, table_len ) )
+                    {
+                        continue;
+                    }
                 }
                 else
                 {
@@ -726,6 +775,15 @@ int kv_array_t::export_db (
             fast_memcpy ( & block_id, key + key_len - sizeof ( md5db::block_id_t ), sizeof ( md5db::block_id_t ) );
             cb_pm->block_id = & block_id;
 
+            // the time the record expires at, by the key of the data file,
+            // see put_from_md5db
+            if ( kv_ttl && 0 == kv_ttl->get ( key, key_len, ttl_val ) &&
+                 ttl_val.size () >= sizeof ( uint32_t )
+                )
+            {
+                fast_memcpy ( & ttl, ttl_val.c_str (), sizeof ( uint32_t ) );
+            }
+
             if ( callback )
             {
                 callback ( callback_param,
@@ -900,6 +958,7 @@ int kv_array_t::export_db_mem (
     const char          flag_kv[]             = "kv";
     const char *        noval_flag            = NULL;
     i_kv_t *            kv                    = NULL;
+    hustdb_t *          g_hustdb              = ( hustdb_t * ) G_APPTOOL->get_hustdb ();
 
     if ( unlikely ( ! m_ok ) )
     {
@@ -1171,6 +1230,11 @@ int kv_array_t::export_db_mem (
 
                         type[ 0 ] = hustdb_t::real_table_type ( key [ table_len ] );
                         type_len  = 1;
+
+                        if ( ! g_hustdb->tb_generation_check ( table, table_len, table_len ) )
+                        {
+                            continue;
+                        }
                     }
                     else
                     {
@@ -1327,6 +1391,139 @@ int kv_array_t::export_db_mem (
     return r;
 }
 
+int kv_array_t::table_keys (
+                             conn_ctxt_t                 conn,
+                             item_ctxt_t * &             ctxt,
+                             export_record_callback_t    callback,
+                             void *                      callback_param,
+                             std::vector< std::string > & keys,
+                             std::vector< std::string > & vals
+                             )
+{
+    uint32_t            size                  = 0;
+    uint32_t            offset                = 0;
+    uint32_t            skipped               = 0;
+    uint32_t            version               = 0;
+    uint32_t            ttl                   = 0;
+    uint32_t            compress_type         = 0;
+    size_t              key_len               = 0;
+    const char *        key                   = NULL;
+    size_t              val_len               = 0;
+    const char *        val                   = NULL;
+    size_t              score_len             = 0;
+    bool                byscore               = false;
+    bool                ignore_this_record    = false;
+    bool                break_the_loop        = false;
+    char                min21[ 32 ]           = { };
+    char                max21[ 32 ]           = { };
+    i_kv_t *            kv                    = NULL;
+    i_iterator_t *      it                    = NULL;
+    std::string         content;
+    std::string         seek;
+    md5db::block_id_t   block_id;
+
+    if ( unlikely ( ! m_ok ) )
+    {
+        LOG_ERROR ( "[kv_array][table_keys]not ready" );
+        return EFAULT;
+    }
+
+    if ( unlikely ( ctxt->inner_file_id < 0 || ctxt->inner_file_id >= m_file_count || ctxt->key.empty () ) )
+    {
+        LOG_ERROR ( "[kv_array][table_keys][local=%d][files=%d]invalid param", 
+                    ctxt->inner_file_id, m_file_count );
+        return EFAULT;
+    }
+
+    kv = m_files[ ctxt->inner_file_id ];
+    if ( unlikely ( NULL == kv ) )
+    {
+        LOG_ERROR ( "[kv_array][table_keys][file_id=%d]file is NULL", 
+                    ctxt->inner_file_id );
+        return EFAULT;
+    }
+
+    struct export_cb_param_t * cb_pm = ( struct export_cb_param_t * ) callback_param;
+    size                             = cb_pm->size;
+    offset                           = cb_pm->offset;
+
+    // the score index of a zset is keyed by table, type, score, so it is
+    // listed in score order and a score range is a single seek
+    seek = ctxt->key;
+    if ( ( uint8_t ) ctxt->key[ ctxt->key.size () - 1 ] == ZSET_TB )
+    {
+        score_len = ZSET_SCORE_LEN;
+        byscore   = cb_pm->byscore;
+    }
+
+    if ( byscore )
+    {
+        sprintf ( min21, "%021li", cb_pm->min );
+        sprintf ( max21, "%021li", cb_pm->max );
+        seek += min21;
+    }
+
+    it = kv->iterator ();
+    if ( NULL == it )
+    {
+        LOG_ERROR ( "[kv_array][table_keys]iterator failed" );
+        return EFAULT;
+    }
+
+    for ( it->seek ( seek.c_str (), seek.size () ); it->valid () && keys.size () < size; it->next () )
+    {
+        version    = 0;
+        key        = it->key ( & key_len );
+        val        = it->value ( & val_len );
+
+        if ( key_len != ctxt->key.size () + score_len + sizeof ( md5db::block_id_t ) ||
+             strncmp ( key, ctxt->key.c_str (), ctxt->key.size () ) != 0 ||
+             byscore && strncmp ( key + ctxt->key.size (), max21, ZSET_SCORE_LEN ) > 0
+             )
+        {
+            break;
+        }
+
+        if ( skipped < offset )
+        {
+            skipped ++;
+            continue;
+        }
+
+        fast_memcpy ( & block_id, key + key_len - sizeof ( md5db::block_id_t ), sizeof ( md5db::block_id_t ) );
+        cb_pm->block_id = & block_id;
+
+        if ( callback )
+        {
+            callback ( callback_param,
+                       key,
+                       key_len,
+                       val,
+                       val_len,
+                       ctxt->key.c_str (),
+                       ctxt->key.size () - 1,
+                       version,
+                       ttl,
+                       compress_type,
+                       content,
+                       & ignore_this_record,
+                       & break_the_loop );
+        }
+
+        if ( unlikely ( ignore_this_record ) )
+        {
+            continue;
+        }
+
+        keys.push_back ( std::string ( key, key_len ) );
+        vals.push_back ( std::string ( val, val_len ) );
+    }
+
+    it->kill_me ();
+
+    return 0;
+}
+
 int kv_array_t::ttl_scan (
                            export_record_callback_t callback,
                            void * callback_param
@@ -1506,6 +1703,12 @@ int kv_array_t::ttl_scan (
                 continue;
             }
 
+            // records of a dropped generation are left to the reclaimer
+            if ( table && ! g_hustdb->tb_generation_check ( table, table_len, table_len ) )
+            {
+                continue;
+            }
+
             version = 0;
             switch ( type[ 0 ] )
             {
@@ -1602,6 +1805,7 @@ int kv_array_t::binlog_scan (
     size_t                  val_len               = 0;
     const char *            val                   = NULL;
     size_t                  table_len             = 0;
+    size_t                  name_len              = 0;
     const char *            table                 = NULL;
     i_iterator_t *          it                    = NULL;
     hustdb_t *              g_hustdb              = NULL;
@@ -1794,6 +1998,14 @@ int kv_array_t::binlog_scan (
                     continue;
                 }
 
+                // a dropped generation is not replayed, the peer drops its own copy
+                name_len = table_len;
+                if ( table && ! g_hustdb->tb_generation_check ( table, table_len, name_len ) )
+                {
+                    ttl_key.append ( key, key_len );
+                    continue;
+                }
+
                 binlog_done_cb_param_t * done_cb_pm = ( binlog_done_cb_param_t * ) malloc ( sizeof ( binlog_done_cb_param_t ) );
                 done_cb_pm->db                      = alive_cb_pm->db;
                 done_cb_pm->key_len                 = key_len;
@@ -1808,7 +2020,7 @@ int kv_array_t::binlog_scan (
                         task_cb_pm.host       = host_s;
                         task_cb_pm.host_len   = host_len;
                         task_cb_pm.table      = table;
-                        task_cb_pm.table_len  = table_len;
+                        task_cb_pm.table_len  = name_len;
                         task_cb_pm.key        = val + real_val_offset;
                         task_cb_pm.key_len    = val_len - real_val_offset;
                         task_cb_pm.value      = NULL;
@@ -1893,7 +2105,7 @@ int kv_array_t::binlog_scan (
                         task_cb_pm.host       = host_s;
                         task_cb_pm.host_len   = host_len;
                         task_cb_pm.table      = table;
-                        task_cb_pm.table_len  = table_len;
+                        task_cb_pm.table_len  = name_len;
                         task_cb_pm.key        = key;
                         task_cb_pm.key_len    = key_len;
                         task_cb_pm.value      = val;
@@ -100,6 +100,10 @@ public:
                 std::stringstream & ss
                 );
 
+    bool ready (
+                 std::stringstream & ss
+                 );
+
     i_kv_t * get_file (
                         unsigned int file_id
                         );
@@ -128,6 +132,7 @@ public:
                           size_t key_len
                           );
 
+    // a record without ttl goes to the stage if it takes it
     int put_from_md5db (
                          const md5db::block_id_t & block_id,
                          uint32_t file_id,
@@ -136,7 +141,8 @@ public:
                          const char * val,
                          size_t val_len,
                          uint32_t ttl,
-                         item_ctxt_t * & ctxt
+                         item_ctxt_t * & ctxt,
+                         i_kv_stage_t * stage = NULL
                          );
 
     int put_from_binlog (
@@ -170,6 +176,15 @@ public:
                                 void * callback_param
                                 );
 
+    virtual int table_keys (
+                             conn_ctxt_t conn,
+                             item_ctxt_t * & ctxt,
+                             export_record_callback_t callback,
+                             void * callback_param,
+                             std::vector< std::string > & keys,
+                             std::vector< std::string > & vals
+                             );
+
     virtual int ttl_scan (
                            export_record_callback_t callback,
                            void * callback_param
@@ -260,6 +275,14 @@ private:
                 config_t & config
                 );
 
+    struct open_ctx_t;
+
+    // parallel_run job, opens m_files[ i ]
+    static bool open_file (
+                            void * ctx,
+                            size_t i
+                            );
+
     i_kv_t * create_file ( );
 
 private:
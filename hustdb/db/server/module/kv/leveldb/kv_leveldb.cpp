@@ -1,9 +1,12 @@
 #include "kv_leveldb.h"
 #include "leveldb/db.h"
 #include "leveldb/cache.h"
+#include "leveldb/comparator.h"
 #include "leveldb/env.h"
 #include "leveldb/filter_policy.h"
+#include "leveldb/table_builder.h"
 #include "bloom_filter.h"
+#include "ldb_env.h"
 #include "../../base.h"
 
 class MyLogger : public leveldb::Logger
@@ -44,6 +47,11 @@ struct kv_leveldb_t::inner
     MyLogger                        log;
     const leveldb::FilterPolicy *   filter_policy;
     md5_bloom_filter_t              my_bloom_filter;
+    leveldb::Options                options;
+    rwlockable_t                    locker;
+    volatile bool                   ingesting;
+    ldb_env_t *                     env;
+    ldb_file_t                      file;
 
     inner ( )
     : db ( NULL )
@@ -51,10 +59,52 @@ struct kv_leveldb_t::inner
     , log ( )
     , filter_policy ( NULL )
     , my_bloom_filter ( )
+    , options ( )
+    , locker ( )
+    , ingesting ( false )
+    , env ( NULL )
+    , file ( )
     {
     }
 } ;
 
+// get, put, del and the iterators hold the db shared, ingest holds it
+// exclusively. while an ingest runs they fail at once instead of stalling
+// a worker until the db is reopened
+class scope_enter_t
+{
+public:
+
+    explicit scope_enter_t ( kv_leveldb_t & db )
+    : m_db ( db )
+    , m_ok ( db.enter () )
+    {
+    }
+
+    ~scope_enter_t ( )
+    {
+        if ( m_ok )
+        {
+            m_db.leave ();
+        }
+    }
+
+    bool ok ( ) const
+    {
+        return m_ok;
+    }
+
+private:
+
+    kv_leveldb_t &  m_db;
+    bool            m_ok;
+
+private:
+    // disable
+    scope_enter_t ( const scope_enter_t & );
+    const scope_enter_t & operator= ( const scope_enter_t & );
+} ;
+
 void kv_leveldb_t::kill_me ( )
 {
     delete this;
@@ -89,6 +139,47 @@ void * kv_leveldb_t::get_internal_db ( )
     return NULL;
 }
 
+const void * kv_leveldb_t::get_internal_options ( )
+{
+    if ( m_inner )
+    {
+        return & m_inner->options;
+    }
+    return NULL;
+}
+
+bool kv_leveldb_t::enter ( )
+{
+    if ( unlikely ( NULL == m_inner || m_inner->ingesting ) )
+    {
+        return false;
+    }
+    if ( ! m_inner->locker.try_rlock () )
+    {
+        return false;
+    }
+    __sync_fetch_and_add ( & m_inner->file.ops, 1 );
+    return true;
+}
+
+void kv_leveldb_t::leave ( )
+{
+    m_inner->locker.runlock ();
+}
+
+std::string kv_leveldb_t::file_path (
+                                      const char * file
+                                      )
+{
+    std::string path = m_path;
+    if ( ! path.empty () && S_PATH_SEP_C != path[ path.size () - 1 ] )
+    {
+        path += S_PATH_SEP;
+    }
+    path += file;
+    return path;
+}
+
 bool kv_leveldb_t::check_key (
                                const void *    key,
                                unsigned int    key_len
@@ -114,6 +205,12 @@ void kv_leveldb_t::destroy ( )
 
         if ( m_inner->db )
         {
+            if ( m_inner->env )
+            {
+                m_inner->env->detach ( & m_inner->file );
+            }
+            m_inner->file.db = NULL;
+
             LOG_INFO ( "[ldb][destroy][path=%s]DB closing", 
                         m_path.c_str () );
             try
@@ -304,6 +401,15 @@ bool kv_leveldb_t::open ( const char * path, const kv_config_t & config, int fil
 
     options.info_log = & m_inner->log;
 
+    // NULL where md5db did not start it, leveldb keeps Env::Default then
+    m_inner->env = ldb_env_t::current ();
+    if ( m_inner->env )
+    {
+        options.env = m_inner->env;
+    }
+
+    m_inner->options = options;
+
     G_APPTOOL->make_dir ( path );
 
     if ( MD5_BLOOM_DISABLED != ( md5_bloom_mode_t ) config.my_bloom_filter_type )
@@ -375,6 +481,13 @@ bool kv_leveldb_t::open ( const char * path, const kv_config_t & config, int fil
                 path );
 #endif
 
+    m_inner->file.db      = m_inner->db;
+    m_inner->file.file_id = file_id;
+    if ( m_inner->env )
+    {
+        m_inner->env->attach ( & m_inner->file );
+    }
+
     LOG_INFO ( "[ldb][open][file=%s]DB opened OK", 
                 path );
 
@@ -501,7 +614,19 @@ void kv_leveldb_t::info (
     write_perf_info ( ss, get_id (), "put_fail",          m_perf_put_fail );
     write_perf_info ( ss, get_id (), "bloom_hit",         m_perf_bloom_hit );
     write_perf_info ( ss, get_id (), "bloom_not_hit",     m_perf_bloom_not_hit );
-    write_perf_info ( ss, get_id (), "bloom_add",         m_perf_bloom_add, true );
+    write_perf_info ( ss, get_id (), "bloom_add",         m_perf_bloom_add );
+
+    size_t level0 = 0;
+    size_t debt   = 0;
+    scope_enter_t enter ( * this );
+    if ( enter.ok () && m_inner->db )
+    {
+        level0 = ( size_t ) ldb_env_t::level0_files ( m_inner->db );
+        debt   = ( size_t ) ldb_env_t::compaction_debt ( m_inner->db );
+        m_inner->file.level0 = ( int ) level0;
+    }
+    write_single_count ( ss, get_id (), "level0_files",      level0 );
+    write_single_count ( ss, get_id (), "compaction_debt",   debt, true );
 }
 
 int kv_leveldb_t::flush ( )
@@ -520,6 +645,11 @@ int kv_leveldb_t::del (
                     m_path.c_str () );
         return EINVAL;
     }
+    scope_enter_t enter ( * this );
+    if ( unlikely ( ! enter.ok () ) )
+    {
+        return EAGAIN;
+    }
     if ( unlikely ( NULL == m_inner->db ) )
     {
         LOG_INFO ( "[ldb][del][file=%s]inner->db is NULL", 
@@ -530,6 +660,7 @@ int kv_leveldb_t::del (
     leveldb::Status         status;
     leveldb::WriteOptions   options;
 
+    __sync_fetch_and_add ( & m_inner->file.puts_begun, 1 );
     try
     {
         leveldb::Slice k ( ( const char * ) key, ( size_t ) key_len );
@@ -537,10 +668,12 @@ int kv_leveldb_t::del (
     }
     catch ( ... )
     {
+        __sync_fetch_and_add ( & m_inner->file.puts_done, 1 );
         LOG_INFO ( "[ldb][del][file=%s]db->Delete exception", 
                     m_path.c_str () );
         return EFAULT;
     }
+    __sync_fetch_and_add ( & m_inner->file.puts_done, 1 );
 
     if ( unlikely ( ! status.ok () ) )
     {
@@ -587,6 +720,11 @@ int kv_leveldb_t::put (
                     m_path.c_str () );
         return EINVAL;
     }
+    scope_enter_t enter ( * this );
+    if ( unlikely ( ! enter.ok () ) )
+    {
+        return EAGAIN;
+    }
     if ( unlikely ( NULL == m_inner->db ) )
     {
         LOG_INFO ( "[ldb][put][file=%s]inner->db is NULL", 
@@ -603,6 +741,7 @@ int kv_leveldb_t::put (
     scope_perf_target_t check_put_ok ( m_perf_put_ok );
     scope_perf_target_t check_put_fail ( m_perf_put_fail );
 
+    __sync_fetch_and_add ( & m_inner->file.puts_begun, 1 );
     try
     {
         leveldb::Slice v ( ( const char * ) data, ( size_t ) data_len );
@@ -610,10 +749,12 @@ int kv_leveldb_t::put (
     }
     catch ( ... )
     {
+        __sync_fetch_and_add ( & m_inner->file.puts_done, 1 );
         LOG_INFO ( "[ldb][put][file=%s]db->Put exception", 
                     m_path.c_str () );
         return EFAULT;
     }
+    __sync_fetch_and_add ( & m_inner->file.puts_done, 1 );
 
     if ( unlikely ( ! status.ok () ) )
     {
@@ -692,6 +833,11 @@ int kv_leveldb_t::get (
                     m_path.c_str () );
         return EINVAL;
     }
+    scope_enter_t enter ( * this );
+    if ( unlikely ( ! enter.ok () ) )
+    {
+        return EAGAIN;
+    }
     if ( unlikely ( NULL == m_inner->db ) )
     {
         LOG_INFO ( "[ldb][get][file=%s]inner->db is NULL", 
@@ -773,14 +919,188 @@ i_iterator_t * kv_leveldb_t::iterator ( )
     return it;
 }
 
+i_kv_builder_t * kv_leveldb_t::builder (
+                                         const char * file
+                                         )
+{
+    if ( NULL == file || '\0' == * file )
+    {
+        LOG_ERROR ( "[ldb][builder]empty file" );
+        return NULL;
+    }
+
+    kv_builder_t * b = NULL;
+    try
+    {
+        b = new kv_builder_t ();
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[ldb][builder]bad_alloc" );
+        return NULL;
+    }
+
+    bool bloom = ( MD5_BLOOM_DISABLED != ( md5_bloom_mode_t ) m_config.my_bloom_filter_type );
+    if ( ! b->create ( * this, file_path ( file ).c_str (), bloom ) )
+    {
+        LOG_ERROR ( "[ldb][builder][file=%s]create failed", 
+                    file );
+        delete b;
+        return NULL;
+    }
+
+    return b;
+}
+
+// the number of a file of the db: NNNNNN.ldb, NNNNNN.log, MANIFEST-NNNNNN ...
+static uint64_t ldb_file_number (
+                                  const std::string & name
+                                  )
+{
+    const char * p = name.c_str ();
+    if ( 0 == strncmp ( p, "MANIFEST-", 9 ) )
+    {
+        p += 9;
+    }
+    if ( * p < '0' || * p > '9' )
+    {
+        return 0;
+    }
+    return ( uint64_t ) strtoull ( p, NULL, 10 );
+}
+
+// leveldb 1.18 can not take table files into an open db. the db is closed,
+// the files are renamed to table numbers above every file of the db and
+// RepairDB rebuilds the manifest with all of them at level 0, then the db
+// is opened again. the keys of the ingested files are at sequence 0, they
+// must not be in the db already
+int kv_leveldb_t::ingest (
+                           const std::vector< std::string > & files
+                           )
+{
+    if ( files.empty () )
+    {
+        return 0;
+    }
+    if ( unlikely ( NULL == m_inner || NULL == m_inner->db ) )
+    {
+        LOG_ERROR ( "[ldb][ingest][file=%s]inner->db is NULL", 
+                    m_path.c_str () );
+        return EFAULT;
+    }
+
+    leveldb::Env *              env = leveldb::Env::Default ();
+    leveldb::Status             status;
+    std::vector< std::string >  children;
+    uint64_t                    number = 0;
+    int                         r = 0;
+
+    m_inner->ingesting = true;
+    m_inner->locker.wlock ();
+
+    if ( m_inner->env )
+    {
+        m_inner->env->detach ( & m_inner->file );
+    }
+    m_inner->file.db = NULL;
+
+    LOG_INFO ( "[ldb][ingest][file=%s][tables=%d]DB closing", 
+               m_path.c_str (), ( int ) files.size () );
+    try
+    {
+        delete m_inner->db;
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[ldb][ingest][file=%s]DB closing exception", 
+                    m_path.c_str () );
+    }
+    m_inner->db = NULL;
+
+    try
+    {
+        env->GetChildren ( m_path, & children );
+        for ( size_t i = 0; i < children.size (); ++ i )
+        {
+            uint64_t n = ldb_file_number ( children[ i ] );
+            if ( n > number )
+            {
+                number = n;
+            }
+        }
+
+        for ( size_t i = 0; i < files.size (); ++ i )
+        {
+            char table[ 32 ];
+            snprintf ( table, sizeof ( table ), "%06llu.ldb", ( unsigned long long ) ( number + 1 + i ) );
+
+            status = env->RenameFile ( file_path ( files[ i ].c_str () ), file_path ( table ) );
+            if ( ! status.ok () )
+            {
+                LOG_ERROR ( "[ldb][ingest][file=%s][table=%s][status=%s]rename failed", 
+                            m_path.c_str (), files[ i ].c_str (), status.ToString ().c_str () );
+                r = EFAULT;
+                break;
+            }
+        }
+
+        if ( 0 == r )
+        {
+            status = leveldb::RepairDB ( m_path, m_inner->options );
+            if ( ! status.ok () )
+            {
+                LOG_ERROR ( "[ldb][ingest][file=%s][status=%s]RepairDB failed", 
+                            m_path.c_str (), status.ToString ().c_str () );
+                r = EFAULT;
+            }
+        }
+
+        status = leveldb::DB::Open ( m_inner->options, m_path, & m_inner->db );
+        if ( ! status.ok () )
+        {
+            LOG_ERROR ( "[ldb][ingest][file=%s][status=%s]DB open failed", 
+                        m_path.c_str (), status.ToString ().c_str () );
+            m_inner->db = NULL;
+            r = EFAULT;
+        }
+        else
+        {
+            m_inner->file.db = m_inner->db;
+            if ( m_inner->env )
+            {
+                m_inner->env->attach ( & m_inner->file );
+            }
+        }
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[ldb][ingest][file=%s]exception", 
+                    m_path.c_str () );
+        r = EFAULT;
+    }
+
+    m_inner->locker.wunlock ();
+    m_inner->ingesting = false;
+
+    if ( 0 == r )
+    {
+        LOG_INFO ( "[ldb][ingest][file=%s][tables=%d]DB opened OK", 
+                   m_path.c_str (), ( int ) files.size () );
+    }
+
+    return r;
+}
+
 struct kv_iterator_t::inner_t
 {
     int                 m_status;
     leveldb::Iterator * m_iterator;
+    kv_leveldb_t *      m_db;
 
     inner_t ( )
     : m_iterator ( NULL )
     , m_status ( ENOENT )
+    , m_db ( NULL )
     {
     }
 
@@ -791,6 +1111,11 @@ struct kv_iterator_t::inner_t
             delete m_iterator;
             m_iterator = NULL;
         }
+        if ( m_db )
+        {
+            m_db->leave ();
+            m_db = NULL;
+        }
     }
 } ;
 
@@ -834,6 +1159,16 @@ bool kv_iterator_t::create ( kv_leveldb_t & db )
     }
 
     m_inner->m_status = EFAULT;
+    if ( NULL == m_inner->m_db )
+    {
+        if ( ! db.enter () )
+        {
+            LOG_ERROR ( "[ldb][iterator]db is ingesting" );
+            return false;
+        }
+        m_inner->m_db = & db;
+    }
+
     leveldb::DB * p = ( leveldb::DB * )db.get_internal_db ();
     if ( NULL == p )
     {
@@ -978,3 +1313,468 @@ void kv_iterator_t::trans_errno ( const char * func_name )
         }
     }
 }
+
+// the comparator of the keys in the table files of the db: the user key,
+// then the sequence and type trailer in descending order. the keys are not
+// shortened in the index blocks
+class internal_comparator_t : public leveldb::Comparator
+{
+public:
+
+    explicit internal_comparator_t ( const leveldb::Comparator * user )
+    : m_user ( user )
+    {
+    }
+
+    virtual const char * Name ( ) const
+    {
+        return "leveldb.InternalKeyComparator";
+    }
+
+    virtual int Compare (
+                          const leveldb::Slice & a,
+                          const leveldb::Slice & b
+                          ) const
+    {
+        int r = m_user->Compare ( leveldb::Slice ( a.data (), a.size () - 8 ),
+                                  leveldb::Slice ( b.data (), b.size () - 8 ) );
+        if ( 0 == r )
+        {
+            uint64_t x = trailer ( a );
+            uint64_t y = trailer ( b );
+            r = ( x > y ) ? - 1 : ( ( x < y ) ? 1 : 0 );
+        }
+        return r;
+    }
+
+    virtual void FindShortestSeparator (
+                                         std::string * start,
+                                         const leveldb::Slice & limit
+                                         ) const
+    {
+    }
+
+    virtual void FindShortSuccessor (
+                                      std::string * key
+                                      ) const
+    {
+    }
+
+private:
+
+    static uint64_t trailer ( const leveldb::Slice & key )
+    {
+        const unsigned char * p = ( const unsigned char * ) key.data () + key.size () - 8;
+        uint64_t r = 0;
+        for ( int i = 7; i >= 0; -- i )
+        {
+            r = ( r << 8 ) | p[ i ];
+        }
+        return r;
+    }
+
+    const leveldb::Comparator * m_user;
+} ;
+
+// the bloom filter of the db takes the user keys
+class internal_filter_policy_t : public leveldb::FilterPolicy
+{
+public:
+
+    explicit internal_filter_policy_t ( const leveldb::FilterPolicy * user )
+    : m_user ( user )
+    {
+    }
+
+    virtual const char * Name ( ) const
+    {
+        return m_user->Name ();
+    }
+
+    virtual void CreateFilter (
+                                const leveldb::Slice * keys,
+                                int n,
+                                std::string * dst
+                                ) const
+    {
+        std::vector< leveldb::Slice > user_keys ( n );
+        for ( int i = 0; i < n; ++ i )
+        {
+            user_keys[ i ] = leveldb::Slice ( keys[ i ].data (), keys[ i ].size () - 8 );
+        }
+        m_user->CreateFilter ( n > 0 ? & user_keys[ 0 ] : keys, n, dst );
+    }
+
+    virtual bool KeyMayMatch (
+                               const leveldb::Slice & key,
+                               const leveldb::Slice & filter
+                               ) const
+    {
+        return m_user->KeyMayMatch ( leveldb::Slice ( key.data (), key.size () - 8 ), filter );
+    }
+
+private:
+
+    const leveldb::FilterPolicy * m_user;
+} ;
+
+// the trailer of an internal key, leveldb/db/dbformat.h: the fixed64 of
+// ( sequence << 8 ) | type, little endian. kTypeValue is 0x1
+#define LDB_TYPE_VALUE      0x1
+
+static void ldb_append_trailer (
+                                 std::string & key,
+                                 uint64_t sequence
+                                 )
+{
+    uint64_t packed = ( sequence << 8 ) | LDB_TYPE_VALUE;
+    char     buf[ 8 ];
+
+    for ( int i = 0; i < 8; ++ i )
+    {
+        buf[ i ] = ( char ) ( packed >> ( 8 * i ) );
+    }
+    key.append ( buf, sizeof ( buf ) );
+}
+
+// RepairDB keeps what it replaces in lost, DestroyDB leaves the directory
+static void ldb_destroy_scratch (
+                                  const std::string & dir,
+                                  const leveldb::Options & options
+                                  )
+{
+    leveldb::Env *              env     = leveldb::Env::Default ();
+    std::string                 lost    = dir + S_PATH_SEP "lost";
+    std::vector< std::string >  children;
+
+    env->GetChildren ( lost, & children );
+    for ( size_t i = 0; i < children.size (); ++ i )
+    {
+        if ( "." != children[ i ] && ".." != children[ i ] )
+        {
+            env->DeleteFile ( lost + S_PATH_SEP + children[ i ] );
+        }
+    }
+    env->DeleteDir ( lost );
+
+    leveldb::DestroyDB ( dir, options );
+}
+
+// the tables written here are only readable if the trailer above is the one
+// of the leveldb linked in: a table of two keys is written the same way,
+// repaired into a scratch db and read back
+static bool ldb_check_format (
+                               const std::string & dir
+                               )
+{
+    leveldb::Env *          env     = leveldb::Env::Default ();
+    leveldb::Options        options;
+    leveldb::DB *           db      = NULL;
+    leveldb::WritableFile * file    = NULL;
+    internal_comparator_t   comparator ( options.comparator );
+    leveldb::Status         status;
+    bool                    ok      = false;
+
+    options.create_if_missing = true;
+    ldb_destroy_scratch ( dir, options );
+
+    do
+    {
+        status = leveldb::DB::Open ( options, dir, & db );
+        if ( ! status.ok () )
+        {
+            break;
+        }
+        delete db;
+        db = NULL;
+
+        status = env->NewWritableFile ( dir + S_PATH_SEP "999999.ldb", & file );
+        if ( ! status.ok () )
+        {
+            break;
+        }
+
+        leveldb::Options table_options = options;
+        table_options.comparator = & comparator;
+
+        leveldb::TableBuilder table ( table_options, file );
+        std::string key;
+        for ( char c = 'a'; c <= 'b'; ++ c )
+        {
+            key.assign ( 1, c );
+            ldb_append_trailer ( key, 0 );
+            table.Add ( key, leveldb::Slice ( & c, 1 ) );
+        }
+        status = table.Finish ();
+        if ( status.ok () )
+        {
+            status = file->Close ();
+        }
+        delete file;
+        file = NULL;
+        if ( ! status.ok () )
+        {
+            break;
+        }
+
+        status = leveldb::RepairDB ( dir, options );
+        if ( ! status.ok () )
+        {
+            break;
+        }
+
+        status = leveldb::DB::Open ( options, dir, & db );
+        if ( ! status.ok () )
+        {
+            break;
+        }
+
+        ok = true;
+        for ( char c = 'a'; ok && c <= 'b'; ++ c )
+        {
+            std::string val;
+            status = db->Get ( leveldb::ReadOptions (), leveldb::Slice ( & c, 1 ), & val );
+            ok = status.ok () && 1 == val.size () && c == val[ 0 ];
+        }
+    }
+    while ( 0 );
+
+    if ( db )
+    {
+        delete db;
+    }
+    if ( file )
+    {
+        delete file;
+    }
+    ldb_destroy_scratch ( dir, options );
+
+    if ( ! ok )
+    {
+        LOG_ERROR ( "[ldb][builder][dir=%s][status=%s]internal key format check failed", 
+                    dir.c_str (), status.ToString ().c_str () );
+    }
+
+    return ok;
+}
+
+struct kv_builder_t::inner_t
+{
+    kv_leveldb_t *              m_db;
+    std::string                 m_path;
+    leveldb::WritableFile *     m_file;
+    leveldb::TableBuilder *     m_table;
+    internal_comparator_t       m_comparator;
+    internal_filter_policy_t    m_filter_policy;
+    std::string                 m_key;
+    bool                        m_bloom;
+
+    inner_t (
+              kv_leveldb_t & db,
+              const leveldb::Options & options,
+              const char * path
+              )
+    : m_db ( & db )
+    , m_path ( path )
+    , m_file ( NULL )
+    , m_table ( NULL )
+    , m_comparator ( options.comparator )
+    , m_filter_policy ( options.filter_policy )
+    , m_key ( )
+    , m_bloom ( false )
+    {
+    }
+
+    ~ inner_t ( )
+    {
+        if ( m_table )
+        {
+            m_table->Abandon ();
+            delete m_table;
+            m_table = NULL;
+        }
+        if ( m_file )
+        {
+            m_file->Close ();
+            delete m_file;
+            m_file = NULL;
+        }
+    }
+} ;
+
+void kv_builder_t::kill_me ( )
+{
+    delete this;
+}
+
+kv_builder_t::kv_builder_t ( )
+: m_inner ( NULL )
+{
+}
+
+kv_builder_t::~ kv_builder_t ( )
+{
+    destroy ();
+}
+
+void kv_builder_t::destroy ( )
+{
+    if ( m_inner )
+    {
+        delete m_inner;
+        m_inner = NULL;
+    }
+}
+
+bool kv_builder_t::create (
+                            kv_leveldb_t & db,
+                            const char * path,
+                            bool bloom
+                            )
+{
+    const leveldb::Options * db_options = ( const leveldb::Options * ) db.get_internal_options ();
+    if ( NULL == db_options || NULL != m_inner )
+    {
+        LOG_ERROR ( "[ldb][builder]db not opened" );
+        return false;
+    }
+
+    // once, the builders are only used by the slow task thread. 0 is not
+    // checked yet, 1 ok, - 1 failed
+    static int checked = 0;
+    if ( 0 == checked )
+    {
+        std::string dir ( path );
+        size_t pos = dir.rfind ( S_PATH_SEP_C );
+        dir.resize ( std::string::npos == pos ? 0 : pos + 1 );
+        dir += "load-check";
+
+        checked = ldb_check_format ( dir ) ? 1 : - 1;
+    }
+    if ( checked < 0 )
+    {
+        return false;
+    }
+
+    try
+    {
+        m_inner = new inner_t ( db, * db_options, path );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[ldb][builder]bad_alloc" );
+        return false;
+    }
+
+    // the tables have the block layout and compression of the db
+    leveldb::Options options = * db_options;
+    options.comparator = & m_inner->m_comparator;
+    if ( NULL != db_options->filter_policy )
+    {
+        options.filter_policy = & m_inner->m_filter_policy;
+    }
+
+    leveldb::Status status = leveldb::Env::Default ()->NewWritableFile ( m_inner->m_path, & m_inner->m_file );
+    if ( ! status.ok () )
+    {
+        LOG_ERROR ( "[ldb][builder][file=%s]NewWritableFile failed", 
+                    path );
+        return false;
+    }
+
+    try
+    {
+        m_inner->m_table = new leveldb::TableBuilder ( options, m_inner->m_file );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[ldb][builder]bad_alloc" );
+        return false;
+    }
+
+    m_inner->m_key.reserve ( 1024 + 8 );
+    m_inner->m_bloom = bloom;
+    return true;
+}
+
+int kv_builder_t::add (
+                        const void *        key,
+                        unsigned int        key_len,
+                        const void *        data,
+                        unsigned int        data_len
+                        )
+{
+    if ( unlikely ( NULL == m_inner->m_table ) )
+    {
+        return EFAULT;
+    }
+
+    try
+    {
+        m_inner->m_key.assign ( ( const char * ) key, ( size_t ) key_len );
+        // sequence 0, below every write of the db
+        ldb_append_trailer ( m_inner->m_key, 0 );
+        m_inner->m_table->Add ( m_inner->m_key, leveldb::Slice ( ( const char * ) data, ( size_t ) data_len ) );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[ldb][builder][file=%s]Add exception", 
+                    m_inner->m_path.c_str () );
+        return EFAULT;
+    }
+
+    if ( unlikely ( ! m_inner->m_table->status ().ok () ) )
+    {
+        LOG_ERROR ( "[ldb][builder][file=%s][status=%s]Add failed", 
+                    m_inner->m_path.c_str (), m_inner->m_table->status ().ToString ().c_str () );
+        return EFAULT;
+    }
+
+    if ( m_inner->m_bloom )
+    {
+        m_inner->m_db->bloomfilter_add ( key, key_len );
+    }
+
+    return 0;
+}
+
+uint64_t kv_builder_t::file_size ( ) const
+{
+    if ( NULL == m_inner->m_table )
+    {
+        return 0;
+    }
+    return m_inner->m_table->FileSize ();
+}
+
+int kv_builder_t::finish ( )
+{
+    if ( unlikely ( NULL == m_inner->m_table ) )
+    {
+        return EFAULT;
+    }
+
+    leveldb::Status status = m_inner->m_table->Finish ();
+    delete m_inner->m_table;
+    m_inner->m_table = NULL;
+
+    if ( status.ok () )
+    {
+        status = m_inner->m_file->Sync ();
+    }
+    if ( status.ok () )
+    {
+        status = m_inner->m_file->Close ();
+    }
+    delete m_inner->m_file;
+    m_inner->m_file = NULL;
+
+    if ( ! status.ok () )
+    {
+        LOG_ERROR ( "[ldb][builder][file=%s][status=%s]finish failed", 
+                    m_inner->m_path.c_str (), status.ToString ().c_str () );
+        return EFAULT;
+    }
+
+    return 0;
+}
@@ -83,6 +83,63 @@ private:
     inner_t * m_inner;
 };
 
+class kv_builder_t : public i_kv_builder_t
+{
+public:
+
+    virtual void kill_me ( );
+
+    virtual int add (
+                      const void * key,
+                      unsigned int key_len,
+                      const void * data,
+                      unsigned int data_len
+                      );
+
+    virtual uint64_t file_size ( ) const;
+
+    virtual int finish ( );
+
+public:
+
+    kv_builder_t ( );
+    virtual ~kv_builder_t ( );
+
+    void destroy ( );
+
+    // the keys are added to the md5 bloom filter of the db if bloom
+    bool create (
+                  kv_leveldb_t & db,
+                  const char * path,
+                  bool bloom
+                  );
+
+    static void * operator new(
+                                size_t size
+                                )
+    {
+        void * p = malloc ( size );
+        if ( NULL == p )
+        {
+            throw std::bad_alloc ( );
+        }
+        return p;
+    }
+
+    static void operator delete(
+                                 void * p
+                                 )
+    {
+        free ( p );
+    }
+
+private:
+
+    struct inner_t;
+
+    inner_t * m_inner;
+};
+
 class kv_leveldb_t : public i_kv_t
 {
 public:
@@ -128,8 +185,24 @@ public:
 
     virtual i_iterator_t * iterator ( );
 
+    virtual i_kv_builder_t * builder (
+                                       const char * file
+                                       );
+
+    virtual int ingest (
+                         const std::vector< std::string > & files
+                         );
+
     void * get_internal_db ( );
 
+    // the options the db is opened with
+    const void * get_internal_options ( );
+
+    // shared use of the db, false while an ingest runs
+    bool enter ( );
+
+    void leave ( );
+
 public:
 
     kv_leveldb_t ( );
@@ -173,6 +246,10 @@ private:
                      unsigned int key_len
                      );
 
+    std::string file_path (
+                            const char * file
+                            );
+
     void calc_my_bloom_filter_path (
                                      const char * parent_dir,
                                      char * bloom_filter_path
@@ -0,0 +1,642 @@
+#include "ldb_env.h"
+#include "leveldb/db.h"
+#include "../../base.h"
+#include "../../perf_target.h"
+#include <sys/time.h>
+
+#define LDB_LEVELS                  7
+#define LDB_L0_COMPACTION           4
+#define LDB_SAMPLE_MS               10
+#define LDB_LOAD_MS                 100
+
+static ldb_env_t *      g_ldb_env       = NULL;
+static pthread_mutex_t  g_ldb_env_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// the file of the work running on this thread, NULL on any other thread
+static __thread ldb_file_t *    t_file      = NULL;
+static __thread bool            t_worker    = false;
+
+// a table file written by a flush or a compaction
+class ldb_throttled_file_t : public leveldb::WritableFile
+{
+public:
+
+    ldb_throttled_file_t (
+                           ldb_env_t & env,
+                           leveldb::WritableFile * file
+                           )
+    : m_env ( env )
+    , m_file ( file )
+    {
+    }
+
+    virtual ~ ldb_throttled_file_t ( )
+    {
+        delete m_file;
+    }
+
+    virtual leveldb::Status Append (
+                                     const leveldb::Slice & data
+                                     )
+    {
+        m_env.throttle ( data.size () );
+        return m_file->Append ( data );
+    }
+
+    virtual leveldb::Status Close ( )
+    {
+        return m_file->Close ();
+    }
+
+    virtual leveldb::Status Flush ( )
+    {
+        return m_file->Flush ();
+    }
+
+    virtual leveldb::Status Sync ( )
+    {
+        return m_file->Sync ();
+    }
+
+private:
+
+    ldb_env_t &                 m_env;
+    leveldb::WritableFile *     m_file;
+
+private:
+    // disable
+    ldb_throttled_file_t ( const ldb_throttled_file_t & );
+    const ldb_throttled_file_t & operator= ( const ldb_throttled_file_t & );
+};
+
+ldb_env_t * ldb_env_t::instance (
+                                  int threads,
+                                  int rate_limit_m,
+                                  int defer_ops,
+                                  int defer_ms
+                                  )
+{
+    pthread_mutex_lock ( & g_ldb_env_mutex );
+
+    if ( NULL == g_ldb_env )
+    {
+        ldb_env_t * env = NULL;
+        try
+        {
+            env = new ldb_env_t ( threads, rate_limit_m, defer_ops, defer_ms );
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[ldb][env]bad_alloc" );
+        }
+
+        // never freed, as Env::Default
+        if ( env && env->start () )
+        {
+            g_ldb_env = env;
+        }
+    }
+
+    ldb_env_t * env = g_ldb_env;
+    pthread_mutex_unlock ( & g_ldb_env_mutex );
+
+    return env;
+}
+
+ldb_env_t * ldb_env_t::current ( )
+{
+    pthread_mutex_lock ( & g_ldb_env_mutex );
+    ldb_env_t * env = g_ldb_env;
+    pthread_mutex_unlock ( & g_ldb_env_mutex );
+
+    return env;
+}
+
+ldb_env_t::ldb_env_t (
+                       int threads,
+                       int rate_limit_m,
+                       int defer_ops,
+                       int defer_ms
+                       )
+: leveldb::EnvWrapper ( leveldb::Env::Default () )
+, m_threads ( threads )
+, m_rate ( ( double ) rate_limit_m * 1048576 )
+, m_defer_ops ( ( size_t ) defer_ops )
+, m_defer_ms ( ( uint32_t ) defer_ms )
+, m_jobs ( )
+, m_paused ( 0 )
+, m_held ( 0 )
+, m_running ( 0 )
+, m_files ( )
+, m_load ( 0 )
+, m_tokens ( 0 )
+, m_refilled ( 0 )
+, m_count_jobs ( 0 )
+, m_count_deferred ( 0 )
+, m_count_urgent ( 0 )
+, m_throttled_ms ( 0 )
+{
+    pthread_mutex_init ( & m_mutex, NULL );
+    pthread_cond_init ( & m_cond, NULL );
+    pthread_cond_init ( & m_idle_cond, NULL );
+    pthread_mutex_init ( & m_files_mutex, NULL );
+    pthread_mutex_init ( & m_bucket_mutex, NULL );
+
+    if ( m_threads <= 0 )
+    {
+        m_threads = 1;
+    }
+}
+
+bool ldb_env_t::start ( )
+{
+    pthread_t tid;
+
+    for ( int i = 0; i < m_threads; ++ i )
+    {
+        if ( 0 != pthread_create ( & tid, NULL, ldb_env_t::work_thread, this ) )
+        {
+            LOG_ERROR ( "[ldb][env]pthread_create failed" );
+            return false;
+        }
+        pthread_detach ( tid );
+    }
+
+    if ( 0 != pthread_create ( & tid, NULL, ldb_env_t::sample_thread, this ) )
+    {
+        LOG_ERROR ( "[ldb][env]pthread_create failed" );
+        return false;
+    }
+    pthread_detach ( tid );
+
+    LOG_INFO ( "[ldb][env][threads=%d][rate_limit=%.0f][defer_ops=%d][defer_ms=%u]env started",
+               m_threads, m_rate, ( int ) m_defer_ops, m_defer_ms );
+
+    return true;
+}
+
+void ldb_env_t::attach (
+                         ldb_file_t * file
+                         )
+{
+    pthread_mutex_lock ( & m_files_mutex );
+    try
+    {
+        m_files.push_back ( file );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[ldb][env]bad_alloc" );
+    }
+    pthread_mutex_unlock ( & m_files_mutex );
+}
+
+void ldb_env_t::detach (
+                         ldb_file_t * file
+                         )
+{
+    pthread_mutex_lock ( & m_files_mutex );
+    for ( files_t::iterator i = m_files.begin (); i != m_files.end (); ++ i )
+    {
+        if ( * i == file )
+        {
+            m_files.erase ( i );
+            break;
+        }
+    }
+    pthread_mutex_unlock ( & m_files_mutex );
+}
+
+ldb_file_t * ldb_env_t::find (
+                               void * db
+                               )
+{
+    ldb_file_t * file = NULL;
+
+    pthread_mutex_lock ( & m_files_mutex );
+    for ( size_t i = 0; i < m_files.size (); ++ i )
+    {
+        if ( m_files[ i ]->db == db )
+        {
+            file = m_files[ i ];
+            break;
+        }
+    }
+    pthread_mutex_unlock ( & m_files_mutex );
+
+    return file;
+}
+
+// the arg of the background work of leveldb is the db itself
+void ldb_env_t::Schedule (
+                           void ( * function ) ( void * ),
+                           void * arg
+                           )
+{
+    job_t job;
+    job.function = function;
+    job.arg      = arg;
+    job.file     = find ( arg );
+    job.queued   = G_APPTOOL->get_tick_count ();
+    job.held     = false;
+
+    pthread_mutex_lock ( & m_mutex );
+    m_jobs.push_back ( job );
+    pthread_cond_signal ( & m_cond );
+    pthread_mutex_unlock ( & m_mutex );
+}
+
+leveldb::Status ldb_env_t::NewWritableFile (
+                                             const std::string & fname,
+                                             leveldb::WritableFile ** result
+                                             )
+{
+    leveldb::Status s = target ()->NewWritableFile ( fname, result );
+    if ( ! s.ok () || ! t_worker || m_rate <= 0 )
+    {
+        return s;
+    }
+
+    size_t len = fname.size ();
+    if ( ( len > 4 && 0 == fname.compare ( len - 4, 4, ".ldb" ) ) ||
+         ( len > 4 && 0 == fname.compare ( len - 4, 4, ".sst" ) )
+        )
+    {
+        try
+        {
+            * result = new ldb_throttled_file_t ( * this, * result );
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[ldb][env]bad_alloc" );
+        }
+    }
+
+    return s;
+}
+
+bool ldb_env_t::urgent (
+                         ldb_file_t * file
+                         )
+{
+    return NULL == file || file->stalled || file->level0 >= LDB_L0_SLOWDOWN;
+}
+
+bool ldb_env_t::deferred (
+                           const job_t & job,
+                           uint32_t now
+                           )
+{
+    return m_defer_ops > 0 &&
+           m_load > m_defer_ops &&
+           ! urgent ( job.file ) &&
+           now - job.queued < m_defer_ms;
+}
+
+// with m_mutex held
+bool ldb_env_t::stopped (
+                          const job_t & job
+                          )
+{
+    return m_held > 0 || ( m_paused > 0 && ! urgent ( job.file ) );
+}
+
+void ldb_env_t::throttle (
+                           size_t bytes
+                           )
+{
+    if ( NULL != t_file && urgent ( t_file ) )
+    {
+        return;
+    }
+
+    uint32_t wait_ms = 0;
+
+    pthread_mutex_lock ( & m_bucket_mutex );
+
+    uint32_t now = G_APPTOOL->get_tick_count ();
+    m_tokens    += ( double ) ( now - m_refilled ) * m_rate / 1000;
+    m_refilled   = now;
+
+    // a burst of 100ms at most
+    if ( m_tokens > m_rate / 10 )
+    {
+        m_tokens = m_rate / 10;
+    }
+
+    m_tokens -= ( double ) bytes;
+    if ( m_tokens < 0 )
+    {
+        wait_ms         = ( uint32_t ) ( - m_tokens * 1000 / m_rate );
+        m_throttled_ms += wait_ms;
+    }
+
+    pthread_mutex_unlock ( & m_bucket_mutex );
+
+    if ( wait_ms > 0 )
+    {
+        G_APPTOOL->sleep_ms ( wait_ms );
+    }
+}
+
+void ldb_env_t::wait (
+                       uint32_t ms
+                       )
+{
+    struct timeval  now;
+    struct timespec ts;
+
+    gettimeofday ( & now, NULL );
+    uint64_t ns = ( uint64_t ) now.tv_usec * 1000 + ( uint64_t ) ms * 1000000;
+    ts.tv_sec   = now.tv_sec + ns / 1000000000;
+    ts.tv_nsec  = ns % 1000000000;
+
+    pthread_cond_timedwait ( & m_cond, & m_mutex, & ts );
+}
+
+void * ldb_env_t::work_thread (
+                                void * arg
+                                )
+{
+    t_worker = true;
+    ( ( ldb_env_t * ) arg )->work ();
+    return NULL;
+}
+
+void ldb_env_t::work ( )
+{
+    pthread_mutex_lock ( & m_mutex );
+
+    while ( true )
+    {
+        if ( m_jobs.empty () || m_held > 0 )
+        {
+            pthread_cond_wait ( & m_cond, & m_mutex );
+            continue;
+        }
+
+        // the urgent first, then the db with most level 0 files
+        uint32_t            now  = G_APPTOOL->get_tick_count ();
+        jobs_t::iterator    best = m_jobs.end ();
+        for ( jobs_t::iterator i = m_jobs.begin (); i != m_jobs.end (); ++ i )
+        {
+            if ( stopped ( * i ) )
+            {
+                continue;
+            }
+            if ( deferred ( * i, now ) )
+            {
+                if ( ! i->held )
+                {
+                    i->held = true;
+                    ++ m_count_deferred;
+                }
+                continue;
+            }
+            if ( m_jobs.end () == best ||
+                 ( urgent ( i->file ) && ! urgent ( best->file ) ) ||
+                 ( urgent ( i->file ) == urgent ( best->file ) &&
+                   i->file && best->file && i->file->level0 > best->file->level0 )
+                )
+            {
+                best = i;
+            }
+        }
+
+        if ( m_jobs.end () == best )
+        {
+            wait ( LDB_SAMPLE_MS );
+            continue;
+        }
+
+        job_t job = * best;
+        m_jobs.erase ( best );
+        ++ m_running;
+        pthread_mutex_unlock ( & m_mutex );
+
+        // the db lives until its work returns
+        if ( job.file )
+        {
+            job.file->level0 = level0_files ( job.arg );
+        }
+
+        if ( deferred ( job, G_APPTOOL->get_tick_count () ) )
+        {
+            pthread_mutex_lock ( & m_mutex );
+            m_jobs.push_front ( job );
+            idle ();
+            continue;
+        }
+
+        bool is_urgent = urgent ( job.file );
+
+        t_file = job.file;
+        job.function ( job.arg );
+        t_file = NULL;
+
+        pthread_mutex_lock ( & m_mutex );
+        ++ m_count_jobs;
+        if ( is_urgent )
+        {
+            ++ m_count_urgent;
+        }
+        idle ();
+    }
+}
+
+// with m_mutex held, a job taken by work is over
+void ldb_env_t::idle ( )
+{
+    -- m_running;
+    if ( 0 == m_running )
+    {
+        pthread_cond_broadcast ( & m_idle_cond );
+    }
+}
+
+void ldb_env_t::pause ( )
+{
+    pthread_mutex_lock ( & m_mutex );
+    ++ m_paused;
+    while ( m_running > 0 )
+    {
+        pthread_cond_wait ( & m_idle_cond, & m_mutex );
+    }
+    pthread_mutex_unlock ( & m_mutex );
+}
+
+void ldb_env_t::resume ( )
+{
+    pthread_mutex_lock ( & m_mutex );
+    -- m_paused;
+    pthread_cond_broadcast ( & m_cond );
+    pthread_mutex_unlock ( & m_mutex );
+}
+
+void ldb_env_t::hold ( )
+{
+    pthread_mutex_lock ( & m_mutex );
+    ++ m_held;
+    while ( m_running > 0 )
+    {
+        pthread_cond_wait ( & m_idle_cond, & m_mutex );
+    }
+    pthread_mutex_unlock ( & m_mutex );
+}
+
+void ldb_env_t::release ( )
+{
+    pthread_mutex_lock ( & m_mutex );
+    -- m_held;
+    pthread_cond_broadcast ( & m_cond );
+    pthread_mutex_unlock ( & m_mutex );
+}
+
+void * ldb_env_t::sample_thread (
+                                  void * arg
+                                  )
+{
+    ( ( ldb_env_t * ) arg )->sample ();
+    return NULL;
+}
+
+// a write that does not return while no other write of its db does is
+// stalled behind the work of the db
+void ldb_env_t::sample ( )
+{
+    uint32_t last     = G_APPTOOL->get_tick_count ();
+    size_t   last_ops = 0;
+
+    while ( true )
+    {
+        G_APPTOOL->sleep_ms ( LDB_SAMPLE_MS );
+
+        size_t ops     = 0;
+        bool   stalled = false;
+
+        pthread_mutex_lock ( & m_files_mutex );
+        for ( size_t i = 0; i < m_files.size (); ++ i )
+        {
+            ldb_file_t * file = m_files[ i ];
+            size_t       done = file->puts_done;
+
+            file->stalled   = ( file->puts_begun != done && file->last_puts == done );
+            file->last_puts = done;
+
+            stalled = stalled || file->stalled;
+            ops    += file->ops;
+        }
+        pthread_mutex_unlock ( & m_files_mutex );
+
+        uint32_t now = G_APPTOOL->get_tick_count ();
+        if ( now - last >= LDB_LOAD_MS )
+        {
+            // files attached or detached meanwhile make one sample off
+            m_load   = ops >= last_ops ? ( ops - last_ops ) * 1000 / ( now - last ) : 0;
+            last_ops = ops;
+            last     = now;
+        }
+
+        if ( stalled )
+        {
+            pthread_mutex_lock ( & m_mutex );
+            pthread_cond_broadcast ( & m_cond );
+            pthread_mutex_unlock ( & m_mutex );
+        }
+    }
+}
+
+int ldb_env_t::level0_files (
+                              void * db
+                              )
+{
+    std::string value;
+    if ( NULL == db ||
+         ! ( ( leveldb::DB * ) db )->GetProperty ( "leveldb.num-files-at-level0", & value ) )
+    {
+        return 0;
+    }
+
+    return atoi ( value.c_str () );
+}
+
+uint64_t ldb_env_t::compaction_debt (
+                                      void * db
+                                      )
+{
+    std::string value;
+    if ( NULL == db ||
+         ! ( ( leveldb::DB * ) db )->GetProperty ( "leveldb.sstables", & value ) )
+    {
+        return 0;
+    }
+
+    // --- level 1 ---
+    //  17:123['a' .. 'd']
+    uint64_t    bytes[ LDB_LEVELS ] = { };
+    int         files0              = 0;
+    int         level               = 0;
+    const char * p                  = value.c_str ();
+
+    while ( * p )
+    {
+        if ( 0 == strncmp ( p, "--- level ", 10 ) )
+        {
+            level = atoi ( p + 10 );
+        }
+        else if ( ' ' == * p && level >= 0 && level < LDB_LEVELS )
+        {
+            const char * size = strchr ( p, ':' );
+            if ( size )
+            {
+                bytes[ level ] += strtoull ( size + 1, NULL, 10 );
+                if ( 0 == level )
+                {
+                    ++ files0;
+                }
+            }
+        }
+
+        p = strchr ( p, '\n' );
+        if ( NULL == p )
+        {
+            break;
+        }
+        ++ p;
+    }
+
+    uint64_t debt = files0 >= LDB_L0_COMPACTION ? bytes[ 0 ] : 0;
+
+    // 10MB for level 1, ten times more for every next level
+    double target = 10 * 1048576.0;
+    for ( int i = 1; i < LDB_LEVELS - 1; ++ i )
+    {
+        if ( ( double ) bytes[ i ] > target )
+        {
+            debt += bytes[ i ] - ( uint64_t ) target;
+        }
+        target *= 10;
+    }
+
+    return debt;
+}
+
+void ldb_env_t::info (
+                       std::stringstream & ss
+                       )
+{
+    int    file_id = 0;
+    size_t load    = m_load;
+    size_t queued  = 0;
+
+    pthread_mutex_lock ( & m_mutex );
+    queued = m_jobs.size ();
+    pthread_mutex_unlock ( & m_mutex );
+
+    write_single_count ( ss, file_id, "compaction_jobs",         m_count_jobs );
+    write_single_count ( ss, file_id, "compaction_urgent",       m_count_urgent );
+    write_single_count ( ss, file_id, "compaction_deferred",     m_count_deferred );
+    write_single_count ( ss, file_id, "compaction_queued",       queued );
+    write_single_count ( ss, file_id, "compaction_throttled_ms", m_throttled_ms );
+    write_single_count ( ss, file_id, "compaction_load",         load, true );
+}
@@ -0,0 +1,216 @@
+#ifndef _ldb_env_h_
+#define _ldb_env_h_
+
+#include "db_stdinc.h"
+#include "leveldb/env.h"
+#include <list>
+#include <vector>
+#include <sstream>
+#include <pthread.h>
+
+// leveldb slows every write down at this many level 0 files
+#define LDB_L0_SLOWDOWN             8
+
+// a leveldb file as the env sees it, kept by kv_leveldb_t
+struct ldb_file_t
+{
+    void *              db;
+    int                 file_id;
+
+    // get, put, del and iterators
+    volatile size_t     ops;
+    volatile size_t     puts_begun;
+    volatile size_t     puts_done;
+
+    // set by the env
+    volatile int        level0;
+    volatile bool       stalled;
+    size_t              last_puts;
+
+    ldb_file_t ( )
+    : db ( NULL )
+    , file_id ( - 1 )
+    , ops ( 0 )
+    , puts_begun ( 0 )
+    , puts_done ( 0 )
+    , level0 ( 0 )
+    , stalled ( false )
+    , last_puts ( 0 )
+    {
+    }
+};
+
+// the env of the leveldb files, started by kv_md5db_t::open before any of
+// them is opened and shared by the data, ttl, binlog and conflict files.
+//
+// leveldb runs the flushes and compactions of every db of a process on the
+// one thread of Env::Default, in the order they are scheduled. here they
+// run on compaction.threads threads, the db with most level 0 files first.
+// the table files they write share a token bucket of compaction.rate_limit,
+// and while the files serve more than compaction.defer_ops requests a
+// second the work waits up to compaction.defer_ms. a db with a write
+// stalled behind its work, or with LDB_L0_SLOWDOWN level 0 files, is
+// neither throttled nor deferred
+class ldb_env_t : public leveldb::EnvWrapper
+{
+public:
+
+    // started once, the calls after the first return it as it is
+    static ldb_env_t * instance (
+                                  int threads,
+                                  int rate_limit_m,
+                                  int defer_ops,
+                                  int defer_ms
+                                  );
+
+    // NULL until instance
+    static ldb_env_t * current ( );
+
+    void attach (
+                  ldb_file_t * file
+                  );
+
+    void detach (
+                  ldb_file_t * file
+                  );
+
+    virtual void Schedule (
+                            void ( * function ) ( void * ),
+                            void * arg
+                            );
+
+    virtual leveldb::Status NewWritableFile (
+                                              const std::string & fname,
+                                              leveldb::WritableFile ** result
+                                              );
+
+    // takes bytes from the token bucket of the running work, waits while
+    // it is empty
+    void throttle (
+                    size_t bytes
+                    );
+
+    // only the urgent work starts until resume, returns once the running
+    // work is done
+    void pause ( );
+
+    void resume ( );
+
+    // no work starts until release, returns once the running work is done.
+    // the files stay as they are meanwhile, see task_backup_t. the writers
+    // are stopped first, a write waiting on a flush would wait for ever
+    void hold ( );
+
+    void release ( );
+
+    void info (
+                std::stringstream & ss
+                );
+
+    static int level0_files (
+                              void * db
+                              );
+
+    // the bytes the compactions of a db still have to move: level 0 once
+    // it is due, every other level above its target
+    static uint64_t compaction_debt (
+                                      void * db
+                                      );
+
+private:
+
+    typedef struct job_s
+    {
+        void ( * function ) ( void * );
+        void *          arg;
+        ldb_file_t *    file;
+        uint32_t        queued;
+        bool            held;
+    } job_t;
+
+    typedef std::list< job_t >          jobs_t;
+    typedef std::vector< ldb_file_t * > files_t;
+
+    ldb_env_t (
+                int threads,
+                int rate_limit_m,
+                int defer_ops,
+                int defer_ms
+                );
+
+    bool start ( );
+
+    static void * work_thread (
+                                void * arg
+                                );
+
+    static void * sample_thread (
+                                  void * arg
+                                  );
+
+    void work ( );
+
+    void sample ( );
+
+    ldb_file_t * find (
+                        void * db
+                        );
+
+    static bool urgent (
+                         ldb_file_t * file
+                         );
+
+    bool deferred (
+                    const job_t & job,
+                    uint32_t now
+                    );
+
+    bool stopped (
+                   const job_t & job
+                   );
+
+    void wait (
+                uint32_t ms
+                );
+
+    void idle ( );
+
+private:
+
+    int                 m_threads;
+    double              m_rate;
+    size_t              m_defer_ops;
+    uint32_t            m_defer_ms;
+
+    // the jobs, taken by the threads of Schedule with the mutex of their
+    // db held. m_files_mutex is taken under it, nothing under that
+    pthread_mutex_t     m_mutex;
+    pthread_cond_t      m_cond;
+    jobs_t              m_jobs;
+    int                 m_paused;
+    int                 m_held;
+    int                 m_running;
+    pthread_cond_t      m_idle_cond;
+
+    pthread_mutex_t     m_files_mutex;
+    files_t             m_files;
+
+    // requests a second of all the files
+    volatile size_t     m_load;
+
+    pthread_mutex_t     m_bucket_mutex;
+    double              m_tokens;
+    uint32_t            m_refilled;
+
+    size_t              m_count_jobs;
+    size_t              m_count_deferred;
+    size_t              m_count_urgent;
+    size_t              m_throttled_ms;
+
+private:
+    // disable
+    ldb_env_t ( const ldb_env_t & );
+    const ldb_env_t & operator= ( const ldb_env_t & );
+};
+
+#endif
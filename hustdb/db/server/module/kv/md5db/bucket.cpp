@@ -1,4 +1,5 @@
 #include "bucket.h"
+#include "../../utils/numa.h"
 
 namespace md5db
 {
@@ -6,6 +7,7 @@ namespace md5db
     bucket_t::bucket_t ( )
     : m_fullkey ( NULL )
     , m_lock ( )
+    , m_dirty ( NULL )
     {
         G_APPTOOL->fmap_init ( & m_data );
     }
@@ -32,6 +34,8 @@ namespace md5db
 
     void bucket_t::close ( )
     {
+        hustdb::dirty_close ( m_dirty );
+        m_dirty = NULL;
         G_APPTOOL->fmap_close ( & m_data );
     }
 
@@ -127,6 +131,13 @@ namespace md5db
             return false;
         }
 
+        hustdb::advise_map_hugepage ( m_data.ptr, m_data.ptr_len );
+
+        if ( read_write )
+        {
+            m_dirty = hustdb::dirty_open ( path );
+        }
+
         return true;
     }
 
@@ -171,6 +182,18 @@ namespace md5db
         return r;
     }
 
+    bucket_data_item_t * bucket_t::item_at (
+                                             size_t index
+                                             )
+    {
+        if ( NULL == m_data.ptr || index >= bucket_item_count () )
+        {
+            return NULL;
+        }
+
+        return ( bucket_data_item_t * ) ( m_data.ptr + index * sizeof ( bucket_data_item_t ) );
+    }
+
     int bucket_t::find (
                         const void *            inner_key,
                         size_t                  inner_key_len,
@@ -4,6 +4,7 @@
 #include "db_stdinc.h"
 #include "db_lib.h"
 #include "../../base.h"
+#include "../../utils/dirty.h"
 
 namespace md5db
 {
@@ -246,6 +247,15 @@ namespace md5db
                    bucket_data_item_t * & result
                    );
 
+        bucket_data_item_t * item_at (
+                                       size_t index
+                                       );
+
+        size_t item_count ( ) const
+        {
+            return bucket_item_count ();
+        }
+
         static void key_to_bytes3 (
                                     const char * inner_key,
                                     size_t inner_key_len,
@@ -269,6 +279,21 @@ namespace md5db
             return m_lock;
         }
 
+        const fmap_t & get_map ( ) const
+        {
+            return m_data;
+        }
+
+        // for the backup, under the bucket write lock once item is written
+        void touch (
+                     const bucket_data_item_t * item
+                     )
+        {
+            hustdb::dirty_mark ( m_dirty,
+                                 ( uint64_t ) ( ( const unsigned char * ) item - m_data.ptr ),
+                                 sizeof ( bucket_data_item_t ) );
+        }
+
     private:
 
         size_t bucket_bytes ( ) const;
@@ -284,9 +309,10 @@ namespace md5db
 
     private:
 
-        fmap_t       m_data;
-        fullkey_t *  m_fullkey;
-        rwlockable_t m_lock;
+        fmap_t                  m_data;
+        fullkey_t *             m_fullkey;
+        rwlockable_t            m_lock;
+        hustdb::dirty_file_t *  m_dirty;
 
     private:
         // disable
@@ -294,6 +320,38 @@ namespace md5db
         const bucket_t & operator= ( const bucket_t & );
     };
 
+    // touches the item when it goes out of scope: declared after the
+    // bucket write lock, it runs once the item is written and before the
+    // lock is dropped
+    class bucket_touch_t
+    {
+    public:
+
+        bucket_touch_t (
+                         bucket_t & bucket,
+                         const bucket_data_item_t * item
+                         )
+        : m_bucket ( bucket )
+        , m_item ( item )
+        {
+        }
+
+        ~bucket_touch_t ( )
+        {
+            m_bucket.touch ( m_item );
+        }
+
+    private:
+
+        bucket_t &                  m_bucket;
+        const bucket_data_item_t *  m_item;
+
+    private:
+        // disable
+        bucket_touch_t ( const bucket_touch_t & );
+        const bucket_touch_t & operator= ( const bucket_touch_t & );
+    };
+
 } // namespace md5db
 
 #endif
@@ -1,10 +1,18 @@
 #include "bucket_array.h"
 #include "fullkey_array.h"
 #include "../../base.h"
+#include "../../utils/parallel.h"
 
 namespace md5db
 {
 
+    struct bucket_array_t::open_ctx_t
+    {
+        bucket_array_t *    self;
+        const char *        path;
+        bool                read_write;
+    };
+
     bucket_array_t::bucket_array_t ( )
     {
     }
@@ -30,43 +38,70 @@ namespace md5db
         }
     }
 
-    bool bucket_array_t::create_buckets ( const char * path )
+    void bucket_array_t::make_path ( const char * path, size_t i, char * ph )
     {
-        if ( NULL == path || '\0' == * path )
+        strcpy ( ph, path );
+        G_APPTOOL->path_to_os ( ph );
+        if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
         {
-            LOG_ERROR ( "[md5db][bucket_array][create_buckets]path is empty" );
-            return false;
+            strcat ( ph, S_PATH_SEP );
         }
 
-        G_APPTOOL->make_dir ( path );
+        char t[ 32 ];
+        sprintf ( t, "%02X", ( int ) i );
+        strcat ( ph, t );
+        strcat ( ph, ".bucket" );
+    }
+
+    bool bucket_array_t::create_file ( void * arg, size_t i )
+    {
+        open_ctx_t * ctx = ( open_ctx_t * ) arg;
 
         char ph[ 260 ];
+        make_path ( ctx->path, i, ph );
 
-        for ( int i = 0; i < COUNT_OF ( m_buckets ); ++ i )
+        if ( ! ctx->self->m_buckets[ i ].create ( ph ) )
         {
-            strcpy ( ph, path );
-            G_APPTOOL->path_to_os ( ph );
-            if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
-            {
-                strcat ( ph, S_PATH_SEP );
-            }
+            LOG_ERROR ( "[md5db][bucket_array][create_buckets][file=%s][i=%d]create failed", 
+                        ph, ( int ) i );
+            return false;
+        }
 
-            char t[ 32 ];
-            sprintf ( t, "%02X", ( int ) i );
-            strcat ( ph, t );
-            strcat ( ph, ".bucket" );
+        return true;
+    }
 
-            if ( ! m_buckets[ i ].create ( ph ) )
-            {
-                LOG_ERROR ( "[md5db][bucket_array][create_buckets][file=%s][i=%d]create failed", 
-                            ph, i );
-                return false;
-            }
+    bool bucket_array_t::open_file ( void * arg, size_t i )
+    {
+        open_ctx_t * ctx = ( open_ctx_t * ) arg;
+
+        char ph[ 260 ];
+        make_path ( ctx->path, i, ph );
+
+        if ( ! ctx->self->m_buckets[ i ].open_exist ( ph, ctx->read_write ) )
+        {
+            LOG_ERROR ( "[md5db][bucket_array][open_exist_buckets][file=%s][i=%d]open_exist failed", 
+                        ph, ( int ) i );
+            return false;
         }
 
         return true;
     }
 
+    bool bucket_array_t::create_buckets ( const char * path )
+    {
+        if ( NULL == path || '\0' == * path )
+        {
+            LOG_ERROR ( "[md5db][bucket_array][create_buckets]path is empty" );
+            return false;
+        }
+
+        G_APPTOOL->make_dir ( path );
+
+        open_ctx_t ctx = { this, path, true };
+
+        return hustdb::parallel_run ( COUNT_OF ( m_buckets ), 0, bucket_array_t::create_file, & ctx );
+    }
+
     bool bucket_array_t::open_exist_buckets ( const char * path, bool read_write )
     {
         if ( NULL == path || '\0' == * path )
@@ -79,31 +114,16 @@ namespace md5db
 
         for ( int i = 0; i < COUNT_OF ( m_buckets ); ++ i )
         {
-            strcpy ( ph, path );
-            G_APPTOOL->path_to_os ( ph );
-            if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
-            {
-                strcat ( ph, S_PATH_SEP );
-            }
-
-            char t[ 32 ];
-            sprintf ( t, "%02X", ( int ) i );
-            strcat ( ph, t );
-            strcat ( ph, ".bucket" );
-
+            make_path ( path, i, ph );
             if ( ! G_APPTOOL->is_file ( ph ) )
             {
                 return false;
             }
-            if ( ! m_buckets[ i ].open_exist ( ph, read_write ) )
-            {
-                LOG_ERROR ( "[md5db][bucket_array][open_exist_buckets][file=%s][i=%d]open_exist failed", 
-                            ph, i );
-                return false;
-            }
         }
 
-        return true;
+        open_ctx_t ctx = { this, path, read_write };
+
+        return hustdb::parallel_run ( COUNT_OF ( m_buckets ), 0, bucket_array_t::open_file, & ctx );
     }
 
     bool bucket_array_t::open ( const char * path )
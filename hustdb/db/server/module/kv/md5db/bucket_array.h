@@ -24,6 +24,18 @@ namespace md5db
                                 const void * inner_key, 
                                 size_t inner_key_len 
                                 );
+
+        size_t size ( ) const
+        {
+            return COUNT_OF ( m_buckets );
+        }
+
+        bucket_t & item (
+                          size_t index
+                          )
+        {
+            return m_buckets[ index ];
+        }
         
         void set_fullkeys ( 
                             fullkey_array_t * p 
@@ -31,6 +43,25 @@ namespace md5db
 
     private:
 
+        struct open_ctx_t;
+
+        static void make_path (
+                                const char * path,
+                                size_t i,
+                                char * ph
+                                );
+
+        // parallel_run jobs on m_buckets[ i ]
+        static bool create_file (
+                                  void * ctx,
+                                  size_t i
+                                  );
+
+        static bool open_file (
+                                void * ctx,
+                                size_t i
+                                );
+
         bool create_buckets ( 
                                 const char * path 
                                 );
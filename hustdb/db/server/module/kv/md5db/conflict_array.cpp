@@ -1,10 +1,18 @@
 #include "conflict_array.h"
 #include "../leveldb/bloom_filter.h"
+#include "../../utils/parallel.h"
 #include <memory>
 
 namespace md5db
 {
 
+    struct conflict_array_t::open_ctx_t
+    {
+        conflict_array_t *  self;
+        const char *        path;
+        kv_config_t         config;
+    };
+
     conflict_array_t::conflict_array_t ( )
     : m_conflicts ( )
     {
@@ -147,63 +155,70 @@ namespace md5db
 
         G_APPTOOL->make_dir ( path );
 
-        char ph[ 260 ];
-
-        if ( m_conflicts.capacity () < ( size_t ) count )
+        try
         {
-            try
-            {
-                m_conflicts.reserve ( count );
-            }
-            catch ( ... )
-            {
-                LOG_ERROR ( "[md5db][conflict_array][open]bad_alloc" );
-                return false;
-            }
+            m_conflicts.resize ( count, NULL );
         }
-        for ( int i = 0; i < count; ++ i )
+        catch ( ... )
         {
-            strcpy ( ph, path );
-            G_APPTOOL->path_to_os ( ph );
-            if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
-            {
-                strcat ( ph, S_PATH_SEP );
-            }
+            LOG_ERROR ( "[md5db][conflict_array][open]bad_alloc" );
+            return false;
+        }
 
-            char t[ 32 ];
-            sprintf ( t, "%02d", ( int ) i );
-            strcat ( ph, t );
-            strcat ( ph, ".conflict" );
+        open_ctx_t ctx;
+        ctx.self = this;
+        ctx.path = path;
+        memset ( & ctx.config, 0, sizeof ( kv_config_t ) );
+        ctx.config.cache_size_m            = cache_m;
+        ctx.config.write_buffer_m          = write_buffer_m;
+        ctx.config.ldb_bloom_filter_bits   = bloom_filter_bits;
+        ctx.config.my_bloom_filter_type    = ( md5_bloom_mode_t ) md5_bloom_filter_type;
+        ctx.config.is_readonly             = false;
+        ctx.config.disable_compression     = disable_compression;
 
-            std::auto_ptr< conflict_t > o;
-            try
-            {
-                o.reset ( new conflict_t () );
-            }
-            catch ( ... )
-            {
-                LOG_ERROR ( "[md5db][conflict_array][open]bad_alloc" );
-                return false;
-            }
+        return hustdb::parallel_run ( ( size_t ) count, 0, conflict_array_t::open_file, & ctx );
+    }
 
-            kv_config_t config;
-            memset ( & config, 0, sizeof ( kv_config_t ) );
-            config.cache_size_m            = cache_m;
-            config.write_buffer_m          = write_buffer_m;
-            config.ldb_bloom_filter_bits   = bloom_filter_bits;
-            config.my_bloom_filter_type    = ( md5_bloom_mode_t ) md5_bloom_filter_type;
-            config.is_readonly             = false;
-            config.disable_compression     = disable_compression;
-            if ( ! o->open ( ph, config, i ) )
-            {
-                LOG_ERROR ( "[md5db][conflict_array][open][file=%s]open failed", 
-                            ph );
-                return false;
-            }
+    bool conflict_array_t::open_file (
+                                       void *  arg,
+                                       size_t  i
+                                       )
+    {
+        open_ctx_t * ctx = ( open_ctx_t * ) arg;
 
-            m_conflicts.push_back ( o.release () );
+        char ph[ 260 ];
+        strcpy ( ph, ctx->path );
+        G_APPTOOL->path_to_os ( ph );
+        if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
+        {
+            strcat ( ph, S_PATH_SEP );
         }
 
+        char t[ 32 ];
+        sprintf ( t, "%02d", ( int ) i );
+        strcat ( ph, t );
+        strcat ( ph, ".conflict" );
+
+        std::auto_ptr< conflict_t > o;
+        try
+        {
+            o.reset ( new conflict_t () );
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[md5db][conflict_array][open]bad_alloc" );
+            return false;
+        }
+
+        if ( ! o->open ( ph, ctx->config, ( int ) i ) )
+        {
+            LOG_ERROR ( "[md5db][conflict_array][open][file=%s]open failed", 
+                        ph );
+            return false;
+        }
+
+        ctx->self->m_conflicts[ i ] = o.release ();
+
         return true;
     }
 
@@ -76,6 +76,16 @@ namespace md5db
                                     size_t inner_key_len
                                     );
 
+    private:
+
+        struct open_ctx_t;
+
+        // parallel_run job, opens m_conflicts[ i ]
+        static bool open_file (
+                                void * ctx,
+                                size_t i
+                                );
+
     private:
 
         typedef std::vector< conflict_t * > container_t;
@@ -45,18 +45,35 @@ namespace md5db
         return r;
     }
 
+    static inline
+    uint32_t size_to_pages ( uint32_t data_len )
+    {
+        uint32_t size = data_len / PAGE;
+        if ( data_len % PAGE > 0 )
+        {
+            size ++;
+        }
+
+        return size;
+    }
+
     content2_t::content2_t ( )
     : m_file_id ( - 1 )
+    , m_data_file ( NULL )
     , m_data_fd ( - 1 )
     , m_data_file_size ( 0 )
-    , m_free_block_max ( 0 )
-    , m_free_block_file_size ( 0 )
-    , m_data_file ( NULL )
-    , m_free_block_file ( NULL )
+    , m_free_bitmap_file ( NULL )
+    , m_free_pages ( 0 )
+    , m_free_extents ( 0 )
+    , m_compact_limit ( 0xFFFFFFFF )
+    , m_move_buf ( )
     , m_lock ( )
+    , m_data_dirty ( NULL )
+    , m_free_bitmap_dirty ( NULL )
     {
-        G_APPTOOL->fmap_init ( & m_free_block_cache );
-        memset ( m_free_block_path, 0, sizeof ( m_free_block_path ) );
+        G_APPTOOL->fmap_init ( & m_free_bitmap );
+        memset ( m_free_bitmap_path, 0, sizeof ( m_free_bitmap_path ) );
+        memset ( m_free_mask, 0, sizeof ( m_free_mask ) );
         memset ( m_tail, 0, PAGE );
     }
 
@@ -67,12 +84,17 @@ namespace md5db
 
     void content2_t::close ( )
     {
-        G_APPTOOL->fmap_close ( & m_free_block_cache );
+        hustdb::dirty_close ( m_free_bitmap_dirty );
+        m_free_bitmap_dirty = NULL;
+        hustdb::dirty_close ( m_data_dirty );
+        m_data_dirty = NULL;
 
-        if ( m_free_block_file )
+        G_APPTOOL->fmap_close ( & m_free_bitmap );
+
+        if ( m_free_bitmap_file )
         {
-            fclose ( m_free_block_file );
-            m_free_block_file = NULL;
+            fclose ( m_free_bitmap_file );
+            m_free_bitmap_file = NULL;
         }
 
         if ( m_data_file )
@@ -167,334 +189,399 @@ namespace md5db
 
         m_data_fd = fileno ( m_data_file );
 
+        memset ( ph, 0, sizeof ( ph ) );
+        strcpy ( ph, path );
+        strcat ( ph, ".free.bitmap" );
+        if ( ! open_free_bitmap ( ph ) )
+        {
+            LOG_ERROR ( "[md5db][content_db][open][file=%s]open free bitmap failed", 
+                        ph );
+            return false;
+        }
+
         memset ( ph, 0, sizeof ( ph ) );
         strcpy ( ph, path );
         strcat ( ph, ".free.block" );
-        if ( ! G_APPTOOL->is_file ( ph ) )
+        if ( G_APPTOOL->is_file ( ph ) )
         {
-            FILE * fp = fopen ( ph, "wb" );
-            if ( ! fp )
+            if ( ! convert_free_block ( ph ) )
             {
-                LOG_ERROR ( "[md5db][content_db][open][file=%s]fopen failed", 
+                LOG_ERROR ( "[md5db][content_db][open][file=%s]convert free block failed", 
                             ph );
                 return false;
             }
+        }
 
-            bool ok = true;
-            char buf[ PAGE ];
-            memset ( buf, 0, sizeof ( buf ) );
-            for ( int i = 0; i < FREE_BLOCK_PAGE; i ++ )
-            {
-                if ( sizeof ( buf ) != fwrite ( buf, 1, sizeof ( buf ), fp ) )
-                {
-                    ok = false;
-                    break;
-                }
-            }
+        m_file_id = file_id;
 
-            fflush ( fp );
+        build_free_lists ( ( uint32_t ) ( m_data_file_size / PAGE ) );
 
-            fclose ( fp );
-            if ( ! ok )
+        m_free_bitmap_dirty = hustdb::dirty_open ( m_free_bitmap_path );
+        strcpy ( ph, path );
+        strcat ( ph, ".content" );
+        m_data_dirty        = hustdb::dirty_open ( ph );
+
+        LOG_INFO ( "[md5db][content_db][open][path=%s][file_id=%d][free_pages=%llu][free_extents=%llu]create success", 
+                    path, file_id, m_free_pages, m_free_extents );
+
+        return true;
+    }
+
+    bool content2_t::open_free_bitmap ( const char * path )
+    {
+        if ( ! G_APPTOOL->is_file ( path ) )
+        {
+            FILE * fp = fopen ( path, "wb" );
+            if ( ! fp )
             {
-                remove ( ph );
+                LOG_ERROR ( "[md5db][content_db][open_free_bitmap][file=%s]fopen failed", 
+                            path );
                 return false;
             }
+            fclose ( fp );
         }
 
-        m_free_block_file = fopen ( ph, "rb+" );
-        if ( ! m_free_block_file )
+        m_free_bitmap_file = fopen ( path, "rb+" );
+        if ( ! m_free_bitmap_file )
         {
-            LOG_ERROR ( "[md5db][content_db][open]fopen failed", 
-                        ph );
+            LOG_ERROR ( "[md5db][content_db][open_free_bitmap][file=%s]fopen failed", 
+                        path );
             return false;
         }
 
-        r = fseek ( m_free_block_file, 0, SEEK_END );
-        if ( 0 != r )
+        strcpy ( m_free_bitmap_path, path );
+
+        // an empty file is grown and mapped here
+        return incr_free_bitmap ( m_data_file_size / PAGE );
+    }
+
+    bool content2_t::incr_free_bitmap ( uint64_t pages )
+    {
+        uint64_t need = ( pages + 7 ) / 8;
+        need = ( need / FREE_BITMAP_INCR + 1 ) * FREE_BITMAP_INCR;
+
+        if ( m_free_bitmap.ptr && m_free_bitmap.ptr_len >= need )
         {
-            LOG_ERROR ( "[md5db][content_db][open]seek end failed" );
-            return false;
+            return true;
         }
 
-        m_free_block_file_size = ftell ( m_free_block_file );
-        if ( m_free_block_file_size < 0 )
+        if ( unlikely ( ! m_free_bitmap_file ) )
         {
-            LOG_ERROR ( "[md5db][content_db][open]ftell failed" );
+            LOG_ERROR( "[md5db][content_db][incr_free_bitmap]initial conditions error" );
             return false;
         }
 
-        uint32_t incr = m_free_block_file_size % FREE_BLOCK_INCR;
-        if ( incr > 0 )
+        int r = fseek ( m_free_bitmap_file, 0, SEEK_END );
+        if ( unlikely ( 0 != r ) )
         {
-            incr = FREE_BLOCK_INCR - incr;
-
-            char buf[ PAGE ];
-            memset ( buf, 0, sizeof ( buf ) );
+            LOG_ERROR ( "[md5db][content_db][incr_free_bitmap]seek end failed" );
+            return false;
+        }
 
-            int incr_i = incr / PAGE;
-            int incr_j = incr % PAGE;
-            for ( int i = 0; i < incr_i; i ++ )
-            {
-                if ( sizeof ( buf ) != fwrite ( buf, 1, sizeof ( buf ), m_free_block_file ) )
-                {
-                    LOG_ERROR ( "[md5db][content_db][open]fwrite failed" );
-                    return false;
-                }
-            }
+        uint64_t size  = ftell ( m_free_bitmap_file );
+        uint64_t start = size;
 
-            if ( incr_j > 0 && incr != fwrite ( buf, 1, incr_j, m_free_block_file ) )
+        char buf[ PAGE ];
+        memset ( buf, 0, sizeof ( buf ) );
+        while ( size < need )
+        {
+            size_t n = need - size < sizeof ( buf ) ? ( size_t ) ( need - size ) : sizeof ( buf );
+            if ( n != fwrite ( buf, 1, n, m_free_bitmap_file ) )
             {
-                LOG_ERROR ( "[md5db][content_db][open]fwrite failed" );
+                LOG_ERROR ( "[md5db][content_db][incr_free_bitmap][size=%llu]incr fwrite failed", 
+                            size );
                 return false;
             }
+            size += n;
+        }
 
-            fflush ( m_free_block_file );
+        fflush ( m_free_bitmap_file );
+        hustdb::dirty_mark ( m_free_bitmap_dirty, start, size - start );
 
-            m_free_block_file_size += incr;
-        }
+        G_APPTOOL->fmap_close ( & m_free_bitmap );
 
-        if ( ! G_APPTOOL->fmap_open ( & m_free_block_cache, ph, 0, 0, true ) )
+        if ( ! G_APPTOOL->fmap_open ( & m_free_bitmap, m_free_bitmap_path, 0, 0, true ) )
         {
-            LOG_ERROR ( "[md5db][content_db][open]fmap_open failed" );
+            LOG_ERROR ( "[md5db][content_db][incr_free_bitmap]fmap_open failed" );
             return false;
         }
 
-        if ( m_free_block_cache.ptr_len != m_free_block_file_size )
+        if ( m_free_bitmap.ptr_len != size )
         {
-            LOG_ERROR ( "[md5db][content_db][open][size=%d]mmap file size error", 
-                        m_free_block_cache.ptr_len );
+            LOG_ERROR ( "[md5db][content_db][incr_free_bitmap][size=%d]mmap file size error", 
+                        m_free_bitmap.ptr_len );
             return false;
         }
 
-        m_file_id = file_id;
-        strcpy ( m_free_block_path, ph );
-
-        parse_free_block ();
-
-        LOG_INFO ( "[md5db][content_db][open][path=%s][file_id=%d]create success", 
-                    path, file_id );
-
         return true;
     }
 
-    void content2_t::parse_free_block ( )
+    bool content2_t::convert_free_block ( const char * path )
     {
-        uint32_t              i;
-        uint32_t              step;
-        uint32_t              prev_i;
-        struct free_block_t * header;
-        struct free_block_t * block;
-        struct free_block_t * prev;
-        struct free_block_t * curr;
-
-        step   = sizeof ( struct free_block_t );
-        i      = m_free_block_file_size - step;
-        header = ( struct free_block_t * ) m_free_block_cache.ptr;
+        fmap_t   legacy;
+        uint32_t step   = sizeof ( struct free_block_t );
+        uint64_t pages  = m_data_file_size / PAGE;
+        uint64_t count  = 0;
 
-        if ( header->offset == 0 )
+        G_APPTOOL->fmap_init ( & legacy );
+        if ( ! G_APPTOOL->fmap_open ( & legacy, path, 0, 0, false ) )
         {
-            header->offset = FREE_BLOCK_FILE_MAX_SIZE;
+            LOG_ERROR ( "[md5db][content_db][convert_free_block]fmap_open failed" );
+            return false;
         }
 
-        m_free_block_merge.clear();
-
-        while ( i >= step )
+        // slot 0 is the header, chained empty slots have size 0
+        for ( size_t i = step; i + step <= legacy.ptr_len; i += step )
         {
-            block = ( struct free_block_t * ) & m_free_block_cache.ptr[ i ];
+            const struct free_block_t * block = ( const struct free_block_t * ) & legacy.ptr[ i ];
 
-            if ( block->offset > 0 && block->size > 0 )
+            if ( block->offset == 0 || block->size == 0 || 
+                 ( uint64_t ) block->offset + block->size > pages )
             {
-                m_free_block_merge.insert ( std::pair < struct free_block_t *, uint32_t >( block, i ) );
-            }
-            else if ( block->offset == 0 )
-            {
-                block->offset  = header->offset;
-                header->offset = i;
+                continue;
             }
 
-            i -= step;
+            set_free_range ( block->offset, block->size, true );
+            ++ count;
         }
 
-        prev = NULL;
-        m_free_block_list.clear();
+        G_APPTOOL->fmap_close ( & legacy );
 
-        for ( free_block_list_t::iterator it = m_free_block_merge.begin (); it != m_free_block_merge.end (); it ++ )
+        if ( 0 != remove ( path ) )
         {
-            curr = it->first;
+            LOG_ERROR ( "[md5db][content_db][convert_free_block][file=%s]remove failed", 
+                        path );
+            return false;
+        }
 
-            if ( unlikely ( ! prev ) )
-            {
-                prev   = curr;
-                prev_i = it->second;
-                continue;
-            }
+        LOG_INFO ( "[md5db][content_db][convert_free_block][file=%s][blocks=%llu]converted to free bitmap", 
+                   path, count );
 
-            if ( prev->offset + prev->size == curr->offset )
-            {
-                prev->size    += curr->size;
+        return true;
+    }
+
+    void content2_t::set_free_range ( uint32_t offset, uint32_t size, bool free )
+    {
+        uint64_t * bits = ( uint64_t * ) m_free_bitmap.ptr;
+        uint64_t   i    = offset;
+        uint64_t   end  = ( uint64_t ) offset + size;
 
-                curr->size     = 0;
-                curr->offset   = header->offset;
-                header->offset = it->second;
+        if ( end > ( uint64_t ) m_free_bitmap.ptr_len * 8 )
+        {
+            end = ( uint64_t ) m_free_bitmap.ptr_len * 8;
+        }
+
+        while ( i < end )
+        {
+            uint64_t w    = i / 64;
+            uint32_t b    = ( uint32_t ) ( i % 64 );
+            uint64_t n    = end - i < 64 - b ? end - i : 64 - b;
+            uint64_t mask = ( 64 == n ) ? ~ 0ULL : ( ( ( 1ULL << n ) - 1 ) << b );
+
+            if ( free )
+            {
+                bits[ w ] |= mask;
             }
             else
             {
-                m_free_block_list.insert ( std::pair < struct free_block_t *, uint32_t >( prev, prev_i ) );
-
-                prev   = curr;
-                prev_i = it->second;
+                bits[ w ] &= ~ mask;
             }
+
+            i += n;
         }
 
-        if ( prev != NULL )
+        if ( offset < end )
         {
-            m_free_block_list.insert ( std::pair < struct free_block_t *, uint32_t >( prev, prev_i ) );
+            hustdb::dirty_mark ( m_free_bitmap_dirty,
+                                 ( uint64_t ) offset / 64 * 8,
+                                 ( ( end - 1 ) / 64 - offset / 64 + 1 ) * 8 );
         }
-        
-        m_free_block_merge.clear();
     }
 
-    bool content2_t::incr_free_block_file ()
+    uint32_t content2_t::size_class ( uint32_t size )
     {
-        if ( unlikely ( ! m_free_block_file || 
-                        m_free_block_cache.ptr_len < FREE_BLOCK_INCR ||
-                        m_free_block_file_size >= FREE_BLOCK_FILE_MAX_SIZE
-                        ) 
-            )
+        if ( size <= FREE_CLASS_EXACT )
         {
-            LOG_ERROR( "[md5db][content_db][incr_free_block_file]initial conditions error" );
-            return false;
+            return size - 1;
         }
 
-        int r = fseek ( m_free_block_file, 0, SEEK_END );
-        if ( unlikely ( 0 != r ) )
-        {
-            LOG_ERROR ( "[md5db][content_db][incr_free_block_file]seek end failed" );
-            return false;
-        }
+        // floor ( log2 ( size ) ) >= 6
+        uint32_t k = 31 - __builtin_clz ( size );
 
-        char buf[ PAGE ];
-        memset ( buf, 0, sizeof ( buf ) );
-        for ( int i = 0; i < FREE_BLOCK_PAGE; i ++ )
-        {
-            if ( sizeof ( buf ) != fwrite ( buf, 1, sizeof ( buf ), m_free_block_file ) )
-            {
-                LOG_ERROR ( "[md5db][content_db][incr_free_block_file][i=%d]incr fwrite failed", 
-                            i );
-                return false;
-            }
-        }
-
-        fflush ( m_free_block_file );
-
-        m_free_block_file_size += FREE_BLOCK_INCR;
+        return FREE_CLASS_EXACT + k - 6;
+    }
 
-        G_APPTOOL->fmap_close ( & m_free_block_cache );
-        
-        if ( ! G_APPTOOL->fmap_open ( & m_free_block_cache, m_free_block_path, 0, 0, true ) )
+    void content2_t::push_free ( uint32_t offset, uint32_t size )
+    {
+        if ( offset >= m_compact_limit )
         {
-            LOG_ERROR ( "[md5db][content_db][incr_free_block_file]fmap_open failed" );
-            return false;
+            return;
         }
 
-        if ( m_free_block_cache.ptr_len != m_free_block_file_size )
+        if ( offset + size > m_compact_limit )
         {
-            LOG_ERROR ( "[md5db][content_db][incr_free_block_file][size=%d]mmap file size error", 
-                        m_free_block_cache.ptr_len );
-            return false;
+            size = m_compact_limit - offset;
         }
 
-        parse_free_block ();
+        free_block_t block;
+        block.offset = offset;
+        block.size   = size;
 
-        return true;
+        uint32_t c = size_class ( size );
+        m_free_lists[ c ].push_back ( block );
+        m_free_mask[ c / 64 ] |= 1ULL << ( c % 64 );
+
+        m_free_pages += size;
+        ++ m_free_extents;
     }
 
-    bool content2_t::use_free_block ( uint32_t size, uint32_t & offset )
+    bool content2_t::pop_free ( uint32_t size, uint32_t & offset )
     {
-        if ( unlikely ( m_free_block_max < size ) )
+        uint32_t      c     = size_class ( size );
+        free_list_t * list  = & m_free_lists[ c ];
+        bool          found = false;
+
+        if ( ! list->empty () )
         {
-            return false;
+            // exact classes hold one size, above that a class spans a power of two
+            if ( size <= FREE_CLASS_EXACT )
+            {
+                found = true;
+            }
+            else
+            {
+                size_t n = list->size ();
+                for ( size_t i = 0; i < FREE_CLASS_SCAN && i < n; ++ i )
+                {
+                    if ( ( * list )[ n - 1 - i ].size >= size )
+                    {
+                        std::swap ( ( * list )[ n - 1 - i ], list->back () );
+                        found = true;
+                        break;
+                    }
+                }
+            }
         }
 
-        struct free_block_t fb;
-        fb.size = size - 1;
+        // any extent of a higher class fits
+        for ( uint32_t w = ( c + 1 ) / 64; ! found && w < COUNT_OF ( m_free_mask ); ++ w )
+        {
+            uint64_t mask = m_free_mask[ w ];
+            if ( w == ( c + 1 ) / 64 )
+            {
+                mask &= ~ 0ULL << ( ( c + 1 ) % 64 );
+            }
+
+            if ( mask )
+            {
+                c     = w * 64 + __builtin_ctzll ( mask );
+                list  = & m_free_lists[ c ];
+                found = true;
+            }
+        }
 
-        free_block_list_t::iterator it = m_free_block_list.upper_bound ( & fb );
-        if ( unlikely ( it == m_free_block_list.end () ) )
+        if ( ! found )
         {
             return false;
         }
-        
-        struct free_block_t * block    = it->first;
-        uint32_t              block_i  = it->second;
-        struct free_block_t * header   = ( struct free_block_t * ) m_free_block_cache.ptr;
-        
-        offset = block->offset;
 
-        if ( size == block->size )
+        free_block_t block = list->back ();
+        list->pop_back ();
+        if ( list->empty () )
         {
-            block->size    = 0;
-            block->offset  = header->offset;
-            header->offset = block_i;
+            m_free_mask[ c / 64 ] &= ~ ( 1ULL << ( c % 64 ) );
         }
-        else
+
+        m_free_pages -= block.size;
+        -- m_free_extents;
+
+        offset = block.offset;
+        set_free_range ( offset, size, false );
+
+        if ( block.size > size )
         {
-            block->offset = block->offset + size;
-            block->size   = block->size - size;
+            push_free ( block.offset + size, block.size - size );
         }
 
-        m_free_block_list.erase ( it );
+        return true;
+    }
+
+    void content2_t::build_free_lists ( uint32_t limit )
+    {
+        const uint64_t * bits  = ( const uint64_t * ) m_free_bitmap.ptr;
+        uint64_t         pages = m_data_file_size / PAGE;
 
-        if ( block->size > 0 )
+        for ( size_t c = 0; c < COUNT_OF ( m_free_lists ); ++ c )
         {
-            m_free_block_list.insert ( std::pair < struct free_block_t *, uint32_t >( block, block_i ) );
+            m_free_lists[ c ].clear ();
         }
+        memset ( m_free_mask, 0, sizeof ( m_free_mask ) );
+        m_free_pages   = 0;
+        m_free_extents = 0;
 
-        if ( ! m_free_block_list.empty () )
+        if ( pages > ( uint64_t ) m_free_bitmap.ptr_len * 8 )
         {
-            free_block_list_t::reverse_iterator rit = m_free_block_list.rbegin(); 
-            m_free_block_max = rit->first->size;
+            pages = ( uint64_t ) m_free_bitmap.ptr_len * 8;
         }
-        else
+
+        if ( pages > limit )
         {
-            m_free_block_max = 0;
+            pages = limit;
         }
 
-        return true;
-    }
-
-    bool content2_t::add_free_block ( uint32_t size, uint32_t offset )
-    {
-        struct free_block_t * block   = NULL;
-        uint32_t              block_i = 0;
-        struct free_block_t * header  = ( struct free_block_t * ) m_free_block_cache.ptr;
-        
-        if ( header->offset == FREE_BLOCK_FILE_MAX_SIZE )
+        // page 0 never holds data, 0 is an invalid data_id
+        uint64_t i = 1;
+        while ( i < pages )
         {
-            if ( ! incr_free_block_file () )
+            uint64_t word = bits[ i / 64 ] >> ( i % 64 );
+            if ( 0 == word )
             {
-                LOG_ERROR ( "[md5db][content_db][add_free_block]add free block failed" );
-                return false;
+                i = ( i / 64 + 1 ) * 64;
+                continue;
+            }
+            i += __builtin_ctzll ( word );
+            if ( i >= pages )
+            {
+                break;
+            }
+
+            uint64_t start = i;
+            while ( i < pages )
+            {
+                word = ~ bits[ i / 64 ] >> ( i % 64 );
+                if ( 0 == word )
+                {
+                    i = ( i / 64 + 1 ) * 64;
+                    continue;
+                }
+                i += __builtin_ctzll ( word );
+                break;
+            }
+            if ( i > pages )
+            {
+                i = pages;
             }
-        
-            header = ( struct free_block_t * ) m_free_block_cache.ptr;
-        }
 
-        block          = ( struct free_block_t * ) & m_free_block_cache.ptr[ header->offset ];
-        block_i        = header->offset;
-        header->offset = block->offset;
+            push_free ( ( uint32_t ) start, ( uint32_t ) ( i - start ) );
+        }
+    }
 
-        block->offset  = offset;
-        block->size    = size;
-        
-        m_free_block_list.insert ( std::pair < struct free_block_t *, uint32_t >( block, block_i ) );
+    bool content2_t::use_free_block ( uint32_t size, uint32_t & offset )
+    {
+        return pop_free ( size, offset );
+    }
 
-        if ( m_free_block_max < size )
+    bool content2_t::add_free_block ( uint32_t size, uint32_t offset )
+    {
+        if ( unlikely ( ! incr_free_bitmap ( ( uint64_t ) offset + size ) ) )
         {
-            m_free_block_max = size;   
+            LOG_ERROR ( "[md5db][content_db][add_free_block]incr free bitmap failed" );
+            return false;
         }
 
+        set_free_range ( offset, size, true );
+        push_free ( offset, size );
+
         return true;
     }
 
@@ -512,15 +599,6 @@ namespace md5db
             size ++;
         }
 
-
-        if ( unlikely ( m_data_file_size > DATA_FILE_MAX_SIZE &&
-                        m_free_block_max < size
-                        ) 
-        )
-        {
-            return false;
-        }
-
         scope_wlock_t lock ( m_lock );
 
         return write_inner ( data, data_len, offset, size, tail );
@@ -535,11 +613,15 @@ namespace md5db
                                   )
     {
         ssize_t  pw       = 0;
-        bool     seek_end = false;
 
         bool r = use_free_block ( size, offset );
         if ( ! r )
         {
+            if ( unlikely ( m_data_file_size > DATA_FILE_MAX_SIZE ) )
+            {
+                return false;
+            }
+
             offset = m_data_file_size / PAGE;
 
             pw = pwrite ( m_data_fd, data, data_len, m_data_file_size );
@@ -559,6 +641,8 @@ namespace md5db
             }
 
             m_data_file_size += tail;
+
+            hustdb::dirty_mark ( m_data_dirty, ( uint64_t ) offset * PAGE, data_len + tail );
         }
         else
         {
@@ -570,6 +654,8 @@ namespace md5db
                 LOG_ERROR ( "[md5db][content_db][write_inner]pwrite data failed" );
                 return false;
             }
+
+            hustdb::dirty_mark ( m_data_dirty, real_offset, data_len );
         }
 
         return true;
@@ -611,6 +697,7 @@ namespace md5db
                 LOG_ERROR ( "[md5db][content_db][update]pwrite data failed" );
                 return false;
             }
+            hustdb::dirty_mark ( m_data_dirty, real_offset, data_len );
 
             if ( old_size > size )
             {
@@ -624,14 +711,6 @@ namespace md5db
             return true;
         }
 
-        if ( unlikely ( m_data_file_size > DATA_FILE_MAX_SIZE &&
-                        m_free_block_max < size
-                        ) 
-        )
-        {
-            return false;
-        }
-
         if ( ! add_free_block ( old_size, offset ) )
         {
             LOG_ERROR ( "[md5db][content_db][update]add free block failed" );
@@ -684,6 +763,150 @@ namespace md5db
         return true;
     }
 
+    bool content2_t::compact_begin (
+                                    int                 min_free_ratio,
+                                    uint32_t &          limit
+                                    )
+    {
+        scope_wlock_t lock ( m_lock );
+
+        uint64_t pages = m_data_file_size / PAGE;
+
+        m_compact_limit = 0xFFFFFFFF;
+        build_free_lists ( ( uint32_t ) pages );
+
+        if ( 0 == m_free_pages || m_free_pages * 100 < pages * ( uint64_t ) min_free_ratio )
+        {
+            return false;
+        }
+
+        // live data would exactly fit below the limit, free space above it is
+        // not handed out until compact_end
+        limit = ( uint32_t ) ( pages - m_free_pages );
+        m_compact_limit = limit;
+        build_free_lists ( limit );
+
+        return true;
+    }
+
+    bool content2_t::relocate (
+                               uint32_t &          offset,
+                               uint32_t            data_len,
+                               uint32_t            limit
+                               )
+    {
+        uint32_t size = size_to_pages ( data_len );
+        uint32_t to   = 0;
+
+        scope_wlock_t lock ( m_lock );
+
+        if ( offset + size <= limit || limit != m_compact_limit )
+        {
+            return false;
+        }
+
+        if ( ! use_free_block ( size, to ) )
+        {
+            return false;
+        }
+
+        try
+        {
+            m_move_buf.resize ( data_len );
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[md5db][content_db][relocate]bad_alloc" );
+            add_free_block ( size, to );
+            return false;
+        }
+
+        ssize_t r = pread ( m_data_fd, & m_move_buf[ 0 ], data_len, ( uint64_t ) offset * PAGE );
+        if ( data_len != ( size_t ) r )
+        {
+            LOG_ERROR ( "[md5db][content_db][relocate][offset=%u][data_len=%u]pread failed", 
+                        offset, data_len );
+            add_free_block ( size, to );
+            return false;
+        }
+
+        r = pwrite ( m_data_fd, m_move_buf.c_str (), data_len, ( uint64_t ) to * PAGE );
+        if ( data_len != ( size_t ) r )
+        {
+            LOG_ERROR ( "[md5db][content_db][relocate][offset=%u][data_len=%u]pwrite failed", 
+                        to, data_len );
+            add_free_block ( size, to );
+            return false;
+        }
+        hustdb::dirty_mark ( m_data_dirty, ( uint64_t ) to * PAGE, data_len );
+
+        // above the limit, only the bitmap takes it
+        if ( ! add_free_block ( size, offset ) )
+        {
+            LOG_ERROR ( "[md5db][content_db][relocate]add free block failed" );
+        }
+
+        offset = to;
+
+        return true;
+    }
+
+    uint64_t content2_t::compact_end ( )
+    {
+        scope_wlock_t lock ( m_lock );
+
+        const uint64_t * bits  = ( const uint64_t * ) m_free_bitmap.ptr;
+        uint64_t         pages = m_data_file_size / PAGE;
+        uint64_t         keep  = pages;
+
+        m_compact_limit = 0xFFFFFFFF;
+
+        // drop the free tail, page 0 always stays
+        while ( keep > 1 && keep - 1 < ( uint64_t ) m_free_bitmap.ptr_len * 8 )
+        {
+            uint64_t i = keep - 1;
+            if ( 0 == ( bits[ i / 64 ] & ( 1ULL << ( i % 64 ) ) ) )
+            {
+                break;
+            }
+            -- keep;
+        }
+
+        uint64_t truncated = 0;
+        if ( keep < pages )
+        {
+            if ( 0 != ftruncate ( m_data_fd, keep * PAGE ) )
+            {
+                LOG_ERROR ( "[md5db][content_db][compact_end][file_id=%d][pages=%llu]ftruncate failed", 
+                            m_file_id, keep );
+                keep = pages;
+            }
+            else
+            {
+                set_free_range ( ( uint32_t ) keep, ( uint32_t ) ( pages - keep ), false );
+                m_data_file_size = keep * PAGE;
+                truncated = ( pages - keep ) * PAGE;
+            }
+        }
+
+        build_free_lists ( ( uint32_t ) keep );
+
+        return truncated;
+    }
+
+    void content2_t::stat (
+                           uint64_t &          file_bytes,
+                           uint64_t &          free_bytes,
+                           uint64_t &          free_extents
+                           )
+    {
+        scope_rlock_t lock ( m_lock );
+
+        file_bytes   = m_data_file_size;
+        free_bytes   = m_free_pages * PAGE;
+        free_extents = m_free_extents;
+    }
+
     void content2_t::info (
                            std::stringstream & ss
                            )
@@ -4,13 +4,16 @@
 #include "db_lib.h"
 #include "db_stdinc.h"
 #include "../../base.h"
-#include <map>
+#include "../../utils/dirty.h"
+#include <vector>
 #include <sstream>
 #include <iostream>
 
-#define FREE_BLOCK_PAGE              8192
-#define FREE_BLOCK_INCR              8388608
-#define FREE_BLOCK_FILE_MAX_SIZE     2147483648
+// one bit per data page, grown in steps of 512K pages
+#define FREE_BITMAP_INCR             65536
+#define FREE_CLASS_EXACT             64
+#define FREE_CLASS_COUNT             128
+#define FREE_CLASS_SCAN              8
 #define DATA_FILE_MAX_SIZE           274876858368
 
 namespace md5db
@@ -18,6 +21,7 @@ namespace md5db
 
 #pragma pack( push, 1 )
 
+    // record of the legacy .free.block file, converted on open
     struct free_block_t
     {
         free_block_t ( )
@@ -37,22 +41,11 @@ namespace md5db
 
 #pragma pack( pop )
 
-    struct block_cmp_t
-    {
-        bool operator () ( const struct free_block_t * p, const struct free_block_t * q )
-        {
-            return p->size < q->size ? true : false;
-        }
-    };
-
-    struct block_merge_t
-    {
-        bool operator () ( const struct free_block_t * p, const struct free_block_t * q )
-        {
-            return p->offset < q->offset ? true : false;
-        }
-    };
-
+    // free space of a data file is persisted as a page bitmap ( bit set = free ).
+    // in memory it is split into segregated size classes: one class per size
+    // up to FREE_CLASS_EXACT pages, then one per power of two. alloc pops a
+    // class, free pushes one, neighbours are merged when the lists are rebuilt
+    // from the bitmap ( open, compaction ).
     class content2_t
     {
     public:
@@ -66,20 +59,6 @@ namespace md5db
 
         void close ( );
 
-        void parse_free_block ( );
-
-        bool incr_free_block_file ( );
-
-        bool use_free_block (
-                               uint32_t size,
-                               uint32_t & offset
-                               );
-
-        bool add_free_block (
-                                uint32_t size,
-                                uint32_t offset
-                                );
-
         bool write (
                      const char * data,
                      uint32_t data_len,
@@ -104,12 +83,81 @@ namespace md5db
                    uint32_t data_len
                    );
 
+        // compaction: begin picks the page limit live data should fit under
+        // and keeps only the free space below it allocatable, relocate moves
+        // one value below the limit, end merges free space and truncates the
+        // free tail of the file
+        bool compact_begin (
+                             int min_free_ratio,
+                             uint32_t & limit
+                             );
+
+        bool relocate (
+                        uint32_t & offset,
+                        uint32_t data_len,
+                        uint32_t limit
+                        );
+
+        uint64_t compact_end ( );
+
+        void stat (
+                    uint64_t & file_bytes,
+                    uint64_t & free_bytes,
+                    uint64_t & free_extents
+                    );
+
         void info (
                     std::stringstream & ss
                     );
 
     private:
 
+        bool open_free_bitmap (
+                                const char * path
+                                );
+
+        bool convert_free_block (
+                                  const char * path
+                                  );
+
+        bool incr_free_bitmap (
+                                uint64_t pages
+                                );
+
+        void set_free_range (
+                              uint32_t offset,
+                              uint32_t size,
+                              bool free
+                              );
+
+        void build_free_lists (
+                                uint32_t limit
+                                );
+
+        static uint32_t size_class (
+                                     uint32_t size
+                                     );
+
+        void push_free (
+                         uint32_t offset,
+                         uint32_t size
+                         );
+
+        bool pop_free (
+                        uint32_t size,
+                        uint32_t & offset
+                        );
+
+        bool use_free_block (
+                               uint32_t size,
+                               uint32_t & offset
+                               );
+
+        bool add_free_block (
+                                uint32_t size,
+                                uint32_t offset
+                                );
+
         bool write_inner (
                            const char * data,
                            uint32_t data_len,
@@ -121,7 +169,6 @@ namespace md5db
     private:
 
         int m_file_id;
-        char m_free_block_path[ 260 ];
 
         FILE * m_data_file;
         int m_data_fd;
@@ -129,20 +176,25 @@ namespace md5db
 
         char m_tail[ PAGE ];
 
-        typedef std::multimap< struct free_block_t *, uint32_t, block_cmp_t > free_block_list_t;
-        typedef std::multimap< struct free_block_t *, uint32_t, block_merge_t > free_block_merge_t;
+        typedef std::vector< free_block_t > free_list_t;
 
-        FILE * m_free_block_file;
-        uint64_t m_free_block_file_size;
+        char m_free_bitmap_path[ 260 ];
+        FILE * m_free_bitmap_file;
+        fmap_t m_free_bitmap;
 
-        fmap_t m_free_block_cache;
-        uint32_t m_free_block_max;
+        free_list_t m_free_lists[ FREE_CLASS_COUNT ];
+        uint64_t m_free_mask[ FREE_CLASS_COUNT / 64 ];
+        uint64_t m_free_pages;
+        uint64_t m_free_extents;
+        uint32_t m_compact_limit;
 
-        free_block_list_t m_free_block_list;
-        free_block_merge_t m_free_block_merge;
+        std::string m_move_buf;
 
         rwlockable_t m_lock;
 
+        hustdb::dirty_file_t * m_data_dirty;
+        hustdb::dirty_file_t * m_free_bitmap_dirty;
+
     private:
         // disable
         content2_t ( const content2_t & );
@@ -1,11 +1,19 @@
 #include "content_array.h"
 #include "../../base.h"
 #include "../../perf_target.h"
+#include "../../utils/parallel.h"
 #include <memory>
 
 namespace md5db
 {
 
+    struct content_array_t::open_ctx_t
+    {
+        content_array_t *   self;
+        const char *        path;
+        int                 max_count_len;
+    };
+
     content_array_t::content_array_t ( )
     : m_contents ( )
     , m_token ( )
@@ -128,118 +136,121 @@ namespace md5db
             return false;
         }
 
-        char ph[ 260 ] = { };
-
-        if ( m_contents.capacity () < ( size_t ) count )
+        try
         {
-            try
-            {
-                m_contents.reserve ( count );
-            }
-            catch ( ... )
-            {
-                LOG_ERROR ( "[md5db][content_db_array][open]bad_alloc" );
-                return false;
-            }
+            m_contents.resize ( count, NULL );
         }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[md5db][content_db_array][open]bad_alloc" );
+            return false;
+        }
+
+        open_ctx_t ctx = { this, path, max_count_len };
 
-        for ( int i = 0; i < count; i ++ )
+        if ( ! hustdb::parallel_run ( ( size_t ) count, 0, content_array_t::open_file, & ctx ) )
         {
-            strcpy ( ph, path );
-            G_APPTOOL->path_to_os ( ph );
-            if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
-            {
-                strcat ( ph, S_PATH_SEP );
-            }
+            return false;
+        }
 
-            char t[ 32 ] = { };
-            if ( 1 == max_count_len )
-            {
-                sprintf ( t, "%d", ( int ) i );
-            }
-            else if ( 2 == max_count_len )
-            {
-                sprintf ( t, "%02d", ( int ) i );
-            }
-            else if ( 3 == max_count_len )
-            {
-                sprintf ( t, "%03d", ( int ) i );
-            }
-            else if ( 4 == max_count_len )
-            {
-                sprintf ( t, "%04d", ( int ) i );
-            }
-            else if ( 5 == max_count_len )
-            {
-                sprintf ( t, "%05d", ( int ) i );
-            }
-            else if ( 6 == max_count_len )
-            {
-                sprintf ( t, "%06d", ( int ) i );
-            }
-            else if ( 7 == max_count_len )
-            {
-                sprintf ( t, "%07d", ( int ) i );
-            }
-            else if ( 8 == max_count_len )
-            {
-                sprintf ( t, "%08d", ( int ) i );
-            }
-            else if ( 9 == max_count_len )
-            {
-                sprintf ( t, "%09d", ( int ) i );
-            }
-            else
-            {
-                LOG_ERROR ( "[md5db][content_db_array][open][max_count_len=%d]invalid max_count_len", 
-                            max_count_len );
-                return false;
-            }
-            strcat ( ph, t );
+        m_ok = true;
 
-            G_APPTOOL->make_dir ( ph );
-            if ( ! G_APPTOOL->is_dir ( ph ) )
-            {
-                LOG_ERROR ( "[md5db][content_db_array][open][file=%s]create directory failed", 
-                            ph );
-                return false;
-            }
-            strcat ( ph, S_PATH_SEP );
-            strcat ( ph, t );
+        LOG_INFO ( "[md5db][content_db_array][open][file=%s][count=%d]create success", 
+                    path, count );
 
-            content2_t * p = NULL;
-            try
-            {
-                p = new content2_t ();
-            }
-            catch ( ... )
-            {
-                LOG_ERROR ( "[md5db][content_db_array][open]bad_alloc" );
-                return false;
-            }
+        return true;
+    }
 
-            if ( ! p->open ( ph, i ) )
-            {
-                LOG_ERROR ( "[md5db][content_db_array][open][file=%s]open failed", 
-                            ph );
-                return false;
-            }
+    bool content_array_t::open_file (
+                                      void *  arg,
+                                      size_t  i
+                                      )
+    {
+        open_ctx_t * ctx = ( open_ctx_t * ) arg;
 
-            try
-            {
-                m_contents.push_back ( p );
-            }
-            catch ( ... )
-            {
-                LOG_ERROR ( "[md5db][content_db_array][open]bad_alloc" );
-                return false;
-            }
+        char ph[ 260 ] = { };
+
+        strcpy ( ph, ctx->path );
+        G_APPTOOL->path_to_os ( ph );
+        if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
+        {
+            strcat ( ph, S_PATH_SEP );
         }
 
-        m_ok = true;
+        char t[ 32 ] = { };
+        if ( 1 == ctx->max_count_len )
+        {
+            sprintf ( t, "%d", ( int ) i );
+        }
+        else if ( 2 == ctx->max_count_len )
+        {
+            sprintf ( t, "%02d", ( int ) i );
+        }
+        else if ( 3 == ctx->max_count_len )
+        {
+            sprintf ( t, "%03d", ( int ) i );
+        }
+        else if ( 4 == ctx->max_count_len )
+        {
+            sprintf ( t, "%04d", ( int ) i );
+        }
+        else if ( 5 == ctx->max_count_len )
+        {
+            sprintf ( t, "%05d", ( int ) i );
+        }
+        else if ( 6 == ctx->max_count_len )
+        {
+            sprintf ( t, "%06d", ( int ) i );
+        }
+        else if ( 7 == ctx->max_count_len )
+        {
+            sprintf ( t, "%07d", ( int ) i );
+        }
+        else if ( 8 == ctx->max_count_len )
+        {
+            sprintf ( t, "%08d", ( int ) i );
+        }
+        else if ( 9 == ctx->max_count_len )
+        {
+            sprintf ( t, "%09d", ( int ) i );
+        }
+        else
+        {
+            LOG_ERROR ( "[md5db][content_db_array][open][max_count_len=%d]invalid max_count_len", 
+                        ctx->max_count_len );
+            return false;
+        }
+        strcat ( ph, t );
 
-        LOG_INFO ( "[md5db][content_db_array][open][file=%s][count=%d]create success", 
-                    path, count );
+        G_APPTOOL->make_dir ( ph );
+        if ( ! G_APPTOOL->is_dir ( ph ) )
+        {
+            LOG_ERROR ( "[md5db][content_db_array][open][file=%s]create directory failed", 
+                        ph );
+            return false;
+        }
+        strcat ( ph, S_PATH_SEP );
+        strcat ( ph, t );
+
+        content2_t * p = NULL;
+        try
+        {
+            p = new content2_t ();
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[md5db][content_db_array][open]bad_alloc" );
+            return false;
+        }
+        // owned by the array from here on, close () releases it
+        ctx->self->m_contents[ i ] = p;
+
+        if ( ! p->open ( ph, ( int ) i ) )
+        {
+            LOG_ERROR ( "[md5db][content_db_array][open][file=%s]open failed", 
+                        ph );
+            return false;
+        }
 
         return true;
     }
@@ -386,19 +397,76 @@ namespace md5db
         return p->del ( data_id, data_len );
     }
 
+    bool content_array_t::compact_begin (
+                                          uint32_t            file_id,
+                                          int                 min_free_ratio,
+                                          uint32_t &          limit
+                                          )
+    {
+        if ( unlikely ( ! m_ok || file_id >= m_contents.size () || NULL == m_contents[ file_id ] ) )
+        {
+            return false;
+        }
+
+        return m_contents[ file_id ]->compact_begin ( min_free_ratio, limit );
+    }
+
+    bool content_array_t::relocate (
+                                     uint32_t            file_id,
+                                     uint32_t &          data_id,
+                                     uint32_t            data_len,
+                                     uint32_t            limit
+                                     )
+    {
+        if ( unlikely ( ! m_ok || file_id >= m_contents.size () || NULL == m_contents[ file_id ] ) )
+        {
+            return false;
+        }
+
+        return m_contents[ file_id ]->relocate ( data_id, data_len, limit );
+    }
+
+    uint64_t content_array_t::compact_end (
+                                            uint32_t            file_id
+                                            )
+    {
+        if ( unlikely ( ! m_ok || file_id >= m_contents.size () || NULL == m_contents[ file_id ] ) )
+        {
+            return 0;
+        }
+
+        return m_contents[ file_id ]->compact_end ();
+    }
+
     void content_array_t::info (
                                  std::stringstream & ss
                                  )
     {
+        int    file_id      = 0;
+        size_t file_bytes   = 0;
+        size_t free_bytes   = 0;
+        size_t free_extents = 0;
+
         size_t count = m_contents.size ();
         for ( size_t i = 0; i < count; ++ i )
         {
             content2_t * p = m_contents[ i ];
             if ( p )
             {
-                p->info ( ss );
+                uint64_t f = 0;
+                uint64_t b = 0;
+                uint64_t e = 0;
+                p->stat ( f, b, e );
+
+                file_bytes   += f;
+                free_bytes   += b;
+                free_extents += e;
             }
         }
+
+        write_single_count ( ss, file_id, "file_bytes",   file_bytes );
+        write_single_count ( ss, file_id, "free_bytes",   free_bytes );
+        write_single_count ( ss, file_id, "free_extents", free_extents );
     }
 
 } // namespace md5db
@@ -72,10 +72,42 @@ namespace md5db
                    uint32_t data_len
                    );
 
+        size_t size ( ) const
+        {
+            return m_contents.size ();
+        }
+
+        bool compact_begin (
+                             uint32_t file_id,
+                             int min_free_ratio,
+                             uint32_t & limit
+                             );
+
+        bool relocate (
+                        uint32_t file_id,
+                        uint32_t & data_id,
+                        uint32_t data_len,
+                        uint32_t limit
+                        );
+
+        uint64_t compact_end (
+                               uint32_t file_id
+                               );
+
         void info (
                     std::stringstream & ss
                     );
 
+    private:
+
+        struct open_ctx_t;
+
+        // parallel_run job, opens m_contents[ i ]
+        static bool open_file (
+                                void * ctx,
+                                size_t i
+                                );
+
     private:
 
         typedef std::vector< content2_t * > container_t;
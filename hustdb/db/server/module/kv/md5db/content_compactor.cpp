@@ -0,0 +1,275 @@
+#include "content_compactor.h"
+#include "bucket_array.h"
+#include "content_array.h"
+#include "fullkey.h"
+#include "../../perf_target.h"
+#include <sys/time.h>
+
+namespace md5db
+{
+
+// fullkey records checked per bucket lock hold
+#define COMPACT_BATCH           4096
+
+    content_compactor_t::content_compactor_t ( )
+    : m_buckets ( NULL )
+    , m_contents ( NULL )
+    , m_interval ( 0 )
+    , m_min_free_ratio ( 0 )
+    , m_rate_limit ( 0 )
+    , m_tid ( )
+    , m_running ( false )
+    , m_stop ( false )
+    , m_count_passes ( 0 )
+    , m_count_files ( 0 )
+    , m_count_relocated ( 0 )
+    , m_count_relocate_fail ( 0 )
+    , m_bytes_relocated ( 0 )
+    , m_bytes_truncated ( 0 )
+    {
+        pthread_mutex_init ( & m_mutex, NULL );
+        pthread_cond_init ( & m_cond, NULL );
+    }
+
+    content_compactor_t::~ content_compactor_t ( )
+    {
+        close ();
+
+        pthread_cond_destroy ( & m_cond );
+        pthread_mutex_destroy ( & m_mutex );
+    }
+
+    void content_compactor_t::close ( )
+    {
+        if ( ! m_running )
+        {
+            return;
+        }
+
+        pthread_mutex_lock ( & m_mutex );
+        m_stop = true;
+        pthread_cond_broadcast ( & m_cond );
+        pthread_mutex_unlock ( & m_mutex );
+
+        pthread_join ( m_tid, NULL );
+        m_running = false;
+    }
+
+    bool content_compactor_t::open (
+                                     const char *        storage_conf,
+                                     bucket_array_t &    buckets,
+                                     content_array_t &   contents
+                                     )
+    {
+        ini_t * ini = NULL;
+
+        ini = G_APPINI->ini_create ( storage_conf );
+        if ( NULL == ini )
+        {
+            LOG_ERROR ( "[md5db][content_compactor][open][file=%s]open failed",
+                        storage_conf );
+            return false;
+        }
+
+        m_interval       = G_APPINI->ini_get_int ( ini, "contentdb", "compact.interval", 3600 );
+        m_min_free_ratio = G_APPINI->ini_get_int ( ini, "contentdb", "compact.min_free_ratio", 25 );
+        m_rate_limit     = G_APPINI->ini_get_int ( ini, "contentdb", "compact.rate_limit", 16 );
+        G_APPINI->ini_destroy ( ini );
+
+        if ( m_interval < 0 || m_min_free_ratio <= 0 || m_min_free_ratio >= 100 || m_rate_limit < 0 )
+        {
+            LOG_ERROR ( "[md5db][content_compactor][open][interval=%d][min_free_ratio=%d][rate_limit=%d]invalid config",
+                        m_interval, m_min_free_ratio, m_rate_limit );
+            return false;
+        }
+
+        m_buckets  = & buckets;
+        m_contents = & contents;
+
+        if ( 0 == m_interval )
+        {
+            LOG_INFO ( "[md5db][content_compactor][open]disabled" );
+            return true;
+        }
+
+        m_stop = false;
+        if ( 0 != pthread_create ( & m_tid, NULL, content_compactor_t::compact_thread, this ) )
+        {
+            LOG_ERROR ( "[md5db][content_compactor][open]pthread_create failed" );
+            return false;
+        }
+        m_running = true;
+
+        return true;
+    }
+
+    void * content_compactor_t::compact_thread (
+                                                 void * arg
+                                                 )
+    {
+        content_compactor_t * obj = ( content_compactor_t * ) arg;
+        if ( obj )
+        {
+            obj->run ();
+        }
+        return 0;
+    }
+
+    bool content_compactor_t::wait ( uint64_t ms )
+    {
+        struct timeval  now;
+        struct timespec ts;
+
+        gettimeofday ( & now, NULL );
+        uint64_t ns = ( uint64_t ) now.tv_usec * 1000 + ( ms % 1000 ) * 1000000;
+        ts.tv_sec   = now.tv_sec + ms / 1000 + ns / 1000000000;
+        ts.tv_nsec  = ns % 1000000000;
+
+        pthread_mutex_lock ( & m_mutex );
+        while ( ! m_stop )
+        {
+            if ( ETIMEDOUT == pthread_cond_timedwait ( & m_cond, & m_mutex, & ts ) )
+            {
+                break;
+            }
+        }
+        bool stop = m_stop;
+        pthread_mutex_unlock ( & m_mutex );
+
+        return ! stop;
+    }
+
+    void content_compactor_t::run ( )
+    {
+        while ( wait ( ( uint64_t ) m_interval * 1000 ) )
+        {
+            compact ();
+        }
+    }
+
+    void content_compactor_t::compact ( )
+    {
+        size_t                  file_count = m_contents->size ();
+        std::vector< uint32_t > limits ( file_count, 0 );
+        size_t                  compacting = 0;
+
+        for ( size_t i = 0; i < file_count; ++ i )
+        {
+            uint32_t limit = 0;
+            if ( m_contents->compact_begin ( ( uint32_t ) i, m_min_free_ratio, limit ) )
+            {
+                limits[ i ] = limit;
+                ++ compacting;
+            }
+        }
+
+        ++ m_count_passes;
+
+        if ( 0 == compacting )
+        {
+            return;
+        }
+
+        size_t relocated = 0;
+        size_t truncated = 0;
+
+        for ( size_t b = 0; b < m_buckets->size () && ! m_stop; ++ b )
+        {
+            bucket_t &  bucket = m_buckets->item ( b );
+            fullkey_t * fk     = bucket.get_fullkey ();
+            if ( NULL == fk )
+            {
+                continue;
+            }
+
+            uint32_t index = 1;
+            bool     done  = false;
+            while ( ! done && ! m_stop )
+            {
+                uint64_t moved = 0;
+                {
+                    scope_wlock_t lock ( bucket.get_lock () );
+
+                    uint32_t count = fk->count ();
+                    uint32_t end   = index + COMPACT_BATCH;
+                    for ( ; index <= count && index < end; ++ index )
+                    {
+                        block_id_t   block_id;
+                        content_id_t content_id;
+
+                        block_id.set ( ( byte_t ) fk->file_id (), index );
+                        if ( ! fk->get_content_id ( block_id, content_id ) || 0 == content_id.data_len () )
+                        {
+                            continue;
+                        }
+
+                        uint32_t file_id  = content_id.file_id ();
+                        uint32_t data_id  = content_id.data_id ();
+                        uint32_t data_len = content_id.data_len ();
+                        if ( file_id >= file_count || 0 == limits[ file_id ] ||
+                             data_id + ( data_len + PAGE - 1 ) / PAGE <= limits[ file_id ] )
+                        {
+                            continue;
+                        }
+
+                        if ( ! m_contents->relocate ( file_id, data_id, data_len, limits[ file_id ] ) )
+                        {
+                            ++ m_count_relocate_fail;
+                            continue;
+                        }
+
+                        content_id.set ( ( byte_t ) file_id, data_id, data_len );
+                        if ( ! fk->set_content_id ( block_id, content_id ) )
+                        {
+                            LOG_ERROR ( "[md5db][content_compactor][compact][block_id=%d.%u]fullkey.set_content_id failed",
+                                        fk->file_id (), index );
+                            continue;
+                        }
+
+                        moved += data_len;
+                        ++ relocated;
+                    }
+
+                    done = index > count;
+                }
+
+                m_bytes_relocated += moved;
+
+                if ( moved > 0 && m_rate_limit > 0 )
+                {
+                    wait ( moved * 1000 / ( ( uint64_t ) m_rate_limit * 1048576 ) );
+                }
+            }
+        }
+
+        for ( size_t i = 0; i < file_count; ++ i )
+        {
+            if ( limits[ i ] > 0 )
+            {
+                truncated += m_contents->compact_end ( ( uint32_t ) i );
+            }
+        }
+
+        m_count_files     += compacting;
+        m_count_relocated += relocated;
+        m_bytes_truncated += truncated;
+
+        LOG_INFO ( "[md5db][content_compactor][compact][files=%d][relocated=%d][truncated=%llu]done",
+                   ( int ) compacting, ( int ) relocated, ( unsigned long long ) truncated );
+    }
+
+    void content_compactor_t::info (
+                                     std::stringstream & ss
+                                     )
+    {
+        int file_id = 0;
+
+        write_single_count ( ss, file_id, "compact_passes",        m_count_passes );
+        write_single_count ( ss, file_id, "compact_files",         m_count_files );
+        write_single_count ( ss, file_id, "compact_relocated",     m_count_relocated );
+        write_single_count ( ss, file_id, "compact_relocate_fail", m_count_relocate_fail );
+        write_single_count ( ss, file_id, "compact_relocated_bytes", m_bytes_relocated );
+        write_single_count ( ss, file_id, "compact_truncated_bytes", m_bytes_truncated, true );
+    }
+
+} // namespace md5db
@@ -0,0 +1,82 @@
+#ifndef _md5db_content_compactor_h_
+#define _md5db_content_compactor_h_
+
+#include "db_stdinc.h"
+#include "db_lib.h"
+#include "../../base.h"
+#include <vector>
+#include <sstream>
+#include <pthread.h>
+
+namespace md5db
+{
+
+    class bucket_array_t;
+    class content_array_t;
+
+    // background thread that moves live values of fragmented content files
+    // below their compacted size, rewrites content_id in fullkey under the
+    // bucket lock and truncates the freed tail, capped at compact.rate_limit
+    class content_compactor_t
+    {
+    public:
+        content_compactor_t ( );
+        ~content_compactor_t ( );
+
+        bool open (
+                    const char * storage_conf,
+                    bucket_array_t & buckets,
+                    content_array_t & contents
+                    );
+
+        void close ( );
+
+        void info (
+                    std::stringstream & ss
+                    );
+
+    private:
+
+        static void * compact_thread (
+                                       void * arg
+                                       );
+
+        void run ( );
+
+        void compact ( );
+
+        bool wait (
+                    uint64_t ms
+                    );
+
+    private:
+
+        bucket_array_t *    m_buckets;
+        content_array_t *   m_contents;
+
+        int                 m_interval;
+        int                 m_min_free_ratio;
+        int                 m_rate_limit;
+
+        pthread_t           m_tid;
+        bool                m_running;
+        bool                m_stop;
+        pthread_mutex_t     m_mutex;
+        pthread_cond_t      m_cond;
+
+        size_t              m_count_passes;
+        size_t              m_count_files;
+        size_t              m_count_relocated;
+        size_t              m_count_relocate_fail;
+        size_t              m_bytes_relocated;
+        size_t              m_bytes_truncated;
+
+    private:
+        // disable
+        content_compactor_t ( const content_compactor_t & );
+        const content_compactor_t & operator= ( const content_compactor_t & );
+    };
+
+} // namespace md5db
+
+#endif
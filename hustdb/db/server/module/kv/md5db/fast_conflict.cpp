@@ -15,6 +15,7 @@ namespace md5db
     : m_file_id ( - 1 )
     , m_file ( NULL )
     , m_conflict_count ( - 1 )
+    , m_dirty ( NULL )
     {
         G_APPTOOL->fmap_init ( & m_data );
         m_path[ 0 ] = '\0';
@@ -27,6 +28,8 @@ namespace md5db
 
     void fast_conflict_t::close ( )
     {
+        hustdb::dirty_close ( m_dirty );
+        m_dirty = NULL;
         G_APPTOOL->fmap_close ( & m_data );
 
         if ( m_file )
@@ -147,8 +150,9 @@ namespace md5db
             return false;
         }
 
+        // grows in place inside the reserved range, see alloc_item
         bool read_write = true;
-        if ( ! G_APPTOOL->fmap_open ( & m_data, path, 0, 0, read_write ) )
+        if ( ! G_APPTOOL->fmap_open_reserved ( & m_data, path, FAST_CONFLICT_BYTES_PER_FILE, read_write ) )
         {
             LOG_ERROR ( "[md5db][fast_conflict][open]fmap_open failed" );
             return false;
@@ -166,6 +170,7 @@ namespace md5db
 
         m_file_id           = file_id;
         m_conflict_count    = conflict_count;
+        m_dirty             = hustdb::dirty_open ( path );
 
         return true;
     }
@@ -313,18 +318,32 @@ namespace md5db
 
             fflush ( m_file );
 
-            bool read_write = true;
-            fmap_t m;
-            if ( ! G_APPTOOL->fmap_open ( & m, m_path, 0, 0, read_write ) )
+            bool   read_write = true;
+            size_t new_len    = m_data.ptr_len + ( size_t ) expand_count * data.size ();
+            hustdb::dirty_mark ( m_dirty, m_data.ptr_len, new_len - m_data.ptr_len );
+            if ( m_data.reserve_len )
             {
-                LOG_ERROR ( "[md5db][fast_conflict][alloc_item]fmap_open failed" );
-                return NULL;
+                if ( ! G_APPTOOL->fmap_extend ( & m_data, m_path, m_data.ptr_len, new_len, read_write ) )
+                {
+                    LOG_ERROR ( "[md5db][fast_conflict][alloc_item]fmap_extend failed" );
+                    return NULL;
+                }
+                m_data.ptr_len = new_len;
             }
+            else
+            {
+                fmap_t m;
+                if ( ! G_APPTOOL->fmap_open ( & m, m_path, 0, 0, read_write ) )
+                {
+                    LOG_ERROR ( "[md5db][fast_conflict][alloc_item]fmap_open failed" );
+                    return NULL;
+                }
 
-            fmap_t old_m;
-            memcpy ( & old_m, & m_data, sizeof ( fmap_t ) );
-            memcpy ( & m_data, & m, sizeof ( fmap_t ) );
-            G_APPTOOL->fmap_close ( & old_m );
+                fmap_t old_m;
+                memcpy ( & old_m, & m_data, sizeof ( fmap_t ) );
+                memcpy ( & m_data, & m, sizeof ( fmap_t ) );
+                G_APPTOOL->fmap_close ( & old_m );
+            }
 
             header = ( header_t * ) m_data.ptr;
 
@@ -358,6 +377,7 @@ namespace md5db
             LOG_ERROR ( "[md5db][fast_conflict][write]alloc_item failed" );
             return false;
         }
+        hustdb::dirty_mark ( m_dirty, 0, sizeof ( header_t ) );
 
         uint32_t offset;
         uint32_t item_max_per_file = ( uint32_t ) FAST_CONFLICT_BYTES_PER_FILE / ( uint32_t ) ( m_conflict_count * sizeof ( bucket_data_item_t ) );
@@ -374,6 +394,7 @@ namespace md5db
         memcpy ( & item[ 0 ], & bucket_item_1, sizeof ( bucket_data_item_t ) );
         memcpy ( & item[ 1 ], & bucket_item_2, sizeof ( bucket_data_item_t ) );
         memset ( & item[ 2 ], 0, sizeof ( bucket_data_item_t ) * ( m_conflict_count - 2 ) );
+        hustdb::dirty_mark ( m_dirty, offset, m_conflict_count * sizeof ( bucket_data_item_t ) );
 
         uint32_t index = offset / ( uint32_t ) ( m_conflict_count * sizeof ( bucket_data_item_t ) );
         if ( ! generate_addr ( addr, m_file_id, index ) )
@@ -462,6 +483,9 @@ namespace md5db
 
         * p = header->free_list_id;
         header->free_list_id = index;
+        hustdb::dirty_mark ( m_dirty, 0, sizeof ( header_t ) );
+        hustdb::dirty_mark ( m_dirty, ( uint64_t ) index * ( m_conflict_count * sizeof ( bucket_data_item_t ) ),
+                             m_conflict_count * sizeof ( bucket_data_item_t ) );
 
         return true;
     }
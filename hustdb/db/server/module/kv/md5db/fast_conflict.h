@@ -5,6 +5,7 @@
 #include "db_lib.h"
 #include "../../base.h"
 #include "bucket.h"
+#include "../../utils/dirty.h"
 #include <sstream>
 
 namespace md5db
@@ -70,6 +71,17 @@ namespace md5db
                     std::stringstream & ss
                     );
 
+        // for the backup, under the bucket write lock once an item got
+        // from get is written
+        void touch (
+                     const bucket_data_item_t * item
+                     )
+        {
+            hustdb::dirty_mark ( m_dirty,
+                                 ( uint64_t ) ( ( const char * ) item - ( const char * ) m_data.ptr ),
+                                 sizeof ( bucket_data_item_t ) );
+        }
+
     private:
 
         bool generate_addr (
@@ -90,11 +102,12 @@ namespace md5db
 
     private:
 
-        int    m_conflict_count;
-        int    m_file_id;
-        char   m_path[ 260 ];
-        fmap_t m_data;
-        FILE * m_file;
+        int                     m_conflict_count;
+        int                     m_file_id;
+        char                    m_path[ 260 ];
+        fmap_t                  m_data;
+        FILE *                  m_file;
+        hustdb::dirty_file_t *  m_dirty;
 
     private:
         // disable
@@ -2,10 +2,18 @@
 #include "bucket_array.h"
 #include "fullkey.h"
 #include "../../base.h"
+#include "../../utils/parallel.h"
 
 namespace md5db
 {
 
+    struct fast_conflict_array_t::open_ctx_t
+    {
+        fast_conflict_array_t * self;
+        const char *            path;
+        int                     conflict_count;
+    };
+
     fast_conflict_array_t::fast_conflict_array_t ( )
     : m_bucket_array ( NULL )
     {
@@ -72,31 +80,41 @@ namespace md5db
 
         G_APPTOOL->make_dir ( path );
 
-        char ph[ 260 ];
+        open_ctx_t ctx = { this, path, conflict_count };
 
-        for ( int i = 0; i < COUNT_OF ( m_fast_conflicts ); ++ i )
+        if ( ! hustdb::parallel_run ( COUNT_OF ( m_fast_conflicts ), 0, fast_conflict_array_t::open_file, & ctx ) )
         {
-            strcpy ( ph, path );
-            G_APPTOOL->path_to_os ( ph );
-            if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
-            {
-                strcat ( ph, S_PATH_SEP );
-            }
+            return false;
+        }
 
-            char t[ 32 ];
-            sprintf ( t, "%02X", ( int ) i );
-            strcat ( ph, t );
-            strcat ( ph, ".fastconflict" );
+        m_bucket_array = buckets;
+        return true;
+    }
 
-            if ( ! m_fast_conflicts[ i ].open ( ph, i, conflict_count ) )
-            {
-                LOG_ERROR ( "[md5db][fast_conflict][open][file=%s]open failed", 
-                            ph );
-                return false;
-            }
+    bool fast_conflict_array_t::open_file ( void * arg, size_t i )
+    {
+        open_ctx_t * ctx = ( open_ctx_t * ) arg;
+
+        char ph[ 260 ];
+        strcpy ( ph, ctx->path );
+        G_APPTOOL->path_to_os ( ph );
+        if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
+        {
+            strcat ( ph, S_PATH_SEP );
+        }
+
+        char t[ 32 ];
+        sprintf ( t, "%02X", ( int ) i );
+        strcat ( ph, t );
+        strcat ( ph, ".fastconflict" );
+
+        if ( ! ctx->self->m_fast_conflicts[ i ].open ( ph, ( int ) i, ctx->conflict_count ) )
+        {
+            LOG_ERROR ( "[md5db][fast_conflict][open][file=%s]open failed", 
+                        ph );
+            return false;
         }
 
-        m_bucket_array = buckets;
         return true;
     }
 
@@ -320,6 +338,7 @@ namespace md5db
                 item->set_type ( BUCKET_CONFLICT_DATA );
                 item->set_version ( version );
                 item->m_block_id = block_id;
+                c.touch ( item );
                 return 0;
             }
         }
@@ -397,6 +416,7 @@ namespace md5db
             if ( item->version () != version )
             {
                 item->set_version ( version );
+                c.touch ( item );
             }
 
             return 0;
@@ -473,7 +493,8 @@ namespace md5db
             }
 
             memset ( item, 0, sizeof ( bucket_data_item_t ) );
-            
+            c.touch ( item );
+
             return 0;
         }
 
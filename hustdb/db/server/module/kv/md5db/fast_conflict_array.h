@@ -84,6 +84,11 @@ namespace md5db
 
     private:
 
+        struct open_ctx_t;
+
+        // parallel_run job, opens m_fast_conflicts[ i ]
+        static bool open_file ( void * ctx, size_t i );
+
         fast_conflict_t & get_fast_conflict ( const void * inner_key, size_t inner_key_len );
 
     private:
@@ -2,6 +2,7 @@
 #include "bucket.h"
 #include "../../base.h"
 #include "../../perf_target.h"
+#include "../../utils/numa.h"
 
 namespace md5db
 {
@@ -9,6 +10,9 @@ namespace md5db
     fullkey_t::fullkey_t ( )
     : m_file_id ( - 1 )
     , m_file ( NULL )
+    , m_ready_len ( 0 )
+    , m_grow_lock ( )
+    , m_dirty ( NULL )
     {
         G_APPTOOL->fmap_init ( & m_data );
         m_path[ 0 ] = '\0';
@@ -21,7 +25,10 @@ namespace md5db
 
     void fullkey_t::close ( )
     {
+        hustdb::dirty_close ( m_dirty );
+        m_dirty = NULL;
         G_APPTOOL->fmap_close ( & m_data );
+        m_ready_len = 0;
 
         if ( m_file )
         {
@@ -129,12 +136,16 @@ namespace md5db
             return false;
         }
 
+        // the file never grows past FILEKEY_BYTES_PER_FILE, reserving that
+        // much address space lets it grow without moving the existing pages
         bool read_write = true;
-        if ( ! G_APPTOOL->fmap_open ( & m_data, path, 0, 0, read_write ) )
+        if ( ! G_APPTOOL->fmap_open_reserved ( & m_data, path, FILEKEY_BYTES_PER_FILE, read_write ) )
         {
             LOG_ERROR ( "[md5db][fullkey][open]fmap_open failed" );
             return false;
         }
+        m_ready_len = m_data.ptr_len;
+        hustdb::advise_map_hugepage ( m_data.ptr, m_data.ptr_len );
         if ( m_data.ptr_len < sizeof ( header_t ) + sizeof ( data_t ) * DEFAULT_ITEM_COUNT )
         {
             LOG_ERROR ( "[md5db][fullkey][open]error" );
@@ -147,6 +158,7 @@ namespace md5db
         }
 
         m_file_id = file_id;
+        m_dirty   = hustdb::dirty_open ( path );
 
         return true;
     }
@@ -209,7 +221,7 @@ namespace md5db
 
 #define GET_MAX()   ( uint32_t ) ( ( m_data.ptr_len - sizeof ( header_t ) ) / sizeof( data_t ) )
 
-    fullkey_data_t * fullkey_t::alloc_item ( fullkey_header_t * & header )
+    fullkey_data_t * fullkey_t::alloc_item ( fullkey_header_t * & header, bool append )
     {
         header = ( header_t * ) m_data.ptr;
         if ( unlikely ( NULL == header ) )
@@ -218,7 +230,7 @@ namespace md5db
             return NULL;
         }
 
-        if ( 0 != header->free_list_id )
+        if ( ! append && 0 != header->free_list_id )
         {
             do
             {
@@ -255,86 +267,185 @@ namespace md5db
             return NULL;
         }
 
-        uint32_t item_max_per_file = ( uint32_t ) FILEKEY_BYTES_PER_FILE / ( uint32_t ) sizeof ( data_t );
-        
         if ( header->count == GET_MAX () )
         {
-            int     i;
-            data_t  data;
+            if ( ! expand () )
+            {
+                return NULL;
+            }
 
-            int expand_count = EXPAND_ITEM_COUNT;
-            if ( header->count + 1 + ( uint32_t ) expand_count > item_max_per_file )
+            header = ( header_t * ) m_data.ptr;
+
+            if ( header->count >= GET_MAX () )
             {
-                expand_count = item_max_per_file - 1 - header->count;
-                if ( expand_count <= 0 )
-                {
-                    LOG_ERROR ( "[md5db][fullkey][alloc_item]file size limit" );
-                    return NULL;
-                }
+                LOG_ERROR ( "[md5db][fullkey][alloc_item]expand algorithm error" );
+                return NULL;
             }
+        }
+
+        header->count ++;
+
+        data_t * d    = ( data_t * ) header;
+        data_t * item = & d[ header->count ];
+
+        return item;
+    }
+
+    // under the bucket write lock
+    bool fullkey_t::expand ( )
+    {
+        scope_lock_t lock ( m_grow_lock );
+
+        if ( m_ready_len <= m_data.ptr_len && ! extend_file () )
+        {
+            return false;
+        }
+
+        if ( m_data.reserve_len )
+        {
+            m_data.ptr_len = m_ready_len;
+            return true;
+        }
 
-            std::string t;
-            try
+        bool read_write = true;
+        fmap_t m;
+        if ( ! G_APPTOOL->fmap_open ( & m, m_path, 0, 0, read_write ) )
+        {
+            LOG_ERROR ( "[md5db][fullkey][expand]fmap_open failed" );
+            return false;
+        }
+
+        fmap_t old_m;
+        memcpy ( & old_m, & m_data, sizeof ( fmap_t ) );
+        memcpy ( & m_data, & m, sizeof ( fmap_t ) );
+        G_APPTOOL->fmap_close ( & old_m );
+
+        m_ready_len = m_data.ptr_len;
+
+        return true;
+    }
+
+    // under m_grow_lock, appends EXPAND_ITEM_COUNT items to the file and maps
+    // them into the reserved range
+    bool fullkey_t::extend_file ( )
+    {
+        int     i;
+        data_t  data;
+
+        uint32_t item_max_per_file = ( uint32_t ) FILEKEY_BYTES_PER_FILE / ( uint32_t ) sizeof ( data_t );
+        uint32_t item_count        = ( uint32_t ) ( ( m_ready_len - sizeof ( header_t ) ) / sizeof ( data_t ) );
+
+        int expand_count = EXPAND_ITEM_COUNT;
+        if ( item_count + 1 + ( uint32_t ) expand_count > item_max_per_file )
+        {
+            expand_count = item_max_per_file - 1 - item_count;
+            if ( expand_count <= 0 )
             {
-                t.resize ( expand_count * sizeof ( data_t ), '\0' );
-                if ( t.size () != fwrite ( & t[ 0 ], 1, t.size (), m_file ) )
-                {
-                    LOG_ERROR ( "[md5db][fullkey][alloc_item][data_len=%d]write data failed", 
-                                ( int ) t.size () );
-                    return NULL;
-                }
+                LOG_ERROR ( "[md5db][fullkey][extend_file]file size limit" );
+                return false;
             }
-            catch ( ... )
+        }
+
+        std::string t;
+        try
+        {
+            t.resize ( expand_count * sizeof ( data_t ), '\0' );
+            if ( t.size () != fwrite ( & t[ 0 ], 1, t.size (), m_file ) )
             {
-                LOG_ERROR ( "[md5db][fullkey][alloc_item]maybe bad_alloc, try to write without buffer" );
+                LOG_ERROR ( "[md5db][fullkey][extend_file][data_len=%d]write data failed", 
+                            ( int ) t.size () );
+                return false;
+            }
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[md5db][fullkey][extend_file]maybe bad_alloc, try to write without buffer" );
 
-                for ( i = 0; i < expand_count; ++ i )
-                {
-                    if ( sizeof ( data ) != fwrite ( & data, 1, sizeof ( data ), m_file ) )
-                    {
-                        LOG_ERROR ( "[md5db][fullkey][alloc_item][i=%d]expand data failed", 
-                                    i );
-                        break;
-                    }
-                }
-                if ( i < expand_count )
+            for ( i = 0; i < expand_count; ++ i )
+            {
+                if ( sizeof ( data ) != fwrite ( & data, 1, sizeof ( data ), m_file ) )
                 {
-                    LOG_ERROR ( "[md5db][fullkey][alloc_item][i=%d][expand_count=%d]expand failed", 
-                                i, expand_count );
-                    return NULL;
+                    LOG_ERROR ( "[md5db][fullkey][extend_file][i=%d]expand data failed", 
+                                i );
+                    break;
                 }
             }
+            if ( i < expand_count )
+            {
+                LOG_ERROR ( "[md5db][fullkey][extend_file][i=%d][expand_count=%d]expand failed", 
+                            i, expand_count );
+                return false;
+            }
+        }
+
+        fflush ( m_file );
 
-            fflush ( m_file );
+        size_t new_len = m_ready_len + ( size_t ) expand_count * sizeof ( data_t );
+        hustdb::dirty_mark ( m_dirty, m_ready_len, new_len - m_ready_len );
 
+        if ( m_data.reserve_len )
+        {
             bool read_write = true;
-            fmap_t m;
-            if ( ! G_APPTOOL->fmap_open ( & m, m_path, 0, 0, read_write ) )
+            if ( ! G_APPTOOL->fmap_extend ( & m_data, m_path, m_ready_len, new_len, read_write ) )
             {
-                LOG_ERROR ( "[md5db][fullkey][alloc_item]fmap_open failed" );
-                return NULL;
+                LOG_ERROR ( "[md5db][fullkey][extend_file][file=%s]fmap_extend failed",
+                            m_path );
+                return false;
             }
+            hustdb::advise_map_hugepage ( m_data.ptr + m_ready_len, new_len - m_ready_len );
+        }
 
-            fmap_t old_m;
-            memcpy ( & old_m, & m_data, sizeof ( fmap_t ) );
-            memcpy ( & m_data, & m, sizeof ( fmap_t ) );
-            G_APPTOOL->fmap_close ( & old_m );
+        m_ready_len = new_len;
 
-            header = ( header_t * ) m_data.ptr;
+        return true;
+    }
 
-            if ( header->count >= GET_MAX () )
-            {
-                LOG_ERROR ( "[md5db][fullkey][alloc_item]expand algorithm error" );
-                return NULL;
-            }
+    bool fullkey_t::need_grow (
+                                int high_water
+                                )
+    {
+        header_t * header = ( header_t * ) m_data.ptr;
+        if ( NULL == header || 0 == m_data.reserve_len )
+        {
+            return false;
         }
 
-        header->count ++;
+        uint32_t item_max_per_file = ( uint32_t ) FILEKEY_BYTES_PER_FILE / ( uint32_t ) sizeof ( data_t );
+        uint32_t capacity          = GET_MAX ();
 
-        data_t * d    = ( data_t * ) header;
-        data_t * item = & d[ header->count ];
+        if ( capacity + 1 >= item_max_per_file )
+        {
+            return false;
+        }
 
-        return item;
+        return ( uint64_t ) header->count * 100 >= ( uint64_t ) capacity * high_water;
+    }
+
+    bool fullkey_t::grow_ahead ( )
+    {
+        scope_lock_t lock ( m_grow_lock );
+
+        if ( 0 == m_data.reserve_len )
+        {
+            return false;
+        }
+
+        if ( m_ready_len > m_data.ptr_len )
+        {
+            return true;
+        }
+
+        return extend_file ();
+    }
+
+    void fullkey_t::grow_publish ( )
+    {
+        scope_lock_t lock ( m_grow_lock );
+
+        if ( m_ready_len > m_data.ptr_len )
+        {
+            m_data.ptr_len = m_ready_len;
+        }
     }
 
     bool fullkey_t::compare (
@@ -366,7 +477,8 @@ namespace md5db
                             unsigned int    inner_key_len,
                             const char *    user_key,
                             unsigned int    user_key_len,
-                            block_id_t &    block_id
+                            block_id_t &    block_id,
+                            bool            append
                             )
     {
         block_id.reset ();
@@ -378,12 +490,13 @@ namespace md5db
         }
 
         header_t * header;
-        data_t * item = alloc_item ( header );
+        data_t * item = alloc_item ( header, append );
         if ( NULL == item )
         {
             LOG_ERROR ( "[md5db][fullkey][write]alloc_item failed" );
             return false;
         }
+        hustdb::dirty_mark ( m_dirty, 0, sizeof ( header_t ) );
 
         uint32_t item_max_per_file = ( uint32_t ) FILEKEY_BYTES_PER_FILE / ( uint32_t ) sizeof ( data_t );
         uint32_t offset            = ( uint32_t ) ( ( char * ) item - ( char * ) header );
@@ -396,6 +509,7 @@ namespace md5db
         }
 
         memcpy ( item->m_md5_suffix, & inner_key[ 3 ], sizeof ( item->m_md5_suffix ) );
+        hustdb::dirty_mark ( m_dirty, offset, sizeof ( data_t ) );
 
         uint32_t index = offset / ( uint32_t ) sizeof ( data_t );
         if ( ! generate_block_id ( block_id, m_file_id, index ) )
@@ -446,6 +560,8 @@ namespace md5db
 
         * p = header->free_list_id;
         header->free_list_id = index;
+        hustdb::dirty_mark ( m_dirty, 0, sizeof ( header_t ) );
+        hustdb::dirty_mark ( m_dirty, ( uint64_t ) index * sizeof ( data_t ), sizeof ( data_t ) );
 
         return true;
     }
@@ -474,7 +590,8 @@ namespace md5db
 
         data_t * item = ( data_t * ) ( m_data.ptr + index * sizeof ( data_t ) );
         fast_memcpy ( & item->m_content_id, & content_id, sizeof ( content_id_t ) );
-        
+        hustdb::dirty_mark ( m_dirty, ( uint64_t ) index * sizeof ( data_t ), sizeof ( data_t ) );
+
         return true;
     }
 
@@ -497,6 +614,13 @@ namespace md5db
         return true;
     }
 
+    uint32_t fullkey_t::count ( )
+    {
+        header_t * header = ( header_t * ) m_data.ptr;
+
+        return header ? header->count : 0;
+    }
+
     void fullkey_t::info (
                            std::stringstream & ss
                            )
@@ -5,6 +5,7 @@
 #include "db_lib.h"
 #include "bucket.h"
 #include "../../base.h"
+#include "../../utils/dirty.h"
 #include <sstream>
 
 namespace md5db
@@ -75,12 +76,14 @@ namespace md5db
 
         void close ( );
 
+        // append skips the free list, the block_id has never been used
         bool write (
                      const char * inner_key,
                      unsigned int inner_key_len,
                      const char * user_key,
                      unsigned int user_key_len,
-                     block_id_t & block_id
+                     block_id_t & block_id,
+                     bool append = false
                      );
 
         bool compare (
@@ -108,6 +111,33 @@ namespace md5db
                                 content_id_t & content_id
                                 );
 
+        int file_id ( ) const
+        {
+            return m_file_id;
+        }
+
+        uint32_t count ( );
+
+        // grows in place inside a reserved range ( remapped where the range
+        // could not be reserved ), ptr_len is only stable under the bucket lock
+        const fmap_t & get_map ( ) const
+        {
+            return m_data;
+        }
+
+        // under the bucket lock: more than high_water percent of the
+        // mapped items are used and the file may still grow in place
+        bool need_grow (
+                         int high_water
+                         );
+
+        // without the bucket lock: extends the file and maps the new items
+        // into the reserved range, they are not visible before grow_publish
+        bool grow_ahead ( );
+
+        // under the bucket write lock
+        void grow_publish ( );
+
         void info (
                     std::stringstream & ss
                     );
@@ -127,15 +157,27 @@ namespace md5db
                               );
 
         fullkey_data_t * alloc_item (
-                                      fullkey_header_t * & header
+                                      fullkey_header_t * & header,
+                                      bool append
                                       );
 
+        bool expand ( );
+
+        bool extend_file ( );
+
     private:
 
-        int    m_file_id;
-        char   m_path[ 260 ];
-        fmap_t m_data;
-        FILE * m_file;
+        int         m_file_id;
+        char        m_path[ 260 ];
+        fmap_t      m_data;
+        FILE *      m_file;
+
+        // bytes of the file mapped so far, ahead of m_data.ptr_len once
+        // grow_ahead has run. both change under m_grow_lock only
+        size_t      m_ready_len;
+        lockable_t  m_grow_lock;
+
+        hustdb::dirty_file_t * m_dirty;
 
     private:
         // disable
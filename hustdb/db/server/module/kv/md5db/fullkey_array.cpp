@@ -1,9 +1,16 @@
 #include "fullkey_array.h"
 #include "../../base.h"
+#include "../../utils/parallel.h"
 
 namespace md5db
 {
 
+    struct fullkey_array_t::open_ctx_t
+    {
+        fullkey_array_t *   self;
+        const char *        path;
+    };
+
     fullkey_array_t::fullkey_array_t ( )
     {
     }
@@ -33,28 +40,36 @@ namespace md5db
 
         G_APPTOOL->make_dir ( path );
 
-        char ph[ 260 ];
+        open_ctx_t ctx = { this, path };
 
-        for ( int i = 0; i < COUNT_OF ( m_fullkeys ); ++ i )
+        return hustdb::parallel_run ( COUNT_OF ( m_fullkeys ), 0, fullkey_array_t::open_file, & ctx );
+    }
+
+    bool fullkey_array_t::open_file (
+                                      void * arg,
+                                      size_t i
+                                      )
+    {
+        open_ctx_t * ctx = ( open_ctx_t * ) arg;
+
+        char ph[ 260 ];
+        strcpy ( ph, ctx->path );
+        G_APPTOOL->path_to_os ( ph );
+        if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
         {
-            strcpy ( ph, path );
-            G_APPTOOL->path_to_os ( ph );
-            if ( S_PATH_SEP_C != ph[ strlen ( ph ) - 1 ] )
-            {
-                strcat ( ph, S_PATH_SEP );
-            }
+            strcat ( ph, S_PATH_SEP );
+        }
 
-            char t[ 32 ];
-            sprintf ( t, "%02X", ( int ) i );
-            strcat ( ph, t );
-            strcat ( ph, ".fullkey" );
+        char t[ 32 ];
+        sprintf ( t, "%02X", ( int ) i );
+        strcat ( ph, t );
+        strcat ( ph, ".fullkey" );
 
-            if ( ! m_fullkeys[ i ].open ( ph, i ) )
-            {
-                LOG_ERROR ( "[md5db][fullkey][open][file=%s]open failed", 
-                            ph );
-                return false;
-            }
+        if ( ! ctx->self->m_fullkeys[ i ].open ( ph, ( int ) i ) )
+        {
+            LOG_ERROR ( "[md5db][fullkey][open][file=%s]open failed", 
+                        ph );
+            return false;
         }
 
         return true;
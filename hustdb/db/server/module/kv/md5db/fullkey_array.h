@@ -36,6 +36,14 @@ namespace md5db
 
     private:
 
+        struct open_ctx_t;
+
+        // parallel_run job, opens m_fullkeys[ i ]
+        static bool open_file (
+                                void * ctx,
+                                size_t i
+                                );
+
         fullkey_t & get_fullkey (
                                   const void * inner_key,
                                   size_t inner_key_len
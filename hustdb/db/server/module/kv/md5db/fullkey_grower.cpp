@@ -0,0 +1,184 @@
+#include "fullkey_grower.h"
+#include "bucket_array.h"
+#include "fullkey.h"
+#include "../../perf_target.h"
+#include <sys/time.h>
+
+namespace md5db
+{
+
+    fullkey_grower_t::fullkey_grower_t ( )
+    : m_buckets ( NULL )
+    , m_interval ( 0 )
+    , m_high_water ( 0 )
+    , m_tid ( )
+    , m_running ( false )
+    , m_stop ( false )
+    , m_count_grown ( 0 )
+    , m_count_grow_fail ( 0 )
+    {
+        pthread_mutex_init ( & m_mutex, NULL );
+        pthread_cond_init ( & m_cond, NULL );
+    }
+
+    fullkey_grower_t::~ fullkey_grower_t ( )
+    {
+        close ();
+
+        pthread_cond_destroy ( & m_cond );
+        pthread_mutex_destroy ( & m_mutex );
+    }
+
+    void fullkey_grower_t::close ( )
+    {
+        if ( ! m_running )
+        {
+            return;
+        }
+
+        pthread_mutex_lock ( & m_mutex );
+        m_stop = true;
+        pthread_cond_broadcast ( & m_cond );
+        pthread_mutex_unlock ( & m_mutex );
+
+        pthread_join ( m_tid, NULL );
+        m_running = false;
+    }
+
+    bool fullkey_grower_t::open (
+                                  const char *        storage_conf,
+                                  bucket_array_t &    buckets
+                                  )
+    {
+        ini_t * ini = NULL;
+
+        ini = G_APPINI->ini_create ( storage_conf );
+        if ( NULL == ini )
+        {
+            LOG_ERROR ( "[md5db][fullkey_grower][open][file=%s]open failed",
+                        storage_conf );
+            return false;
+        }
+
+        m_interval   = G_APPINI->ini_get_int ( ini, "md5db", "grow_ahead.interval", 100 );
+        m_high_water = G_APPINI->ini_get_int ( ini, "md5db", "grow_ahead.high_water", 80 );
+        G_APPINI->ini_destroy ( ini );
+
+        if ( m_interval < 0 || m_high_water < 50 || m_high_water > 99 )
+        {
+            LOG_ERROR ( "[md5db][fullkey_grower][open][interval=%d][high_water=%d]invalid config",
+                        m_interval, m_high_water );
+            return false;
+        }
+
+        m_buckets = & buckets;
+
+        if ( 0 == m_interval )
+        {
+            LOG_INFO ( "[md5db][fullkey_grower][open]disabled" );
+            return true;
+        }
+
+        m_stop = false;
+        if ( 0 != pthread_create ( & m_tid, NULL, fullkey_grower_t::grow_thread, this ) )
+        {
+            LOG_ERROR ( "[md5db][fullkey_grower][open]pthread_create failed" );
+            return false;
+        }
+        m_running = true;
+
+        return true;
+    }
+
+    void * fullkey_grower_t::grow_thread (
+                                           void * arg
+                                           )
+    {
+        fullkey_grower_t * obj = ( fullkey_grower_t * ) arg;
+        if ( obj )
+        {
+            obj->run ();
+        }
+        return 0;
+    }
+
+    bool fullkey_grower_t::wait ( uint64_t ms )
+    {
+        struct timeval  now;
+        struct timespec ts;
+
+        gettimeofday ( & now, NULL );
+        uint64_t ns = ( uint64_t ) now.tv_usec * 1000 + ( ms % 1000 ) * 1000000;
+        ts.tv_sec   = now.tv_sec + ms / 1000 + ns / 1000000000;
+        ts.tv_nsec  = ns % 1000000000;
+
+        pthread_mutex_lock ( & m_mutex );
+        while ( ! m_stop )
+        {
+            if ( ETIMEDOUT == pthread_cond_timedwait ( & m_cond, & m_mutex, & ts ) )
+            {
+                break;
+            }
+        }
+        bool stop = m_stop;
+        pthread_mutex_unlock ( & m_mutex );
+
+        return ! stop;
+    }
+
+    void fullkey_grower_t::run ( )
+    {
+        while ( wait ( ( uint64_t ) m_interval ) )
+        {
+            grow ();
+        }
+    }
+
+    void fullkey_grower_t::grow ( )
+    {
+        for ( size_t b = 0; b < m_buckets->size () && ! m_stop; ++ b )
+        {
+            bucket_t &  bucket = m_buckets->item ( b );
+            fullkey_t * fk     = bucket.get_fullkey ();
+            if ( NULL == fk )
+            {
+                continue;
+            }
+
+            {
+                scope_rlock_t lock ( bucket.get_lock () );
+                if ( ! fk->need_grow ( m_high_water ) )
+                {
+                    continue;
+                }
+            }
+
+            // the file write is the slow part, puts go on meanwhile
+            if ( ! fk->grow_ahead () )
+            {
+                ++ m_count_grow_fail;
+                continue;
+            }
+
+            {
+                scope_wlock_t lock ( bucket.get_lock () );
+                fk->grow_publish ();
+            }
+
+            ++ m_count_grown;
+
+            LOG_INFO ( "[md5db][fullkey_grower][grow][file=%d]grown",
+                       fk->file_id () );
+        }
+    }
+
+    void fullkey_grower_t::info (
+                                  std::stringstream & ss
+                                  )
+    {
+        ss << "\"grow_ahead\":{"
+            "\"grown\":" << m_count_grown << ","
+            "\"grow_fail\":" << m_count_grow_fail << "}";
+    }
+
+} // namespace md5db
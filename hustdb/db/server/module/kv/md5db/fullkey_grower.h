@@ -0,0 +1,74 @@
+#ifndef _md5db_fullkey_grower_h_
+#define _md5db_fullkey_grower_h_
+
+#include "db_stdinc.h"
+#include "db_lib.h"
+#include "../../base.h"
+#include <sstream>
+#include <pthread.h>
+
+namespace md5db
+{
+
+    class bucket_array_t;
+
+    // background thread that grows a fullkey file once it passes
+    // grow_ahead.high_water, so that a put rarely finds it full: the file is
+    // extended and mapped without the bucket lock, only the new length is
+    // published under it
+    class fullkey_grower_t
+    {
+    public:
+        fullkey_grower_t ( );
+        ~fullkey_grower_t ( );
+
+        bool open (
+                    const char * storage_conf,
+                    bucket_array_t & buckets
+                    );
+
+        void close ( );
+
+        void info (
+                    std::stringstream & ss
+                    );
+
+    private:
+
+        static void * grow_thread (
+                                    void * arg
+                                    );
+
+        void run ( );
+
+        void grow ( );
+
+        bool wait (
+                    uint64_t ms
+                    );
+
+    private:
+
+        bucket_array_t *    m_buckets;
+
+        int                 m_interval;
+        int                 m_high_water;
+
+        pthread_t           m_tid;
+        bool                m_running;
+        bool                m_stop;
+        pthread_mutex_t     m_mutex;
+        pthread_cond_t      m_cond;
+
+        size_t              m_count_grown;
+        size_t              m_count_grow_fail;
+
+    private:
+        // disable
+        fullkey_grower_t ( const fullkey_grower_t & );
+        const fullkey_grower_t & operator= ( const fullkey_grower_t & );
+    };
+
+} // namespace md5db
+
+#endif
@@ -6,7 +6,14 @@
 #include "fullkey_array.h"
 #include "conflict_array.h"
 #include "fast_conflict_array.h"
+#include "negative_filter.h"
+#include "content_compactor.h"
+#include "warmup.h"
+#include "fullkey_grower.h"
+#include "../../utils/numa.h"
+#include "../../utils/parallel.h"
 #include "../kv_array/kv_array.h"
+#include "../leveldb/ldb_env.h"
 #include "../../binlog/binlog.h"
 
 using namespace md5db;
@@ -18,6 +25,7 @@ struct query_ctxt_t
     uint32_t      table_len;
     uint32_t      wttl;
     uint32_t      rttl;
+    i_kv_stage_t * stage;
 
     query_ctxt_t ( )
     : tbkey ( )
@@ -25,6 +33,7 @@ struct query_ctxt_t
     , table_len ( 0 )
     , wttl ( 0 )
     , rttl ( 0 )
+    , stage ( NULL )
     {
         tbkey.reserve ( HASH_TB_LEN * 64 );
     }
@@ -36,6 +45,7 @@ struct query_ctxt_t
         table_len = 0;
         wttl = 0;
         rttl = 0;
+        stage = NULL;
     }
 
 } __attribute__ ( ( aligned ( 64 ) ) );
@@ -52,6 +62,10 @@ public:
     , m_fullkeys ( )
     , m_fast_conflicts ( )
     , m_conflicts ( )
+    , m_filter ( )
+    , m_compactor ( )
+    , m_warmup ( )
+    , m_grower ( )
     , m_query_ctxts ( )
     , m_data ( )
     , m_binlog ( )
@@ -60,11 +74,15 @@ public:
 
     ~ inner ( )
     {
+        m_grower.close ();
+        m_warmup.close ();
+        m_compactor.close ();
         m_buckets.close ();
         m_contents.close ();
         m_fullkeys.close ();
         m_fast_conflicts.close ();
         m_conflicts.close ();
+        m_filter.close ();
         m_data.close ();
     }
 
@@ -73,6 +91,10 @@ public:
     fullkey_array_t         m_fullkeys;
     fast_conflict_array_t   m_fast_conflicts;
     conflict_array_t        m_conflicts;
+    negative_filter_t       m_filter;
+    content_compactor_t     m_compactor;
+    warmup_t                m_warmup;
+    fullkey_grower_t        m_grower;
     query_ctxts_t           m_query_ctxts;
     kv_array_t              m_data;
     binlog_t                m_binlog;
@@ -87,6 +109,8 @@ kv_md5db_t::kv_md5db_t ( )
 : m_inner ( NULL )
 , m_db ( NULL )
 , m_ok ( false )
+, m_inner_hash ( INNER_HASH_MD5 )
+, m_open_ms ( 0 )
 
 , m_perf_put_ok ( )
 , m_perf_put_fail ( )
@@ -221,7 +245,14 @@ void kv_md5db_t::user_key_to_inner (
                                      unsigned int    user_key_len
                                      )
 {
-    G_APPTOOL->md5 ( user_key, user_key_len, ( char * ) inner_key );
+    if ( INNER_HASH_MURMUR3 == m_inner_hash )
+    {
+        G_APPTOOL->murmur3 ( user_key, user_key_len, ( char * ) inner_key );
+    }
+    else
+    {
+        G_APPTOOL->md5 ( user_key, user_key_len, ( char * ) inner_key );
+    }
 }
 
 void kv_md5db_t::destroy ( )
@@ -256,11 +287,12 @@ bool kv_md5db_t::open ( )
     }
 
     m_db = ( hustdb_t * ) G_APPTOOL->get_hustdb ();
+    m_inner_hash = m_db->get_inner_hash ();
 
     m_inner->m_query_ctxts.resize ( 0 );
     try
     {
-        m_inner->m_query_ctxts.resize ( m_db->get_worker_count () + 2 );
+        m_inner->m_query_ctxts.resize ( m_db->get_conn_count () );
     }
     catch ( ... )
     {
@@ -268,63 +300,99 @@ bool kv_md5db_t::open ( )
         return false;
     }
 
-    // data
-    if ( ! m_inner->m_data.open ( ) )
+    ini_t * ini = G_APPINI->ini_create ( HUSTDB_CONFIG );
+    if ( NULL == ini )
     {
-        LOG_ERROR ( "[md5db][db][open]kvs open failed" );
+        LOG_ERROR ( "[md5db][db][open][file=%s]open config failed", HUSTDB_CONFIG );
         return false;
     }
-    LOG_INFO ( "[md5db][db][open]kvs opened OK" );
+    int  open_threads = G_APPINI->ini_get_int ( ini, "md5db", "open_threads", 8 );
+    bool warmup       = G_APPINI->ini_get_bool ( ini, "md5db", "warmup", false );
+    bool hugepage     = G_APPINI->ini_get_bool ( ini, "md5db", "hugepage", false );
+    int  ldb_threads  = G_APPINI->ini_get_int ( ini, "md5db", "compaction.threads", 1 );
+    int  ldb_rate     = G_APPINI->ini_get_int ( ini, "md5db", "compaction.rate_limit", 0 );
+    int  ldb_defer    = G_APPINI->ini_get_int ( ini, "md5db", "compaction.defer_ops", 0 );
+    int  ldb_defer_ms = G_APPINI->ini_get_int ( ini, "md5db", "compaction.defer_ms", 1000 );
+    G_APPINI->ini_destroy ( ini );
 
-    // content
-    if ( content_array_t::enable ( HUSTDB_CONFIG ) )
+    if ( open_threads < 1 || open_threads > 64 )
     {
-        if ( ! m_inner->m_contents.open ( DB_CONTENTS_DIR, HUSTDB_CONFIG ) )
-        {
-            LOG_ERROR ( "[md5db][db][open]contents open failed" );
-            return false;
-        }
-        LOG_INFO ( "[md5db][db][open]contents opened OK" );
+        LOG_ERROR ( "[md5db][db][open][open_threads=%d]invalid open_threads", open_threads );
+        return false;
     }
-    else
+    hustdb::set_parallel_threads ( open_threads );
+    hustdb::set_map_hugepage ( hugepage );
+
+    if ( ldb_threads < 1 || ldb_threads > 16 || ldb_rate < 0 || ldb_defer < 0 ||
+         ldb_defer_ms < 0 || ldb_defer_ms > 60000
+        )
     {
-        LOG_INFO ( "[md5db][db][open]contents disabled" );
+        LOG_ERROR ( "[md5db][db][open][threads=%d][rate_limit=%d][defer_ops=%d][defer_ms=%d]invalid compaction",
+                    ldb_threads, ldb_rate, ldb_defer, ldb_defer_ms );
+        return false;
+    }
+
+    // every leveldb file below is opened with it
+    if ( NULL == ldb_env_t::instance ( ldb_threads, ldb_rate, ldb_defer, ldb_defer_ms ) )
+    {
+        LOG_ERROR ( "[md5db][db][open]ldb_env start failed" );
         return false;
     }
 
-    // bucket
-    if ( ! m_inner->m_buckets.open ( DB_BUCKETS_DIR ) )
+    if ( ! content_array_t::enable ( HUSTDB_CONFIG ) )
     {
-        LOG_ERROR ( "[md5db][db][open]buckets open failed" );
+        LOG_INFO ( "[md5db][db][open]contents disabled" );
         return false;
     }
-    LOG_INFO ( "[md5db][db][open]buckets opened OK" );
 
-    // fullkey
-    if ( ! m_inner->m_fullkeys.open ( DB_FULLKEY_DIR ) )
+    unsigned int start = G_APPTOOL->get_tick_count ();
+
+    // data, contents, buckets, fullkeys, fast conflicts and conflicts do not
+    // depend on each other, each of them also opens its files in parallel
+    if ( ! hustdb::parallel_run ( 6, 6, kv_md5db_t::open_component, this ) )
     {
-        LOG_ERROR ( "[md5db][db][open]fullkeys create failed" );
         return false;
     }
-    LOG_INFO ( "[md5db][db][open]fullkeys opened OK" );
 
     m_inner->m_buckets.set_fullkeys ( & m_inner->m_fullkeys );
 
-    // fast conflict
-    if ( ! m_inner->m_fast_conflicts.open ( DB_FAST_CONFLICT_DIR, & m_inner->m_buckets, HUSTDB_CONFIG ) )
+    // negative filter
+    if ( ! m_inner->m_filter.open ( HUSTDB_CONFIG ) )
     {
-        LOG_ERROR ( "[md5db][db][open]fast_conflicts open failed" );
+        LOG_ERROR ( "[md5db][db][open]negative_filter open failed" );
         return false;
     }
-    LOG_INFO ( "[md5db][db][open]fast_conflicts opened OK" );
+    if ( m_inner->m_filter.is_open () )
+    {
+        if ( ! m_inner->m_filter.build ( m_inner->m_buckets ) )
+        {
+            LOG_ERROR ( "[md5db][db][open]negative_filter build failed" );
+            return false;
+        }
+        LOG_INFO ( "[md5db][db][open]negative_filter built OK" );
+    }
 
-    // conflict
-    if ( ! m_inner->m_conflicts.open ( DB_CONFLICT_DIR, HUSTDB_CONFIG ) )
+    // content compactor
+    if ( ! m_inner->m_compactor.open ( HUSTDB_CONFIG, m_inner->m_buckets, m_inner->m_contents ) )
+    {
+        LOG_ERROR ( "[md5db][db][open]content_compactor open failed" );
+        return false;
+    }
+    LOG_INFO ( "[md5db][db][open]content_compactor opened OK" );
+
+    // fullkey grow ahead
+    if ( ! m_inner->m_grower.open ( HUSTDB_CONFIG, m_inner->m_buckets ) )
     {
-        LOG_ERROR ( "[md5db][db][open]conflicts open failed" );
+        LOG_ERROR ( "[md5db][db][open]fullkey_grower open failed" );
+        return false;
+    }
+
+    // warmup
+    if ( ! m_inner->m_warmup.open ( m_inner->m_buckets, warmup ) )
+    {
+        LOG_ERROR ( "[md5db][db][open]warmup open failed" );
         return false;
     }
-    LOG_INFO ( "[md5db][db][open]conflicts opened OK" );
 
     // binlog
     if ( ! m_inner->m_binlog.init ( m_db->get_store_conf ().db_binlog_thread_count,
@@ -343,13 +411,89 @@ bool kv_md5db_t::open ( )
 
     m_inner->m_binlog.set_callback ( binlog_done_callback );
 
-    m_ok = true;
+    m_open_ms = G_APPTOOL->get_tick_count () - start;
+    m_ok      = true;
 
-    LOG_INFO ( "[md5db][db][open]open OK" );
+    LOG_INFO ( "[md5db][db][open][open_threads=%d][elapsed_ms=%u]open OK", open_threads, m_open_ms );
 
     return true;
 }
 
+bool kv_md5db_t::open_component (
+                                  void *  ctx,
+                                  size_t  i
+                                  )
+{
+    kv_md5db_t * self  = ( kv_md5db_t * ) ctx;
+    inner *      in    = self->m_inner;
+
+    switch ( i )
+    {
+        case 0:
+            // data
+            if ( ! in->m_data.open ( ) )
+            {
+                LOG_ERROR ( "[md5db][db][open]kvs open failed" );
+                return false;
+            }
+            LOG_INFO ( "[md5db][db][open]kvs opened OK" );
+            return true;
+
+        case 1:
+            // content
+            if ( ! in->m_contents.open ( DB_CONTENTS_DIR, HUSTDB_CONFIG ) )
+            {
+                LOG_ERROR ( "[md5db][db][open]contents open failed" );
+                return false;
+            }
+            LOG_INFO ( "[md5db][db][open]contents opened OK" );
+            return true;
+
+        case 2:
+            // bucket
+            if ( ! in->m_buckets.open ( DB_BUCKETS_DIR ) )
+            {
+                LOG_ERROR ( "[md5db][db][open]buckets open failed" );
+                return false;
+            }
+            LOG_INFO ( "[md5db][db][open]buckets opened OK" );
+            return true;
+
+        case 3:
+            // fullkey
+            if ( ! in->m_fullkeys.open ( DB_FULLKEY_DIR ) )
+            {
+                LOG_ERROR ( "[md5db][db][open]fullkeys create failed" );
+                return false;
+            }
+            LOG_INFO ( "[md5db][db][open]fullkeys opened OK" );
+            return true;
+
+        case 4:
+            // fast conflict, keeps the bucket pointer only
+            if ( ! in->m_fast_conflicts.open ( DB_FAST_CONFLICT_DIR, & in->m_buckets, HUSTDB_CONFIG ) )
+            {
+                LOG_ERROR ( "[md5db][db][open]fast_conflicts open failed" );
+                return false;
+            }
+            LOG_INFO ( "[md5db][db][open]fast_conflicts opened OK" );
+            return true;
+
+        case 5:
+            // conflict
+            if ( ! in->m_conflicts.open ( DB_CONFLICT_DIR, HUSTDB_CONFIG ) )
+            {
+                LOG_ERROR ( "[md5db][db][open]conflicts open failed" );
+                return false;
+            }
+            LOG_INFO ( "[md5db][db][open]conflicts opened OK" );
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 int kv_md5db_t::flush ( )
 {
     return EINVAL;
@@ -463,7 +607,8 @@ int kv_md5db_t::add_data_to_content_db (
                                          const char *                val,
                                          size_t                      val_len,
                                          conn_ctxt_t                 conn,
-                                         item_ctxt_t * &             ctxt
+                                         item_ctxt_t * &             ctxt,
+                                         bool                        staged
                                          )
 {
     int            r        = 0;
@@ -531,7 +676,8 @@ int kv_md5db_t::add_data_to_content_db (
                                              "",
                                              0,
                                              tmp_ctxt->wttl,
-                                             ctxt );
+                                             ctxt,
+                                             staged ? tmp_ctxt->stage : NULL );
     }
 
     if ( unlikely ( 0 != r ) )
@@ -628,7 +774,8 @@ int kv_md5db_t::set_data_to_kv_array (
                                        const char *                val,
                                        size_t                      val_len,
                                        conn_ctxt_t                 conn,
-                                       item_ctxt_t * &             ctxt
+                                       item_ctxt_t * &             ctxt,
+                                       bool                        staged
                                        )
 {
     int            r        = 0;
@@ -669,7 +816,8 @@ int kv_md5db_t::set_data_to_kv_array (
                                             tmp_ctxt->value.c_str (),
                                             tmp_ctxt->value.size (),
                                             tmp_ctxt->wttl,
-                                            ctxt );
+                                            ctxt,
+                                            staged ? tmp_ctxt->stage : NULL );
     }
 
     if ( 0 != r )
@@ -837,6 +985,13 @@ int kv_md5db_t::new_data (
     bool            b            = false;
     block_id_t      block_id;
     uint32_t        user_version = version;
+    query_ctxt_t *  tmp_ctxt     = & m_inner->m_query_ctxts[ conn.worker_id ];
+
+    // a staged record is ingested at sequence 0 below every other write of
+    // the data file: it takes a block_id that has never been used, which no
+    // older record or tombstone can shadow
+    bool            staged       = ( NULL != tmp_ctxt->stage &&
+                                     0 == tmp_ctxt->wttl );
 
     version = 0;
 
@@ -856,7 +1011,7 @@ int kv_md5db_t::new_data (
     }
     {
         scope_perf_target_t perf ( m_perf_fullkey_write );
-        b = fullkey->write ( inner_key, inner_key_len, user_key, user_key_len, block_id );
+        b = fullkey->write ( inner_key, inner_key_len, user_key, user_key_len, block_id, staged );
     }
     if ( unlikely ( ! b ) )
     {
@@ -873,7 +1028,8 @@ int kv_md5db_t::new_data (
                                      val,
                                      val_len,
                                      conn,
-                                     ctxt );
+                                     ctxt,
+                                     staged );
     }
     else
     {
@@ -883,7 +1039,8 @@ int kv_md5db_t::new_data (
                                    val,
                                    val_len,
                                    conn,
-                                   ctxt );
+                                   ctxt,
+                                   staged );
     }
     if ( unlikely ( 0 != r ) )
     {
@@ -1397,6 +1554,11 @@ int kv_md5db_t::exists (
     const char * new_user_key = get_inner_tbkey ( user_key, new_user_key_len, conn );
     user_key_to_inner ( inner_key, new_user_key, new_user_key_len );
 
+    if ( ! m_inner->m_filter.may_contain ( inner_key, inner_key_len ) )
+    {
+        return ENOENT;
+    }
+
     bucket_t & bucket = m_inner->m_buckets.get_bucket ( inner_key, inner_key_len );
 
     bucket_data_item_t * item = NULL;
@@ -1472,6 +1634,11 @@ int kv_md5db_t::exists (
             break;
     }
 
+    if ( ENOENT == r )
+    {
+        m_inner->m_filter.false_positive ();
+    }
+
     return r;
 }
 
@@ -1550,6 +1717,12 @@ int kv_md5db_t::get (
         return r;
     }
 
+    if ( ! m_inner->m_filter.may_contain ( inner_key, inner_key_len ) )
+    {
+        PERF_GET_NOT_FOUND ();
+        return ENOENT;
+    }
+
     // get bucket
     bucket_t & bucket = m_inner->m_buckets.get_bucket ( inner_key, inner_key_len );
 
@@ -1670,6 +1843,11 @@ int kv_md5db_t::get (
             break;
     }
 
+    if ( ENOENT == r )
+    {
+        m_inner->m_filter.false_positive ();
+    }
+
     return r;
 }
 
@@ -2130,7 +2308,8 @@ int kv_md5db_t::del_inner (
         return r;
     }
 
-    scope_wlock_t lock ( bucket.get_lock () );
+    scope_wlock_t  lock  ( bucket.get_lock () );
+    bucket_touch_t touch ( bucket, item );
 
     switch ( item->type () )
     {
@@ -2386,6 +2565,9 @@ int kv_md5db_t::put_inner (
     const char * new_user_key = get_inner_tbkey ( user_key, new_user_key_len, conn );
     user_key_to_inner ( inner_key, new_user_key, new_user_key_len );
 
+    // added before the bucket is written, a key is never filtered once put returns
+    m_inner->m_filter.add ( inner_key, inner_key_len );
+
     query_ctxt_t * tmp_ctxt;
     tmp_ctxt = & m_inner->m_query_ctxts[ conn.worker_id ];
 
@@ -2429,7 +2611,8 @@ int kv_md5db_t::put_inner (
         return r;
     }
 
-    scope_wlock_t lock ( bucket.get_lock () );
+    scope_wlock_t  lock  ( bucket.get_lock () );
+    bucket_touch_t touch ( bucket, item );
 
     switch ( item->type () )
     {
@@ -2810,11 +2993,43 @@ void kv_md5db_t::info (
 
     ss << "\"fast_conflictdb\":{";
     m_inner->m_fast_conflicts.info ( ss );
-    ss << "}";
+    ss << "},";
+
+    ss << "\"negative_filter\":{";
+    m_inner->m_filter.info ( ss );
+    ss << "},";
+
+    ss << "\"contentdb\":{";
+    m_inner->m_contents.info ( ss );
+    m_inner->m_compactor.info ( ss );
+    ss << "},";
+
+    m_inner->m_grower.info ( ss );
+    ss << ",";
+
+    hustdb::hw_counters_info ( ss );
+    ss << ",";
+
+    m_inner->m_warmup.info ( ss );
 
     ss << "}";
 }
 
+bool kv_md5db_t::ready (
+                         std::stringstream & ss
+                         )
+{
+    if ( NULL == m_inner )
+    {
+        return false;
+    }
+
+    ss << "\"open_ms\":" << m_open_ms << ",";
+    m_inner->m_warmup.info ( ss );
+
+    return m_ok && m_inner->m_warmup.done ();
+}
+
 uint32_t kv_md5db_t::md5db_info_by_key (
                                          const char *                key,
                                          size_t                      key_len,
@@ -2983,6 +3198,51 @@ int kv_md5db_t::export_db_mem (
     return 0;
 }
 
+int kv_md5db_t::table_keys (
+                             conn_ctxt_t                 conn,
+                             item_ctxt_t * &             ctxt,
+                             export_record_callback_t    callback,
+                             void *                      callback_param,
+                             std::vector< std::string > & keys,
+                             std::vector< std::string > & vals
+                             )
+{
+    ctxt    = NULL;
+
+    query_ctxt_t * tmp_ctxt;
+    tmp_ctxt = & m_inner->m_query_ctxts[ conn.worker_id ];
+
+    int r = 0;
+    if ( tmp_ctxt->tbkey.empty () )
+    {
+        LOG_ERROR ( "[md5db][db][table_keys]table empty" );
+        return EFAULT;
+    }
+
+    r = m_inner->m_data.hash_with_md5db ( tmp_ctxt->tbkey.c_str (), tmp_ctxt->table_len, conn, ctxt );
+    if ( r < 0 )
+    {
+        LOG_ERROR ( "[md5db][db][table_keys]hash failed" );
+        return r;
+    }
+
+    ctxt->key = tmp_ctxt->tbkey;
+
+    struct export_cb_param_t * cb_pm = ( struct export_cb_param_t * ) callback_param;
+    cb_pm->db                        = this;
+    cb_pm->block_id                  = NULL;
+
+    r = m_inner->m_data.table_keys ( conn, ctxt, export_md5db_record_callback, cb_pm, keys, vals );
+    if ( 0 != r )
+    {
+        LOG_ERROR ( "[md5db][db][table_keys][r=%d]table_keys", 
+                    r );
+        return r;
+    }
+
+    return 0;
+}
+
 int kv_md5db_t::ttl_scan (
                            export_record_callback_t callback,
                            void * callback_param
@@ -3229,6 +3489,22 @@ i_kv_t * kv_md5db_t::get_conflict ( int file_id )
     return c->get_kv ();
 }
 
+int kv_md5db_t::get_data_count ( )
+{
+    return m_inner ? ( int ) m_inner->m_data.file_count () : 0;
+}
+
+i_kv_t * kv_md5db_t::get_data ( int file_id )
+{
+    if ( unlikely ( NULL == m_inner ) )
+    {
+        LOG_ERROR ( "[md5db][db][get_data]inner is NULL" );
+        return NULL;
+    }
+
+    return m_inner->m_data.get_file ( ( unsigned int ) file_id );
+}
+
 void kv_md5db_t::set_inner_ttl (
                                  uint32_t                ttl,
                                  conn_ctxt_t             conn
@@ -3237,6 +3513,32 @@ void kv_md5db_t::set_inner_ttl (
     m_inner->m_query_ctxts[ conn.worker_id ].wttl = ttl;
 }
 
+void kv_md5db_t::set_inner_stage (
+                                   i_kv_stage_t *        stage,
+                                   conn_ctxt_t           conn
+                                   )
+{
+    m_inner->m_query_ctxts[ conn.worker_id ].stage = stage;
+}
+
+// the compactor and the grower write under the bucket locks as well, and
+// the leveldb work is paused by the caller
+void kv_md5db_t::freeze ( )
+{
+    for ( size_t i = 0; i < m_inner->m_buckets.size (); ++ i )
+    {
+        m_inner->m_buckets.item ( i ).get_lock ().wlock ();
+    }
+}
+
+void kv_md5db_t::thaw ( )
+{
+    for ( size_t i = m_inner->m_buckets.size (); i > 0; -- i )
+    {
+        m_inner->m_buckets.item ( i - 1 ).get_lock ().wunlock ();
+    }
+}
+
 uint32_t kv_md5db_t::get_inner_ttl (
                                      conn_ctxt_t         conn
                                      )
@@ -3329,6 +3631,10 @@ static void export_md5db_record_callback (
 
     if ( db->get_inner ()->m_contents.is_open () )
     {
+        // the compactor moves contents and rewrites content ids under the
+        // bucket write lock, so read both under the read lock
+        scope_rlock_t lock ( db->get_inner ()->m_buckets.item ( block_id->bucket_id () ).get_lock () );
+
         md5db::content_id_t content_id;
         bool b = db->get_inner ()->m_fullkeys.item ( block_id->bucket_id () ).get_content_id ( * block_id, content_id );
         if ( ! b || content_id.data_len () == 0 )
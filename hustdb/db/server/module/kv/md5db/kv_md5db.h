@@ -55,6 +55,10 @@ public:
                         std::stringstream & ss
                         );
 
+    virtual bool ready (
+                         std::stringstream & ss
+                         );
+
     virtual int get_user_file_count ( );
 
     bool ok ( )
@@ -128,6 +132,15 @@ public:
                                 void * callback_param
                                 );
 
+    virtual int table_keys (
+                             conn_ctxt_t conn,
+                             item_ctxt_t * & ctxt,
+                             export_record_callback_t callback,
+                             void * callback_param,
+                             std::vector< std::string > & keys,
+                             std::vector< std::string > & vals
+                             );
+
     virtual int ttl_scan (
                            export_record_callback_t callback,
                            void * callback_param
@@ -161,6 +174,12 @@ public:
                                     int file_id
                                     );
 
+    virtual int get_data_count ( );
+
+    virtual i_kv_t * get_data (
+                                int file_id
+                                );
+
     virtual void set_inner_ttl (
                                  uint32_t ttl,
                                  conn_ctxt_t conn
@@ -170,6 +189,15 @@ public:
                                      conn_ctxt_t conn
                                      );
 
+    virtual void set_inner_stage (
+                                   i_kv_stage_t * stage,
+                                   conn_ctxt_t conn
+                                   );
+
+    virtual void freeze ( );
+
+    virtual void thaw ( );
+
     virtual void set_inner_table (
                                    const char * table,
                                    size_t table_len,
@@ -228,6 +256,12 @@ public:
 
 private:
 
+    // parallel_run job, opens one of the independent md5db components
+    static bool open_component (
+                                 void * ctx,
+                                 size_t i
+                                 );
+
     void user_key_to_inner (
                              void * inner_key,
                              const void * user_key,
@@ -359,7 +393,8 @@ private:
                                const char * val,
                                size_t val_len,
                                conn_ctxt_t conn,
-                               item_ctxt_t * & ctxt
+                               item_ctxt_t * & ctxt,
+                               bool staged = false
                                );
 
     int set_data_to_content_db (
@@ -381,7 +416,8 @@ private:
                                  const char * val,
                                  size_t val_len,
                                  conn_ctxt_t conn,
-                                 item_ctxt_t * & ctxt
+                                 item_ctxt_t * & ctxt,
+                                 bool staged = false
                                  );
 
     int new_data (
@@ -442,6 +478,8 @@ private:
     inner *       m_inner;
     hustdb_t *    m_db;
     bool          m_ok;
+    uint32_t      m_inner_hash;
+    uint32_t      m_open_ms;
 
     perf_target_t m_perf_put_ok;
     perf_target_t m_perf_put_fail;
@@ -0,0 +1,353 @@
+#include "negative_filter.h"
+#include "bucket_array.h"
+#include "fullkey.h"
+#include "../../perf_target.h"
+#include "../../utils/parallel.h"
+#include <math.h>
+
+namespace md5db
+{
+
+// 512 bits per block, one cache line
+#define FILTER_BLOCK_WORDS      8
+#define FILTER_BLOCK_BITS       512
+#define FILTER_PROBES           8
+#define FILTER_SLOT_MARK        0x5A
+
+    struct negative_filter_t::build_ctx_t
+    {
+        negative_filter_t * self;
+        bucket_array_t *    buckets;
+    };
+
+    static inline uint64_t filter_mix ( uint64_t k )
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+
+        return k;
+    }
+
+    negative_filter_t::negative_filter_t ( )
+    : m_blocks ( NULL )
+    , m_block_count ( 0 )
+    , m_key_count ( 0 )
+    , m_slot_count ( 0 )
+    , m_count_filtered ( 0 )
+    , m_count_passed ( 0 )
+    , m_count_false_positive ( 0 )
+    {
+    }
+
+    negative_filter_t::~ negative_filter_t ( )
+    {
+        close ();
+    }
+
+    void negative_filter_t::close ( )
+    {
+        if ( m_blocks )
+        {
+            free ( m_blocks );
+            m_blocks = NULL;
+        }
+
+        m_block_count = 0;
+        m_key_count   = 0;
+        m_slot_count  = 0;
+    }
+
+    bool negative_filter_t::open (
+                                   const char * storage_conf
+                                   )
+    {
+        ini_t * ini = NULL;
+
+        ini = G_APPINI->ini_create ( storage_conf );
+        if ( NULL == ini )
+        {
+            LOG_ERROR ( "[md5db][negative_filter][open][file=%s]open failed", 
+                        storage_conf );
+            return false;
+        }
+
+        int filter_m = G_APPINI->ini_get_int ( ini, "md5db", "negative_filter", 0 );
+        G_APPINI->ini_destroy ( ini );
+
+        if ( filter_m < 0 || filter_m > 65536 )
+        {
+            LOG_ERROR ( "[md5db][negative_filter][open][negative_filter=%d]invalid size", 
+                        filter_m );
+            return false;
+        }
+
+        if ( 0 == filter_m )
+        {
+            return true;
+        }
+
+        return open ( ( size_t ) filter_m * 1024 * 1024 );
+    }
+
+    bool negative_filter_t::open (
+                                   size_t bytes
+                                   )
+    {
+        close ();
+
+        size_t block_count = bytes / ( FILTER_BLOCK_WORDS * sizeof ( uint64_t ) );
+        if ( 0 == block_count )
+        {
+            LOG_ERROR ( "[md5db][negative_filter][open][bytes=%u]too small", 
+                        ( unsigned int ) bytes );
+            return false;
+        }
+
+        void * p = NULL;
+        if ( 0 != posix_memalign ( & p, 64, block_count * FILTER_BLOCK_WORDS * sizeof ( uint64_t ) ) )
+        {
+            LOG_ERROR ( "[md5db][negative_filter][open][bytes=%u]bad_alloc", 
+                        ( unsigned int ) bytes );
+            return false;
+        }
+        memset ( p, 0, block_count * FILTER_BLOCK_WORDS * sizeof ( uint64_t ) );
+
+        m_blocks      = ( uint64_t * ) p;
+        m_block_count = block_count;
+
+        return true;
+    }
+
+    void negative_filter_t::slot_key (
+                                       const unsigned char *   inner_key,
+                                       unsigned char           rsp[ 16 ]
+                                       ) const
+    {
+        // bucket file + 20 bits bucket index, see bucket_t::key_to_item
+        rsp[ 0 ] = inner_key[ 0 ];
+        rsp[ 1 ] = inner_key[ 1 ];
+        rsp[ 2 ] = inner_key[ 2 ];
+        rsp[ 3 ] = inner_key[ 3 ] & 0xF0;
+        memset ( & rsp[ 4 ], FILTER_SLOT_MARK, 12 );
+    }
+
+    void negative_filter_t::add_hash (
+                                       const unsigned char * key
+                                       )
+    {
+        uint64_t lo;
+        uint64_t hi;
+        memcpy ( & lo, key, sizeof ( lo ) );
+        memcpy ( & hi, key + 8, sizeof ( hi ) );
+
+        uint64_t h      = filter_mix ( lo ^ filter_mix ( hi ) );
+        uint64_t * blk  = & m_blocks[ ( h % m_block_count ) * FILTER_BLOCK_WORDS ];
+        uint32_t a      = ( uint32_t ) ( h >> 32 );
+        uint32_t b      = ( uint32_t ) filter_mix ( h ) | 1;
+
+        for ( int i = 0; i < FILTER_PROBES; ++ i )
+        {
+            uint32_t bit = ( a + i * b ) % FILTER_BLOCK_BITS;
+            __sync_fetch_and_or ( & blk[ bit / 64 ], ( uint64_t ) 1 << ( bit % 64 ) );
+        }
+    }
+
+    bool negative_filter_t::test_hash (
+                                        const unsigned char * key
+                                        ) const
+    {
+        uint64_t lo;
+        uint64_t hi;
+        memcpy ( & lo, key, sizeof ( lo ) );
+        memcpy ( & hi, key + 8, sizeof ( hi ) );
+
+        uint64_t h            = filter_mix ( lo ^ filter_mix ( hi ) );
+        const uint64_t * blk  = & m_blocks[ ( h % m_block_count ) * FILTER_BLOCK_WORDS ];
+        uint32_t a            = ( uint32_t ) ( h >> 32 );
+        uint32_t b            = ( uint32_t ) filter_mix ( h ) | 1;
+
+        for ( int i = 0; i < FILTER_PROBES; ++ i )
+        {
+            uint32_t bit = ( a + i * b ) % FILTER_BLOCK_BITS;
+            if ( 0 == ( blk[ bit / 64 ] & ( ( uint64_t ) 1 << ( bit % 64 ) ) ) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool negative_filter_t::build (
+                                    bucket_array_t & buckets
+                                    )
+    {
+        if ( ! is_open () )
+        {
+            return true;
+        }
+
+        // buckets are scanned in parallel, add_hash sets its bits atomically
+        build_ctx_t ctx = { this, & buckets };
+        if ( ! hustdb::parallel_run ( buckets.size (), 0, negative_filter_t::build_bucket, & ctx ) )
+        {
+            return false;
+        }
+
+        LOG_INFO ( "[md5db][negative_filter][build][keys=%u][slots=%u][fpr=%f]", 
+                   ( unsigned int ) m_key_count, ( unsigned int ) m_slot_count, estimated_fpr () );
+
+        return true;
+    }
+
+    bool negative_filter_t::build_bucket (
+                                           void *  arg,
+                                           size_t  b
+                                           )
+    {
+        build_ctx_t *       ctx    = ( build_ctx_t * ) arg;
+        negative_filter_t * self   = ctx->self;
+        bucket_t &          bucket = ctx->buckets->item ( b );
+        fullkey_t *         fk     = bucket.get_fullkey ();
+        size_t              count  = bucket.item_count ();
+
+        unsigned char key[ 16 ];
+
+        for ( size_t i = 0; i < count; ++ i )
+        {
+            bucket_data_item_t * item = bucket.item_at ( i );
+            if ( unlikely ( NULL == item ) )
+            {
+                LOG_ERROR ( "[md5db][negative_filter][build][bucket=%d]bucket not open", 
+                            ( int ) b );
+                return false;
+            }
+
+            key[ 0 ] = ( unsigned char ) b;
+            key[ 1 ] = ( unsigned char ) ( ( i >> 12 ) & 0xFF );
+            key[ 2 ] = ( unsigned char ) ( ( i >> 4 ) & 0xFF );
+            key[ 3 ] = ( unsigned char ) ( ( i & 0x0F ) << 4 );
+
+            switch ( item->type () )
+            {
+                case BUCKET_DIRECT_DATA:
+                    if ( NULL == fk || ! fk->get ( item->m_block_id, ( char * ) & key[ 3 ] ) )
+                    {
+                        LOG_ERROR ( "[md5db][negative_filter][build][bucket=%d][index=%d]fullkey.get failed", 
+                                    ( int ) b, ( int ) i );
+                        return false;
+                    }
+                    self->add ( key, sizeof ( key ) );
+                    break;
+
+                case BUCKET_CONFLICT_DATA:
+                    // the keys sharing this index live in fast_conflict / conflictdb,
+                    // mark the whole index instead of enumerating them
+                    memset ( & key[ 4 ], FILTER_SLOT_MARK, 12 );
+                    self->add_hash ( key );
+                    __sync_fetch_and_add ( & self->m_slot_count, 1 );
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        return true;
+    }
+
+    void negative_filter_t::add (
+                                  const void * inner_key,
+                                  size_t inner_key_len
+                                  )
+    {
+        if ( ! is_open () || inner_key_len < 16 )
+        {
+            return;
+        }
+
+        add_hash ( ( const unsigned char * ) inner_key );
+        __sync_fetch_and_add ( & m_key_count, 1 );
+    }
+
+    bool negative_filter_t::may_contain (
+                                          const void * inner_key,
+                                          size_t inner_key_len
+                                          )
+    {
+        if ( ! is_open () || inner_key_len < 16 )
+        {
+            return true;
+        }
+
+        if ( test_hash ( ( const unsigned char * ) inner_key ) )
+        {
+            __sync_fetch_and_add ( & m_count_passed, 1 );
+            return true;
+        }
+
+        if ( m_slot_count > 0 )
+        {
+            unsigned char key[ 16 ];
+            slot_key ( ( const unsigned char * ) inner_key, key );
+            if ( test_hash ( key ) )
+            {
+                __sync_fetch_and_add ( & m_count_passed, 1 );
+                return true;
+            }
+        }
+
+        __sync_fetch_and_add ( & m_count_filtered, 1 );
+        return false;
+    }
+
+    void negative_filter_t::false_positive ( )
+    {
+        if ( is_open () )
+        {
+            __sync_fetch_and_add ( & m_count_false_positive, 1 );
+        }
+    }
+
+    double negative_filter_t::estimated_fpr ( ) const
+    {
+        if ( 0 == m_block_count )
+        {
+            return 1.0;
+        }
+
+        double bits = ( double ) m_block_count * FILTER_BLOCK_BITS;
+        double n    = ( double ) ( m_key_count + m_slot_count );
+
+        return pow ( 1.0 - exp ( - ( double ) FILTER_PROBES * n / bits ), FILTER_PROBES );
+    }
+
+    void negative_filter_t::info (
+                                   std::stringstream & ss
+                                   )
+    {
+        int    file_id = 0;
+        size_t bytes   = m_block_count * FILTER_BLOCK_WORDS * sizeof ( uint64_t );
+        size_t keys    = m_key_count;
+        size_t slots   = m_slot_count;
+
+        // parts per million, observed over the lookups of missing keys only:
+        // the filtered ones and the false positives, not the passed hits
+        size_t estimated_fpr_ppm = ( size_t ) ( estimated_fpr () * 1000000 );
+        size_t negatives         = m_count_filtered + m_count_false_positive;
+        size_t observed_fpr_ppm  = negatives > 0 ? m_count_false_positive * 1000000 / negatives : 0;
+
+        write_single_count ( ss, file_id, "bytes",              bytes );
+        write_single_count ( ss, file_id, "keys",               keys );
+        write_single_count ( ss, file_id, "slots",              slots );
+        write_single_count ( ss, file_id, "estimated_fpr_ppm",  estimated_fpr_ppm );
+        write_single_count ( ss, file_id, "observed_fpr_ppm",   observed_fpr_ppm );
+        write_single_count ( ss, file_id, "filtered",           m_count_filtered );
+        write_single_count ( ss, file_id, "passed",             m_count_passed );
+        write_single_count ( ss, file_id, "false_positive",     m_count_false_positive, true );
+    }
+
+} // namespace md5db
@@ -0,0 +1,103 @@
+#ifndef _md5db_negative_filter_h_
+#define _md5db_negative_filter_h_
+
+#include "db_stdinc.h"
+#include "db_lib.h"
+#include "../../base.h"
+#include <sstream>
+
+namespace md5db
+{
+
+    class bucket_array_t;
+
+    // cache line blocked bloom filter over inner keys, answers definite
+    // misses of get / exists without touching bucket, fullkey or conflict
+    // files. deletes are not applied, stale bits are dropped on restart.
+    class negative_filter_t
+    {
+    public:
+        negative_filter_t ( );
+        ~negative_filter_t ( );
+
+        bool open (
+                    const char * storage_conf
+                    );
+
+        void close ( );
+
+        bool is_open ( ) const
+        {
+            return NULL != m_blocks;
+        }
+
+        bool build (
+                     bucket_array_t & buckets
+                     );
+
+        void add (
+                   const void * inner_key,
+                   size_t inner_key_len
+                   );
+
+        bool may_contain (
+                           const void * inner_key,
+                           size_t inner_key_len
+                           );
+
+        void false_positive ( );
+
+        void info (
+                    std::stringstream & ss
+                    );
+
+    private:
+
+        bool open (
+                    size_t bytes
+                    );
+
+        struct build_ctx_t;
+
+        // parallel_run job, adds the keys of bucket b
+        static bool build_bucket (
+                                   void * ctx,
+                                   size_t b
+                                   );
+
+        void add_hash (
+                        const unsigned char * key
+                        );
+
+        bool test_hash (
+                         const unsigned char * key
+                         ) const;
+
+        void slot_key (
+                        const unsigned char * inner_key,
+                        unsigned char rsp[ 16 ]
+                        ) const;
+
+        double estimated_fpr ( ) const;
+
+    private:
+
+        uint64_t *  m_blocks;
+        size_t      m_block_count;
+
+        size_t      m_key_count;
+        size_t      m_slot_count;
+
+        size_t      m_count_filtered;
+        size_t      m_count_passed;
+        size_t      m_count_false_positive;
+
+    private:
+        // disable
+        negative_filter_t ( const negative_filter_t & );
+        const negative_filter_t & operator= ( const negative_filter_t & );
+    };
+
+} // namespace md5db
+
+#endif
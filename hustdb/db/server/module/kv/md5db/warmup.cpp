@@ -0,0 +1,193 @@
+#include "warmup.h"
+#include "bucket_array.h"
+#include "fullkey.h"
+#include <sys/mman.h>
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ      22
+#endif
+
+namespace md5db
+{
+
+// bytes populated per bucket lock hold
+#define WARMUP_CHUNK            1048576
+
+    static void populate_range ( const byte_t * ptr, size_t len )
+    {
+        // linux 5.14+, older kernels say EINVAL and get their pages touched
+        if ( 0 == madvise ( ( void * ) ptr, len, MADV_POPULATE_READ ) )
+        {
+            return;
+        }
+
+        volatile byte_t sum = 0;
+        for ( size_t i = 0; i < len; i += 4096 )
+        {
+            sum += ptr[ i ];
+        }
+    }
+
+    warmup_t::warmup_t ( )
+    : m_buckets ( NULL )
+    , m_tid ( )
+    , m_running ( false )
+    , m_stop ( false )
+    , m_done ( true )
+    , m_total_bytes ( 0 )
+    , m_populated_bytes ( 0 )
+    , m_elapsed_ms ( 0 )
+    {
+    }
+
+    warmup_t::~ warmup_t ( )
+    {
+        close ();
+    }
+
+    void warmup_t::close ( )
+    {
+        if ( ! m_running )
+        {
+            return;
+        }
+
+        m_stop = true;
+        pthread_join ( m_tid, NULL );
+        m_running = false;
+    }
+
+    bool warmup_t::open (
+                          bucket_array_t &    buckets,
+                          bool                enable
+                          )
+    {
+        m_buckets = & buckets;
+
+        if ( ! enable )
+        {
+            m_done = true;
+            return true;
+        }
+
+        m_total_bytes = 0;
+        for ( size_t b = 0; b < buckets.size (); ++ b )
+        {
+            bucket_t & bucket = buckets.item ( b );
+
+            scope_rlock_t lock ( bucket.get_lock () );
+            m_total_bytes += bucket.get_map ().ptr_len;
+            if ( bucket.get_fullkey () )
+            {
+                m_total_bytes += bucket.get_fullkey ()->get_map ().ptr_len;
+            }
+        }
+
+        m_populated_bytes = 0;
+        m_stop            = false;
+        m_done            = false;
+        if ( 0 != pthread_create ( & m_tid, NULL, warmup_t::warmup_thread, this ) )
+        {
+            LOG_ERROR ( "[md5db][warmup][open]pthread_create failed" );
+            m_done = true;
+            return false;
+        }
+        m_running = true;
+
+        return true;
+    }
+
+    void * warmup_t::warmup_thread (
+                                     void * arg
+                                     )
+    {
+        warmup_t * obj = ( warmup_t * ) arg;
+        if ( obj )
+        {
+            obj->run ();
+        }
+        return 0;
+    }
+
+    bool warmup_t::populate (
+                              size_t      b,
+                              bool        fullkey,
+                              size_t &    offset
+                              )
+    {
+        bucket_t & bucket = m_buckets->item ( b );
+
+        // a fullkey file may be remapped by a put while we are unlocked,
+        // so ptr and len are taken again for every chunk
+        scope_rlock_t lock ( bucket.get_lock () );
+
+        const fmap_t * m = & bucket.get_map ();
+        if ( fullkey )
+        {
+            if ( NULL == bucket.get_fullkey () )
+            {
+                return false;
+            }
+            m = & bucket.get_fullkey ()->get_map ();
+        }
+
+        if ( NULL == m->ptr || offset >= m->ptr_len )
+        {
+            return false;
+        }
+
+        size_t len = m->ptr_len - offset;
+        if ( len > WARMUP_CHUNK )
+        {
+            len = WARMUP_CHUNK;
+        }
+
+        populate_range ( m->ptr + offset, len );
+
+        offset            += len;
+        m_populated_bytes += len;
+
+        return true;
+    }
+
+    void warmup_t::run ( )
+    {
+        unsigned int start = G_APPTOOL->get_tick_count ();
+
+        for ( size_t b = 0; b < m_buckets->size () && ! m_stop; ++ b )
+        {
+            size_t offset = 0;
+            while ( ! m_stop && populate ( b, false, offset ) )
+            {
+            }
+
+            offset = 0;
+            while ( ! m_stop && populate ( b, true, offset ) )
+            {
+            }
+        }
+
+        if ( m_stop )
+        {
+            return;
+        }
+
+        m_elapsed_ms = G_APPTOOL->get_tick_count () - start;
+        m_done       = true;
+
+        LOG_INFO ( "[md5db][warmup][run][bytes=%llu][elapsed_ms=%llu]done",
+                   ( unsigned long long ) m_populated_bytes, ( unsigned long long ) m_elapsed_ms );
+    }
+
+    void warmup_t::info (
+                          std::stringstream & ss
+                          )
+    {
+        ss << "\"warmup\":{"
+            "\"done\":" << ( m_done ? "true" : "false" ) << ","
+            "\"populated_bytes\":" << m_populated_bytes << ","
+            "\"total_bytes\":" << m_total_bytes << ","
+            "\"elapsed_ms\":" << m_elapsed_ms << "}";
+    }
+
+} // namespace md5db
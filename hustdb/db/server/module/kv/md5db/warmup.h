@@ -0,0 +1,76 @@
+#ifndef _md5db_warmup_h_
+#define _md5db_warmup_h_
+
+#include "db_stdinc.h"
+#include "db_lib.h"
+#include "../../base.h"
+#include <sstream>
+#include <pthread.h>
+
+namespace md5db
+{
+
+    class bucket_array_t;
+
+    // the bucket and fullkey maps are faulted in on first use; when enabled
+    // a background thread populates them chunk by chunk under the bucket
+    // read lock, so the first requests after a restart do not pay for it
+    class warmup_t
+    {
+    public:
+        warmup_t ( );
+        ~warmup_t ( );
+
+        bool open (
+                    bucket_array_t & buckets,
+                    bool enable
+                    );
+
+        void close ( );
+
+        // true once every map has been populated ( or warm-up is disabled )
+        bool done ( ) const
+        {
+            return m_done;
+        }
+
+        void info (
+                    std::stringstream & ss
+                    );
+
+    private:
+
+        static void * warmup_thread (
+                                      void * arg
+                                      );
+
+        void run ( );
+
+        bool populate (
+                        size_t b,
+                        bool fullkey,
+                        size_t & offset
+                        );
+
+    private:
+
+        bucket_array_t *    m_buckets;
+
+        pthread_t           m_tid;
+        bool                m_running;
+        volatile bool       m_stop;
+        volatile bool       m_done;
+
+        uint64_t            m_total_bytes;
+        volatile uint64_t   m_populated_bytes;
+        uint64_t            m_elapsed_ms;
+
+    private:
+        // disable
+        warmup_t ( const warmup_t & );
+        const warmup_t & operator= ( const warmup_t & );
+    };
+
+} // namespace md5db
+
+#endif
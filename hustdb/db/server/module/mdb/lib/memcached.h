@@ -66,6 +66,13 @@ extern "C"
 #endif
 
     /* Slab sizing definitions. */
+/* backing of the slab arena, [md5db] l2_cache.hugepage, same as mdb.h */
+#ifndef MDB_HUGEPAGE_NONE
+#define MDB_HUGEPAGE_NONE           0
+#define MDB_HUGEPAGE_TRANSPARENT    1
+#define MDB_HUGEPAGE_EXPLICIT       2
+#endif
+
 #define POWER_SMALLEST 1
 #define POWER_LARGEST  256 /* actual cap is 255 */
 #define CHUNK_ALIGN_BYTES 8
@@ -415,7 +422,7 @@ extern "C"
     int process_touch_command ( char *key, size_t nkey, int32_t exptime_int );
     int process_get_command ( char *key, size_t nkey, char *dst, int *len );
     int process_update_command ( char *key, size_t nkey, uint32_t flags, char *value, size_t nbytes, int32_t exptime_int, int comm );
-    int mdb_init ( size_t size );
+    int mdb_init ( size_t size, int hugepage );
     unsigned int get_maxbytes ( );
     void set_current_time ( time_t timestamp );
 
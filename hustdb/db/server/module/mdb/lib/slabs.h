@@ -7,8 +7,10 @@
     size equal to the previous slab's chunk size times this factor.
     3rd argument specifies if the slab allocator should allocate all memory
     up front (if true), or allocate memory in chunks as it is needed (if false)
+    4th argument maps the memory as one arena on huge pages, see MDB_HUGEPAGE_*;
+    the arena is only faulted in as slabs are carved from it
  */
-void slabs_init ( const size_t limit, const double factor, const bool prealloc );
+void slabs_init ( const size_t limit, const double factor, const bool prealloc, const int hugepage );
 
 
 /**
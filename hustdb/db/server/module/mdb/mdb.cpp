@@ -19,7 +19,8 @@ mdb_t::~ mdb_t ( )
 
 bool mdb_t::open (
                    int count,
-                   int size
+                   int size,
+                   int hugepage
                    )
 {
     try
@@ -45,7 +46,7 @@ bool mdb_t::open (
         return true;
     }
 
-    if ( mdb_init ( size ) != 0 )
+    if ( mdb_init ( size, hugepage ) != 0 )
     {
         return false;
     }
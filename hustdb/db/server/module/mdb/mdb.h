@@ -9,6 +9,11 @@
 #define MDB_KEY_LEN 255
 #define MDB_VAL_LEN 1048571
 
+// backing of the slab arena, [md5db] l2_cache.hugepage
+#define MDB_HUGEPAGE_NONE           0
+#define MDB_HUGEPAGE_TRANSPARENT    1
+#define MDB_HUGEPAGE_EXPLICIT       2
+
 class mdb_t
 {
     
@@ -19,9 +24,11 @@ public:
 
     void kill_me ( );
 
+    // hugepage: MDB_HUGEPAGE_NONE, _TRANSPARENT or _EXPLICIT
     bool open (
                 int count,
-                int size
+                int size,
+                int hugepage
                 );
 
     void close ( );
@@ -415,7 +415,7 @@ enum store_item_type do_store_item ( item *it, int comm, const uint32_t hv )
     return stored;
 }
 
-int mdb_init ( size_t size )
+int mdb_init ( size_t size, int hugepage )
 {
     enum hashfunc_type hash_type = JENKINS_HASH;
     bool preallocate = false;
@@ -436,7 +436,7 @@ int mdb_init ( size_t size )
     {
         preallocate = true;
     }
-    slabs_init (settings.maxbytes, settings.factor, preallocate);
+    slabs_init (settings.maxbytes, settings.factor, preallocate, hugepage);
 
     memcached_thread_init ();
 
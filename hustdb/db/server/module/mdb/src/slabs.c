@@ -12,6 +12,7 @@
 #include <sys/stat.h>
 #include <sys/signal.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <errno.h>
@@ -93,18 +94,83 @@ unsigned int slabs_clsid ( const size_t size )
     return res;
 }
 
+#define SLABS_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/*
+ * Maps the slab arena on huge pages. Explicit huge pages come from the
+ * hugetlbfs pool and fall back to transparent ones when the pool is short;
+ * a transparent arena is aligned on a huge page so that every 2MB of it
+ * can be backed by one.
+ */
+static void *slabs_arena_alloc ( const size_t len, const int hugepage )
+{
+    size_t size = ( len + SLABS_HUGEPAGE_SIZE - 1 ) / SLABS_HUGEPAGE_SIZE * SLABS_HUGEPAGE_SIZE;
+    size_t head;
+    char *p;
+
+#ifdef MAP_HUGETLB
+    if ( hugepage == MDB_HUGEPAGE_EXPLICIT )
+    {
+        p = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, - 1, 0);
+        if ( p != MAP_FAILED )
+        {
+            return p;
+        }
+        fprintf (stderr, "Failed to map %lu bytes of huge pages: %s\n"
+                 "Will use transparent huge pages\n", ( unsigned long ) size, strerror (errno));
+    }
+#endif
+
+    p = mmap (NULL, size + SLABS_HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, - 1, 0);
+    if ( p == MAP_FAILED )
+    {
+        return NULL;
+    }
+
+    head = ( SLABS_HUGEPAGE_SIZE - ( size_t ) p % SLABS_HUGEPAGE_SIZE ) % SLABS_HUGEPAGE_SIZE;
+    if ( head )
+    {
+        munmap (p, head);
+    }
+    munmap (p + head + size, SLABS_HUGEPAGE_SIZE - head);
+    p += head;
+
+#ifdef MADV_HUGEPAGE
+    if ( madvise (p, size, MADV_HUGEPAGE) != 0 )
+    {
+        fprintf (stderr, "Failed to enable transparent huge pages: %s\n", strerror (errno));
+    }
+#endif
+
+    return p;
+}
+
 /**
  * Determines the chunk sizes and initializes the slab class descriptors
  * accordingly.
  */
-void slabs_init ( const size_t limit, const double factor, const bool prealloc )
+void slabs_init ( const size_t limit, const double factor, const bool prealloc, const int hugepage )
 {
     int i = POWER_SMALLEST - 1;
     unsigned int size = sizeof (item ) + settings.chunk_size;
 
     mem_limit = limit;
 
-    if ( prealloc )
+    if ( hugepage != MDB_HUGEPAGE_NONE )
+    {
+        mem_base = slabs_arena_alloc (mem_limit, hugepage);
+        if ( mem_base != NULL )
+        {
+            mem_current = mem_base;
+            mem_avail = mem_limit;
+        }
+        else
+        {
+            fprintf (stderr, "Warning: Failed to map the slab arena on huge pages.\n"
+                     "Will allocate in smaller chunks\n");
+        }
+    }
+    else if ( prealloc )
     {
         /* Allocate everything in a big chunk with malloc */
         mem_base = malloc (mem_limit);
@@ -0,0 +1,697 @@
+#include "load_stage.h"
+#include "../base.h"
+#include <algorithm>
+#include <sys/uio.h>
+
+// min-heap of the runs by their current key
+struct run_greater_t
+{
+    template< typename T >
+    bool operator() ( const T * a, const T * b ) const
+    {
+        int r = a->key.compare ( b->key );
+        // a key found in several runs is taken from the first one
+        return r > 0 || ( 0 == r && a > b );
+    }
+};
+
+load_stage_t::load_stage_t (
+                             size_t buffer_bytes
+                             )
+: m_buffer ( buffer_bytes )
+, m_block ( buffer_bytes / 16 )
+, m_bytes ( 0 )
+, m_files ( )
+, m_seq ( 0 )
+, m_staged ( 0 )
+, m_tables ( 0 )
+, m_error ( 0 )
+{
+    // a small buffer still holds several blocks before it is spilled
+    if ( m_block > LOAD_BLOCK_BYTES )
+    {
+        m_block = LOAD_BLOCK_BYTES;
+    }
+}
+
+load_stage_t::~ load_stage_t ( )
+{
+    for ( size_t i = 0; i < m_files.size (); ++ i )
+    {
+        release ( m_files[ i ] );
+        delete m_files[ i ];
+    }
+    m_files.clear ();
+}
+
+void load_stage_t::release (
+                             file_t * file
+                             )
+{
+    if ( file->log >= 0 )
+    {
+        close ( file->log );
+        file->log = -1;
+    }
+
+    for ( size_t i = 0; i < file->blocks.size (); ++ i )
+    {
+        free ( file->blocks[ i ] );
+    }
+    file->blocks.clear ();
+    file->block_used = 0;
+
+    std::vector< record_t > ( ).swap ( file->records );
+
+    m_bytes   -= file->bytes;
+    file->bytes = 0;
+
+    for ( size_t i = 0; i < file->runs.size (); ++ i )
+    {
+        unlink ( file->runs[ i ].c_str () );
+    }
+    file->runs.clear ();
+}
+
+bool load_stage_t::record_less (
+                                 const record_t & a,
+                                 const record_t & b
+                                 )
+{
+    uint32_t len = a.key_len < b.key_len ? a.key_len : b.key_len;
+    int r = memcmp ( a.data, b.data, len );
+    if ( 0 != r )
+    {
+        return r < 0;
+    }
+    return a.key_len < b.key_len;
+}
+
+std::string load_stage_t::file_path (
+                                      file_t * file,
+                                      const char * name
+                                      )
+{
+    std::string path = file->kv->get_path ();
+    if ( ! path.empty () && S_PATH_SEP_C != path[ path.size () - 1 ] )
+    {
+        path += S_PATH_SEP;
+    }
+    path += name;
+    return path;
+}
+
+load_stage_t::file_t * load_stage_t::create (
+                                              i_kv_t * kv
+                                              )
+{
+    file_t * file = new file_t ();
+    file->kv         = kv;
+    file->refused    = true;
+    file->logged     = false;
+    file->log        = -1;
+    file->block_used = 0;
+    file->bytes      = 0;
+
+    try
+    {
+        m_files.push_back ( file );
+    }
+    catch ( ... )
+    {
+        delete file;
+        throw;
+    }
+
+    return file;
+}
+
+load_stage_t::file_t * load_stage_t::find (
+                                            i_kv_t * kv
+                                            )
+{
+    for ( size_t i = 0; i < m_files.size (); ++ i )
+    {
+        if ( m_files[ i ]->kv == kv )
+        {
+            return m_files[ i ];
+        }
+    }
+
+    file_t * file = create ( kv );
+
+    i_iterator_t * it = kv->iterator ();
+    if ( it )
+    {
+        it->seek_first ();
+        file->refused = it->valid () || 0 != it->status ();
+        it->kill_me ();
+    }
+
+    if ( file->refused )
+    {
+        LOG_INFO ( "[slow_task][load][file=%s]not empty, written as usual",
+                   kv->get_path () );
+        return file;
+    }
+
+    // a log left by a load that is not replayed yet belongs to that load
+    std::string path = file_path ( file, LOAD_LOG_NAME );
+    file->log = open ( path.c_str (), O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644 );
+    if ( file->log < 0 )
+    {
+        LOG_ERROR ( "[slow_task][load][file=%s][errno=%d]open failed, written as usual",
+                    path.c_str (), errno );
+        file->refused = true;
+        return file;
+    }
+    file->logged = true;
+
+    return file;
+}
+
+// a log record is [ key_len ][ val_len ][ key ][ val ] like a run, it is
+// written before the bucket points to the record
+int load_stage_t::log (
+                        file_t *        file,
+                        const char *    key,
+                        size_t          key_len,
+                        const char *    val,
+                        size_t          val_len
+                        )
+{
+    uint32_t lens[ 2 ] = { ( uint32_t ) key_len, ( uint32_t ) val_len };
+
+    struct iovec iov[ 3 ];
+    iov[ 0 ].iov_base = lens;
+    iov[ 0 ].iov_len  = sizeof ( lens );
+    iov[ 1 ].iov_base = ( void * ) key;
+    iov[ 1 ].iov_len  = key_len;
+    iov[ 2 ].iov_base = ( void * ) val;
+    iov[ 2 ].iov_len  = val_len;
+
+    ssize_t n = writev ( file->log, iov, 3 );
+    if ( n != ( ssize_t ) ( sizeof ( lens ) + key_len + val_len ) )
+    {
+        LOG_ERROR ( "[slow_task][load][file=%s][errno=%d]log write failed, written as usual",
+                    file->kv->get_path (), errno );
+        return EFAULT;
+    }
+
+    return 0;
+}
+
+int load_stage_t::add (
+                        i_kv_t *        kv,
+                        const char *    key,
+                        size_t          key_len,
+                        const char *    val,
+                        size_t          val_len
+                        )
+{
+    if ( unlikely ( 0 != m_error ) )
+    {
+        return m_error;
+    }
+
+    file_t * file = NULL;
+    try
+    {
+        file = find ( kv );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[slow_task][load]bad_alloc" );
+        return ENOMEM;
+    }
+
+    if ( file->refused )
+    {
+        return EEXIST;
+    }
+
+    int r = log ( file, key, key_len, val, val_len );
+    if ( 0 != r )
+    {
+        // the records taken so far are still ingested
+        file->refused = true;
+        return r;
+    }
+
+    return take ( file, key, key_len, val, val_len );
+}
+
+int load_stage_t::take (
+                         file_t *        file,
+                         const char *    key,
+                         size_t          key_len,
+                         const char *    val,
+                         size_t          val_len
+                         )
+{
+    try
+    {
+        size_t need = key_len + val_len;
+        if ( file->blocks.empty () || file->block_used + need > m_block )
+        {
+            size_t size = need > m_block ? need : m_block;
+            char * block = ( char * ) malloc ( size );
+            if ( NULL == block )
+            {
+                LOG_ERROR ( "[slow_task][load]bad_alloc" );
+                return ENOMEM;
+            }
+            file->blocks.push_back ( block );
+            file->block_used = 0;
+            file->bytes     += size;
+            m_bytes         += size;
+        }
+
+        char * p = file->blocks.back () + file->block_used;
+        memcpy ( p, key, key_len );
+        memcpy ( p + key_len, val, val_len );
+        file->block_used += need;
+
+        record_t record;
+        record.data    = p;
+        record.key_len = ( uint32_t ) key_len;
+        record.val_len = ( uint32_t ) val_len;
+        file->records.push_back ( record );
+
+        file->bytes += sizeof ( record_t );
+        m_bytes     += sizeof ( record_t );
+        ++ m_staged;
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[slow_task][load]bad_alloc" );
+        return ENOMEM;
+    }
+
+    if ( m_bytes > m_buffer )
+    {
+        file_t * largest = NULL;
+        for ( size_t i = 0; i < m_files.size (); ++ i )
+        {
+            if ( NULL == largest || m_files[ i ]->bytes > largest->bytes )
+            {
+                largest = m_files[ i ];
+            }
+        }
+
+        // the record is taken, a failed spill stops the staging of the next
+        m_error = spill ( largest );
+    }
+
+    return 0;
+}
+
+// a run is [ key_len ][ val_len ][ key ][ val ] in the order of the keys
+int load_stage_t::spill (
+                          file_t * file
+                          )
+{
+    char name[ 64 ];
+    snprintf ( name, sizeof ( name ), "load-%06u.run", ++ m_seq );
+    std::string path = file_path ( file, name );
+
+    std::sort ( file->records.begin (), file->records.end (), record_less );
+
+    FILE * fp = fopen ( path.c_str (), "wb" );
+    if ( NULL == fp )
+    {
+        LOG_ERROR ( "[slow_task][load][file=%s]fopen failed",
+                    path.c_str () );
+        return EFAULT;
+    }
+    file->runs.push_back ( path );
+
+    bool ok = true;
+    for ( size_t i = 0; ok && i < file->records.size (); ++ i )
+    {
+        const record_t & record = file->records[ i ];
+        uint32_t lens[ 2 ] = { record.key_len, record.val_len };
+        ok = ( 1 == fwrite ( lens, sizeof ( lens ), 1, fp ) ) &&
+             ( record.key_len + record.val_len == fwrite ( record.data, 1, record.key_len + record.val_len, fp ) );
+    }
+    if ( 0 != fclose ( fp ) )
+    {
+        ok = false;
+    }
+
+    if ( ! ok )
+    {
+        LOG_ERROR ( "[slow_task][load][file=%s]fwrite failed",
+                    path.c_str () );
+        return EFAULT;
+    }
+
+    for ( size_t i = 0; i < file->blocks.size (); ++ i )
+    {
+        free ( file->blocks[ i ] );
+    }
+    file->blocks.clear ();
+    file->block_used = 0;
+    file->records.resize ( 0 );
+
+    m_bytes    -= file->bytes;
+    file->bytes = 0;
+
+    return 0;
+}
+
+bool load_stage_t::next_record (
+                                 run_t & run
+                                 )
+{
+    uint32_t lens[ 2 ];
+    if ( 1 != fread ( lens, sizeof ( lens ), 1, run.fp ) )
+    {
+        return false;
+    }
+
+    run.key.resize ( lens[ 0 ] );
+    run.val.resize ( lens[ 1 ] );
+    if ( ( lens[ 0 ] > 0 && 1 != fread ( & run.key[ 0 ], lens[ 0 ], 1, run.fp ) ) ||
+         ( lens[ 1 ] > 0 && 1 != fread ( & run.val[ 0 ], lens[ 1 ], 1, run.fp ) )
+        )
+    {
+        LOG_ERROR ( "[slow_task][load]record truncated" );
+        return false;
+    }
+
+    return true;
+}
+
+int load_stage_t::write_table (
+                                file_t *                        file,
+                                i_kv_builder_t * &              builder,
+                                std::vector< std::string > &    tables,
+                                const char *                    key,
+                                size_t                          key_len,
+                                const char *                    val,
+                                size_t                          val_len
+                                )
+{
+    if ( NULL == builder )
+    {
+        char name[ 64 ];
+        snprintf ( name, sizeof ( name ), "load-%06u.ldb", ++ m_seq );
+
+        builder = file->kv->builder ( name );
+        if ( NULL == builder )
+        {
+            return EFAULT;
+        }
+        tables.push_back ( name );
+    }
+
+    int r = builder->add ( key, ( unsigned int ) key_len, val, ( unsigned int ) val_len );
+    if ( 0 != r )
+    {
+        return r;
+    }
+
+    if ( builder->file_size () >= LOAD_TABLE_BYTES )
+    {
+        r = builder->finish ();
+        builder->kill_me ();
+        builder = NULL;
+        ++ m_tables;
+    }
+
+    return r;
+}
+
+int load_stage_t::build (
+                          file_t * file
+                          )
+{
+    int                         r           = 0;
+    i_kv_builder_t *            builder     = NULL;
+    std::vector< std::string >  tables;
+    std::vector< run_t * >      heap;
+
+    if ( ! file->runs.empty () && ! file->records.empty () )
+    {
+        r = spill ( file );
+        if ( 0 != r )
+        {
+            return r;
+        }
+    }
+
+    if ( file->runs.empty () )
+    {
+        std::sort ( file->records.begin (), file->records.end (), record_less );
+
+        for ( size_t i = 0; 0 == r && i < file->records.size (); ++ i )
+        {
+            const record_t & record = file->records[ i ];
+            if ( i > 0 && ! record_less ( file->records[ i - 1 ], record ) )
+            {
+                continue;
+            }
+
+            r = write_table ( file, builder, tables,
+                              record.data, record.key_len,
+                              record.data + record.key_len, record.val_len );
+        }
+    }
+    else
+    {
+        run_t *     runs = new run_t [ file->runs.size () ];
+        std::string last;
+
+        for ( size_t i = 0; i < file->runs.size (); ++ i )
+        {
+            runs[ i ].fp = fopen ( file->runs[ i ].c_str (), "rb" );
+            if ( NULL == runs[ i ].fp )
+            {
+                LOG_ERROR ( "[slow_task][load][file=%s]fopen failed",
+                            file->runs[ i ].c_str () );
+                r = EFAULT;
+                continue;
+            }
+            if ( next_record ( runs[ i ] ) )
+            {
+                heap.push_back ( & runs[ i ] );
+            }
+        }
+        std::make_heap ( heap.begin (), heap.end (), run_greater_t () );
+
+        bool first = true;
+        while ( 0 == r && ! heap.empty () )
+        {
+            std::pop_heap ( heap.begin (), heap.end (), run_greater_t () );
+            run_t * run = heap.back ();
+
+            if ( first || run->key != last )
+            {
+                r = write_table ( file, builder, tables,
+                                  run->key.c_str (), run->key.size (),
+                                  run->val.c_str (), run->val.size () );
+                last  = run->key;
+                first = false;
+            }
+
+            if ( next_record ( * run ) )
+            {
+                std::push_heap ( heap.begin (), heap.end (), run_greater_t () );
+            }
+            else
+            {
+                heap.pop_back ();
+            }
+        }
+
+        for ( size_t i = 0; i < file->runs.size (); ++ i )
+        {
+            if ( runs[ i ].fp )
+            {
+                fclose ( runs[ i ].fp );
+            }
+        }
+        delete [] runs;
+    }
+
+    if ( builder )
+    {
+        if ( 0 == r )
+        {
+            r = builder->finish ();
+            ++ m_tables;
+        }
+        builder->kill_me ();
+        builder = NULL;
+    }
+
+    if ( 0 == r )
+    {
+        r = file->kv->ingest ( tables );
+    }
+
+    if ( 0 != r )
+    {
+        for ( size_t i = 0; i < tables.size (); ++ i )
+        {
+            unlink ( file_path ( file, tables[ i ].c_str () ).c_str () );
+        }
+    }
+
+    return r;
+}
+
+int load_stage_t::finish ( )
+{
+    int r = 0;
+
+    for ( size_t i = 0; i < m_files.size (); ++ i )
+    {
+        file_t * file = m_files[ i ];
+
+        int e = 0;
+        if ( ! file->records.empty () || ! file->runs.empty () )
+        {
+            try
+            {
+                e = build ( file );
+            }
+            catch ( ... )
+            {
+                e = ENOMEM;
+            }
+        }
+        if ( 0 != e )
+        {
+            LOG_ERROR ( "[slow_task][load][file=%s][r=%d]ingest failed, %s kept for the replay",
+                        file->kv->get_path (), e, LOAD_LOG_NAME );
+            r = e;
+        }
+
+        release ( file );
+
+        if ( 0 == e && file->logged )
+        {
+            unlink ( file_path ( file, LOAD_LOG_NAME ).c_str () );
+            file->logged = false;
+        }
+    }
+
+    return r;
+}
+
+// the runs and tables of a load that stopped, the renamed tables are not in
+// the manifest and leveldb removes them itself
+void load_stage_t::remove_temps (
+                                  const std::string & dir
+                                  )
+{
+    DIR * d = opendir ( dir.c_str () );
+    if ( NULL == d )
+    {
+        return;
+    }
+
+    struct dirent * e;
+    while ( NULL != ( e = readdir ( d ) ) )
+    {
+        if ( 0 == strncmp ( e->d_name, "load-", 5 ) )
+        {
+            std::string path = dir;
+            if ( ! path.empty () && S_PATH_SEP_C != path[ path.size () - 1 ] )
+            {
+                path += S_PATH_SEP;
+            }
+            path += e->d_name;
+            unlink ( path.c_str () );
+        }
+    }
+
+    closedir ( d );
+}
+
+int load_stage_t::replay_file (
+                                i_kv_t * kv
+                                )
+{
+    file_t *    file = create ( kv );
+    std::string path = file_path ( file, LOAD_LOG_NAME );
+    run_t       run;
+
+    run.fp = fopen ( path.c_str (), "rb" );
+    if ( NULL == run.fp )
+    {
+        return 0;
+    }
+
+    LOG_INFO ( "[slow_task][load][file=%s]replaying",
+               path.c_str () );
+
+    remove_temps ( kv->get_path () );
+    file->refused = false;
+    file->logged  = true;
+
+    // a record cut by the crash is not in the buckets yet
+    int r = 0;
+    while ( 0 == r && 0 == m_error && next_record ( run ) )
+    {
+        r = take ( file, run.key.c_str (), run.key.size (), run.val.c_str (), run.val.size () );
+    }
+    fclose ( run.fp );
+
+    if ( 0 == r )
+    {
+        r = m_error;
+    }
+    if ( 0 == r )
+    {
+        r = finish ();
+    }
+    if ( 0 != r )
+    {
+        LOG_ERROR ( "[slow_task][load][file=%s][r=%d]replay failed",
+                    path.c_str (), r );
+        return r;
+    }
+
+    LOG_INFO ( "[slow_task][load][file=%s][staged=%llu][tables=%u]replay OK",
+               path.c_str (), ( unsigned long long ) m_staged, m_tables );
+    return 0;
+}
+
+int load_stage_t::replay (
+                           i_server_kv_t *  storage,
+                           size_t           buffer_bytes
+                           )
+{
+    int r = 0;
+
+    for ( int i = 0; i < storage->get_data_count (); ++ i )
+    {
+        i_kv_t * kv = storage->get_data ( i );
+        if ( NULL == kv )
+        {
+            continue;
+        }
+
+        int e = 0;
+        try
+        {
+            load_stage_t stage ( buffer_bytes );
+            e = stage.replay_file ( kv );
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[slow_task][load][file=%s]replay exception",
+                        kv->get_path () );
+            e = ENOMEM;
+        }
+        if ( 0 != e )
+        {
+            r = e;
+        }
+    }
+
+    return r;
+}
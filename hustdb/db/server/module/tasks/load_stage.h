@@ -0,0 +1,180 @@
+#ifndef _load_stage_h_
+#define _load_stage_h_
+
+#include "db_stdinc.h"
+#include "i_server_kv.h"
+#include <vector>
+#include <string>
+
+// records of a table file are cut at this size
+#define LOAD_TABLE_BYTES              ( 64 * 1024 * 1024 )
+#define LOAD_BLOCK_BYTES              ( 4 * 1024 * 1024 )
+// the staged records of a data file, until its tables are ingested
+#define LOAD_LOG_NAME                 "load.log"
+
+// the stage of task_load_t.
+//
+// the records of every data file are kept in memory and sorted by key. once
+// the buffer is full the largest file is written out as a sorted run. finish
+// merges the runs of a file into table files of LOAD_TABLE_BYTES and ingests
+// them with i_kv_t::ingest. a data file that is not empty at its first
+// record is not staged: ingest would put its tables back to level 0, its
+// records are written as usual.
+//
+// the buckets point to a record once add returns, so add appends it to the
+// load.log of the data file first. the log is removed once the tables of
+// the file are ingested, replay ingests the logs left by a crash or by a
+// failed ingest when the storage opens
+class load_stage_t : public i_kv_stage_t
+{
+public:
+
+    load_stage_t (
+                   size_t buffer_bytes
+                   );
+
+    ~load_stage_t ( );
+
+    virtual int add (
+                      i_kv_t * file,
+                      const char * key,
+                      size_t key_len,
+                      const char * val,
+                      size_t val_len
+                      );
+
+    // every record taken must be ingested, the buckets point to them. the
+    // log of a file that fails is kept for replay
+    int finish ( );
+
+    // ingests the load.log left in the data files of the storage
+    static int replay (
+                        i_server_kv_t * storage,
+                        size_t buffer_bytes
+                        );
+
+    uint64_t staged ( ) const
+    {
+        return m_staged;
+    }
+
+    uint32_t tables ( ) const
+    {
+        return m_tables;
+    }
+
+private:
+
+    typedef struct record_s
+    {
+        const char *    data;
+        uint32_t        key_len;
+        uint32_t        val_len;
+    } record_t;
+
+    typedef struct file_s
+    {
+        i_kv_t *                    kv;
+        bool                        refused;
+        bool                        logged;
+        int                         log;
+        std::vector< char * >       blocks;
+        size_t                      block_used;
+        std::vector< record_t >     records;
+        size_t                      bytes;
+        std::vector< std::string >  runs;
+    } file_t;
+
+    typedef struct run_s
+    {
+        FILE *          fp;
+        std::string     key;
+        std::string     val;
+    } run_t;
+
+    file_t * find (
+                    i_kv_t * kv
+                    );
+
+    file_t * create (
+                      i_kv_t * kv
+                      );
+
+    std::string file_path (
+                            file_t * file,
+                            const char * name
+                            );
+
+    int log (
+              file_t * file,
+              const char * key,
+              size_t key_len,
+              const char * val,
+              size_t val_len
+              );
+
+    int take (
+               file_t * file,
+               const char * key,
+               size_t key_len,
+               const char * val,
+               size_t val_len
+               );
+
+    int replay_file (
+                      i_kv_t * kv
+                      );
+
+    int spill (
+                file_t * file
+                );
+
+    int build (
+                file_t * file
+                );
+
+    int write_table (
+                      file_t * file,
+                      i_kv_builder_t * & builder,
+                      std::vector< std::string > & tables,
+                      const char * key,
+                      size_t key_len,
+                      const char * val,
+                      size_t val_len
+                      );
+
+    static bool next_record (
+                              run_t & run
+                              );
+
+    static void remove_temps (
+                               const std::string & dir
+                               );
+
+    static bool record_less (
+                              const record_t & a,
+                              const record_t & b
+                              );
+
+    void release (
+                   file_t * file
+                   );
+
+private:
+
+    size_t                  m_buffer;
+    size_t                  m_block;
+    size_t                  m_bytes;
+    std::vector< file_t * > m_files;
+    uint32_t                m_seq;
+    uint64_t                m_staged;
+    uint32_t                m_tables;
+    int                     m_error;
+
+private:
+    // disable
+    load_stage_t ( const load_stage_t & );
+    const load_stage_t & operator= ( const load_stage_t & );
+};
+
+#endif
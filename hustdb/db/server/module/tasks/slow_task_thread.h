@@ -196,6 +196,8 @@ class task2_t
 {
 public:
 
+    virtual ~task2_t ( ) { }
+
     virtual void release ( ) = 0;
     virtual void process ( ) = 0;
 };
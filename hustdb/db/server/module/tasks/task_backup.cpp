@@ -0,0 +1,1130 @@
+#include "task_backup.h"
+#include "../base.h"
+#include "../kv/leveldb/ldb_env.h"
+#include "../utils/murmur3.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <map>
+
+#ifndef FICLONE
+#define FICLONE                       _IOW ( 0x94, 9, int )
+#endif
+
+typedef struct backup_digest_s
+{
+    uint64_t    h[ 2 ];
+} backup_digest_t;
+
+typedef std::vector< backup_digest_t >              backup_digests_t;
+typedef std::map< std::string, backup_digests_t >   backup_files_t;
+
+// the digests of the chunks of ./BACKUP/DATA as the last backup left them,
+// and the id of its manifest. only the slow task thread touches them
+static backup_files_t   g_backup_files;
+static uint64_t         g_backup_id     = 0;
+
+static bool backup_list (
+                          const std::string &           dir,
+                          std::vector< std::string > &  names
+                          )
+{
+    DIR * d = opendir ( dir.c_str () );
+    if ( NULL == d )
+    {
+        LOG_ERROR ( "[slow_task][backup][dir=%s][errno=%d]opendir failed",
+                    dir.c_str (), errno );
+        return false;
+    }
+
+    struct dirent * e;
+    while ( NULL != ( e = readdir ( d ) ) )
+    {
+        if ( 0 == strcmp ( e->d_name, "." ) || 0 == strcmp ( e->d_name, ".." ) )
+        {
+            continue;
+        }
+        names.push_back ( e->d_name );
+    }
+    closedir ( d );
+
+    return true;
+}
+
+static bool backup_ends_with (
+                               const std::string & s,
+                               const char *        suffix
+                               )
+{
+    size_t len = strlen ( suffix );
+    return s.size () >= len && 0 == s.compare ( s.size () - len, len, suffix );
+}
+
+// 0 where the manifest is missing or does not parse
+static uint64_t backup_manifest_id ( )
+{
+    char    buf[ 256 ];
+    FILE *  fp = fopen ( BACKUP_MANIFEST, "rb" );
+    if ( NULL == fp )
+    {
+        return 0;
+    }
+    size_t n = fread ( buf, 1, sizeof ( buf ) - 1, fp );
+    fclose ( fp );
+    buf[ n ] = '\0';
+
+    const char * p = strstr ( buf, "\"id\":" );
+    if ( NULL == p )
+    {
+        return 0;
+    }
+    return strtoull ( p + 5, NULL, 10 );
+}
+
+static int backup_clone (
+                          const char * src,
+                          const char * dst
+                          )
+{
+    int in = open ( src, O_RDONLY );
+    if ( in < 0 )
+    {
+        return errno;
+    }
+    int out = open ( dst, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( out < 0 )
+    {
+        int e = errno;
+        close ( in );
+        return e;
+    }
+
+    int r = 0;
+    if ( 0 != ioctl ( out, FICLONE, in ) )
+    {
+        r = errno;
+    }
+    close ( out );
+    close ( in );
+
+    if ( 0 != r )
+    {
+        unlink ( dst );
+    }
+    return r;
+}
+
+task_backup_t * task_backup_t::create (
+                                        uint64_t rate_limit
+                                        )
+{
+    task_backup_t * p = NULL;
+
+    try
+    {
+        p = new task_backup_t ( rate_limit );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[slow_task][backup]bad_alloc" );
+    }
+
+    return p;
+}
+
+void task_backup_t::release ( )
+{
+    delete this;
+}
+
+task_backup_t::task_backup_t (
+                               uint64_t rate_limit
+                               )
+: m_rate_limit ( rate_limit )
+, m_clone ( false )
+, m_seen ( )
+, m_pendings ( )
+, m_synceds ( )
+, m_trackeds ( )
+, m_tables ( )
+, m_unsynced ( )
+, m_pass_bytes ( 0 )
+, m_frozen_bytes ( 0 )
+, m_frozen_over ( false )
+, m_catch_up ( false )
+, m_throttle_start ( 0 )
+, m_throttle_bytes ( 0 )
+, m_files ( 0 )
+, m_bytes_read ( 0 )
+, m_bytes_written ( 0 )
+, m_linked ( 0 )
+{
+}
+
+task_backup_t::~ task_backup_t ( )
+{
+}
+
+void task_backup_t::process ( )
+{
+    bool ok = false;
+
+    try
+    {
+        ok = process_backup ();
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[slow_task][backup]bad_alloc" );
+    }
+
+    // whatever is left aside by a failed backup
+    for ( size_t i = 0; i < m_pendings.size (); ++ i )
+    {
+        unlink ( m_pendings[ i ].src.c_str () );
+    }
+    m_pendings.clear ();
+    hustdb::dirty_untrack ();
+
+    if ( ! ok )
+    {
+        LOG_ERROR ( "[slow_task][backup]backup failed, %s is incomplete",
+                    BACKUP_DATA_ROOT );
+    }
+}
+
+bool task_backup_t::process_backup ( )
+{
+    hustdb_t *  db      = ( hustdb_t * ) G_APPTOOL->get_hustdb ();
+    ldb_env_t * env     = ldb_env_t::current ();
+    uint32_t    start   = G_APPTOOL->get_tick_count ();
+
+    if ( ! G_APPTOOL->make_dir ( BACKUP_DATA_ROOT ) )
+    {
+        LOG_ERROR ( "[slow_task][backup][dir=%s]make_dir failed",
+                    BACKUP_DATA_ROOT );
+        return false;
+    }
+
+    // the backup is incomplete until the manifest is written again. the
+    // digests hold only for the files the last backup of this process left
+    uint64_t id = backup_manifest_id ();
+    if ( 0 != unlink ( BACKUP_MANIFEST ) && ENOENT != errno )
+    {
+        LOG_ERROR ( "[slow_task][backup][errno=%d]unlink %s failed",
+                    errno, BACKUP_MANIFEST );
+        return false;
+    }
+    if ( 0 == id || id != g_backup_id )
+    {
+        g_backup_files.clear ();
+    }
+    g_backup_id = 0;
+
+    std::string probe = std::string ( BACKUP_ROOT ) + S_PATH_SEP ".clone";
+    m_clone = 0 == backup_clone ( DB_DATA_ROOT S_PATH_SEP "meta_index" S_PATH_SEP "invariant", probe.c_str () );
+    unlink ( probe.c_str () );
+
+    // the bulk of the data without any lock, then again what was written
+    // meanwhile until that is little. a clone in the freeze makes it useless
+    uint32_t frozen = 0;
+    for ( int tries = 1; ; ++ tries )
+    {
+        m_throttle_start = G_APPTOOL->get_tick_count ();
+        m_throttle_bytes = 0;
+        uint64_t last = 0;
+        for ( int i = ( 1 == tries ? 0 : 1 ); ! m_clone && i < BACKUP_SYNC_PASSES; ++ i )
+        {
+            m_pass_bytes = 0;
+            if ( ! sync_dir ( DB_DATA_ROOT, BACKUP_DATA_ROOT, false ) )
+            {
+                return false;
+            }
+            if ( i > 0 && m_pass_bytes < BACKUP_FROZEN_BYTES / 4 )
+            {
+                break;
+            }
+            // the writes outpace the rate limit. a pass copies about what
+            // the writers wrote during the one before, it catches up faster
+            if ( 0 != last && m_pass_bytes * 4 > last * 3 )
+            {
+                m_catch_up = true;
+            }
+            last = m_pass_bytes;
+        }
+
+        // the leveldb work that a stalled write waits on still runs until
+        // the writers are stopped
+        if ( env )
+        {
+            env->pause ();
+        }
+        db->freeze ();
+        if ( env )
+        {
+            env->hold ();
+        }
+
+        bool ok = false;
+
+        frozen = G_APPTOOL->get_tick_count ();
+        m_seen.clear ();
+        m_files        = 0;
+        m_linked       = 0;
+        m_frozen_bytes = 0;
+        m_frozen_over  = false;
+        try
+        {
+            ok = sync_dir ( DB_DATA_ROOT, BACKUP_DATA_ROOT, true );
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[slow_task][backup]bad_alloc" );
+        }
+        frozen = G_APPTOOL->get_tick_count () - frozen;
+
+        if ( env )
+        {
+            env->release ();
+        }
+        db->thaw ();
+        if ( env )
+        {
+            env->resume ();
+        }
+
+        if ( ok )
+        {
+            break;
+        }
+
+        for ( size_t i = 0; i < m_pendings.size (); ++ i )
+        {
+            unlink ( m_pendings[ i ].src.c_str () );
+        }
+        m_pendings.clear ();
+
+        if ( ! m_frozen_over )
+        {
+            return false;
+        }
+        if ( tries >= BACKUP_FROZEN_TRIES )
+        {
+            LOG_ERROR ( "[slow_task][backup][tries=%d][frozen_ms=%u]more than %d bytes to read in every freeze",
+                        tries, frozen, BACKUP_FROZEN_BYTES );
+            return false;
+        }
+        LOG_INFO ( "[slow_task][backup][tries=%d][frozen_ms=%u]more than %d bytes to read in the freeze, synced again",
+                   tries, frozen, BACKUP_FROZEN_BYTES );
+    }
+
+    m_catch_up       = false;
+    m_throttle_start = G_APPTOOL->get_tick_count ();
+    m_throttle_bytes = 0;
+    for ( size_t i = 0; i < m_pendings.size (); ++ i )
+    {
+        const pending_t & pending = m_pendings[ i ];
+        if ( ! sync_file ( pending.src, pending.dst, pending.size, true ) )
+        {
+            return false;
+        }
+        unlink ( pending.src.c_str () );
+    }
+    m_pendings.clear ();
+
+    if ( ! flush_files () )
+    {
+        return false;
+    }
+
+    clean_dir ( BACKUP_DATA_ROOT );
+
+    return write_manifest ( frozen, G_APPTOOL->get_tick_count () - start );
+}
+
+bool task_backup_t::sync_dir (
+                               const std::string & src,
+                               const std::string & dst,
+                               bool                frozen
+                               )
+{
+    // a leveldb file is taken in the freeze, see snapshot_leveldb
+    if ( G_APPTOOL->is_file ( ( src + S_PATH_SEP "CURRENT" ).c_str () ) )
+    {
+        return frozen ? snapshot_leveldb ( src, dst ) : link_tables ( src, dst );
+    }
+
+    if ( ! G_APPTOOL->make_dir ( dst.c_str () ) )
+    {
+        LOG_ERROR ( "[slow_task][backup][dir=%s]make_dir failed",
+                    dst.c_str () );
+        return false;
+    }
+    m_seen.insert ( dst );
+
+    std::vector< std::string > names;
+    if ( ! backup_list ( src, names ) )
+    {
+        return false;
+    }
+
+    for ( size_t i = 0; i < names.size (); ++ i )
+    {
+        std::string s = src + S_PATH_SEP + names[ i ];
+        std::string d = dst + S_PATH_SEP + names[ i ];
+
+        struct stat st;
+        if ( 0 != lstat ( s.c_str (), & st ) )
+        {
+            // removed since it was listed
+            continue;
+        }
+
+        if ( S_ISDIR ( st.st_mode ) )
+        {
+            if ( ! sync_dir ( s, d, frozen ) )
+            {
+                return false;
+            }
+        }
+        else if ( S_ISREG ( st.st_mode ) )
+        {
+            if ( frozen )
+            {
+                m_seen.insert ( d );
+                ++ m_files;
+            }
+
+            // tracked since its whole sync: the pages written since the
+            // last one
+            trackeds_t::iterator t = m_trackeds.find ( s );
+            if ( t != m_trackeds.end () && t->second == st.st_ino )
+            {
+                std::vector< uint64_t > pages;
+                if ( hustdb::dirty_take ( st.st_dev, st.st_ino, pages ) )
+                {
+                    if ( ! sync_pages ( s, d, pages, ! frozen ) )
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                m_trackeds.erase ( t );
+            }
+
+            synceds_t::iterator it = m_synceds.find ( s );
+            if ( it != m_synceds.end () &&
+                 it->second.mtime_sec == st.st_mtim.tv_sec &&
+                 it->second.mtime_nsec == st.st_mtim.tv_nsec &&
+                 it->second.size == st.st_size &&
+                 it->second.ino == st.st_ino
+                )
+            {
+                continue;
+            }
+
+            if ( frozen && m_clone && clone_file ( s, d ) )
+            {
+                continue;
+            }
+            // the pages written from now on are kept where the file has a
+            // writer that marks them
+            if ( ! frozen && hustdb::dirty_track ( st.st_dev, st.st_ino ) )
+            {
+                m_trackeds[ s ] = st.st_ino;
+            }
+            if ( ! sync_file ( s, d, ( uint64_t ) - 1, ! frozen ) )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// the tables never change once written, they are linked. the log and the
+// manifest are only appended to, they are linked aside and cut at their
+// size of now once the writers are back. the info log is left out
+bool task_backup_t::snapshot_leveldb (
+                                       const std::string & src,
+                                       const std::string & dst
+                                       )
+{
+    if ( ! G_APPTOOL->make_dir ( dst.c_str () ) )
+    {
+        LOG_ERROR ( "[slow_task][backup][dir=%s]make_dir failed",
+                    dst.c_str () );
+        return false;
+    }
+    m_seen.insert ( dst );
+
+    std::vector< std::string > names;
+    if ( ! backup_list ( src, names ) )
+    {
+        return false;
+    }
+
+    for ( size_t i = 0; i < names.size (); ++ i )
+    {
+        const std::string & name = names[ i ];
+        std::string         s    = src + S_PATH_SEP + name;
+        std::string         d    = dst + S_PATH_SEP + name;
+
+        struct stat st;
+        if ( 0 != lstat ( s.c_str (), & st ) || ! S_ISREG ( st.st_mode ) )
+        {
+            continue;
+        }
+
+        if ( 0 == name.compare ( 0, 3, "LOG" ) )
+        {
+            continue;
+        }
+
+        m_seen.insert ( d );
+        ++ m_files;
+
+        if ( "LOCK" == name )
+        {
+            int fd = open ( d.c_str (), O_WRONLY | O_CREAT, 0644 );
+            if ( fd < 0 )
+            {
+                LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]open failed",
+                            d.c_str (), errno );
+                return false;
+            }
+            close ( fd );
+            continue;
+        }
+
+        if ( backup_ends_with ( name, ".ldb" ) || backup_ends_with ( name, ".sst" ) )
+        {
+            if ( m_tables.find ( d ) != m_tables.end () )
+            {
+                continue;
+            }
+            if ( link_file ( s, d ) )
+            {
+                ++ m_linked;
+                continue;
+            }
+        }
+        else if ( backup_ends_with ( name, ".log" ) || 0 == name.compare ( 0, 9, "MANIFEST-" ) )
+        {
+            pending_t pending;
+            pending.src  = d + ".snap";
+            pending.dst  = d;
+            pending.size = ( uint64_t ) st.st_size;
+
+            unlink ( pending.src.c_str () );
+            if ( 0 == link ( s.c_str (), pending.src.c_str () ) )
+            {
+                m_pendings.push_back ( pending );
+                continue;
+            }
+        }
+
+        // CURRENT, and whatever could not be linked
+        if ( ! sync_file ( s, d, ( uint64_t ) - 1, false ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the tables before the freeze, it only takes those written since. a table
+// that can not be linked is copied, it never changes once written
+bool task_backup_t::link_tables (
+                                  const std::string & src,
+                                  const std::string & dst
+                                  )
+{
+    if ( ! G_APPTOOL->make_dir ( dst.c_str () ) )
+    {
+        LOG_ERROR ( "[slow_task][backup][dir=%s]make_dir failed",
+                    dst.c_str () );
+        return false;
+    }
+
+    std::vector< std::string > names;
+    if ( ! backup_list ( src, names ) )
+    {
+        return false;
+    }
+
+    for ( size_t i = 0; i < names.size (); ++ i )
+    {
+        const std::string & name = names[ i ];
+        std::string         s    = src + S_PATH_SEP + name;
+        std::string         d    = dst + S_PATH_SEP + name;
+
+        if ( ! backup_ends_with ( name, ".ldb" ) && ! backup_ends_with ( name, ".sst" ) )
+        {
+            continue;
+        }
+        if ( m_tables.find ( d ) != m_tables.end () || link_file ( s, d ) )
+        {
+            continue;
+        }
+
+        struct stat st;
+        struct stat copied;
+        if ( 0 != stat ( s.c_str (), & st ) )
+        {
+            // compacted since it was listed
+            continue;
+        }
+        if ( ! sync_file ( s, d, ( uint64_t ) - 1, true ) )
+        {
+            return false;
+        }
+        if ( 0 == stat ( d.c_str (), & copied ) && copied.st_size == st.st_size )
+        {
+            m_tables.insert ( d );
+        }
+    }
+
+    return true;
+}
+
+bool task_backup_t::clone_file (
+                                 const std::string & src,
+                                 const std::string & dst
+                                 )
+{
+    pending_t pending;
+    pending.src  = dst + ".snap";
+    pending.dst  = dst;
+    pending.size = ( uint64_t ) - 1;
+
+    int r = backup_clone ( src.c_str (), pending.src.c_str () );
+    if ( 0 != r )
+    {
+        LOG_INFO ( "[slow_task][backup][file=%s][errno=%d]clone failed, the files are synced in the freeze",
+                   src.c_str (), r );
+        m_clone = false;
+        return false;
+    }
+
+    m_pendings.push_back ( pending );
+    return true;
+}
+
+bool task_backup_t::link_file (
+                                const std::string & src,
+                                const std::string & dst
+                                )
+{
+    struct stat s;
+    struct stat d;
+    if ( 0 == stat ( src.c_str (), & s ) &&
+         0 == stat ( dst.c_str (), & d ) &&
+         s.st_dev == d.st_dev &&
+         s.st_ino == d.st_ino
+        )
+    {
+        // linked by an earlier backup
+        return true;
+    }
+
+    unlink ( dst.c_str () );
+    g_backup_files.erase ( dst );
+
+    return 0 == link ( src.c_str (), dst.c_str () );
+}
+
+// a chunk is written where it differs from the digest of the last backup,
+// or from the file found in its place where there is none
+bool task_backup_t::sync_file (
+                                const std::string & src,
+                                const std::string & dst,
+                                uint64_t            limit,
+                                bool                throttled
+                                )
+{
+    int in = open ( src.c_str (), O_RDONLY );
+    if ( in < 0 )
+    {
+        if ( ENOENT == errno && throttled )
+        {
+            // removed since it was listed, the freeze sees it
+            return true;
+        }
+        LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]open failed",
+                    src.c_str (), errno );
+        return false;
+    }
+
+    int out = open ( dst.c_str (), O_RDWR | O_CREAT, 0644 );
+    if ( out < 0 )
+    {
+        LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]open failed",
+                    dst.c_str (), errno );
+        close ( in );
+        return false;
+    }
+
+    // flushed first: the next write to a clean page, mapped or not, moves
+    // the mtime on. a file last written well before is not read again in
+    // the freeze while its mtime stays
+    time_t now = time ( NULL );
+    if ( throttled )
+    {
+        fdatasync ( in );
+    }
+
+    struct stat s;
+    struct stat d;
+    if ( 0 != fstat ( in, & s ) || 0 != fstat ( out, & d ) )
+    {
+        LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]fstat failed",
+                    src.c_str (), errno );
+        close ( out );
+        close ( in );
+        return false;
+    }
+
+    // never written through a link into ./DATA
+    if ( d.st_nlink > 1 )
+    {
+        close ( out );
+        unlink ( dst.c_str () );
+        g_backup_files.erase ( dst );
+        out = open ( dst.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if ( out < 0 )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]open failed",
+                        dst.c_str (), errno );
+            close ( in );
+            return false;
+        }
+        d.st_size = 0;
+    }
+
+    uint64_t size = ( uint64_t ) s.st_size;
+    if ( size > limit )
+    {
+        size = limit;
+    }
+
+    backup_digests_t &  digests = g_backup_files[ dst ];
+    std::string         buf ( BACKUP_CHUNK_BYTES, '\0' );
+    std::string         old ( BACKUP_CHUNK_BYTES, '\0' );
+    bool                written = false;
+    bool                ok      = true;
+    size_t              chunks  = 0;
+
+    for ( uint64_t off = 0; off < size; off += BACKUP_CHUNK_BYTES, ++ chunks )
+    {
+        size_t  len = ( size_t ) ( size - off < BACKUP_CHUNK_BYTES ? size - off : BACKUP_CHUNK_BYTES );
+        if ( ! throttled && m_frozen_bytes + 2 * len > BACKUP_FROZEN_BYTES )
+        {
+            m_frozen_over = true;
+            ok            = false;
+            break;
+        }
+
+        ssize_t n   = pread ( in, & buf[ 0 ], len, ( off_t ) off );
+        if ( n < 0 )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]pread failed",
+                        src.c_str (), errno );
+            ok = false;
+            break;
+        }
+        if ( ( size_t ) n < len )
+        {
+            // cut since the stat, only without the freeze
+            len  = ( size_t ) n;
+            size = off + len;
+            if ( 0 == len )
+            {
+                break;
+            }
+        }
+        m_bytes_read += len;
+        m_pass_bytes += len;
+
+        backup_digest_t digest;
+        MurmurHash3_x64_128 ( buf.data (), len, 0, & digest );
+
+        bool same = false;
+        if ( chunks < digests.size () )
+        {
+            same = 0 == memcmp ( & digests[ chunks ], & digest, sizeof ( digest ) );
+        }
+        else if ( off + len <= ( uint64_t ) d.st_size )
+        {
+            same = ( ssize_t ) len == pread ( out, & old[ 0 ], len, ( off_t ) off ) &&
+                   0 == memcmp ( old.data (), buf.data (), len );
+            m_bytes_read += len;
+            m_pass_bytes += len;
+        }
+
+        if ( ! same )
+        {
+            if ( ( ssize_t ) len != pwrite ( out, buf.data (), len, ( off_t ) off ) )
+            {
+                LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]pwrite failed",
+                            dst.c_str (), errno );
+                ok = false;
+                break;
+            }
+            written          = true;
+            m_bytes_written += len;
+        }
+
+        if ( chunks < digests.size () )
+        {
+            digests[ chunks ] = digest;
+        }
+        else
+        {
+            digests.push_back ( digest );
+        }
+
+        if ( throttled )
+        {
+            throttle ( same ? len : 2 * len );
+        }
+        else
+        {
+            m_frozen_bytes += same ? len : 2 * len;
+        }
+    }
+
+    if ( ok )
+    {
+        digests.resize ( chunks );
+        if ( ( uint64_t ) d.st_size != size )
+        {
+            if ( 0 != ftruncate ( out, ( off_t ) size ) )
+            {
+                LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]ftruncate failed",
+                            dst.c_str (), errno );
+                ok = false;
+            }
+            written = true;
+        }
+    }
+    else if ( ! m_frozen_over )
+    {
+        g_backup_files.erase ( dst );
+    }
+
+    // a whole copy leaves the page cache once written, a frozen one only
+    // after the freeze
+    if ( ok && written && throttled )
+    {
+        if ( 0 != fdatasync ( out ) )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]fdatasync failed",
+                        dst.c_str (), errno );
+            ok = false;
+        }
+        posix_fadvise ( out, 0, 0, POSIX_FADV_DONTNEED );
+    }
+    else if ( ok && written )
+    {
+        m_unsynced.insert ( dst );
+    }
+    if ( ok && throttled && ( uint64_t ) s.st_size == size && s.st_mtim.tv_sec + 2 < now )
+    {
+        synced_t & synced  = m_synceds[ src ];
+        synced.mtime_sec   = s.st_mtim.tv_sec;
+        synced.mtime_nsec  = s.st_mtim.tv_nsec;
+        synced.size        = s.st_size;
+        synced.ino         = s.st_ino;
+    }
+
+    close ( out );
+    close ( in );
+
+    return ok;
+}
+
+// the pages of a tracked file written since its last sync, dst holds the
+// rest already. they are copied as they are, the chunks they fall in lose
+// their digest: a zero digest, that no chunk has, is never the same
+bool task_backup_t::sync_pages (
+                                 const std::string &             src,
+                                 const std::string &             dst,
+                                 const std::vector< uint64_t > & pages,
+                                 bool                            throttled
+                                 )
+{
+    int in = open ( src.c_str (), O_RDONLY );
+    if ( in < 0 )
+    {
+        if ( ENOENT == errno && throttled )
+        {
+            return true;
+        }
+        LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]open failed",
+                    src.c_str (), errno );
+        return false;
+    }
+
+    int out = open ( dst.c_str (), O_WRONLY | O_CREAT, 0644 );
+    if ( out < 0 )
+    {
+        LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]open failed",
+                    dst.c_str (), errno );
+        close ( in );
+        return false;
+    }
+
+    struct stat s;
+    struct stat d;
+    if ( 0 != fstat ( in, & s ) || 0 != fstat ( out, & d ) )
+    {
+        LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]fstat failed",
+                    src.c_str (), errno );
+        close ( out );
+        close ( in );
+        return false;
+    }
+
+    uint64_t            size    = ( uint64_t ) s.st_size;
+    backup_digests_t &  digests = g_backup_files[ dst ];
+    std::string         buf ( BACKUP_CHUNK_BYTES, '\0' );
+    bool                written = false;
+    bool                ok      = true;
+
+    for ( size_t i = 0; i < pages.size (); )
+    {
+        // a run of pages, up to a chunk
+        size_t j = i + 1;
+        while ( j < pages.size () && pages[ j ] == pages[ j - 1 ] + 1 &&
+                ( j - i ) * DIRTY_PAGE_BYTES < BACKUP_CHUNK_BYTES
+               )
+        {
+            ++ j;
+        }
+
+        uint64_t off = pages[ i ] * DIRTY_PAGE_BYTES;
+        if ( off >= size )
+        {
+            break;
+        }
+        size_t len = ( size_t ) ( ( j - i ) * DIRTY_PAGE_BYTES );
+        if ( len > size - off )
+        {
+            len = ( size_t ) ( size - off );
+        }
+        i = j;
+
+        if ( ! throttled && m_frozen_bytes + 2 * len > BACKUP_FROZEN_BYTES )
+        {
+            m_frozen_over = true;
+            ok            = false;
+            break;
+        }
+
+        ssize_t n = pread ( in, & buf[ 0 ], len, ( off_t ) off );
+        if ( n < 0 )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]pread failed",
+                        src.c_str (), errno );
+            ok = false;
+            break;
+        }
+        if ( 0 == n )
+        {
+            // cut since the stat, only without the freeze
+            break;
+        }
+        len = ( size_t ) n;
+
+        if ( ( ssize_t ) len != pwrite ( out, buf.data (), len, ( off_t ) off ) )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]pwrite failed",
+                        dst.c_str (), errno );
+            ok = false;
+            break;
+        }
+        written          = true;
+        m_bytes_read    += len;
+        m_bytes_written += len;
+        m_pass_bytes    += len;
+
+        for ( uint64_t c = off / BACKUP_CHUNK_BYTES; c <= ( off + len - 1 ) / BACKUP_CHUNK_BYTES && c < digests.size (); ++ c )
+        {
+            memset ( & digests[ c ], 0, sizeof ( backup_digest_t ) );
+        }
+
+        if ( throttled )
+        {
+            throttle ( 2 * len );
+        }
+        else
+        {
+            m_frozen_bytes += 2 * len;
+        }
+    }
+
+    if ( ok && ( uint64_t ) d.st_size != size )
+    {
+        // the chunks it grew by have no digest either
+        digests.resize ( ( size_t ) ( ( size + BACKUP_CHUNK_BYTES - 1 ) / BACKUP_CHUNK_BYTES ) );
+        if ( 0 != ftruncate ( out, ( off_t ) size ) )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]ftruncate failed",
+                        dst.c_str (), errno );
+            ok = false;
+        }
+        written = true;
+    }
+    if ( ! ok && ! m_frozen_over )
+    {
+        g_backup_files.erase ( dst );
+    }
+
+    if ( ok && written )
+    {
+        m_unsynced.insert ( dst );
+    }
+
+    close ( out );
+    close ( in );
+
+    return ok;
+}
+
+// the files written by the syncs reach the disk once, after the freeze
+bool task_backup_t::flush_files ( )
+{
+    for ( std::set< std::string >::iterator it = m_unsynced.begin (); it != m_unsynced.end (); ++ it )
+    {
+        int fd = open ( it->c_str (), O_WRONLY );
+        if ( fd < 0 )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]open failed",
+                        it->c_str (), errno );
+            return false;
+        }
+        if ( 0 != fdatasync ( fd ) )
+        {
+            LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]fdatasync failed",
+                        it->c_str (), errno );
+            close ( fd );
+            return false;
+        }
+        posix_fadvise ( fd, 0, 0, POSIX_FADV_DONTNEED );
+        close ( fd );
+    }
+    m_unsynced.clear ();
+
+    return true;
+}
+
+// removes what ./DATA no longer has
+void task_backup_t::clean_dir (
+                                const std::string & dst
+                                )
+{
+    std::vector< std::string > names;
+    if ( ! backup_list ( dst, names ) )
+    {
+        return;
+    }
+
+    for ( size_t i = 0; i < names.size (); ++ i )
+    {
+        std::string d    = dst + S_PATH_SEP + names[ i ];
+        bool        seen = m_seen.find ( d ) != m_seen.end ();
+        struct stat st;
+
+        if ( 0 != lstat ( d.c_str (), & st ) )
+        {
+            continue;
+        }
+
+        if ( S_ISDIR ( st.st_mode ) )
+        {
+            clean_dir ( d );
+            if ( ! seen )
+            {
+                rmdir ( d.c_str () );
+            }
+        }
+        else if ( ! seen )
+        {
+            unlink ( d.c_str () );
+            g_backup_files.erase ( d );
+        }
+    }
+}
+
+bool task_backup_t::write_manifest (
+                                     uint32_t frozen_ms,
+                                     uint32_t elapsed_ms
+                                     )
+{
+    int year, month, day, hour, minute, second, ms;
+    G_APPTOOL->get_current_time ( & year, & month, & day, & hour, & minute, & second, & ms );
+
+    uint64_t    id  = ( ( uint64_t ) time ( NULL ) << 32 ) | G_APPTOOL->get_tick_count ();
+    std::string tmp = std::string ( BACKUP_MANIFEST ) + ".tmp";
+
+    FILE * fp = fopen ( tmp.c_str (), "wb" );
+    if ( NULL == fp )
+    {
+        LOG_ERROR ( "[slow_task][backup][file=%s]fopen failed",
+                    tmp.c_str () );
+        return false;
+    }
+
+    fprintf ( fp, "{\"id\":%llu,\"time\":\"%04d-%02d-%02d %02d:%02d:%02d\",\"files\":%llu,\"linked\":%llu,"
+              "\"bytes_read\":%llu,\"bytes_written\":%llu,\"frozen_ms\":%u,\"elapsed_ms\":%u}\n",
+              ( unsigned long long ) id, year, month, day, hour, minute, second,
+              ( unsigned long long ) m_files, ( unsigned long long ) m_linked,
+              ( unsigned long long ) m_bytes_read, ( unsigned long long ) m_bytes_written,
+              frozen_ms, elapsed_ms );
+
+    bool ok = 0 == fflush ( fp ) && 0 == fsync ( fileno ( fp ) );
+    if ( 0 != fclose ( fp ) )
+    {
+        ok = false;
+    }
+    if ( ! ok || 0 != rename ( tmp.c_str (), BACKUP_MANIFEST ) )
+    {
+        LOG_ERROR ( "[slow_task][backup][file=%s][errno=%d]write failed",
+                    BACKUP_MANIFEST, errno );
+        unlink ( tmp.c_str () );
+        return false;
+    }
+
+    g_backup_id = id;
+
+    LOG_INFO ( "[slow_task][backup][files=%llu][linked=%llu][read=%llu][written=%llu][frozen_ms=%u][elapsed_ms=%u]backup OK",
+               ( unsigned long long ) m_files, ( unsigned long long ) m_linked,
+               ( unsigned long long ) m_bytes_read, ( unsigned long long ) m_bytes_written,
+               frozen_ms, elapsed_ms );
+
+    return true;
+}
+
+// paces the bytes read and written out of the freeze at the rate limit,
+// but for the syncs that catch up with the writers
+void task_backup_t::throttle (
+                               uint64_t bytes
+                               )
+{
+    if ( 0 == m_rate_limit || m_catch_up )
+    {
+        return;
+    }
+
+    m_throttle_bytes += bytes;
+
+    uint64_t due     = m_throttle_bytes * 1000 / m_rate_limit;
+    uint32_t elapsed = G_APPTOOL->get_tick_count () - m_throttle_start;
+    if ( due > ( uint64_t ) elapsed + 10 )
+    {
+        G_APPTOOL->sleep_ms ( ( unsigned int ) ( due - elapsed ) );
+    }
+}
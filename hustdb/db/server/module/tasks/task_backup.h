@@ -0,0 +1,177 @@
+#ifndef _task_backup_h_
+#define _task_backup_h_
+
+#include "../hustdb.h"
+#include "../utils/dirty.h"
+#include "slow_task_thread.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#define BACKUP_ROOT                   "./BACKUP"
+#define BACKUP_DATA_ROOT              "./BACKUP/DATA"
+#define BACKUP_MANIFEST               "./BACKUP/backup.json"
+
+// files are compared and written in chunks of this size
+#define BACKUP_CHUNK_BYTES            ( 64 * 1024 )
+
+// the syncs without any lock stop once one reads less than a quarter of
+// BACKUP_FROZEN_BYTES, or after BACKUP_SYNC_PASSES of them
+#define BACKUP_SYNC_PASSES            8
+
+// bytes read and written in the freeze before it is given up, and how many
+// times the files are synced again without any lock and frozen once more
+#define BACKUP_FROZEN_BYTES           ( 256 * 1024 * 1024 )
+#define BACKUP_FROZEN_TRIES           3
+
+// a point in time copy of ./DATA in ./BACKUP/DATA, updated in place.
+//
+// the files are synced without any lock until a sync reads little, then
+// hustdb_t::freeze stops the writers and the leveldb work is paused while
+// they are synced again: a chunk is written only where its digest differs
+// from the one written last. the bucket, fullkey, content, free bitmap and
+// fast conflict files of md5db are tracked from their first sync on, the
+// later syncs read only the pages written since ( see dirty.h ). another
+// file is read again where it was modified since it was flushed by an
+// earlier sync. the tables of a leveldb file are hard linked ( or copied )
+// before the freeze, the freeze links the tables written since, its log
+// and manifest are linked aside and cut at their size of that moment once
+// the writers are back. the freeze reads at most BACKUP_FROZEN_BYTES, past
+// that the writers are let go and the files synced again before the next
+// try. the syncs drop the rate limit while the writers outpace it, the
+// pages they copy and what the freeze writes reach the disk after it.
+// where the filesystem clones files, the other files are cloned aside in
+// the freeze and synced from the clone after it
+class task_backup_t : public task2_t
+{
+public:
+
+    static task_backup_t * create (
+                                    uint64_t rate_limit
+                                    );
+
+    virtual void release ( );
+
+    virtual void process ( );
+
+private:
+
+    // a file linked or cloned in the freeze, synced into dst after it
+    typedef struct pending_s
+    {
+        std::string     src;
+        std::string     dst;
+        uint64_t        size;
+    } pending_t;
+
+    typedef std::vector< pending_t > pendings_t;
+
+    // a file as the first sync flushed and read it
+    typedef struct synced_s
+    {
+        time_t          mtime_sec;
+        long            mtime_nsec;
+        off_t           size;
+        ino_t           ino;
+    } synced_t;
+
+    typedef std::map< std::string, synced_t > synceds_t;
+
+    // the files tracked since their whole sync, by inode
+    typedef std::map< std::string, ino_t > trackeds_t;
+
+    bool process_backup ( );
+
+    bool sync_dir (
+                    const std::string & src,
+                    const std::string & dst,
+                    bool frozen
+                    );
+
+    bool snapshot_leveldb (
+                            const std::string & src,
+                            const std::string & dst
+                            );
+
+    bool link_tables (
+                       const std::string & src,
+                       const std::string & dst
+                       );
+
+    bool clone_file (
+                      const std::string & src,
+                      const std::string & dst
+                      );
+
+    bool sync_file (
+                     const std::string & src,
+                     const std::string & dst,
+                     uint64_t limit,
+                     bool throttled
+                     );
+
+    bool sync_pages (
+                      const std::string & src,
+                      const std::string & dst,
+                      const std::vector< uint64_t > & pages,
+                      bool throttled
+                      );
+
+    bool link_file (
+                     const std::string & src,
+                     const std::string & dst
+                     );
+
+    bool flush_files ( );
+
+    void clean_dir (
+                     const std::string & dst
+                     );
+
+    bool write_manifest (
+                          uint32_t frozen_ms,
+                          uint32_t elapsed_ms
+                          );
+
+    void throttle (
+                    uint64_t bytes
+                    );
+
+private:
+
+    uint64_t                m_rate_limit;
+    bool                    m_clone;
+
+    std::set< std::string > m_seen;
+    pendings_t              m_pendings;
+    synceds_t               m_synceds;
+    trackeds_t              m_trackeds;
+    // tables copied whole where they could not be linked
+    std::set< std::string > m_tables;
+    // written since their last fdatasync
+    std::set< std::string > m_unsynced;
+
+    uint64_t                m_pass_bytes;
+    uint64_t                m_frozen_bytes;
+    bool                    m_frozen_over;
+    // the syncs run without the rate limit once it keeps them behind
+    bool                    m_catch_up;
+
+    uint32_t                m_throttle_start;
+    uint64_t                m_throttle_bytes;
+
+    uint64_t                m_files;
+    uint64_t                m_bytes_read;
+    uint64_t                m_bytes_written;
+    uint64_t                m_linked;
+
+public:
+
+    task_backup_t (
+                    uint64_t rate_limit
+                    );
+    ~task_backup_t ( );
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "task_drop_scan.h"
+#include "../base.h"
+
+task_drop_scan_t * task_drop_scan_t::create (
+                                              uint32_t size
+                                              )
+{
+    task_drop_scan_t * p = NULL;
+
+    try
+    {
+        p = new task_drop_scan_t ( size );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[slow_task][drop_scan]bad_alloc" );
+    }
+
+    return p;
+}
+
+void task_drop_scan_t::release ( )
+{
+    delete this;
+}
+
+task_drop_scan_t::task_drop_scan_t (
+                                     uint32_t size
+                                     )
+: m_size ( size )
+{
+}
+
+task_drop_scan_t::~ task_drop_scan_t ( )
+{
+}
+
+void task_drop_scan_t::process ( )
+{
+    process_drop_scan ();
+}
+
+void task_drop_scan_t::process_drop_scan ( )
+{
+    try
+    {
+        if ( m_size <= 0 )
+        {
+            LOG_ERROR ( "[slow_task][drop_scan]scan size <= 0" );
+            return;
+        }
+
+        hustdb_t * db = ( hustdb_t * ) G_APPTOOL->get_hustdb ();
+
+        int r = db->hustdb_drop_reclaim ( m_size );
+        if ( 0 != r )
+        {
+            LOG_ERROR ( "[slow_task][drop_scan][r=%d]task failed", r );
+            return;
+        }
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[slow_task][drop_scan]task exception" );
+    }
+}
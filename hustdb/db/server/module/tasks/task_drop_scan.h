@@ -0,0 +1,35 @@
+#ifndef _task_drop_scan_h_
+#define _task_drop_scan_h_
+
+#include "../hustdb.h"
+#include "slow_task_thread.h"
+
+class task_drop_scan_t : public task2_t
+{
+public:
+
+    static task_drop_scan_t * create (
+                                       uint32_t size
+                                       );
+
+    virtual void release ( );
+
+    virtual void process ( );
+
+private:
+
+    void process_drop_scan ( );
+
+private:
+
+    uint32_t m_size;
+
+public:
+
+    task_drop_scan_t (
+                       uint32_t size
+                       );
+    ~task_drop_scan_t ( );
+};
+
+#endif
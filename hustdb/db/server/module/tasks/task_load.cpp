@@ -0,0 +1,426 @@
+#include "task_load.h"
+#include "load_stage.h"
+#include "../base.h"
+#include "../../network/hustdb_utils.h"
+
+// a record of the data file of an export, see kv_array_t::export_db
+struct load_record_t
+{
+    std::string key;
+    std::string val;
+    std::string tb;
+    std::string ty;
+    uint32_t    ver;
+    uint32_t    ttl;
+    uint32_t    gz;
+
+    void reset ( )
+    {
+        key.resize ( 0 );
+        val.resize ( 0 );
+        tb.resize ( 0 );
+        ty.resize ( 0 );
+        ver = 0;
+        ttl = 0;
+        gz  = 0;
+    }
+};
+
+static bool load_base64 (
+                          const char *  data,
+                          size_t        len,
+                          std::string & out
+                          )
+{
+    c_str_t src;
+    c_str_t dst;
+
+    out.resize ( c_base64_decoded_length ( len ) + 1 );
+
+    src.assign ( ( char * ) data, len );
+    dst.assign ( & out[ 0 ], out.size () );
+
+    if ( ! hustdb_base64_decode ( & src, & dst ) )
+    {
+        return false;
+    }
+
+    out.resize ( dst.len );
+    return true;
+}
+
+// {"key":"..","val":"..","ver":1,"ttl":..,"gz":1,"tb":"..","ty":"H"}, the strings
+// hold no quote
+static bool load_parse (
+                         const char *    p,
+                         size_t          len,
+                         load_record_t & record
+                         )
+{
+    const char * end = p + len;
+
+    record.reset ();
+
+    if ( len < 2 || '{' != * p || '}' != end[ - 1 ] )
+    {
+        return false;
+    }
+    ++ p;
+    -- end;
+
+    while ( p < end )
+    {
+        if ( '"' != * p )
+        {
+            return false;
+        }
+        const char * name = ++ p;
+        p = ( const char * ) memchr ( p, '"', end - p );
+        if ( NULL == p || p + 1 >= end || ':' != p[ 1 ] )
+        {
+            return false;
+        }
+        std::string field ( name, p - name );
+        p += 2;
+
+        if ( p < end && '"' == * p )
+        {
+            const char * value = ++ p;
+            p = ( const char * ) memchr ( p, '"', end - p );
+            if ( NULL == p )
+            {
+                return false;
+            }
+            size_t value_len = p - value;
+            ++ p;
+
+            bool ok = true;
+            if ( field == "key" )
+            {
+                ok = load_base64 ( value, value_len, record.key );
+            }
+            else if ( field == "val" )
+            {
+                // the score of a zset is not encoded, ty tells
+                record.val.assign ( value, value_len );
+            }
+            else if ( field == "tb" )
+            {
+                record.tb.assign ( value, value_len );
+            }
+            else if ( field == "ty" )
+            {
+                record.ty.assign ( value, value_len );
+            }
+            if ( ! ok )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            char * num_end = NULL;
+            unsigned long n = strtoul ( p, & num_end, 10 );
+            if ( num_end == p )
+            {
+                return false;
+            }
+            p = num_end;
+
+            if ( field == "ver" )
+            {
+                record.ver = ( uint32_t ) n;
+            }
+            else if ( field == "ttl" )
+            {
+                record.ttl = ( uint32_t ) n;
+            }
+            else if ( field == "gz" )
+            {
+                record.gz = ( uint32_t ) n;
+            }
+        }
+
+        if ( p < end && ',' == * p )
+        {
+            ++ p;
+        }
+    }
+
+    if ( record.key.empty () || 0 == record.ver )
+    {
+        return false;
+    }
+
+    if ( record.ty != "Z" && ! record.val.empty () )
+    {
+        std::string raw;
+        if ( ! load_base64 ( record.val.c_str (), record.val.size (), raw ) )
+        {
+            return false;
+        }
+        record.val.swap ( raw );
+    }
+
+    return true;
+}
+
+task_load_t * task_load_t::create (
+                                    int file_id,
+                                    uint16_t start,
+                                    uint16_t end,
+                                    size_t buffer_bytes
+                                    )
+{
+    task_load_t * p = NULL;
+
+    try
+    {
+        p = new task_load_t ( file_id, start, end, buffer_bytes );
+    }
+    catch ( ... )
+    {
+        LOG_ERROR ( "[slow_task][load]bad_alloc" );
+    }
+
+    return p;
+}
+
+void task_load_t::release ( )
+{
+    delete this;
+}
+
+task_load_t::task_load_t (
+                           int file_id,
+                           uint16_t start,
+                           uint16_t end,
+                           size_t buffer_bytes
+                           )
+: m_file_id ( file_id )
+, m_start ( start )
+, m_end ( end )
+, m_buffer_bytes ( buffer_bytes )
+{
+}
+
+task_load_t::~ task_load_t ( )
+{
+}
+
+void task_load_t::process ( )
+{
+    process_load_db ();
+}
+
+void task_load_t::process_load_db ( )
+{
+    uint64_t        loaded          = 0;
+    uint64_t        failed          = 0;
+    uint64_t        expired         = 0;
+    hustdb_t *      db              = ( hustdb_t * ) G_APPTOOL->get_hustdb ();
+    i_server_kv_t * storage         = db->get_storage ();
+    int             file_count      = storage->get_user_file_count ();
+    load_stage_t    stage ( m_buffer_bytes );
+    conn_ctxt_t     conn;
+
+    conn.worker_id = db->get_server_conf ().tcp_worker_count;
+
+    storage->set_inner_stage ( & stage, conn );
+
+    // the records of one export are spread over several data files, all the
+    // exports share the stage so that every data file is ingested once
+    for ( int i = 0; i < file_count; ++ i )
+    {
+        if ( -1 != m_file_id && i != m_file_id )
+        {
+            continue;
+        }
+
+        try
+        {
+            load_file ( i, stage, conn, loaded, failed, expired );
+        }
+        catch ( ... )
+        {
+            LOG_ERROR ( "[slow_task][load][file_id=%d]load exception",
+                        i );
+        }
+    }
+
+    conn.compress_type = NOCOMPRESS;
+    storage->set_inner_stage ( NULL, conn );
+
+    // the records staged so far are referred to by the buckets already, the
+    // ones of a file that fails are ingested from its log at the next start
+    int r = stage.finish ();
+    if ( 0 != r )
+    {
+        LOG_ERROR ( "[slow_task][load][file_id=%d][r=%d]ingest failed, replayed at the next start",
+                    m_file_id, r );
+        return;
+    }
+
+    LOG_INFO ( "[slow_task][load][file_id=%d][loaded=%llu][failed=%llu][expired=%llu][staged=%llu][tables=%u]load OK",
+               m_file_id, ( unsigned long long ) loaded, ( unsigned long long ) failed,
+               ( unsigned long long ) expired, ( unsigned long long ) stage.staged (), stage.tables () );
+}
+
+void task_load_t::load_file (
+                              int               file_id,
+                              load_stage_t &    stage,
+                              conn_ctxt_t &     conn,
+                              uint64_t &        loaded,
+                              uint64_t &        failed,
+                              uint64_t &        expired
+                              )
+{
+    char            i_ph[ 256 ]     = { };
+    char            d_ph[ 256 ]     = { };
+    FILE *          i_fp            = NULL;
+    FILE *          d_fp            = NULL;
+    hustdb_t *      db              = ( hustdb_t * ) G_APPTOOL->get_hustdb ();
+
+    sprintf ( i_ph, "./EXPORT/%s%d[%d-%d].kv", EXPORT_DB_ALL, file_id, m_start, m_end );
+    G_APPTOOL->path_to_os ( i_ph );
+
+    sprintf ( d_ph, "./EXPORT/%s%d[%d-%d].kv.data", EXPORT_DB_ALL, file_id, m_start, m_end );
+    G_APPTOOL->path_to_os ( d_ph );
+
+    if ( ! G_APPTOOL->is_file ( i_ph ) || ! G_APPTOOL->is_file ( d_ph ) )
+    {
+        return;
+    }
+
+    do
+    {
+        i_fp = fopen ( i_ph, "rb" );
+        d_fp = fopen ( d_ph, "rb" );
+        if ( NULL == i_fp || NULL == d_fp )
+        {
+            LOG_ERROR ( "[slow_task][load][file=%s]fopen failed",
+                        i_fp ? d_ph : i_ph );
+            break;
+        }
+
+        fseeko ( d_fp, 0, SEEK_END );
+        uint64_t data_size = ( uint64_t ) ftello ( d_fp );
+        fseeko ( d_fp, 0, SEEK_SET );
+
+        uint64_t        offset      = 0;
+        uint64_t        next        = 0;
+        bool            has_next    = ( 1 == fread ( & next, sizeof ( uint64_t ), 1, i_fp ) );
+        std::string     item;
+        load_record_t   record;
+        item_ctxt_t *   ctxt        = NULL;
+        std::string *   rsp         = NULL;
+        int             rsp_len     = 0;
+        bool            ver_error   = false;
+
+        while ( has_next )
+        {
+            offset   = next;
+            has_next = ( 1 == fread ( & next, sizeof ( uint64_t ), 1, i_fp ) );
+
+            uint64_t end = has_next ? next : data_size;
+            if ( unlikely ( end < offset || end > data_size ) )
+            {
+                LOG_ERROR ( "[slow_task][load][file=%s][offset=%llu]bad index",
+                            i_ph, ( unsigned long long ) offset );
+                break;
+            }
+
+            item.resize ( end - offset );
+            if ( ! item.empty () && 1 != fread ( & item[ 0 ], item.size (), 1, d_fp ) )
+            {
+                LOG_ERROR ( "[slow_task][load][file=%s]fread failed",
+                            d_ph );
+                break;
+            }
+
+            if ( ! load_parse ( item.c_str (), item.size (), record ) )
+            {
+                ++ failed;
+                continue;
+            }
+
+            uint32_t ver = record.ver;
+            uint32_t ttl = 0;
+            int      r   = EINVAL;
+
+            // the export has the time the record expires at, it keeps the
+            // rest of its ttl and is written as usual, not staged
+            if ( 0 != record.ttl )
+            {
+                uint32_t now = db->get_current_timestamp ();
+                if ( record.ttl <= now )
+                {
+                    ++ expired;
+                    continue;
+                }
+
+                ttl = record.ttl - now;
+                if ( ttl > ( uint32_t ) db->get_store_conf ().db_ttl_maximum )
+                {
+                    ttl = ( uint32_t ) db->get_store_conf ().db_ttl_maximum;
+                }
+            }
+
+            conn.compress_type = record.gz ? COMPREESED : NOCOMPRESS;
+
+            if ( record.tb.empty () )
+            {
+                r = db->hustdb_put ( record.key.c_str (), record.key.size (),
+                                     record.val.c_str (), record.val.size (),
+                                     ver, ttl, true, conn, ctxt );
+            }
+            else if ( record.ty == "H" )
+            {
+                r = db->hustdb_hset ( record.tb.c_str (), record.tb.size (),
+                                      record.key.c_str (), record.key.size (),
+                                      record.val.c_str (), record.val.size (),
+                                      ver, ttl, true, conn, ctxt );
+            }
+            else if ( record.ty == "S" )
+            {
+                r = db->hustdb_sadd ( record.tb.c_str (), record.tb.size (),
+                                      record.key.c_str (), record.key.size (),
+                                      ver, ttl, true, conn, ctxt );
+            }
+            else if ( record.ty == "Z" )
+            {
+                conn.compress_type = NOCOMPRESS;
+                r = db->hustdb_zadd ( record.tb.c_str (), record.tb.size (),
+                                      record.key.c_str (), record.key.size (),
+                                      strtoll ( record.val.c_str (), NULL, 10 ),
+                                      rsp, rsp_len, 0, ver, ttl, true, conn, ver_error );
+            }
+
+            if ( 0 == r )
+            {
+                ++ loaded;
+            }
+            else
+            {
+                ++ failed;
+            }
+
+            if ( 0 == ( ( loaded + failed ) % 1000000 ) )
+            {
+                LOG_INFO ( "[slow_task][load][file_id=%d][loaded=%llu][failed=%llu][staged=%llu]",
+                           file_id, ( unsigned long long ) loaded,
+                           ( unsigned long long ) failed, ( unsigned long long ) stage.staged () );
+            }
+        }
+    }
+    while ( 0 );
+
+    if ( i_fp )
+    {
+        fclose ( i_fp );
+    }
+    if ( d_fp )
+    {
+        fclose ( d_fp );
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef _task_load_h_
+#define _task_load_h_
+
+#include "../hustdb.h"
+#include "slow_task_thread.h"
+#include <string>
+
+class load_stage_t;
+
+class task_load_t : public task2_t
+{
+public:
+
+    static task_load_t * create (
+                                  int file_id,
+                                  uint16_t start,
+                                  uint16_t end,
+                                  size_t buffer_bytes
+                                  );
+
+    virtual void release ( );
+
+    virtual void process ( );
+
+private:
+
+    void process_load_db ( );
+
+    void load_file (
+                     int file_id,
+                     load_stage_t & stage,
+                     conn_ctxt_t & conn,
+                     uint64_t & loaded,
+                     uint64_t & failed,
+                     uint64_t & expired
+                     );
+
+private:
+
+    int m_file_id;
+    uint16_t m_start;
+    uint16_t m_end;
+    size_t m_buffer_bytes;
+
+public:
+
+    task_load_t (
+                  int file_id,
+                  uint16_t start,
+                  uint16_t end,
+                  size_t buffer_bytes
+                  );
+    ~task_load_t ( );
+};
+
+#endif
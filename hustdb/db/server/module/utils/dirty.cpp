@@ -0,0 +1,211 @@
+#include "dirty.h"
+#include <pthread.h>
+#include <sys/stat.h>
+#include <map>
+#include <utility>
+
+namespace hustdb
+{
+
+    struct dirty_file_t
+    {
+        dev_t                   dev;
+        ino_t                   ino;
+        int                     refs;
+        volatile bool           tracked;
+        pthread_mutex_t         lock;
+        // one bit per page, grown by the writes
+        std::vector< uint64_t > bits;
+    };
+
+    typedef std::pair< dev_t, ino_t >                   dirty_key_t;
+    typedef std::map< dirty_key_t, dirty_file_t * >     dirty_files_t;
+
+    static pthread_mutex_t  g_dirty_lock    = PTHREAD_MUTEX_INITIALIZER;
+    static dirty_files_t    g_dirty_files;
+
+    dirty_file_t * dirty_open (
+                                const char * path
+                                )
+    {
+        struct stat st;
+        if ( 0 != stat ( path, & st ) )
+        {
+            return NULL;
+        }
+
+        dirty_file_t * file = NULL;
+
+        pthread_mutex_lock ( & g_dirty_lock );
+        try
+        {
+            dirty_files_t::iterator it = g_dirty_files.find ( dirty_key_t ( st.st_dev, st.st_ino ) );
+            if ( it != g_dirty_files.end () )
+            {
+                file = it->second;
+                ++ file->refs;
+            }
+            else
+            {
+                file          = new dirty_file_t;
+                file->dev     = st.st_dev;
+                file->ino     = st.st_ino;
+                file->refs    = 1;
+                file->tracked = false;
+                pthread_mutex_init ( & file->lock, NULL );
+                g_dirty_files[ dirty_key_t ( st.st_dev, st.st_ino ) ] = file;
+            }
+        }
+        catch ( ... )
+        {
+            file = NULL;
+        }
+        pthread_mutex_unlock ( & g_dirty_lock );
+
+        return file;
+    }
+
+    void dirty_close (
+                       dirty_file_t * file
+                       )
+    {
+        if ( NULL == file )
+        {
+            return;
+        }
+
+        pthread_mutex_lock ( & g_dirty_lock );
+        if ( 0 == -- file->refs )
+        {
+            g_dirty_files.erase ( dirty_key_t ( file->dev, file->ino ) );
+            pthread_mutex_destroy ( & file->lock );
+            delete file;
+        }
+        pthread_mutex_unlock ( & g_dirty_lock );
+    }
+
+    void dirty_mark (
+                      dirty_file_t * file,
+                      uint64_t offset,
+                      uint64_t len
+                      )
+    {
+        if ( NULL == file || 0 == len )
+        {
+            return;
+        }
+
+        // the write is seen by a copy that starts after dirty_track, unless
+        // this sees the file tracked
+        __sync_synchronize ();
+        if ( ! file->tracked )
+        {
+            return;
+        }
+
+        uint64_t first = offset / DIRTY_PAGE_BYTES;
+        uint64_t last  = ( offset + len - 1 ) / DIRTY_PAGE_BYTES;
+
+        pthread_mutex_lock ( & file->lock );
+        try
+        {
+            if ( file->bits.size () <= last / 64 )
+            {
+                file->bits.resize ( last / 64 + 1, 0 );
+            }
+            for ( uint64_t i = first; i <= last; ++ i )
+            {
+                file->bits[ i / 64 ] |= 1ULL << ( i % 64 );
+            }
+        }
+        catch ( ... )
+        {
+            // not kept, dirty_take fails and the file is copied whole
+            file->tracked = false;
+        }
+        pthread_mutex_unlock ( & file->lock );
+    }
+
+    bool dirty_track (
+                       dev_t dev,
+                       ino_t ino
+                       )
+    {
+        bool ok = false;
+
+        pthread_mutex_lock ( & g_dirty_lock );
+        dirty_files_t::iterator it = g_dirty_files.find ( dirty_key_t ( dev, ino ) );
+        if ( it != g_dirty_files.end () )
+        {
+            dirty_file_t * file = it->second;
+
+            pthread_mutex_lock ( & file->lock );
+            file->bits.clear ();
+            file->tracked = true;
+            pthread_mutex_unlock ( & file->lock );
+
+            ok = true;
+        }
+        pthread_mutex_unlock ( & g_dirty_lock );
+
+        return ok;
+    }
+
+    bool dirty_take (
+                      dev_t dev,
+                      ino_t ino,
+                      std::vector< uint64_t > & pages
+                      )
+    {
+        bool ok = false;
+
+        pages.clear ();
+
+        pthread_mutex_lock ( & g_dirty_lock );
+        dirty_files_t::iterator it = g_dirty_files.find ( dirty_key_t ( dev, ino ) );
+        if ( it != g_dirty_files.end () )
+        {
+            dirty_file_t * file = it->second;
+
+            pthread_mutex_lock ( & file->lock );
+            ok = file->tracked;
+            try
+            {
+                for ( size_t w = 0; ok && w < file->bits.size (); ++ w )
+                {
+                    for ( uint64_t b = file->bits[ w ]; 0 != b; b &= b - 1 )
+                    {
+                        pages.push_back ( ( uint64_t ) w * 64 + __builtin_ctzll ( b ) );
+                    }
+                }
+            }
+            catch ( ... )
+            {
+                pages.clear ();
+                file->tracked = false;
+                ok            = false;
+            }
+            file->bits.clear ();
+            pthread_mutex_unlock ( & file->lock );
+        }
+        pthread_mutex_unlock ( & g_dirty_lock );
+
+        return ok;
+    }
+
+    void dirty_untrack ( )
+    {
+        pthread_mutex_lock ( & g_dirty_lock );
+        for ( dirty_files_t::iterator it = g_dirty_files.begin (); it != g_dirty_files.end (); ++ it )
+        {
+            dirty_file_t * file = it->second;
+
+            pthread_mutex_lock ( & file->lock );
+            file->tracked = false;
+            std::vector< uint64_t > ().swap ( file->bits );
+            pthread_mutex_unlock ( & file->lock );
+        }
+        pthread_mutex_unlock ( & g_dirty_lock );
+    }
+
+}
@@ -0,0 +1,60 @@
+#ifndef _dirty_h_
+#define _dirty_h_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <vector>
+
+// the writes are kept in pages of this size
+#define DIRTY_PAGE_BYTES              4096
+
+namespace hustdb
+{
+
+    // [backup] an open data file, known by its device and inode. while a
+    // backup tracks it, the pages written are kept until the backup takes
+    // them. a writer marks a range once it is written, before it drops the
+    // lock that the freeze takes
+    struct dirty_file_t;
+
+    // NULL where the file can not be stat'ed, it is not tracked then. a
+    // file opened twice is the same dirty_file_t
+    dirty_file_t * dirty_open (
+                                const char * path
+                                );
+
+    void dirty_close (
+                       dirty_file_t * file
+                       );
+
+    // a no-op on a NULL file, or while the file is not tracked
+    void dirty_mark (
+                      dirty_file_t * file,
+                      uint64_t offset,
+                      uint64_t len
+                      );
+
+    // forgets the pages written so far and keeps those written from now
+    // on, the whole file is copied after this call. false where the file
+    // is not open
+    bool dirty_track (
+                       dev_t dev,
+                       ino_t ino
+                       );
+
+    // the pages written since dirty_track or the last dirty_take, sorted,
+    // and forgets them. false where the file has not been tracked since,
+    // it was closed or opened again meanwhile
+    bool dirty_take (
+                      dev_t dev,
+                      ino_t ino,
+                      std::vector< uint64_t > & pages
+                      );
+
+    // stops tracking all the files
+    void dirty_untrack ( );
+
+}
+
+#endif // _dirty_h_
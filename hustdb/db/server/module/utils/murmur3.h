@@ -0,0 +1,19 @@
+/*
+ **********************************************************************
+ ** murmur3.h -- Header file for MurmurHash3 (x64, 128-bit variant)  **
+ ** MurmurHash3 was written by Austin Appleby, and is placed in the  **
+ ** public domain. The author hereby disclaims copyright to this     **
+ ** source code.                                                     **
+ **********************************************************************
+ */
+
+#ifndef _base_murmur3_h_
+#define _base_murmur3_h_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 128-bit non-cryptographic hash, digest must hold 16 bytes */
+void MurmurHash3_x64_128 ( const void * key, size_t len, uint32_t seed, void * digest );
+
+#endif // #ifndef _base_murmur3_h_
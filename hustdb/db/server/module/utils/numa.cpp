@@ -0,0 +1,290 @@
+#include "numa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE         3
+#endif
+
+#define NUMA_NODE_DIR           "/sys/devices/system/node"
+#define NUMA_MAX_NODES          64
+
+namespace hustdb
+{
+
+    static bool g_map_hugepage      = false;
+    static int  g_dtlb_fd           = - 1;
+    static int  g_node_fd           = - 1;
+
+    // "0-3,8-11" style lists of /sys, calls func on each id
+    template < typename func_t >
+    static bool parse_list (
+                             const char * path,
+                             func_t & func
+                             )
+    {
+        char buf[ 4096 ] = { };
+
+        FILE * fp = fopen ( path, "r" );
+        if ( NULL == fp )
+        {
+            return false;
+        }
+        size_t n = fread ( buf, 1, sizeof ( buf ) - 1, fp );
+        fclose ( fp );
+        buf[ n ] = '\0';
+
+        const char * p = buf;
+        while ( * p >= '0' && * p <= '9' )
+        {
+            char * end = NULL;
+            long first = strtol ( p, & end, 10 );
+            long last  = first;
+            if ( '-' == * end )
+            {
+                last = strtol ( end + 1, & end, 10 );
+            }
+            for ( long i = first; i <= last; ++ i )
+            {
+                func ( ( int ) i );
+            }
+            p = ( ',' == * end ) ? end + 1 : end;
+        }
+
+        return true;
+    }
+
+    struct max_id_t
+    {
+        int max;
+        max_id_t ( ) : max ( - 1 ) { }
+        void operator() ( int i ) { if ( i > max ) max = i; }
+    };
+
+    struct cpu_set_fill_t
+    {
+        cpu_set_t * set;
+        int count;
+        void operator() ( int i ) { if ( i < CPU_SETSIZE ) { CPU_SET ( i, set ); ++ count; } }
+    };
+
+    int numa_node_count ( )
+    {
+        max_id_t m;
+        if ( ! parse_list ( NUMA_NODE_DIR "/online", m ) || m.max < 0 )
+        {
+            return 1;
+        }
+
+        return m.max + 1 > NUMA_MAX_NODES ? NUMA_MAX_NODES : m.max + 1;
+    }
+
+    bool numa_interleave ( )
+    {
+        int nodes = numa_node_count ();
+        if ( nodes <= 1 )
+        {
+            return true;
+        }
+
+        unsigned long mask = 0;
+        for ( int i = 0; i < nodes; ++ i )
+        {
+            mask |= 1UL << i;
+        }
+
+        return 0 == syscall ( SYS_set_mempolicy, MPOL_INTERLEAVE, & mask, sizeof ( mask ) * 8 );
+    }
+
+    bool numa_bind_node (
+                          int node
+                          )
+    {
+        char      path[ 128 ];
+        cpu_set_t set;
+
+        CPU_ZERO ( & set );
+        cpu_set_fill_t fill = { & set, 0 };
+
+        snprintf ( path, sizeof ( path ), NUMA_NODE_DIR "/node%d/cpulist", node );
+        if ( ! parse_list ( path, fill ) || 0 == fill.count )
+        {
+            return false;
+        }
+
+        return 0 == sched_setaffinity ( 0, sizeof ( set ), & set );
+    }
+
+    int bind_cpu (
+                   uint32_t index
+                   )
+    {
+        cpu_set_t set;
+
+        CPU_ZERO ( & set );
+        if ( 0 != sched_getaffinity ( 0, sizeof ( set ), & set ) )
+        {
+            return -1;
+        }
+
+        int count = CPU_COUNT ( & set );
+        if ( count <= 0 )
+        {
+            return -1;
+        }
+
+        int nth = ( int ) ( index % ( uint32_t ) count );
+        for ( int cpu = 0; cpu < CPU_SETSIZE; ++ cpu )
+        {
+            if ( ! CPU_ISSET ( cpu, & set ) )
+            {
+                continue;
+            }
+            if ( nth -- > 0 )
+            {
+                continue;
+            }
+
+            CPU_ZERO ( & set );
+            CPU_SET ( cpu, & set );
+            return 0 == sched_setaffinity ( 0, sizeof ( set ), & set ) ? cpu : -1;
+        }
+
+        return -1;
+    }
+
+    void set_map_hugepage (
+                            bool enable
+                            )
+    {
+        g_map_hugepage = enable;
+    }
+
+    void advise_map_hugepage (
+                               void * ptr,
+                               size_t len
+                               )
+    {
+#ifdef MADV_HUGEPAGE
+        if ( ! g_map_hugepage || NULL == ptr || 0 == len )
+        {
+            return;
+        }
+
+        size_t page  = ( size_t ) sysconf ( _SC_PAGESIZE );
+        size_t start = ( size_t ) ptr / page * page;
+
+        // file systems without huge page support in the page cache say
+        // EINVAL, the map then just keeps small pages
+        madvise ( ( void * ) start, ( size_t ) ptr + len - start, MADV_HUGEPAGE );
+#endif
+    }
+
+    static int open_cache_counter (
+                                    uint64_t cache
+                                    )
+    {
+        struct perf_event_attr attr;
+        memset ( & attr, 0, sizeof ( attr ) );
+
+        attr.size           = sizeof ( attr );
+        attr.type           = PERF_TYPE_HW_CACHE;
+        attr.config         = cache |
+                              ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) |
+                              ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+        attr.inherit        = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        return ( int ) syscall ( SYS_perf_event_open, & attr, 0, - 1, - 1, 0 );
+    }
+
+    bool hw_counters_open ( )
+    {
+        if ( g_dtlb_fd < 0 )
+        {
+            g_dtlb_fd = open_cache_counter ( PERF_COUNT_HW_CACHE_DTLB );
+        }
+        if ( g_node_fd < 0 )
+        {
+            g_node_fd = open_cache_counter ( PERF_COUNT_HW_CACHE_NODE );
+        }
+
+        return g_dtlb_fd >= 0 || g_node_fd >= 0;
+    }
+
+    static long long read_counter (
+                                    int fd
+                                    )
+    {
+        uint64_t value = 0;
+        if ( fd < 0 || sizeof ( value ) != read ( fd, & value, sizeof ( value ) ) )
+        {
+            return - 1;
+        }
+        return ( long long ) value;
+    }
+
+    void hw_counters_info (
+                            std::stringstream & ss
+                            )
+    {
+        int nodes = numa_node_count ();
+
+        ss << "\"hw\":{"
+            "\"dtlb_load_misses\":" << read_counter ( g_dtlb_fd ) << ","
+            "\"node_load_misses\":" << read_counter ( g_node_fd ) << ","
+            "\"numa_nodes\":" << nodes << ","
+            "\"numa\":[";
+
+        // system wide allocation counters of each node, other_node counts
+        // the pages a process got from a node it does not run on
+        for ( int i = 0; i < nodes; ++ i )
+        {
+            char               path[ 128 ];
+            char               name[ 64 ];
+            unsigned long long value     = 0;
+            unsigned long long hit       = 0;
+            unsigned long long miss      = 0;
+            unsigned long long other     = 0;
+
+            snprintf ( path, sizeof ( path ), NUMA_NODE_DIR "/node%d/numastat", i );
+            FILE * fp = fopen ( path, "r" );
+            if ( fp )
+            {
+                while ( 2 == fscanf ( fp, "%63s %llu", name, & value ) )
+                {
+                    if ( 0 == strcmp ( name, "numa_hit" ) )
+                    {
+                        hit = value;
+                    }
+                    else if ( 0 == strcmp ( name, "numa_miss" ) )
+                    {
+                        miss = value;
+                    }
+                    else if ( 0 == strcmp ( name, "other_node" ) )
+                    {
+                        other = value;
+                    }
+                }
+                fclose ( fp );
+            }
+
+            ss << ( i > 0 ? "," : "" ) << "{"
+                "\"node\":" << i << ","
+                "\"numa_hit\":" << hit << ","
+                "\"numa_miss\":" << miss << ","
+                "\"other_node\":" << other << "}";
+        }
+
+        ss << "]}";
+    }
+
+}
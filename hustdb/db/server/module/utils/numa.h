@@ -0,0 +1,54 @@
+#ifndef _numa_h_
+#define _numa_h_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sstream>
+
+namespace hustdb
+{
+
+    // online nodes, 1 where the kernel knows no NUMA
+    int numa_node_count ( );
+
+    // MPOL_INTERLEAVE over the online nodes for the calling thread; the
+    // threads it starts afterwards inherit the policy, and so do the page
+    // cache pages they fault in. true on a single node machine
+    bool numa_interleave ( );
+
+    // binds the calling thread to the cpus of node
+    bool numa_bind_node (
+                          int node
+                          );
+
+    // binds the calling thread to the ( index % n )-th of the n cpus it may
+    // run on, returns that cpu or -1
+    int bind_cpu (
+                   uint32_t index
+                   );
+
+    // [md5db] hugepage, set before the bucket and fullkey files are opened
+    void set_map_hugepage (
+                            bool enable
+                            );
+
+    // madvise ( MADV_HUGEPAGE ) over the pages of [ ptr, ptr + len ) once
+    // set_map_hugepage ( true ), a no-op otherwise
+    void advise_map_hugepage (
+                               void * ptr,
+                               size_t len
+                               );
+
+    // dTLB load misses and loads served by a remote node, counted for the
+    // whole process: the perf events are inherited by the threads started
+    // after this call. false if perf events are not available
+    bool hw_counters_open ( );
+
+    // "hw":{...}, the counters read -1 when not available
+    void hw_counters_info (
+                            std::stringstream & ss
+                            );
+
+}
+
+#endif // _numa_h_
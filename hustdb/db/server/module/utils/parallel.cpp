@@ -0,0 +1,98 @@
+#include "parallel.h"
+#include <pthread.h>
+#include <vector>
+
+namespace hustdb
+{
+
+    static int g_parallel_threads = 1;
+
+    struct parallel_job_t
+    {
+        size_t count;
+        parallel_func_t func;
+        void * ctx;
+        volatile size_t next;
+        volatile int failed;
+    };
+
+    static void * parallel_thread (
+                                    void * arg
+                                    )
+    {
+        parallel_job_t * job = ( parallel_job_t * ) arg;
+
+        while ( true )
+        {
+            size_t i = __sync_fetch_and_add ( & job->next, 1 );
+            if ( i >= job->count )
+            {
+                break;
+            }
+            if ( ! job->func ( job->ctx, i ) )
+            {
+                __sync_fetch_and_add ( & job->failed, 1 );
+            }
+        }
+
+        return NULL;
+    }
+
+    bool parallel_run (
+                        size_t count,
+                        int threads,
+                        parallel_func_t func,
+                        void * ctx
+                        )
+    {
+        if ( threads <= 0 )
+        {
+            threads = g_parallel_threads;
+        }
+        if ( ( size_t ) threads > count )
+        {
+            threads = ( int ) count;
+        }
+
+        parallel_job_t job;
+        job.count  = count;
+        job.func   = func;
+        job.ctx    = ctx;
+        job.next   = 0;
+        job.failed = 0;
+
+        // a thread that can not be created just leaves its share to the others
+        std::vector<pthread_t> tids;
+        for ( int i = 1; i < threads; ++ i )
+        {
+            pthread_t tid;
+            if ( 0 != pthread_create ( & tid, NULL, parallel_thread, & job ) )
+            {
+                break;
+            }
+            tids.push_back ( tid );
+        }
+
+        parallel_thread ( & job );
+
+        for ( size_t i = 0; i < tids.size (); ++ i )
+        {
+            pthread_join ( tids[ i ], NULL );
+        }
+
+        return 0 == job.failed;
+    }
+
+    void set_parallel_threads (
+                                int threads
+                                )
+    {
+        g_parallel_threads = threads > 0 ? threads : 1;
+    }
+
+    int get_parallel_threads ( )
+    {
+        return g_parallel_threads;
+    }
+
+}
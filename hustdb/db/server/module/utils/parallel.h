@@ -0,0 +1,31 @@
+#ifndef _parallel_h_
+#define _parallel_h_
+
+#include <stddef.h>
+
+namespace hustdb
+{
+
+    // returns false when item i failed, the other items still run
+    typedef bool (*parallel_func_t )( void * ctx, size_t i );
+
+    // runs func ( ctx, i ) for every i in [ 0, count ) on up to threads
+    // threads, the calling thread included. threads <= 0 takes the value of
+    // set_parallel_threads. returns false if any item failed.
+    bool parallel_run (
+                        size_t count,
+                        int threads,
+                        parallel_func_t func,
+                        void * ctx
+                        );
+
+    // default thread count of parallel_run, [md5db] open_threads
+    void set_parallel_threads (
+                                int threads
+                                );
+
+    int get_parallel_threads ( );
+
+}
+
+#endif // _parallel_h_
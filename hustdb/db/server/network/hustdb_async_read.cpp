@@ -0,0 +1,202 @@
+#include "hustdb_async_read.h"
+#include <deque>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace hustdb_network {
+
+struct async_worker_t
+{
+    int fds[2];
+    struct event * ev;
+    int inflight;
+};
+
+static hustdb_network_ctx_t * g_ctx = NULL;
+static std::vector<async_worker_t> g_workers;
+static std::vector<pthread_t> g_threads;
+static std::deque<async_get_t *> g_jobs;
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static bool g_stop = false;
+static int g_depth = 0;
+
+static void * async_read_thread(void * arg)
+{
+    hustdb_t * db = g_ctx->db;
+    // every pool thread owns a conn slot past the workers, see hustdb_t::get_conn_count
+    conn_ctxt_t conn;
+    conn.worker_id = db->get_worker_count() + 2 + (uint32_t)(size_t)arg;
+
+    while (true)
+    {
+        async_get_t * job = NULL;
+        pthread_mutex_lock(&g_mutex);
+        while (!g_stop && g_jobs.empty())
+        {
+            pthread_cond_wait(&g_cond, &g_mutex);
+        }
+        if (!g_jobs.empty())
+        {
+            job = g_jobs.front();
+            g_jobs.pop_front();
+        }
+        pthread_mutex_unlock(&g_mutex);
+        if (!job)
+        {
+            break;
+        }
+
+        std::string * rsp = NULL;
+        int rsp_len = 0;
+        item_ctxt_t * ctxt = NULL;
+        job->r = db->hustdb_get(job->key.c_str(), job->key.size(), rsp, rsp_len, job->ver, conn, ctxt, true);
+        // the slot buffers are reused by the next job, the worker gets its own copy
+        if (0 == job->r && rsp && rsp_len > 0)
+        {
+            job->val.assign(rsp->c_str(), rsp_len);
+        }
+        if (ctxt)
+        {
+            job->ctxt.kv_data = ctxt->kv_data;
+        }
+
+        int fd = g_workers[job->worker].fds[1];
+        while (write(fd, &job, sizeof(job)) < 0 && EINTR == errno)
+        {
+        }
+    }
+    return NULL;
+}
+
+static void on_async_read_done(evutil_socket_t fd, short events, void * arg)
+{
+    async_worker_t * worker = reinterpret_cast<async_worker_t *>(arg);
+    async_get_t * jobs[64];
+    while (true)
+    {
+        // pointer-sized writes to a pipe are atomic, reads never split one
+        ssize_t len = read(fd, jobs, sizeof(jobs));
+        if (len <= 0)
+        {
+            break;
+        }
+        size_t count = (size_t)len / sizeof(async_get_t *);
+        for (size_t i = 0; i < count; ++i)
+        {
+            async_get_t * job = jobs[i];
+            --worker->inflight;
+            async_get_reply(job);
+            evhtp_request_resume(job->request);
+            delete job;
+        }
+    }
+}
+
+bool async_read_open(hustdb_network_ctx_t * ctx)
+{
+    server_conf_t& cf = ctx->db->get_server_conf();
+    if (cf.tcp_async_read_threads < 1)
+    {
+        return true;
+    }
+    g_ctx = ctx;
+    g_depth = cf.tcp_async_read_depth;
+    g_stop = false;
+
+    async_worker_t worker = { { -1, -1 }, NULL, 0 };
+    g_workers.resize(ctx->base.threads, worker);
+    for (size_t i = 0; i < g_workers.size(); ++i)
+    {
+        // the read end is drained non-blocking on the worker, the write end
+        // blocks, the pipe always has room for tcp.async_read.depth pointers
+        if (0 != pipe(g_workers[i].fds) || 0 != fcntl(g_workers[i].fds[0], F_SETFL, O_NONBLOCK))
+        {
+            LOG_ERROR("[hustdb_network][async_read_open]pipe error: %d", errno);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < cf.tcp_async_read_threads; ++i)
+    {
+        pthread_t tid;
+        if (0 != pthread_create(&tid, NULL, async_read_thread, (void *)(size_t)i))
+        {
+            LOG_ERROR("[hustdb_network][async_read_open]pthread_create error");
+            return false;
+        }
+        g_threads.push_back(tid);
+    }
+    return true;
+}
+
+bool async_read_thread_init(evthr_t * thr, hustdb_network_ctx_t * ctx)
+{
+    if (g_workers.empty())
+    {
+        return true;
+    }
+    uint32_t id = ctx->base.get_id(thr);
+    if (id >= g_workers.size())
+    {
+        return false;
+    }
+    async_worker_t& worker = g_workers[id];
+    worker.ev = event_new(evthr_get_base(thr), worker.fds[0], EV_READ | EV_PERSIST, on_async_read_done, &worker);
+    if (!worker.ev || 0 != event_add(worker.ev, NULL))
+    {
+        LOG_ERROR("[hustdb_network][async_read_thread_init]event_add error, worker: %u", id);
+        return false;
+    }
+    return true;
+}
+
+void async_read_close()
+{
+    pthread_mutex_lock(&g_mutex);
+    g_stop = true;
+    pthread_cond_broadcast(&g_cond);
+    pthread_mutex_unlock(&g_mutex);
+    for (size_t i = 0; i < g_threads.size(); ++i)
+    {
+        pthread_join(g_threads[i], NULL);
+    }
+    g_threads.clear();
+}
+
+bool async_read_enabled()
+{
+    return !g_threads.empty();
+}
+
+bool async_read_get(const char * key, size_t key_len, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    if (g_threads.empty())
+    {
+        return false;
+    }
+    uint32_t id = ctx->base.get_id(request);
+    if (id >= g_workers.size() || !g_workers[id].ev || g_workers[id].inflight >= g_depth)
+    {
+        return false;
+    }
+
+    async_get_t * job = new async_get_t();
+    job->request = request;
+    job->ctx = ctx;
+    job->worker = id;
+    job->key.assign(key, key_len);
+    job->r = 0;
+    job->ver = 0;
+
+    ++g_workers[id].inflight;
+    evhtp_request_pause(request);
+
+    pthread_mutex_lock(&g_mutex);
+    g_jobs.push_back(job);
+    pthread_cond_signal(&g_cond);
+    pthread_mutex_unlock(&g_mutex);
+    return true;
+}
+
+}
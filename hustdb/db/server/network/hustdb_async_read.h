@@ -0,0 +1,40 @@
+#ifndef __hustdb_async_read_20261018103012_h__
+#define __hustdb_async_read_20261018103012_h__
+
+#include "hustdb_network_utils.h"
+
+namespace hustdb_network {
+
+// a read that was taken off the evhtp worker, completed by the read pool
+// and handed back to the worker's event base
+struct async_get_t
+{
+    evhtp_request_t * request;
+    hustdb_network_ctx_t * ctx;
+    uint32_t worker;
+    std::string key;
+    int r;
+    uint32_t ver;
+    std::string val;
+    item_ctxt_t ctxt;
+};
+
+// sends the reply of a finished job, runs on the job's worker thread
+void async_get_reply(async_get_t * job);
+
+// called before the evhtp threads are started, no-op when tcp.async_read.threads = 0
+bool async_read_open(hustdb_network_ctx_t * ctx);
+// called from on_evhtp_thread_init, binds the completion pipe to the worker's event base
+bool async_read_thread_init(evthr_t * thr, hustdb_network_ctx_t * ctx);
+void async_read_close();
+
+// tcp.async_read.threads > 0, set before the evhtp threads are started
+bool async_read_enabled();
+
+// pauses the request and queues the read; false when disabled or when the
+// worker already has tcp.async_read.depth reads outstanding
+bool async_read_get(const char * key, size_t key_len, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+
+}
+
+#endif // __hustdb_async_read_20261018103012_h__
@@ -1,4 +1,6 @@
 #include "hustdb_handler.h"
+#include "hustdb_async_read.h"
+#include "hustdb_mq_watch.h"
 
 static evhtp::c_str_t KEY_ACCEPT_ENCODING = evhtp_make_str("Accept-Encoding");
 static evhtp::c_str_t KEY_CONTENT_ENCODING = evhtp_make_str("Content-Encoding");
@@ -200,6 +202,12 @@ void from_hustdb_data(
     }
 }
 
+void async_get_reply(async_get_t * job)
+{
+    std::string * rsp = job->val.empty() ? NULL : &job->val;
+    from_hustdb_data(job->ver, job->r, rsp, job->val.size(), job->request, job->ctx, &job->ctxt);
+}
+
 void post_read_handler(
     uint32_t ver,
     int r,
@@ -304,7 +312,21 @@ void hustdb_get_handler(hustdb_get_ctx_t& args, evhtp_request_t * request, hustd
 {
     PRE_READ;
     hustdb_network::unescape_key(false, request, args.key);
-    int r = ctx->db->hustdb_get(args.key.data, args.key.len, rsp, rsp_len, ver, conn, ctxt);
+    // with a read pool, l2_cache hits never block, everything else goes to the pool if the worker has room
+    bool pooled = hustdb_network::async_read_enabled();
+    int r = ENOENT;
+    if (pooled)
+    {
+        r = ctx->db->hustdb_get_cached(args.key.data, args.key.len, rsp, rsp_len, ver, conn, ctxt);
+        if (ENOENT == r && hustdb_network::async_read_get(args.key.data, args.key.len, request, ctx))
+        {
+            return;
+        }
+    }
+    if (ENOENT == r)
+    {
+        r = ctx->db->hustdb_get(args.key.data, args.key.len, rsp, rsp_len, ver, conn, ctxt, pooled);
+    }
     hustdb_network::from_hustdb_data(ver, r, rsp, rsp_len, request, ctx, ctxt);
 }
 
@@ -414,6 +436,12 @@ void hustdb_hkeys_handler(hustdb_hkeys_ctx_t& args, evhtp_request_t * request, h
     hustdb_network::post_keys_handler(r, count, total, rsp, request, ctx);
 }
 
+void hustdb_hdrop_handler(hustdb_hdrop_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    int r = ctx->db->hustdb_drop(args.tb.data, args.tb.len, HASH_TB);
+    evhtp::send_reply(ctx->db->errno_int_status(r), request);
+}
+
 void hustdb_sismember_handler(hustdb_sismember_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
 {
     PRE_EXIST;
@@ -443,6 +471,12 @@ void hustdb_smembers_handler(hustdb_smembers_ctx_t& args, evhtp_request_t * requ
     hustdb_network::post_keys_handler(r, count, total, rsp, request, ctx);
 }
 
+void hustdb_sdrop_handler(hustdb_sdrop_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    int r = ctx->db->hustdb_drop(args.tb.data, args.tb.len, SET_TB);
+    evhtp::send_reply(ctx->db->errno_int_status(r), request);
+}
+
 void hustdb_file_count_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx)
 {
     int file_count = ctx->db->hustdb_file_count();
@@ -460,6 +494,24 @@ void hustdb_export_handler(hustdb_export_ctx_t& args, evhtp_request_t * request,
     hustdb_network::post_handler(r, &rsp, rsp.size(), request, ctx);
 }
 
+void hustdb_load_handler(hustdb_load_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    void * token = 0;
+    int r = ctx->db->hustdb_load(args.file, args.start, args.end, token);
+    uint64_t tmp = reinterpret_cast<uint64_t> (token);
+    std::string rsp = evhtp::to_string(tmp);
+    hustdb_network::post_handler(r, &rsp, rsp.size(), request, ctx);
+}
+
+void hustdb_backup_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    void * token = 0;
+    int r = ctx->db->hustdb_backup(token);
+    uint64_t tmp = reinterpret_cast<uint64_t> (token);
+    std::string rsp = evhtp::to_string(tmp);
+    hustdb_network::post_handler(r, &rsp, rsp.size(), request, ctx);
+}
+
 void hustdb_binlog_handler(hustdb_binlog_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
 {
     conn_ctxt_t conn;
@@ -576,6 +628,19 @@ void hustmq_sub_handler(hustmq_sub_ctx_t& args, evhtp_request_t * request, hustd
     hustdb_network::post_handler(r, rsp, rsp ? rsp->size() : 0, request, ctx);
 }
 
+void hustmq_watch_handler(hustmq_watch_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    uint64_t seq = 0;
+    std::string stats;
+    // the ha keeps one of these open per backend, it is answered as soon as a queue changes
+    if (!ctx->db->hustmq_watch(args.seq, seq, stats) &&
+        hustdb_network::mq_watch_park(args.seq, args.timeout > 300 ? 300 : args.timeout, request, ctx))
+    {
+        return;
+    }
+    hustdb_network::mq_watch_reply(args.seq, request, ctx);
+}
+
 void hustdb_info_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx)
 {
     std::string info;
@@ -583,6 +648,13 @@ void hustdb_info_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx)
     evhtp::send_reply(ctx->db->errno_int_status(0), info.c_str(), info.size(), request);
 }
 
+void hustdb_ready_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    std::string info;
+    bool ready = ctx->db->hustdb_ready(info);
+    evhtp::send_reply(ready ? EVHTP_RES_200 : EVHTP_RES_SERVUNAVAIL, info.c_str(), info.size(), request);
+}
+
 void hustdb_task_info_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx)
 {
     std::string info;
@@ -598,6 +670,13 @@ void hustdb_task_status_handler(hustdb_task_status_ctx_t& args, evhtp_request_t
     evhtp::send_reply(ctx->db->errno_int_status(0), rsp.c_str(), rsp.size(), request);
 }
 
+void hustdb_hotkeys_handler(hustdb_hotkeys_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    std::string rsp;
+    ctx->db->hustdb_hotkeys(args.n, rsp);
+    evhtp::send_reply(ctx->db->errno_int_status(0), rsp.c_str(), rsp.size(), request);
+}
+
 void hustdb_zismember_handler(hustdb_zismember_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
 {
     PRE_EXIST;
@@ -649,6 +728,42 @@ void hustdb_zrangebyscore_handler(hustdb_zrangebyscore_ctx_t& args, evhtp_reques
     hustdb_network::post_keys_handler(r, count, total, rsp, request, ctx);
 }
 
+void hustdb_zdrop_handler(hustdb_zdrop_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    int r = ctx->db->hustdb_drop(args.tb.data, args.tb.len, ZSET_TB);
+    evhtp::send_reply(ctx->db->errno_int_status(r), request);
+}
+
+void hustdb_zremrangebyscore_handler(hustdb_zremrangebyscore_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    PRE_HANDLER;
+    uint32_t count = 0;
+    std::string rsp;
+    int r = ctx->db->hustdb_zremrange(args.tb.data, args.tb.len, args.min, args.max, 0, args.size, true,
+        args.has_host ? args.host.data : NULL, args.host.len, count, rsp, conn);
+    hustdb_network::post_keys_handler(r, count, 0, &rsp, request, ctx);
+}
+
+void hustdb_zremrangebyrank_handler(hustdb_zremrangebyrank_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    PRE_HANDLER;
+    uint32_t count = 0;
+    std::string rsp;
+    int r = ctx->db->hustdb_zremrange(args.tb.data, args.tb.len, 0, 0, args.offset, args.size, false,
+        args.has_host ? args.host.data : NULL, args.host.len, count, rsp, conn);
+    hustdb_network::post_keys_handler(r, count, 0, &rsp, request, ctx);
+}
+
+void hustdb_zpopmin_handler(hustdb_zpopmin_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    PRE_HANDLER;
+    uint32_t count = 0;
+    std::string rsp;
+    int r = ctx->db->hustdb_zremrange(args.tb.data, args.tb.len, 0, 0, 0, args.size, false,
+        args.has_host ? args.host.data : NULL, args.host.len, count, rsp, conn);
+    hustdb_network::post_keys_handler(r, count, 0, &rsp, request, ctx);
+}
+
 void hustcache_exist_handler(hustcache_exist_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
 {
     PRE_EXIST;
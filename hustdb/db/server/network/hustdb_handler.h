@@ -19,12 +19,16 @@ void hustdb_hset_handler(hustdb_hset_ctx_t& args, evhtp_request_t * request, hus
 void hustdb_hincrby_handler(hustdb_hincrby_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_hdel_handler(hustdb_hdel_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_hkeys_handler(hustdb_hkeys_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_hdrop_handler(hustdb_hdrop_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_sismember_handler(hustdb_sismember_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_sadd_handler(hustdb_sadd_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_srem_handler(hustdb_srem_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_smembers_handler(hustdb_smembers_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_sdrop_handler(hustdb_sdrop_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_file_count_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_export_handler(hustdb_export_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_load_handler(hustdb_load_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_backup_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_binlog_handler(hustdb_binlog_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustmq_put_handler(hustmq_put_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustmq_get_handler(hustmq_get_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
@@ -38,15 +42,22 @@ void hustmq_lock_handler(hustmq_lock_ctx_t& args, evhtp_request_t * request, hus
 void hustmq_purge_handler(hustmq_purge_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustmq_pub_handler(hustmq_pub_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustmq_sub_handler(hustmq_sub_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustmq_watch_handler(hustmq_watch_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_info_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_ready_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_task_info_handler(evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_task_status_handler(hustdb_task_status_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_hotkeys_handler(hustdb_hotkeys_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_zismember_handler(hustdb_zismember_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_zscore_handler(hustdb_zscore_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_zadd_handler(hustdb_zadd_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_zrem_handler(hustdb_zrem_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_zrangebyrank_handler(hustdb_zrangebyrank_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustdb_zrangebyscore_handler(hustdb_zrangebyscore_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_zdrop_handler(hustdb_zdrop_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_zremrangebyscore_handler(hustdb_zremrangebyscore_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_zremrangebyrank_handler(hustdb_zremrangebyrank_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+void hustdb_zpopmin_handler(hustdb_zpopmin_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustcache_exist_handler(hustcache_exist_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustcache_get_handler(hustcache_get_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
 void hustcache_ttl_handler(hustcache_ttl_ctx_t& args, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
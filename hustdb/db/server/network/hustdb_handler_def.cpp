@@ -596,6 +596,32 @@ hustdb_hkeys_ctx_t::hustdb_hkeys_ctx_t(evhtp_query_t * htp_query)
     }
 }
 
+hustdb_hdrop_ctx_t::hustdb_hdrop_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_tb = false;
+
+    memset(&tb, 0, sizeof(evhtp::c_str_t));
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __tb = evhtp_make_str("tb");
+
+        if (kv->klen == __tb.len && 0 == strncmp(__tb.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_tb = true;
+            tb.assign(kv->val, kv->vlen);
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
 hustdb_sismember_ctx_t::hustdb_sismember_ctx_t(evhtp_query_t * htp_query)
 {
     // reset
@@ -816,6 +842,32 @@ hustdb_smembers_ctx_t::hustdb_smembers_ctx_t(evhtp_query_t * htp_query)
     }
 }
 
+hustdb_sdrop_ctx_t::hustdb_sdrop_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_tb = false;
+
+    memset(&tb, 0, sizeof(evhtp::c_str_t));
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __tb = evhtp_make_str("tb");
+
+        if (kv->klen == __tb.len && 0 == strncmp(__tb.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_tb = true;
+            tb.assign(kv->val, kv->vlen);
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
 hustdb_export_ctx_t::hustdb_export_ctx_t(evhtp_query_t * htp_query)
 {
     // reset
@@ -900,6 +952,48 @@ hustdb_export_ctx_t::hustdb_export_ctx_t(evhtp_query_t * htp_query)
     }
 }
 
+hustdb_load_ctx_t::hustdb_load_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_file = false;
+    has_start = false;
+    has_end = false;
+
+    file = -1;
+    start = 0;
+    end = MAX_BUCKET_NUM;
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __file = evhtp_make_str("file");
+        static evhtp::c_str_t __start = evhtp_make_str("start");
+        static evhtp::c_str_t __end = evhtp_make_str("end");
+
+        if (kv->klen == __file.len && 0 == strncmp(__file.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_file = true;
+            file = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __start.len && 0 == strncmp(__start.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_start = true;
+            start = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __end.len && 0 == strncmp(__end.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_end = true;
+            end = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
 hustdb_binlog_ctx_t::hustdb_binlog_ctx_t(evhtp_query_t * htp_query)
 {
     // reset
@@ -1342,6 +1436,40 @@ hustmq_sub_ctx_t::hustmq_sub_ctx_t(evhtp_query_t * htp_query)
     }
 }
 
+hustmq_watch_ctx_t::hustmq_watch_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_seq = false;
+    has_timeout = false;
+
+    seq = 0;
+    timeout = 30;
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __seq = evhtp_make_str("seq");
+        static evhtp::c_str_t __timeout = evhtp_make_str("timeout");
+
+        if (kv->klen == __seq.len && 0 == strncmp(__seq.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_seq = true;
+            seq = evhtp::cast <uint64_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __timeout.len && 0 == strncmp(__timeout.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_timeout = true;
+            timeout = evhtp::cast <uint32_t> (std::string(kv->val, kv->vlen));
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
 hustdb_task_status_ctx_t::hustdb_task_status_ctx_t(evhtp_query_t * htp_query)
 {
     // reset
@@ -1368,6 +1496,32 @@ hustdb_task_status_ctx_t::hustdb_task_status_ctx_t(evhtp_query_t * htp_query)
     }
 }
 
+hustdb_hotkeys_ctx_t::hustdb_hotkeys_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_n = false;
+
+    n = 0;
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __n = evhtp_make_str("n");
+
+        if (kv->klen == __n.len && 0 == strncmp(__n.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_n = true;
+            n = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
 hustdb_zismember_ctx_t::hustdb_zismember_ctx_t(evhtp_query_t * htp_query)
 {
     // reset
@@ -1721,6 +1875,182 @@ hustdb_zrangebyscore_ctx_t::hustdb_zrangebyscore_ctx_t(evhtp_query_t * htp_query
     }
 }
 
+hustdb_zdrop_ctx_t::hustdb_zdrop_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_tb = false;
+
+    memset(&tb, 0, sizeof(evhtp::c_str_t));
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __tb = evhtp_make_str("tb");
+
+        if (kv->klen == __tb.len && 0 == strncmp(__tb.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_tb = true;
+            tb.assign(kv->val, kv->vlen);
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
+hustdb_zremrangebyscore_ctx_t::hustdb_zremrangebyscore_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_tb = false;
+    has_min = false;
+    has_max = false;
+    has_size = false;
+    has_host = false;
+
+    memset(&tb, 0, sizeof(evhtp::c_str_t));
+    min = 0;
+    max = 0;
+    size = MEM_EXPORT_SIZE;
+    memset(&host, 0, sizeof(evhtp::c_str_t));
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __tb = evhtp_make_str("tb");
+        static evhtp::c_str_t __min = evhtp_make_str("min");
+        static evhtp::c_str_t __max = evhtp_make_str("max");
+        static evhtp::c_str_t __size = evhtp_make_str("size");
+        static evhtp::c_str_t __host = evhtp_make_str("host");
+
+        if (kv->klen == __tb.len && 0 == strncmp(__tb.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_tb = true;
+            tb.assign(kv->val, kv->vlen);
+        }
+        else if (kv->klen == __min.len && 0 == strncmp(__min.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_min = true;
+            min = evhtp::cast <int64_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __max.len && 0 == strncmp(__max.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_max = true;
+            max = evhtp::cast <int64_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __size.len && 0 == strncmp(__size.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_size = true;
+            size = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __host.len && 0 == strncmp(__host.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_host = true;
+            host.assign(kv->val, kv->vlen);
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
+hustdb_zremrangebyrank_ctx_t::hustdb_zremrangebyrank_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_tb = false;
+    has_offset = false;
+    has_size = false;
+    has_host = false;
+
+    memset(&tb, 0, sizeof(evhtp::c_str_t));
+    offset = -1;
+    size = -1;
+    memset(&host, 0, sizeof(evhtp::c_str_t));
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __tb = evhtp_make_str("tb");
+        static evhtp::c_str_t __offset = evhtp_make_str("offset");
+        static evhtp::c_str_t __size = evhtp_make_str("size");
+        static evhtp::c_str_t __host = evhtp_make_str("host");
+
+        if (kv->klen == __tb.len && 0 == strncmp(__tb.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_tb = true;
+            tb.assign(kv->val, kv->vlen);
+        }
+        else if (kv->klen == __offset.len && 0 == strncmp(__offset.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_offset = true;
+            offset = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __size.len && 0 == strncmp(__size.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_size = true;
+            size = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __host.len && 0 == strncmp(__host.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_host = true;
+            host.assign(kv->val, kv->vlen);
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
+hustdb_zpopmin_ctx_t::hustdb_zpopmin_ctx_t(evhtp_query_t * htp_query)
+{
+    // reset
+    has_tb = false;
+    has_size = false;
+    has_host = false;
+
+    memset(&tb, 0, sizeof(evhtp::c_str_t));
+    size = 1;
+    memset(&host, 0, sizeof(evhtp::c_str_t));
+
+    if (!htp_query)
+    {
+        return;
+    }
+    // parse from htp_query
+    evhtp_kv_s * kv = htp_query->tqh_first;
+    while (kv)
+    {
+        static evhtp::c_str_t __tb = evhtp_make_str("tb");
+        static evhtp::c_str_t __size = evhtp_make_str("size");
+        static evhtp::c_str_t __host = evhtp_make_str("host");
+
+        if (kv->klen == __tb.len && 0 == strncmp(__tb.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_tb = true;
+            tb.assign(kv->val, kv->vlen);
+        }
+        else if (kv->klen == __size.len && 0 == strncmp(__size.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_size = true;
+            size = evhtp::cast <int32_t> (std::string(kv->val, kv->vlen));
+        }
+        else if (kv->klen == __host.len && 0 == strncmp(__host.data, kv->key, kv->klen) && kv->val && kv->vlen > 0)
+        {
+            has_host = true;
+            host.assign(kv->val, kv->vlen);
+        }
+        kv = kv->next.tqe_next;
+    }
+}
+
 hustcache_exist_ctx_t::hustcache_exist_ctx_t(evhtp_query_t * htp_query)
 {
     // reset
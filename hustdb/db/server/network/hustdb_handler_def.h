@@ -182,6 +182,15 @@ struct hustdb_hkeys_ctx_t
     hustdb_hkeys_ctx_t(evhtp_query_t * htp_query);
 };
 
+struct hustdb_hdrop_ctx_t
+{
+    evhtp::c_str_t tb;
+
+    bool has_tb;
+
+    hustdb_hdrop_ctx_t(evhtp_query_t * htp_query);
+};
+
 struct hustdb_sismember_ctx_t
 {
     evhtp::c_str_t tb;
@@ -246,6 +255,15 @@ struct hustdb_smembers_ctx_t
     hustdb_smembers_ctx_t(evhtp_query_t * htp_query);
 };
 
+struct hustdb_sdrop_ctx_t
+{
+    evhtp::c_str_t tb;
+
+    bool has_tb;
+
+    hustdb_sdrop_ctx_t(evhtp_query_t * htp_query);
+};
+
 struct hustdb_export_ctx_t
 {
     evhtp::c_str_t tb;
@@ -269,6 +287,19 @@ struct hustdb_export_ctx_t
     hustdb_export_ctx_t(evhtp_query_t * htp_query);
 };
 
+struct hustdb_load_ctx_t
+{
+    int32_t file;
+    int32_t start;
+    int32_t end;
+
+    bool has_file;
+    bool has_start;
+    bool has_end;
+
+    hustdb_load_ctx_t(evhtp_query_t * htp_query);
+};
+
 struct hustdb_binlog_ctx_t
 {
     evhtp::c_str_t tb;
@@ -409,6 +440,17 @@ struct hustmq_sub_ctx_t
     hustmq_sub_ctx_t(evhtp_query_t * htp_query);
 };
 
+struct hustmq_watch_ctx_t
+{
+    uint64_t seq;
+    uint32_t timeout;
+
+    bool has_seq;
+    bool has_timeout;
+
+    hustmq_watch_ctx_t(evhtp_query_t * htp_query);
+};
+
 struct hustdb_task_status_ctx_t
 {
     evhtp::c_str_t token;
@@ -418,6 +460,15 @@ struct hustdb_task_status_ctx_t
     hustdb_task_status_ctx_t(evhtp_query_t * htp_query);
 };
 
+struct hustdb_hotkeys_ctx_t
+{
+    int32_t n;
+
+    bool has_n;
+
+    hustdb_hotkeys_ctx_t(evhtp_query_t * htp_query);
+};
+
 struct hustdb_zismember_ctx_t
 {
     evhtp::c_str_t tb;
@@ -520,6 +571,60 @@ struct hustdb_zrangebyscore_ctx_t
     hustdb_zrangebyscore_ctx_t(evhtp_query_t * htp_query);
 };
 
+struct hustdb_zdrop_ctx_t
+{
+    evhtp::c_str_t tb;
+
+    bool has_tb;
+
+    hustdb_zdrop_ctx_t(evhtp_query_t * htp_query);
+};
+
+struct hustdb_zremrangebyscore_ctx_t
+{
+    evhtp::c_str_t tb;
+    int64_t min;
+    int64_t max;
+    int32_t size;
+    evhtp::c_str_t host;
+
+    bool has_tb;
+    bool has_min;
+    bool has_max;
+    bool has_size;
+    bool has_host;
+
+    hustdb_zremrangebyscore_ctx_t(evhtp_query_t * htp_query);
+};
+
+struct hustdb_zremrangebyrank_ctx_t
+{
+    evhtp::c_str_t tb;
+    int32_t offset;
+    int32_t size;
+    evhtp::c_str_t host;
+
+    bool has_tb;
+    bool has_offset;
+    bool has_size;
+    bool has_host;
+
+    hustdb_zremrangebyrank_ctx_t(evhtp_query_t * htp_query);
+};
+
+struct hustdb_zpopmin_ctx_t
+{
+    evhtp::c_str_t tb;
+    int32_t size;
+    evhtp::c_str_t host;
+
+    bool has_tb;
+    bool has_size;
+    bool has_host;
+
+    hustdb_zpopmin_ctx_t(evhtp_query_t * htp_query);
+};
+
 struct hustcache_exist_ctx_t
 {
     evhtp::c_str_t key;
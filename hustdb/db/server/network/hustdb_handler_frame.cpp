@@ -371,6 +371,33 @@ void hustdb_hkeys_frame(evhtp_request_t * request, void * data)
     hustdb_hkeys_handler(args, request, ctx);
 }
 
+void hustdb_hdrop_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_hdrop_ctx_t args(request->uri->query);
+    if (!args.has_tb)
+    {
+        evhtp::send_reply(EVHTP_RES_NOTFOUND, request);
+        return;
+    }
+    hustdb_hdrop_handler(args, request, ctx);
+}
+
 void hustdb_sismember_frame(evhtp_request_t * request, void * data)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
@@ -521,6 +548,33 @@ void hustdb_smembers_frame(evhtp_request_t * request, void * data)
     hustdb_smembers_handler(args, request, ctx);
 }
 
+void hustdb_sdrop_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_sdrop_ctx_t args(request->uri->query);
+    if (!args.has_tb)
+    {
+        evhtp::send_reply(EVHTP_RES_NOTFOUND, request);
+        return;
+    }
+    hustdb_sdrop_handler(args, request, ctx);
+}
+
 void hustdb_file_count_frame(evhtp_request_t * request, void * data)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
@@ -569,6 +623,49 @@ void hustdb_export_frame(evhtp_request_t * request, void * data)
     hustdb_export_handler(args, request, ctx);
 }
 
+void hustdb_load_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_load_ctx_t args(request->uri->query);
+    hustdb_load_handler(args, request, ctx);
+}
+
+void hustdb_backup_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_backup_handler(request, ctx);
+}
+
 void hustdb_binlog_frame(evhtp_request_t * request, void * data)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
@@ -956,6 +1053,28 @@ void hustmq_sub_frame(evhtp_request_t * request, void * data)
     hustmq_sub_handler(args, request, ctx);
 }
 
+void hustmq_watch_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustmq_watch_ctx_t args(request->uri->query);
+    hustmq_watch_handler(args, request, ctx);
+}
+
 void hustdb_info_frame(evhtp_request_t * request, void * data)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
@@ -977,6 +1096,27 @@ void hustdb_info_frame(evhtp_request_t * request, void * data)
     hustdb_info_handler(request, ctx);
 }
 
+void hustdb_ready_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx)
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_ready_handler(request, ctx);
+}
+
 void hustdb_task_info_frame(evhtp_request_t * request, void * data)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
@@ -1025,6 +1165,28 @@ void hustdb_task_status_frame(evhtp_request_t * request, void * data)
     hustdb_task_status_handler(args, request, ctx);
 }
 
+void hustdb_hotkeys_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_hotkeys_ctx_t args(request->uri->query);
+    hustdb_hotkeys_handler(args, request, ctx);
+}
+
 void hustdb_zismember_frame(evhtp_request_t * request, void * data)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
@@ -1243,6 +1405,114 @@ void hustdb_zrangebyscore_frame(evhtp_request_t * request, void * data)
     hustdb_zrangebyscore_handler(args, request, ctx);
 }
 
+void hustdb_zdrop_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_zdrop_ctx_t args(request->uri->query);
+    if (!args.has_tb)
+    {
+        evhtp::send_reply(EVHTP_RES_NOTFOUND, request);
+        return;
+    }
+    hustdb_zdrop_handler(args, request, ctx);
+}
+
+void hustdb_zremrangebyscore_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_zremrangebyscore_ctx_t args(request->uri->query);
+    if (!args.has_tb || !args.has_min || !args.has_max)
+    {
+        evhtp::send_reply(EVHTP_RES_NOTFOUND, request);
+        return;
+    }
+    hustdb_zremrangebyscore_handler(args, request, ctx);
+}
+
+void hustdb_zremrangebyrank_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_zremrangebyrank_ctx_t args(request->uri->query);
+    if (!args.has_tb || !args.has_offset || !args.has_size)
+    {
+        evhtp::send_reply(EVHTP_RES_NOTFOUND, request);
+        return;
+    }
+    hustdb_zremrangebyrank_handler(args, request, ctx);
+}
+
+void hustdb_zpopmin_frame(evhtp_request_t * request, void * data)
+{
+    hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
+    if (!request || !ctx || !ctx->db->ok())
+    {
+        evhtp::send_reply(EVHTP_RES_500, request);
+        return;
+    }
+    if (!evhtp::check_auth(request, &ctx->base))
+    {
+        return;
+    }
+    htp_method method = evhtp_request_get_method(request);
+    if (htp_method_GET != method)
+    {
+        evhtp::invalid_method(request);
+        return;
+    }
+    hustdb_zpopmin_ctx_t args(request->uri->query);
+    if (!args.has_tb)
+    {
+        evhtp::send_reply(EVHTP_RES_NOTFOUND, request);
+        return;
+    }
+    hustdb_zpopmin_handler(args, request, ctx);
+}
+
 void hustcache_exist_frame(evhtp_request_t * request, void * data)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(data);
@@ -1678,12 +1948,16 @@ bool hustdb_init_handlers(hustdb_network_ctx_t * ctx, evhtp_t * htp)
     if (!evhtp_set_cb(htp, "/hustdb/hincrby", hustdb_hincrby_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/hdel", hustdb_hdel_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/hkeys", hustdb_hkeys_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/hdrop", hustdb_hdrop_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/sismember", hustdb_sismember_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/sadd", hustdb_sadd_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/srem", hustdb_srem_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/smembers", hustdb_smembers_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/sdrop", hustdb_sdrop_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/file_count", hustdb_file_count_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/export", hustdb_export_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/load", hustdb_load_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/backup", hustdb_backup_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/binlog", hustdb_binlog_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustmq/put", hustmq_put_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustmq/get", hustmq_get_frame, ctx)) return false;
@@ -1697,15 +1971,22 @@ bool hustdb_init_handlers(hustdb_network_ctx_t * ctx, evhtp_t * htp)
     if (!evhtp_set_cb(htp, "/hustmq/purge", hustmq_purge_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustmq/pub", hustmq_pub_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustmq/sub", hustmq_sub_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustmq/watch", hustmq_watch_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/info", hustdb_info_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/ready", hustdb_ready_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/task_info", hustdb_task_info_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/task_status", hustdb_task_status_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/hotkeys", hustdb_hotkeys_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/zismember", hustdb_zismember_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/zscore", hustdb_zscore_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/zadd", hustdb_zadd_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/zrem", hustdb_zrem_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/zrangebyrank", hustdb_zrangebyrank_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustdb/zrangebyscore", hustdb_zrangebyscore_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/zdrop", hustdb_zdrop_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/zremrangebyscore", hustdb_zremrangebyscore_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/zremrangebyrank", hustdb_zremrangebyrank_frame, ctx)) return false;
+    if (!evhtp_set_cb(htp, "/hustdb/zpopmin", hustdb_zpopmin_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustcache/exist", hustcache_exist_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustcache/get", hustcache_get_frame, ctx)) return false;
     if (!evhtp_set_cb(htp, "/hustcache/ttl", hustcache_ttl_frame, ctx)) return false;
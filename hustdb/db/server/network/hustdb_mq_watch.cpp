@@ -0,0 +1,278 @@
+#include "hustdb_mq_watch.h"
+#include <set>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace hustdb_network {
+
+struct mq_watcher_t
+{
+    evhtp_request_t * request;
+    hustdb_network_ctx_t * ctx;
+    uint32_t worker;
+    uint64_t since;
+    struct event * timer;
+};
+
+typedef std::set<mq_watcher_t *> mq_watcher_set_t;
+
+struct mq_watch_worker_t
+{
+    int fds[2];
+    evthr_t * thr;
+    struct event * ev;
+    mq_watcher_set_t * watchers;
+    volatile int pending;
+};
+
+static std::vector<mq_watch_worker_t> g_workers;
+
+static pthread_mutex_t g_close_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_close_cond = PTHREAD_COND_INITIALIZER;
+static size_t g_close_pending = 0;
+
+static void on_mq_changed(void * arg)
+{
+    // runs on the thread that changed the queue, one byte per worker is
+    // enough to wake it up, the worker rescans all of its watchers
+    for (size_t i = 0; i < g_workers.size(); ++i)
+    {
+        mq_watch_worker_t& worker = g_workers[i];
+        if (!worker.ev || __sync_lock_test_and_set(&worker.pending, 1))
+        {
+            continue;
+        }
+        char c = 0;
+        while (write(worker.fds[1], &c, 1) < 0 && EINTR == errno)
+        {
+        }
+    }
+}
+
+static void mq_watch_release(mq_watcher_t * watcher)
+{
+    g_workers[watcher->worker].watchers->erase(watcher);
+    if (watcher->timer)
+    {
+        event_free(watcher->timer);
+    }
+    delete watcher;
+}
+
+static evhtp_res on_mq_watch_fini(evhtp_request_t * request, void * arg)
+{
+    // the connection went away while the request was parked
+    mq_watch_release(reinterpret_cast<mq_watcher_t *>(arg));
+    return EVHTP_RES_OK;
+}
+
+static void mq_watch_finish(mq_watcher_t * watcher)
+{
+    evhtp_request_t * request = watcher->request;
+    evhtp_unset_hook(&request->hooks, evhtp_hook_on_request_fini);
+    mq_watch_reply(watcher->since, request, watcher->ctx);
+    evhtp_request_resume(request);
+    mq_watch_release(watcher);
+}
+
+static void on_mq_watch_timeout(evutil_socket_t fd, short events, void * arg)
+{
+    mq_watch_finish(reinterpret_cast<mq_watcher_t *>(arg));
+}
+
+static void on_mq_watch_wakeup(evutil_socket_t fd, short events, void * arg)
+{
+    mq_watch_worker_t * worker = reinterpret_cast<mq_watch_worker_t *>(arg);
+    char buf[64];
+    while (read(fd, buf, sizeof(buf)) > 0)
+    {
+    }
+    __sync_lock_release(&worker->pending);
+
+    if (worker->watchers->empty())
+    {
+        return;
+    }
+
+    // the stats are built by the reply of each watcher that has news
+    uint64_t seq = (*worker->watchers->begin())->ctx->db->hustmq_watch_seq();
+    std::vector<mq_watcher_t *> ready;
+    for (mq_watcher_set_t::iterator it = worker->watchers->begin(); it != worker->watchers->end(); ++it)
+    {
+        if ((*it)->since != seq)
+        {
+            ready.push_back(*it);
+        }
+    }
+    for (size_t i = 0; i < ready.size(); ++i)
+    {
+        mq_watch_finish(ready[i]);
+    }
+}
+
+static void mq_watch_worker_release(mq_watch_worker_t * worker)
+{
+    if (worker->ev)
+    {
+        event_del(worker->ev);
+        event_free(worker->ev);
+        worker->ev = NULL;
+    }
+    if (worker->watchers)
+    {
+        // parked requests get the current stats instead of hanging until the process exits
+        while (!worker->watchers->empty())
+        {
+            mq_watch_finish(*worker->watchers->begin());
+        }
+        delete worker->watchers;
+        worker->watchers = NULL;
+    }
+}
+
+static void on_mq_watch_close(evthr_t * thr, void * cmd_arg, void * shared)
+{
+    mq_watch_worker_release(reinterpret_cast<mq_watch_worker_t *>(cmd_arg));
+    pthread_mutex_lock(&g_close_mutex);
+    --g_close_pending;
+    pthread_cond_signal(&g_close_cond);
+    pthread_mutex_unlock(&g_close_mutex);
+}
+
+bool mq_watch_open(hustdb_network_ctx_t * ctx)
+{
+    mq_watch_worker_t worker = { { -1, -1 }, NULL, NULL, NULL, 0 };
+    g_workers.resize(ctx->base.threads, worker);
+    for (size_t i = 0; i < g_workers.size(); ++i)
+    {
+        // both ends are non-blocking, a full pipe already has a wake-up pending
+        if (0 != pipe(g_workers[i].fds) ||
+            0 != fcntl(g_workers[i].fds[0], F_SETFL, O_NONBLOCK) ||
+            0 != fcntl(g_workers[i].fds[1], F_SETFL, O_NONBLOCK))
+        {
+            LOG_ERROR("[hustdb_network][mq_watch_open]pipe error: %d", errno);
+            return false;
+        }
+        g_workers[i].watchers = new mq_watcher_set_t();
+    }
+    ctx->db->hustmq_set_notify(on_mq_changed, NULL);
+    return true;
+}
+
+bool mq_watch_thread_init(evthr_t * thr, hustdb_network_ctx_t * ctx)
+{
+    uint32_t id = ctx->base.get_id(thr);
+    if (id >= g_workers.size())
+    {
+        return false;
+    }
+    mq_watch_worker_t& worker = g_workers[id];
+    worker.thr = thr;
+    worker.ev = event_new(evthr_get_base(thr), worker.fds[0], EV_READ | EV_PERSIST, on_mq_watch_wakeup, &worker);
+    if (!worker.ev || 0 != event_add(worker.ev, NULL))
+    {
+        LOG_ERROR("[hustdb_network][mq_watch_thread_init]event_add error, worker: %u", id);
+        return false;
+    }
+    return true;
+}
+
+void mq_watch_close(hustdb_network_ctx_t * ctx)
+{
+    // the storage may still record changes, nothing is written to the pipes past this point
+    ctx->db->hustmq_set_notify(NULL, NULL);
+
+    // the events, timers and parked requests belong to the workers, which are
+    // still running, so each worker releases its own before the pipes are closed
+    pthread_mutex_lock(&g_close_mutex);
+    for (size_t i = 0; i < g_workers.size(); ++i)
+    {
+        if (!g_workers[i].thr)
+        {
+            mq_watch_worker_release(&g_workers[i]);
+        }
+        else if (EVTHR_RES_OK == evthr_defer(g_workers[i].thr, on_mq_watch_close, &g_workers[i]))
+        {
+            ++g_close_pending;
+        }
+        else
+        {
+            LOG_ERROR("[hustdb_network][mq_watch_close]evthr_defer error, worker: %u", (uint32_t)i);
+        }
+    }
+    while (g_close_pending > 0)
+    {
+        pthread_cond_wait(&g_close_cond, &g_close_mutex);
+    }
+    pthread_mutex_unlock(&g_close_mutex);
+
+    for (size_t i = 0; i < g_workers.size(); ++i)
+    {
+        if (g_workers[i].ev)
+        {
+            // still registered on a worker that could not release it
+            continue;
+        }
+        for (int j = 0; j < 2; ++j)
+        {
+            if (g_workers[i].fds[j] >= 0)
+            {
+                close(g_workers[i].fds[j]);
+                g_workers[i].fds[j] = -1;
+            }
+        }
+    }
+}
+
+bool mq_watch_park(uint64_t since, uint32_t timeout, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    uint32_t id = ctx->base.get_id(request);
+    if (id >= g_workers.size() || !g_workers[id].ev || timeout < 1)
+    {
+        return false;
+    }
+
+    mq_watcher_t * watcher = new mq_watcher_t();
+    watcher->request = request;
+    watcher->ctx = ctx;
+    watcher->worker = id;
+    watcher->since = since;
+    watcher->timer = evtimer_new(evthr_get_base(request->conn->thread), on_mq_watch_timeout, watcher);
+    if (!watcher->timer)
+    {
+        delete watcher;
+        return false;
+    }
+    struct timeval tv = { (time_t)timeout, 0 };
+    evtimer_add(watcher->timer, &tv);
+
+    g_workers[id].watchers->insert(watcher);
+    evhtp_set_hook(&request->hooks, evhtp_hook_on_request_fini, (evhtp_hook)on_mq_watch_fini, watcher);
+    evhtp_request_pause(request);
+
+    // a change recorded between the caller's check and the insert above has
+    // already fired its wake-up, so this one is picked up by on_mq_watch_wakeup
+    return true;
+}
+
+void mq_watch_reply(uint64_t since, evhtp_request_t * request, hustdb_network_ctx_t * ctx)
+{
+    uint64_t seq = 0;
+    std::string stats;
+    bool changed = ctx->db->hustmq_watch(since, seq, stats);
+
+    char val[24] = {0};
+    sprintf(val, "%llu", (unsigned long long)seq);
+    evhtp::add_kv("Seq", val, request);
+
+    if (changed)
+    {
+        evhtp::send_reply(EVHTP_RES_200, stats.c_str(), stats.size(), request);
+    }
+    else
+    {
+        evhtp::send_nobody_reply(EVHTP_RES_NOTFOUND, request);
+    }
+}
+
+}
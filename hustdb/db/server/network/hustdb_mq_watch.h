@@ -0,0 +1,28 @@
+#ifndef __hustdb_mq_watch_20261018153020_h__
+#define __hustdb_mq_watch_20261018153020_h__
+
+#include "hustdb_network_utils.h"
+
+namespace hustdb_network {
+
+// /hustmq/watch long-polls: a request with nothing to report is parked on
+// its worker until hustdb_t records a queue change or the timeout expires
+
+// called before the evhtp threads are started
+bool mq_watch_open(hustdb_network_ctx_t * ctx);
+// called from on_evhtp_thread_init, binds the wake-up pipe to the worker's event base
+bool mq_watch_thread_init(evthr_t * thr, hustdb_network_ctx_t * ctx);
+// called after the main loop returns, while the workers still run: each worker
+// frees its event and answers its parked requests, then the pipes are closed
+void mq_watch_close(hustdb_network_ctx_t * ctx);
+
+// pauses the request until a change after since is recorded, timeout in seconds.
+// false when the worker can not park it, the caller replies right away
+bool mq_watch_park(uint64_t since, uint32_t timeout, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+
+// replies with the changes after since, 404 when there are none
+void mq_watch_reply(uint64_t since, evhtp_request_t * request, hustdb_network_ctx_t * ctx);
+
+}
+
+#endif // __hustdb_mq_watch_20261018153020_h__
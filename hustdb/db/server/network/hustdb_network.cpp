@@ -1,7 +1,85 @@
 #include "hustdb_network.h"
+#include "hustdb_async_read.h"
+#include "hustdb_mq_watch.h"
+#include "../module/utils/numa.h"
 
 static evbase_t * g_evbase = NULL;
 
+// tcp.worker_affinity = core: every worker accepts on a listener of its own,
+// all bound to the port with SO_REUSEPORT, so the kernel spreads the
+// connections and a connection never leaves the worker that accepted it
+static __thread evthr_t * t_worker = NULL;
+static __thread evhtp_t * t_listener = NULL;
+
+static pthread_mutex_t g_listen_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_listen_cond = PTHREAD_COND_INITIALIZER;
+static int g_listen_done = 0;
+static int g_listen_failed = 0;
+
+static bool hustdb_setup(hustdb_network_ctx_t * ctx, evhtp_t * htp);
+
+// evhtp_bind_socket sets SO_REUSEPORT only after bind, too late for the
+// second listener on the port
+static evutil_socket_t reuseport_socket(uint16_t port)
+{
+    evutil_socket_t fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    evutil_make_socket_closeonexec(fd);
+    evutil_make_socket_nonblocking(fd);
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, (void *)&on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (void *)&on, sizeof(on));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (void *)&on, sizeof(on)) < 0)
+    {
+        evutil_closesocket(fd);
+        return -1;
+    }
+
+    struct sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+    sin.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&sin, sizeof(sin)) < 0)
+    {
+        evutil_closesocket(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool worker_listen(hustdb_network_ctx_t * ctx)
+{
+    evhtp_t * htp = evhtp_new(evthr_get_base(t_worker), NULL);
+    if (!htp)
+    {
+        return false;
+    }
+    if (!hustdb_setup(ctx, htp))
+    {
+        evhtp_free(htp);
+        return false;
+    }
+    evutil_socket_t fd = reuseport_socket(ctx->base.port);
+    if (fd < 0)
+    {
+        evhtp_free(htp);
+        return false;
+    }
+    if (evhtp_accept_socket(htp, fd, ctx->base.backlog) < 0)
+    {
+        evutil_closesocket(fd);
+        evhtp_free(htp);
+        return false;
+    }
+    t_listener = htp;
+    return true;
+}
+
 void on_evhtp_thread_init(evhtp_t * htp, evthr_t * thr, void * arg)
 {
     hustdb_network_ctx_t * ctx = reinterpret_cast<hustdb_network_ctx_t *>(arg);
@@ -10,11 +88,68 @@ void on_evhtp_thread_init(evhtp_t * htp, evthr_t * thr, void * arg)
         return;
     }
     ctx->base.append(thr);
+    hustdb_network::async_read_thread_init(thr, ctx);
+    hustdb_network::mq_watch_thread_init(thr, ctx);
+    t_worker = thr;
+
+    // runs on the worker itself, workers are spread over the nodes in turn
+    int32_t affinity = ctx->db->get_server_conf().tcp_worker_affinity;
+    uint32_t id = ctx->base.get_id(thr);
+    if (WORKER_AFFINITY_NUMA == affinity)
+    {
+        int node = (int)(id % (uint32_t)hustdb::numa_node_count());
+        if (!hustdb::numa_bind_node(node))
+        {
+            LOG_ERROR("[hustdb_network][on_evhtp_thread_init]bind worker %u to node %d failed", id, node);
+        }
+    }
+    else if (WORKER_AFFINITY_CORE == affinity)
+    {
+        if (hustdb::bind_cpu(id) < 0)
+        {
+            LOG_ERROR("[hustdb_network][on_evhtp_thread_init]bind worker %u to a cpu failed", id);
+        }
+
+        bool ok = worker_listen(ctx);
+        if (!ok)
+        {
+            LOG_ERROR("[hustdb_network][on_evhtp_thread_init]worker %u listen on port %d failed", id, ctx->base.port);
+        }
+        pthread_mutex_lock(&g_listen_mutex);
+        ++g_listen_done;
+        if (!ok)
+        {
+            ++g_listen_failed;
+        }
+        pthread_cond_signal(&g_listen_cond);
+        pthread_mutex_unlock(&g_listen_mutex);
+    }
 }
 
 void on_evhtp_thread_exit(evhtp_t * htp, evthr_t * thr, void * arg)
 {
+    if (t_listener)
+    {
+        // the connections it accepted still refer to it
+        evhtp_unbind_socket(t_listener);
+    }
+}
+
+// hustdb_loop returns false if any worker failed to listen
+static bool wait_worker_listen(int workers)
+{
+    pthread_mutex_lock(&g_listen_mutex);
+    while (g_listen_done < workers)
+    {
+        pthread_cond_wait(&g_listen_cond, &g_listen_mutex);
+    }
+    bool ok = 0 == g_listen_failed;
+    pthread_mutex_unlock(&g_listen_mutex);
+    return ok;
+}
 
+static void on_idle_timer(evutil_socket_t fd, short events, void * arg)
+{
 }
 
 void hustdb_status_handler(evhtp_request_t * request, void * data)
@@ -27,6 +162,11 @@ void hustdb_status_handler(evhtp_request_t * request, void * data)
 static evhtp_res on_post_accept(evhtp_connection_t * conn, void * data)
 {
     hustdb_network::ip_allow_t * ip_allow_map = ((hustdb_network_ctx_t *) data)->ip_allow_map;
+    if (!conn->thread)
+    {
+        // accepted by the listener of a worker, see worker_listen
+        conn->thread = t_worker;
+    }
         
     if ( ip_allow_map->size > 0 && ! hustdb_network::can_access((struct sockaddr_in *)conn->saddr, ip_allow_map) )
     {
@@ -36,6 +176,35 @@ static evhtp_res on_post_accept(evhtp_connection_t * conn, void * data)
     return EVHTP_RES_OK;
 }
 
+static bool hustdb_setup(hustdb_network_ctx_t * ctx, evhtp_t * htp)
+{
+    //evhtp_set_parser_flags(htp, EVHTP_PARSE_QUERY_FLAG_LENIENT);
+    evhtp_set_max_keepalive_requests(htp, ctx->base.max_keepalive_requests);
+    evhtp_set_max_body_size(htp, ctx->base.max_body_size);
+    evhtp_set_timeouts(htp, &ctx->base.recv_timeout, &ctx->base.send_timeout);
+    if (ctx->base.disable_100_cont)
+    {
+        evhtp_disable_100_continue(htp);
+    }
+
+    htp->enable_nodelay      = ctx->base.enable_nodelay;
+    htp->enable_defer_accept = ctx->base.enable_defer_accept;
+    htp->enable_reuseport    = ctx->base.enable_reuseport;
+
+    if (!evhtp_set_cb(htp, "/status.html", hustdb_status_handler, ctx))
+    {
+        return false;
+    }
+
+    if (!hustdb_init_handlers(ctx, htp))
+    {
+        return false;
+    }
+
+    evhtp_set_post_accept_cb(htp, on_post_accept, ctx);
+    return true;
+}
+
 bool hustdb_loop(hustdb_network_ctx_t * ctx)
 {
     if (g_evbase)
@@ -53,45 +222,56 @@ bool hustdb_loop(hustdb_network_ctx_t * ctx)
         return false;
     }
 
-    //evhtp_set_parser_flags(htp, EVHTP_PARSE_QUERY_FLAG_LENIENT);
-    evhtp_set_max_keepalive_requests(htp, ctx->base.max_keepalive_requests);
-    evhtp_set_max_body_size(htp, ctx->base.max_body_size);
-    evhtp_set_timeouts(htp, &ctx->base.recv_timeout, &ctx->base.send_timeout);
-    if (ctx->base.disable_100_cont)
+    if (!hustdb_setup(ctx, htp))
     {
-        evhtp_disable_100_continue(htp);
+        return false;
     }
 
-    htp->enable_nodelay      = ctx->base.enable_nodelay;
-    htp->enable_defer_accept = ctx->base.enable_defer_accept;
-    htp->enable_reuseport    = ctx->base.enable_reuseport;
-
-    if (!evhtp_set_cb(htp, "/status.html", hustdb_status_handler, ctx))
+    if (!hustdb_network::async_read_open(ctx))
     {
         return false;
     }
 
-    if (!hustdb_init_handlers(ctx, htp))
+    if (!hustdb_network::mq_watch_open(ctx))
     {
         return false;
     }
 
-    evhtp_set_post_accept_cb(htp, on_post_accept, ctx);
-
     if (evhtp_use_threads_wexit(htp, on_evhtp_thread_init, on_evhtp_thread_exit, ctx->base.threads, ctx) < 0)
     {
         return false;
     }
-    if (evhtp_bind_socket(htp, "0.0.0.0", ctx->base.port, ctx->base.backlog) < 0)
+    if (WORKER_AFFINITY_CORE == ctx->db->get_server_conf().tcp_worker_affinity)
+    {
+        if (!wait_worker_listen(ctx->base.threads))
+        {
+            return false;
+        }
+        // nothing else is left on the main loop, keep it from returning
+        struct event * idle = event_new(g_evbase, -1, EV_PERSIST, on_idle_timer, NULL);
+        struct timeval tv = { 3600, 0 };
+        if (!idle || event_add(idle, &tv) < 0)
+        {
+            return false;
+        }
+    }
+    else if (evhtp_bind_socket(htp, "0.0.0.0", ctx->base.port, ctx->base.backlog) < 0)
     {
         return false;
     }
+    if (ctx->on_listen)
+    {
+        ctx->on_listen(ctx);
+    }
     event_base_loop(g_evbase, 0);
+    hustdb_network::async_read_close();
+    hustdb_network::mq_watch_close(ctx);
 
     return true;
 }
 
 void libevhtp_exit_server()
 {
-    event_base_loopbreak(g_evbase);
+    // may come from open_storage before the loop runs, which a loopbreak would miss
+    event_base_loopexit(g_evbase, NULL);
 }
@@ -26,6 +26,8 @@ struct hustdb_network_ctx_t
     evhtp::conf_t base;
     hustdb_network::ip_allow_t * ip_allow_map;
     hustdb_t * db;
+    // called once the port is bound, before the main loop runs
+    void (*on_listen)(hustdb_network_ctx_t * ctx);
 };
 
 namespace hustdb_network {
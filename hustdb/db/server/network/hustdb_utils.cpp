@@ -66,6 +66,86 @@ void hustdb_base64_encode(const c_str_t *src, c_str_t *dst)
     base64_encode_internal(src, basis64, 1, dst);
 }
 
+bool base64_decode_internal(const c_str_t *src, const uint8_t *basis, c_str_t *dst)
+{
+    size_t len;
+    uint8_t *d, *s;
+
+    for (len = 0; len < src->len; len++)
+    {
+        if (src->data[len] == '=')
+        {
+            break;
+        }
+
+        if (basis[(uint8_t)src->data[len]] == 77)
+        {
+            return false;
+        }
+    }
+
+    if (len % 4 == 1)
+    {
+        return false;
+    }
+
+    s = (uint8_t *)src->data;
+    d = (uint8_t *)dst->data;
+
+    while (len > 3)
+    {
+        *d++ = (uint8_t)(basis[s[0]] << 2 | basis[s[1]] >> 4);
+        *d++ = (uint8_t)(basis[s[1]] << 4 | basis[s[2]] >> 2);
+        *d++ = (uint8_t)(basis[s[2]] << 6 | basis[s[3]]);
+
+        s += 4;
+        len -= 4;
+    }
+
+    if (len > 1)
+    {
+        *d++ = (uint8_t)(basis[s[0]] << 2 | basis[s[1]] >> 4);
+    }
+
+    if (len > 2)
+    {
+        *d++ = (uint8_t)(basis[s[1]] << 4 | basis[s[2]] >> 2);
+    }
+
+    dst->len = d - (uint8_t *)dst->data;
+
+    return true;
+}
+
+bool hustdb_base64_decode(const c_str_t *src, c_str_t *dst)
+{
+    if (!src || !src->data || !dst || !dst->data)
+    {
+        return false;
+    }
+    static uint8_t basis64[] = {
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 62, 77, 77, 77, 63,
+        52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 77, 77, 77, 77, 77, 77,
+        77,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+        15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 77, 77, 77, 77, 77,
+        77, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+        41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 77, 77, 77, 77, 77,
+
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+        77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77
+    };
+
+    return base64_decode_internal(src, basis64, dst);
+}
+
 #define C_UNESCAPE_URI       1
 #define C_UNESCAPE_REDIRECT  2
 
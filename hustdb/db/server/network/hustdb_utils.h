@@ -9,6 +9,7 @@
 
 #define c_make_str(s) { sizeof(s) - 1, (char *) s }
 #define c_base64_encoded_length(len)  (((len + 2) / 3) * 4)
+#define c_base64_decoded_length(len)  (((len + 3) / 4) * 3)
 
 struct c_str_t
 {
@@ -18,6 +19,7 @@ struct c_str_t
 };
 
 void hustdb_base64_encode(const c_str_t *src, c_str_t *dst);
+bool hustdb_base64_decode(const c_str_t *src, c_str_t *dst);
 size_t hustdb_unescape_str(char * str, size_t size);
 
 #endif // __hustdb_utils_20160414141755_h__
@@ -352,6 +352,15 @@ uint32_t conf_t::get_id(evhtp_request_t * request)
     return buf_for_body.get_id(request->conn->thread);
 }
 
+uint32_t conf_t::get_id(evthr_t * thr)
+{
+    if (!thr)
+    {
+        return 0;
+    }
+    return buf_for_body.get_id(thr);
+}
+
 c_str_t conf_t::get_body(evhtp_request_t * request)
 {
     c_str_t body = { 0, 0 };
@@ -91,6 +91,7 @@ struct conf_t
     ~conf_t() {}
 
     uint32_t get_id(evhtp_request_t * request);
+    uint32_t get_id(evthr_t * thr);
     c_str_t get_body(evhtp_request_t * request);
     c_str_t get_compress_buf(evhtp_request_t * request);
     c_str_t get_decompress_buf(evhtp_request_t * request);
@@ -151,6 +151,35 @@ bool register_quit_signal()
     return true;
 }
 
+static pthread_t g_open_thread;
+static bool g_open_started = false;
+
+static void * open_storage_thread(void * arg)
+{
+    hustdb_t * db = reinterpret_cast<hustdb_t *>(arg);
+    if (!db->open_storage())
+    {
+        LOG_ERROR ("[hustdb_network]db open failed");
+        libevhtp_exit_server();
+        return NULL;
+    }
+    LOG_INFO ("[hustdb_network]db init success");
+    return NULL;
+}
+
+// the storage opens while the workers serve: requests to it get 500 and
+// /hustdb/ready 503 until it is done
+static void on_listen(hustdb_network_ctx_t * ctx)
+{
+    if (0 != pthread_create(&g_open_thread, NULL, open_storage_thread, ctx->db))
+    {
+        LOG_ERROR ("[hustdb_network]pthread_create error");
+        libevhtp_exit_server();
+        return;
+    }
+    g_open_started = true;
+}
+
 bool run_server(const std::string& pid_file)
 {
     pid_file_t pid(pid_file);
@@ -169,8 +198,6 @@ bool run_server(const std::string& pid_file)
         return -1;
     }
 
-    LOG_INFO ("[hustdb_network]db init success");
-
     server_conf_t cf = db.get_server_conf();
 
     evhtp::http_basic_auth_t auth(cf.http_security_user.c_str(), cf.http_security_passwd.c_str());
@@ -193,6 +220,7 @@ bool run_server(const std::string& pid_file)
     ctx.base.send_timeout.tv_sec = cf.tcp_send_timeout;
     ctx.ip_allow_map = &ip_allow_map;
     ctx.db = &db;
+    ctx.on_listen = on_listen;
 
     LOG_INFO ("[hustdb_network]start service");
 
@@ -200,6 +228,10 @@ bool run_server(const std::string& pid_file)
     {
         LOG_ERROR ("[hustdb_network]hustdb_loop error");
     }
+    if (g_open_started)
+    {
+        pthread_join(g_open_thread, NULL);
+    }
 
     LOG_INFO ("[hustdb_network]hustdb closed");
     return true;
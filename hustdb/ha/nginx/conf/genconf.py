@@ -55,6 +55,23 @@ def gen(conf, path):
         '%sproxy_busy_buffers_size %s;' % (tabs[3], conf['proxy']['proxy_buffer_size']),
         '%s}' % tabs[2]
         ])
+    __stream = lambda conf, prefix, cmd: merge([
+        '%slocation %s%s {' % (tabs[2], prefix, cmd),
+        '%sinternal;' % tabs[3],
+        '%sproxy_pass http://backend%s;' % (tabs[3], cmd),
+        '%sproxy_http_version 1.1;' % tabs[3],
+        '%sproxy_set_header Connection "Keep-Alive";' % tabs[3],
+        '%sproxy_set_header Authorization "Basic %s";' % (
+            tabs[3], conf['proxy']['auth']) if __has_proxy_auth(conf) else FILTER,
+        '%sproxy_connect_timeout %s;' % (tabs[3], conf['proxy']['proxy_connect_timeout']),
+        '%sproxy_send_timeout %s;' % (tabs[3], conf['proxy']['proxy_send_timeout']),
+        '%sproxy_read_timeout %s;' % (tabs[3], conf['proxy']['proxy_read_timeout']),
+        '%sproxy_buffering off;' % tabs[3],
+        '%sproxy_buffer_size %s;' % (tabs[3], conf['proxy']['stream_buffer_size']),
+        '%sproxy_buffers 2 %s;' % (tabs[3], conf['proxy']['stream_buffer_size']),
+        '%sproxy_busy_buffers_size %s;' % (tabs[3], conf['proxy']['stream_buffer_size']),
+        '%s}' % tabs[2]
+        ])
     __backends = lambda backends: merge(map(
         lambda s: '%sserver %s;' % (tabs[2], s), backends
         )) if len(backends) > 0 else '%s#server host:port;' % tabs[2]
@@ -72,6 +89,8 @@ def gen(conf, path):
     __proxy_has_key = lambda key: lambda o: 'proxy' in o and key in o['proxy']
     __has_backends = __proxy_has_key('backends')
     __has_proxy_cmds = __proxy_has_key('proxy_cmds')
+    __has_stream_cmds = __proxy_has_key('stream_cmds')
+    __stream_prefix = lambda conf: ([cf[VAL] for cf in conf['main_conf'] if 'stream_prefix' == cf[KEY]] + [None])[0] if 'main_conf' in conf else None
     __gen_health_check = lambda items: merge(map(lambda item: (
         '        %s;' % item), items))
     __gen_upstream = lambda conf: merge([
@@ -118,6 +137,8 @@ def gen(conf, path):
         '',
         merge(map(lambda uri: __proxy(conf, uri), conf['proxy']['proxy_cmds'])
             ) if __has_proxy_cmds(conf) else FILTER,
+        merge(map(lambda uri: __stream(conf, __stream_prefix(conf), uri), conf['proxy']['stream_cmds'])
+            ) if __has_stream_cmds(conf) and __stream_prefix(conf) else FILTER,
         '    }',
         '}'
         ]
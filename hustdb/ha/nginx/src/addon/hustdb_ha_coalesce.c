@@ -0,0 +1,319 @@
+#include "hustdb_ha_handler_inner.h"
+
+// identical reads (same backend uri and args) arriving while one of them is
+// still in flight are parked on it instead of starting their own subrequest;
+// its response is copied to every waiter when it completes. the table is
+// per worker, nothing is shared between processes.
+
+struct hustdb_ha_flight_s
+{
+    ngx_str_node_t sn;
+    ngx_queue_t waiters;
+    ngx_http_request_t * leader;
+    // the waiter reading again after the leader went away, the others stay queued
+    hustdb_ha_waiter_t * heir;
+};
+
+struct hustdb_ha_waiter_s
+{
+    ngx_queue_t queue;
+    hustdb_ha_flight_t * flight;
+    ngx_http_request_t * r;
+    ngx_bool_t done;
+    ngx_uint_t status;
+    ngx_str_t version;
+    ngx_str_t response;
+};
+
+typedef struct
+{
+    ngx_uint_t leaders;
+    ngx_uint_t hits;
+    ngx_uint_t aborts;
+    ngx_uint_t inflight;
+} hustdb_ha_coalesce_stat_t;
+
+static ngx_rbtree_t g_flights;
+static ngx_rbtree_node_t g_sentinel;
+static ngx_bool_t g_flights_init = false;
+static hustdb_ha_coalesce_stat_t g_stat = { 0, 0, 0, 0 };
+
+static ngx_str_t __make_key(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    ngx_str_t key = { 0, NULL };
+    key.data = ngx_palloc(r->pool, backend_uri->len + 1 + r->args.len);
+    if (!key.data)
+    {
+        return key;
+    }
+    u_char * p = ngx_cpymem(key.data, backend_uri->data, backend_uri->len);
+    *p++ = '?';
+    p = ngx_cpymem(p, r->args.data, r->args.len);
+    key.len = p - key.data;
+    return key;
+}
+
+static void __post(ngx_http_request_t * r)
+{
+    ngx_connection_t * c = r->connection;
+    if (c && c->write)
+    {
+        ngx_post_event(c->write, &ngx_posted_events);
+    }
+}
+
+static void __wake(ngx_http_request_t * r, hustdb_ha_waiter_t * waiter)
+{
+    ngx_queue_remove(&waiter->queue);
+    waiter->flight = NULL;
+    __post(r);
+}
+
+static void __waiter_handler(ngx_http_request_t *r)
+{
+    hustdb_ha_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (!ctx || !ctx->waiter)
+    {
+        return;
+    }
+    hustdb_ha_waiter_t * waiter = ctx->waiter;
+    if (waiter->flight && waiter->flight->heir != waiter)
+    {
+        return;
+    }
+    if (waiter->done)
+    {
+        ngx_http_finalize_request(r, hustdb_ha_send_response(waiter->status, &waiter->version, &waiter->response, r));
+        return;
+    }
+    // the leader went away before its subrequest completed: read again,
+    // hustdb_ha_coalesce_join hands the flight to r
+    ngx_http_set_addon_module_ctx(r, NULL);
+    r->write_event_handler = ngx_http_core_run_phases;
+    ngx_http_core_run_phases(r);
+}
+
+static void __leave(hustdb_ha_flight_t * flight)
+{
+    ngx_rbtree_delete(&g_flights, &flight->sn.node);
+    --g_stat.inflight;
+    ngx_free(flight);
+}
+
+// the read of the flight was abandoned: the first waiter reads again for
+// the others, which stay queued, or the flight ends if nobody waits
+static void __promote(hustdb_ha_flight_t * flight)
+{
+    ++g_stat.aborts;
+    flight->leader = NULL;
+    flight->heir = NULL;
+    if (ngx_queue_empty(&flight->waiters))
+    {
+        __leave(flight);
+        return;
+    }
+    ngx_queue_t * q = ngx_queue_head(&flight->waiters);
+    hustdb_ha_waiter_t * waiter = ngx_queue_data(q, hustdb_ha_waiter_t, queue);
+    ngx_queue_remove(&waiter->queue);
+    flight->leader = waiter->r;
+    flight->heir = waiter;
+    __post(waiter->r);
+}
+
+static void __leader_cleanup(void * data)
+{
+    hustdb_ha_ctx_t * ctx = data;
+    hustdb_ha_flight_t * flight = ctx->flight;
+    if (!flight)
+    {
+        return;
+    }
+    ctx->flight = NULL;
+    __promote(flight);
+}
+
+static void __waiter_cleanup(void * data)
+{
+    hustdb_ha_waiter_t * waiter = data;
+    hustdb_ha_flight_t * flight = waiter->flight;
+    if (!flight)
+    {
+        return;
+    }
+    waiter->flight = NULL;
+    if (flight->heir == waiter)
+    {
+        // gone before it could read again, or it was answered without reading
+        __promote(flight);
+        return;
+    }
+    ngx_queue_remove(&waiter->queue);
+}
+
+static ngx_int_t __adopt(hustdb_ha_flight_t * flight, hustdb_ha_ctx_t * ctx, ngx_http_request_t *r)
+{
+    hustdb_ha_waiter_t * heir = flight->heir;
+    ngx_pool_cleanup_t * cln = ngx_pool_cleanup_add(r->pool, 0);
+    if (!cln)
+    {
+        // r reads by itself, the next waiter leads the others
+        heir->flight = NULL;
+        __promote(flight);
+        return NGX_DECLINED;
+    }
+    heir->flight = NULL;
+    flight->heir = NULL;
+
+    cln->handler = __leader_cleanup;
+    cln->data = ctx;
+    ctx->flight = flight;
+
+    ++g_stat.leaders;
+    return NGX_DECLINED;
+}
+
+static ngx_int_t __lead(ngx_str_t * key, uint32_t hash, hustdb_ha_ctx_t * ctx, ngx_http_request_t *r)
+{
+    ngx_pool_cleanup_t * cln = ngx_pool_cleanup_add(r->pool, 0);
+    if (!cln)
+    {
+        return NGX_DECLINED;
+    }
+    hustdb_ha_flight_t * flight = ngx_alloc(sizeof(hustdb_ha_flight_t) + key->len, ngx_cycle->log);
+    if (!flight)
+    {
+        return NGX_DECLINED;
+    }
+    memset(flight, 0, sizeof(hustdb_ha_flight_t));
+    flight->sn.node.key = hash;
+    flight->sn.str.len = key->len;
+    flight->sn.str.data = (u_char *) (flight + 1);
+    memcpy(flight->sn.str.data, key->data, key->len);
+    ngx_queue_init(&flight->waiters);
+    flight->leader = r;
+    ngx_rbtree_insert(&g_flights, &flight->sn.node);
+
+    cln->handler = __leader_cleanup;
+    cln->data = ctx;
+    ctx->flight = flight;
+
+    ++g_stat.leaders;
+    ++g_stat.inflight;
+    return NGX_DECLINED;
+}
+
+static ngx_int_t __wait(hustdb_ha_flight_t * flight, hustdb_ha_ctx_t * ctx, ngx_http_request_t *r)
+{
+    hustdb_ha_waiter_t * waiter = ngx_pcalloc(r->pool, sizeof(hustdb_ha_waiter_t));
+    if (!waiter)
+    {
+        return NGX_DECLINED;
+    }
+    ngx_pool_cleanup_t * cln = ngx_pool_cleanup_add(r->pool, 0);
+    if (!cln)
+    {
+        return NGX_DECLINED;
+    }
+    cln->handler = __waiter_cleanup;
+    cln->data = waiter;
+
+    waiter->flight = flight;
+    waiter->r = r;
+    ngx_queue_insert_tail(&flight->waiters, &waiter->queue);
+
+    ctx->waiter = waiter;
+    r->write_event_handler = __waiter_handler;
+    ++r->main->count;
+
+    ++g_stat.hits;
+    return NGX_DONE;
+}
+
+ngx_int_t hustdb_ha_coalesce_join(ngx_str_t * backend_uri, hustdb_ha_ctx_t * ctx, ngx_http_request_t *r)
+{
+    if (!g_flights_init)
+    {
+        ngx_rbtree_init(&g_flights, &g_sentinel, ngx_str_rbtree_insert_value);
+        g_flights_init = true;
+    }
+    ngx_str_t key = __make_key(backend_uri, r);
+    if (!key.data)
+    {
+        return NGX_DECLINED;
+    }
+    uint32_t hash = ngx_crc32_short(key.data, key.len);
+    ngx_str_node_t * sn = ngx_str_rbtree_lookup(&g_flights, &key, hash);
+    if (!sn)
+    {
+        return __lead(&key, hash, ctx, r);
+    }
+    hustdb_ha_flight_t * flight = (hustdb_ha_flight_t *) sn;
+    if (flight->heir && flight->heir->r == r)
+    {
+        return __adopt(flight, ctx, r);
+    }
+    return __wait(flight, ctx, r);
+}
+
+void hustdb_ha_coalesce_leave(
+    ngx_uint_t status,
+    const ngx_str_t * version,
+    const ngx_str_t * response,
+    hustdb_ha_ctx_t * ctx)
+{
+    hustdb_ha_flight_t * flight = ctx->flight;
+    if (!flight)
+    {
+        return;
+    }
+    ctx->flight = NULL;
+    while (!ngx_queue_empty(&flight->waiters))
+    {
+        ngx_queue_t * q = ngx_queue_head(&flight->waiters);
+        hustdb_ha_waiter_t * waiter = ngx_queue_data(q, hustdb_ha_waiter_t, queue);
+        ngx_http_request_t * r = waiter->r;
+
+        // the leader's pool may be gone before the waiter has sent its response
+        waiter->done = true;
+        waiter->status = status;
+        if (NGX_HTTP_OK == status && version && version->data)
+        {
+            waiter->version = hustdb_ha_make_str((ngx_str_t *) version, r);
+        }
+        if (NGX_HTTP_OK == status && response && response->data && response->len > 0)
+        {
+            waiter->response.data = ngx_palloc(r->pool, response->len);
+            if (waiter->response.data)
+            {
+                memcpy(waiter->response.data, response->data, response->len);
+                waiter->response.len = response->len;
+            }
+            else
+            {
+                waiter->status = NGX_HTTP_NOT_FOUND;
+            }
+        }
+        __wake(r, waiter);
+    }
+    __leave(flight);
+}
+
+ngx_int_t hustdb_ha_coalesce_status_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    if (!mcf)
+    {
+        return NGX_ERROR;
+    }
+    enum { SIZE = 256 };
+    u_char * buf = ngx_palloc(r->pool, SIZE);
+    if (!buf)
+    {
+        return NGX_ERROR;
+    }
+    u_char * last = ngx_snprintf(buf, SIZE,
+        "{\"coalesce_reads\":%s,\"pid\":%P,\"leaders\":%ui,\"hits\":%ui,\"aborts\":%ui,\"inflight\":%ui}",
+        mcf->coalesce_reads ? "true" : "false", ngx_pid, g_stat.leaders, g_stat.hits, g_stat.aborts, g_stat.inflight);
+    ngx_str_t response = { last - buf, buf };
+    return ngx_http_send_response_imp(NGX_HTTP_OK, &response, r);
+}
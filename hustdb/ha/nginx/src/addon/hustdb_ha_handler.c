@@ -42,9 +42,19 @@ static ngx_bool_t __check_keys_parameter(ngx_str_t * backend_uri, ngx_http_reque
     return true;
 }
 
+static ngx_bool_t __check_scatter_keys_parameter(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    char * val = ngx_http_get_param_val(&r->args, "file", r->pool);
+    return val && atoi(val) >= 0;
+}
+
 ngx_int_t hustdb_ha_keys_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_post_peer(__check_keys_parameter, backend_uri, r);
+    if (hustdb_ha_has_cursor(r))
+    {
+        return hustdb_ha_scatter_keys_handler(__check_scatter_keys_parameter, backend_uri, r);
+    }
+    return hustdb_ha_post_peer(true, __check_keys_parameter, backend_uri, r);
 }
 
 static ngx_bool_t __check_stat_parameter(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -62,7 +72,7 @@ static ngx_bool_t __check_stat_parameter(ngx_str_t * backend_uri, ngx_http_reque
 
 ngx_int_t hustdb_ha_stat_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_post_peer(__check_stat_parameter, backend_uri, r);
+    return hustdb_ha_post_peer(false, __check_stat_parameter, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_sync_alive_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -99,7 +109,7 @@ ngx_int_t hustdb_ha_sync_status_handler(ngx_str_t * backend_uri, ngx_http_reques
     return NGX_DONE;
 }
 
-static ngx_bool_t __check_zrangebyscore_parameter(ngx_str_t * backend_uri, ngx_http_request_t *r)
+static ngx_bool_t __check_score_range(ngx_http_request_t *r)
 {
     static const char * keys[] = { "min", "max" };
     static const size_t size = sizeof(keys) / sizeof(char *);
@@ -112,11 +122,25 @@ static ngx_bool_t __check_zrangebyscore_parameter(ngx_str_t * backend_uri, ngx_h
             return false;
         }
     }
-    return hustdb_ha_check_keys(backend_uri, r);
+    return true;
+}
+
+static ngx_bool_t __check_zrangebyscore_parameter(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return __check_score_range(r) && hustdb_ha_check_keys(backend_uri, r);
+}
+
+static ngx_bool_t __check_scatter_zrangebyscore_parameter(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return __check_score_range(r) && hustdb_ha_check_tb(backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_zrangebyscore_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
+    if (hustdb_ha_has_cursor(r))
+    {
+        return hustdb_ha_scatter_zkeys_handler(__check_scatter_zrangebyscore_parameter, backend_uri, r);
+    }
     return hustdb_ha_zread_keys_handler(__check_zrangebyscore_parameter, backend_uri, r);
 }
 
@@ -30,6 +30,31 @@ ngx_bool_t hustdb_ha_add_version(const ngx_str_t * version, ngx_http_request_t *
     return ngx_http_add_field_to_headers_out(&VERSION_KEY, version, r);
 }
 
+ngx_str_t * hustdb_ha_stream_uri(ngx_str_t * backend_uri, ngx_http_subrequest_ctx_t * ctx, ngx_http_request_t * r)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    if (!mcf || mcf->stream_prefix.len < 1)
+    {
+        return backend_uri;
+    }
+    ngx_str_t * uri = ngx_palloc(r->pool, sizeof(ngx_str_t));
+    if (!uri)
+    {
+        return backend_uri;
+    }
+    uri->len = mcf->stream_prefix.len + backend_uri->len;
+    uri->data = ngx_palloc(r->pool, uri->len + 1);
+    if (!uri->data)
+    {
+        return backend_uri;
+    }
+    memcpy(uri->data, mcf->stream_prefix.data, mcf->stream_prefix.len);
+    memcpy(uri->data + mcf->stream_prefix.len, backend_uri->data, backend_uri->len);
+    uri->data[uri->len] = '\0';
+    ctx->stream = true;
+    return uri;
+}
+
 ngx_int_t hustdb_ha_on_subrequest_complete(ngx_http_request_t * r, void * data, ngx_int_t rc)
 {
     hustdb_ha_ctx_t * ctx = data;
@@ -64,7 +89,7 @@ ngx_int_t hustdb_ha_on_subrequest_complete(ngx_http_request_t * r, void * data,
 
     } while (0);
 
-    return ngx_http_finish_subrequest(r);
+    return ngx_http_stream_subrequest_finish(r, rc);
 }
 
 ngx_str_t * hustdb_ha_get_keys_from_header(ngx_http_request_t * r)
@@ -86,10 +111,10 @@ static ngx_int_t __on_subrequest_complete(ngx_http_request_t * r, void * data, n
         ctx->base.response.data = r->upstream->buffer.pos;
         ctx->keys = hustdb_ha_get_keys_from_header(r);
     }
-    return ngx_http_finish_subrequest(r);
+    return ngx_http_stream_subrequest_finish(r, rc);
 }
 
-static ngx_int_t __post_peer(ngx_str_t * backend_uri, ngx_http_request_t *r)
+static ngx_int_t __post_peer(ngx_bool_t stream, ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
     ngx_http_upstream_rr_peer_t * peer = hustdb_ha_get_peer(r);
     if (!peer)
@@ -109,11 +134,17 @@ static ngx_int_t __post_peer(ngx_str_t * backend_uri, ngx_http_request_t *r)
     ngx_str_t key = ngx_string(PEER_KEY);
     ctx->base.args = ngx_http_remove_param(&r->args, &key, r->pool);
 
+    if (stream)
+    {
+        backend_uri = hustdb_ha_stream_uri(backend_uri, &ctx->base, r);
+    }
+
     return ngx_http_gen_subrequest(backend_uri, r, peer,
         &ctx->base, __on_subrequest_complete);
 }
 
 ngx_int_t hustdb_ha_post_peer(
+    ngx_bool_t stream,
     hustdb_ha_check_parameter_t check_parameter,
     ngx_str_t * backend_uri,
     ngx_http_request_t *r)
@@ -125,7 +156,12 @@ ngx_int_t hustdb_ha_post_peer(
         {
             return NGX_ERROR;
         }
-        return __post_peer(backend_uri, r);
+        return __post_peer(stream, backend_uri, r);
+    }
+
+    if (ctx->base.streamed)
+    {
+        return ngx_http_send_special(r, NGX_HTTP_LAST);
     }
 
     if (ctx->keys)
@@ -3,6 +3,9 @@
 
 #include "hustdb_ha_table_def.h"
 
+typedef struct hustdb_ha_flight_s hustdb_ha_flight_t;
+typedef struct hustdb_ha_waiter_s hustdb_ha_waiter_t;
+
 typedef struct
 {
     ngx_http_subrequest_ctx_t base;
@@ -15,6 +18,13 @@ typedef struct
 
     ngx_bool_t key_in_body;
     ngx_bool_t has_tb;
+
+    hustdb_ha_flight_t * flight;
+    hustdb_ha_waiter_t * waiter;
+
+    ngx_str_t cache_key;
+    uint32_t cache_hash;
+    uint64_t cache_gen;
 } hustdb_ha_ctx_t;
 
 ngx_int_t hustdb_ha_send_response(
@@ -25,13 +35,49 @@ ngx_int_t hustdb_ha_send_response(
 
 ngx_int_t hustdb_ha_on_subrequest_complete(ngx_http_request_t * r, void * data, ngx_int_t rc);
 
+// with stream_prefix set, returns the uri of the unbuffered location proxying
+// backend_uri and marks ctx as a stream subrequest; otherwise backend_uri
+ngx_str_t * hustdb_ha_stream_uri(ngx_str_t * backend_uri, ngx_http_subrequest_ctx_t * ctx, ngx_http_request_t * r);
+
+// with coalesce_reads on, a read identical to one in flight in this worker
+// waits for it: NGX_DONE if r was parked, NGX_DECLINED if r has to read
+ngx_int_t hustdb_ha_coalesce_join(ngx_str_t * backend_uri, hustdb_ha_ctx_t * ctx, ngx_http_request_t *r);
+
+// hands the result of the read led by ctx to the requests waiting on it
+void hustdb_ha_coalesce_leave(
+    ngx_uint_t status,
+    const ngx_str_t * version,
+    const ngx_str_t * response,
+    hustdb_ha_ctx_t * ctx);
+
+// with read_cache_shm_size set, get and hget are answered from shared memory
+// when they can: NGX_DECLINED on a miss, which leaves ctx ready for the put
+ngx_int_t hustdb_ha_read_cache_get(ngx_str_t * backend_uri, hustdb_ha_ctx_t * ctx, ngx_http_request_t *r);
+
+void hustdb_ha_read_cache_put(
+    const ngx_str_t * version,
+    const ngx_str_t * response,
+    hustdb_ha_ctx_t * ctx,
+    ngx_http_request_t *r);
+
+// tb is NULL for the keys of get
+void hustdb_ha_read_cache_purge(const char * tb, const char * key, ngx_http_request_t *r);
+// every cached field of tb, for hdrop
+void hustdb_ha_read_cache_purge_table(const char * tb, ngx_http_request_t *r);
+
+ngx_shm_zone_t * hustdb_ha_init_read_cache(ngx_conf_t * cf, ngx_http_hustdb_ha_main_conf_t * mcf, void * module);
+
+ngx_bool_t hustdb_ha_init_write_admission(ngx_http_hustdb_ha_main_conf_t * mcf, ngx_pool_t * pool);
+
 typedef ngx_bool_t (*hustdb_ha_check_parameter_t)(ngx_str_t * backend_uri, ngx_http_request_t *r);
 ngx_int_t hustdb_ha_post_peer(
+    ngx_bool_t stream,
     hustdb_ha_check_parameter_t check_parameter,
     ngx_str_t * backend_uri,
     ngx_http_request_t *r);
 
 ngx_int_t hustdb_ha_read_handler(
+    ngx_bool_t stream,
     ngx_bool_t read_body,
     ngx_bool_t key_in_body,
     hustdb_ha_check_parameter_t check_parameter,
@@ -48,6 +94,29 @@ ngx_int_t hustdb_ha_zread_keys_handler(
     ngx_str_t * backend_uri,
     ngx_http_request_t *r);
 
+// with a cursor argument keys, hkeys, smembers and zrangeby* fan out to
+// every backend they span and merge the pages, see hustdb_ha_scatter_handler.c
+ngx_bool_t hustdb_ha_has_cursor(ngx_http_request_t *r);
+
+ngx_int_t hustdb_ha_scatter_keys_handler(
+    hustdb_ha_check_parameter_t check_parameter,
+    ngx_str_t * backend_uri,
+    ngx_http_request_t *r);
+
+ngx_int_t hustdb_ha_scatter_zkeys_handler(
+    hustdb_ha_check_parameter_t check_parameter,
+    ngx_str_t * backend_uri,
+    ngx_http_request_t *r);
+
+ngx_int_t hustdb_ha_scatter_stat_handler(ngx_str_t * backend_uri, ngx_http_request_t *r);
+// the top-K of every backend, summed up per item
+ngx_int_t hustdb_ha_scatter_hotkeys_handler(ngx_str_t * backend_uri, ngx_http_request_t *r);
+
+// hdrop / sdrop / zdrop go to every backend holding the table
+ngx_int_t hustdb_ha_scatter_drop_handler(ngx_bool_t zset, ngx_str_t * backend_uri, ngx_http_request_t *r);
+// zremrangebyscore / zremrangebyrank / zpopmin go to the replicas of the table
+ngx_int_t hustdb_ha_scatter_zremrange_handler(ngx_str_t * backend_uri, ngx_http_request_t *r);
+
 typedef ngx_http_subrequest_peer_t * (*hustdb_ha_hash_peer_t)(ngx_http_request_t *r);
 
 ngx_http_subrequest_peer_t * hustdb_ha_hash_peer_by_key(ngx_http_request_t *r);
@@ -20,7 +20,7 @@ ngx_int_t hustdb_ha_cache_del_handler(ngx_str_t * backend_uri, ngx_http_request_
 
 ngx_int_t hustdb_ha_cache_exist_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, NULL, backend_uri, r);
+    return hustdb_ha_read_handler(false, false, false, NULL, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_cache_expire_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -30,7 +30,7 @@ ngx_int_t hustdb_ha_cache_expire_handler(ngx_str_t * backend_uri, ngx_http_reque
 
 ngx_int_t hustdb_ha_cache_get_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, NULL, backend_uri, r);
+    return hustdb_ha_read_handler(true, false, false, NULL, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_cache_hdel_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -40,12 +40,12 @@ ngx_int_t hustdb_ha_cache_hdel_handler(ngx_str_t * backend_uri, ngx_http_request
 
 ngx_int_t hustdb_ha_cache_hexist_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, hustdb_ha_check_tb, backend_uri, r);
+    return hustdb_ha_read_handler(false, false, false, hustdb_ha_check_tb, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_cache_hget_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, hustdb_ha_check_tb, backend_uri, r);
+    return hustdb_ha_read_handler(true, false, false, hustdb_ha_check_tb, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_cache_hincrby_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -75,7 +75,7 @@ ngx_int_t hustdb_ha_cache_put_handler(ngx_str_t * backend_uri, ngx_http_request_
 
 ngx_int_t hustdb_ha_cache_ttl_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, NULL, backend_uri, r);
+    return hustdb_ha_read_handler(false, false, false, NULL, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_del_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -85,17 +85,17 @@ ngx_int_t hustdb_ha_del_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 
 ngx_int_t hustdb_ha_exist_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, NULL, backend_uri, r);
+    return hustdb_ha_read_handler(false, false, false, NULL, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_file_count_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_post_peer(NULL, backend_uri, r);
+    return hustdb_ha_post_peer(false, NULL, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_get_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, NULL, backend_uri, r);
+    return hustdb_ha_read_handler(true, false, false, NULL, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_get2_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -110,12 +110,12 @@ ngx_int_t hustdb_ha_hdel_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 
 ngx_int_t hustdb_ha_hexist_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, hustdb_ha_check_tb, backend_uri, r);
+    return hustdb_ha_read_handler(false, false, false, hustdb_ha_check_tb, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_hget_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(false, false, hustdb_ha_check_tb, backend_uri, r);
+    return hustdb_ha_read_handler(true, false, false, hustdb_ha_check_tb, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_hget2_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -125,7 +125,16 @@ ngx_int_t hustdb_ha_hget2_handler(ngx_str_t * backend_uri, ngx_http_request_t *r
 
 ngx_int_t hustdb_ha_hkeys_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_post_peer(hustdb_ha_check_keys, backend_uri, r);
+    if (hustdb_ha_has_cursor(r))
+    {
+        return hustdb_ha_scatter_keys_handler(hustdb_ha_check_tb, backend_uri, r);
+    }
+    return hustdb_ha_post_peer(true, hustdb_ha_check_keys, backend_uri, r);
+}
+
+ngx_int_t hustdb_ha_hdrop_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return hustdb_ha_scatter_drop_handler(false, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_hset_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -145,7 +154,7 @@ ngx_int_t hustdb_ha_sadd_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 
 ngx_int_t hustdb_ha_sismember_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_read_handler(true, true, hustdb_ha_check_tb, backend_uri, r);
+    return hustdb_ha_read_handler(false, true, true, hustdb_ha_check_tb, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_sismember2_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -155,7 +164,16 @@ ngx_int_t hustdb_ha_sismember2_handler(ngx_str_t * backend_uri, ngx_http_request
 
 ngx_int_t hustdb_ha_smembers_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_post_peer(hustdb_ha_check_keys, backend_uri, r);
+    if (hustdb_ha_has_cursor(r))
+    {
+        return hustdb_ha_scatter_keys_handler(hustdb_ha_check_tb, backend_uri, r);
+    }
+    return hustdb_ha_post_peer(true, hustdb_ha_check_keys, backend_uri, r);
+}
+
+ngx_int_t hustdb_ha_sdrop_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return hustdb_ha_scatter_drop_handler(false, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_srem_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -165,7 +183,20 @@ ngx_int_t hustdb_ha_srem_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 
 ngx_int_t hustdb_ha_stat_all_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
-    return hustdb_ha_post_peer(NULL, backend_uri, r);
+    if (!ngx_http_get_param_val(&r->args, PEER_KEY, r->pool))
+    {
+        return hustdb_ha_scatter_stat_handler(backend_uri, r);
+    }
+    return hustdb_ha_post_peer(false, NULL, backend_uri, r);
+}
+
+ngx_int_t hustdb_ha_hotkeys_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    if (!ngx_http_get_param_val(&r->args, PEER_KEY, r->pool))
+    {
+        return hustdb_ha_scatter_hotkeys_handler(backend_uri, r);
+    }
+    return hustdb_ha_post_peer(false, NULL, backend_uri, r);
 }
 
 ngx_int_t hustdb_ha_zadd_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -180,9 +211,33 @@ ngx_int_t hustdb_ha_zismember_handler(ngx_str_t * backend_uri, ngx_http_request_
 
 ngx_int_t hustdb_ha_zrangebyrank_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
+    if (hustdb_ha_has_cursor(r))
+    {
+        return hustdb_ha_scatter_zkeys_handler(hustdb_ha_check_tb, backend_uri, r);
+    }
     return hustdb_ha_zread_keys_handler(NULL, backend_uri, r);
 }
 
+ngx_int_t hustdb_ha_zdrop_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return hustdb_ha_scatter_drop_handler(true, backend_uri, r);
+}
+
+ngx_int_t hustdb_ha_zremrangebyscore_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return hustdb_ha_scatter_zremrange_handler(backend_uri, r);
+}
+
+ngx_int_t hustdb_ha_zremrangebyrank_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return hustdb_ha_scatter_zremrange_handler(backend_uri, r);
+}
+
+ngx_int_t hustdb_ha_zpopmin_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    return hustdb_ha_scatter_zremrange_handler(backend_uri, r);
+}
+
 ngx_int_t hustdb_ha_zrem_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
     return hustdb_ha_zwrite_handler(HUSTDB_METHOD_ZREM, backend_uri, r);
@@ -95,6 +95,8 @@ ngx_int_t hustdb_ha_hincrby_handler(ngx_str_t * backend_uri, ngx_http_request_t
     {
         return __start_hincrby(backend_uri, r);
     }
+    hustdb_ha_read_cache_purge(ngx_http_get_param_val(&r->args, "tb", r->pool),
+        ngx_http_get_param_val(&r->args, "key", r->pool), r);
     if (NGX_HTTP_OK != r->headers_out.status)
     {
         return ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
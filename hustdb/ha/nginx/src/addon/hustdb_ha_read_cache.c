@@ -0,0 +1,369 @@
+#include "hustdb_ha_handler_inner.h"
+
+// get and hget responses kept in a shared memory zone for read_cache_ttl,
+// so that every worker answers a hot key without a subrequest. a write
+// through this ha purges the key and bumps the generation of its stripe:
+// a read started before the write completed sees another generation when
+// its response arrives and does not store it. writes through other ha
+// instances are only bounded by the ttl.
+
+#define READ_CACHE_STRIPES    1024
+
+typedef struct
+{
+    ngx_str_node_t sn;
+    ngx_queue_t queue;
+    ngx_msec_t expire;
+    size_t version_len;
+    size_t value_len;
+    u_char data[1]; // key, version, value
+} hustdb_ha_read_cache_node_t;
+
+typedef struct
+{
+    ngx_rbtree_t rbtree;
+    ngx_rbtree_node_t sentinel;
+    ngx_queue_t lru;
+    uint64_t gens[READ_CACHE_STRIPES];
+
+    ngx_uint_t entries;
+    ngx_uint_t hits;
+    ngx_uint_t misses;
+    ngx_uint_t inserts;
+    ngx_uint_t evictions;
+    ngx_uint_t expired;
+    ngx_uint_t purges;
+} hustdb_ha_read_cache_sh_t;
+
+static const ngx_str_t GET_URI = ngx_string("/hustdb/get");
+static const ngx_str_t HGET_URI = ngx_string("/hustdb/hget");
+
+static ngx_int_t __init_shm_ctx(ngx_slab_pool_t * shpool, void * data)
+{
+    hustdb_ha_read_cache_sh_t * sh = data;
+    ngx_memzero(sh, sizeof(hustdb_ha_read_cache_sh_t));
+    ngx_rbtree_init(&sh->rbtree, &sh->sentinel, ngx_str_rbtree_insert_value);
+    ngx_queue_init(&sh->lru);
+    return NGX_OK;
+}
+
+ngx_shm_zone_t * hustdb_ha_init_read_cache(ngx_conf_t * cf, ngx_http_hustdb_ha_main_conf_t * mcf, void * module)
+{
+    static ngx_str_t SHM_NAME = ngx_string("hustdb_ha_read_cache");
+    if (mcf->read_cache_ttl <= 0)
+    {
+        mcf->read_cache_ttl = 1000;
+    }
+    if (mcf->read_cache_max_value <= 0)
+    {
+        mcf->read_cache_max_value = 64 * 1024;
+    }
+    return ngx_http_addon_init_shm(cf, &SHM_NAME, mcf->read_cache_shm_size,
+        sizeof(hustdb_ha_read_cache_sh_t), __init_shm_ctx, module);
+}
+
+static ngx_http_addon_shm_ctx_t * __get_shm_ctx(ngx_http_request_t *r)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    if (!mcf || !mcf->read_cache_zone)
+    {
+        return NULL;
+    }
+    return mcf->read_cache_zone->data;
+}
+
+static ngx_str_t __make_key(const char * tb, const char * key, ngx_pool_t * pool)
+{
+    ngx_str_t out = ngx_null_string;
+    size_t tb_len = tb ? strlen(tb) + 1 : 0;
+    size_t key_len = strlen(key);
+    out.data = ngx_palloc(pool, tb_len + key_len);
+    if (!out.data)
+    {
+        return out;
+    }
+    u_char * p = out.data;
+    if (tb)
+    {
+        p = ngx_cpymem(p, tb, tb_len - 1);
+        *p++ = '\n';
+    }
+    p = ngx_cpymem(p, key, key_len);
+    out.len = p - out.data;
+    return out;
+}
+
+static void __delete_node(hustdb_ha_read_cache_node_t * node, ngx_slab_pool_t * shpool, hustdb_ha_read_cache_sh_t * sh)
+{
+    ngx_queue_remove(&node->queue);
+    ngx_rbtree_delete(&sh->rbtree, &node->sn.node);
+    ngx_slab_free_locked(shpool, node);
+    --sh->entries;
+}
+
+static hustdb_ha_read_cache_node_t * __lookup(ngx_str_t * key, uint32_t hash, hustdb_ha_read_cache_sh_t * sh)
+{
+    return (hustdb_ha_read_cache_node_t *) ngx_str_rbtree_lookup(&sh->rbtree, key, hash);
+}
+
+ngx_int_t hustdb_ha_read_cache_get(ngx_str_t * backend_uri, hustdb_ha_ctx_t * ctx, ngx_http_request_t *r)
+{
+    ngx_http_addon_shm_ctx_t * shm = __get_shm_ctx(r);
+    if (!shm)
+    {
+        return NGX_DECLINED;
+    }
+    const char * tb = NULL;
+    if (ngx_http_str_eq(backend_uri, &HGET_URI))
+    {
+        tb = ngx_http_get_param_val(&r->args, "tb", r->pool);
+        if (!tb)
+        {
+            return NGX_DECLINED;
+        }
+    }
+    else if (!ngx_http_str_eq(backend_uri, &GET_URI))
+    {
+        return NGX_DECLINED;
+    }
+    const char * key = ngx_http_get_param_val(&r->args, "key", r->pool);
+    if (!key)
+    {
+        return NGX_DECLINED;
+    }
+    ngx_str_t cache_key = __make_key(tb, key, r->pool);
+    if (!cache_key.data)
+    {
+        return NGX_DECLINED;
+    }
+    uint32_t hash = ngx_crc32_short(cache_key.data, cache_key.len);
+
+    ngx_slab_pool_t * shpool = shm->shpool;
+    hustdb_ha_read_cache_sh_t * sh = shm->sh;
+    ngx_str_t version = ngx_null_string;
+    ngx_str_t value = ngx_null_string;
+
+    ngx_shmtx_lock(&shpool->mutex);
+    hustdb_ha_read_cache_node_t * node = __lookup(&cache_key, hash, sh);
+    if (node && (ngx_msec_int_t) (node->expire - ngx_current_msec) <= 0)
+    {
+        __delete_node(node, shpool, sh);
+        ++sh->expired;
+        node = NULL;
+    }
+    if (node)
+    {
+        version.len = node->version_len;
+        value.len = node->value_len;
+        version.data = ngx_palloc(r->pool, version.len + value.len + 1);
+        if (version.data)
+        {
+            ngx_memcpy(version.data, node->data + node->sn.str.len, version.len + value.len);
+            value.data = version.data + version.len;
+            ngx_queue_remove(&node->queue);
+            ngx_queue_insert_head(&sh->lru, &node->queue);
+            ++sh->hits;
+        }
+    }
+    if (!version.data)
+    {
+        ++sh->misses;
+        ctx->cache_key = cache_key;
+        ctx->cache_hash = hash;
+        ctx->cache_gen = sh->gens[hash % READ_CACHE_STRIPES];
+    }
+    ngx_shmtx_unlock(&shpool->mutex);
+
+    if (!version.data)
+    {
+        return NGX_DECLINED;
+    }
+    return hustdb_ha_send_response(NGX_HTTP_OK, &version, &value, r);
+}
+
+static hustdb_ha_read_cache_node_t * __alloc_node(size_t size, ngx_slab_pool_t * shpool, hustdb_ha_read_cache_sh_t * sh)
+{
+    hustdb_ha_read_cache_node_t * node = ngx_slab_alloc_locked(shpool, size);
+    while (!node && !ngx_queue_empty(&sh->lru))
+    {
+        ngx_queue_t * q = ngx_queue_last(&sh->lru);
+        hustdb_ha_read_cache_node_t * last = ngx_queue_data(q, hustdb_ha_read_cache_node_t, queue);
+        if ((ngx_msec_int_t) (last->expire - ngx_current_msec) <= 0)
+        {
+            ++sh->expired;
+        }
+        else
+        {
+            ++sh->evictions;
+        }
+        __delete_node(last, shpool, sh);
+        node = ngx_slab_alloc_locked(shpool, size);
+    }
+    return node;
+}
+
+void hustdb_ha_read_cache_put(
+    const ngx_str_t * version,
+    const ngx_str_t * response,
+    hustdb_ha_ctx_t * ctx,
+    ngx_http_request_t *r)
+{
+    if (!ctx->cache_key.data || !version || !version->data)
+    {
+        return;
+    }
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    ngx_http_addon_shm_ctx_t * shm = __get_shm_ctx(r);
+    if (!shm)
+    {
+        return;
+    }
+    size_t value_len = response ? response->len : 0;
+    if (value_len > (size_t) mcf->read_cache_max_value)
+    {
+        return;
+    }
+    size_t key_len = ctx->cache_key.len;
+    size_t size = offsetof(hustdb_ha_read_cache_node_t, data) + key_len + version->len + value_len;
+
+    ngx_slab_pool_t * shpool = shm->shpool;
+    hustdb_ha_read_cache_sh_t * sh = shm->sh;
+
+    ngx_shmtx_lock(&shpool->mutex);
+    do
+    {
+        if (sh->gens[ctx->cache_hash % READ_CACHE_STRIPES] != ctx->cache_gen)
+        {
+            break;
+        }
+        hustdb_ha_read_cache_node_t * node = __lookup(&ctx->cache_key, ctx->cache_hash, sh);
+        if (node)
+        {
+            __delete_node(node, shpool, sh);
+        }
+        node = __alloc_node(size, shpool, sh);
+        if (!node)
+        {
+            break;
+        }
+        node->sn.node.key = ctx->cache_hash;
+        node->sn.str.len = key_len;
+        node->sn.str.data = node->data;
+        node->expire = ngx_current_msec + mcf->read_cache_ttl;
+        node->version_len = version->len;
+        node->value_len = value_len;
+        u_char * p = ngx_cpymem(node->data, ctx->cache_key.data, key_len);
+        p = ngx_cpymem(p, version->data, version->len);
+        if (value_len > 0)
+        {
+            ngx_memcpy(p, response->data, value_len);
+        }
+        ngx_rbtree_insert(&sh->rbtree, &node->sn.node);
+        ngx_queue_insert_head(&sh->lru, &node->queue);
+        ++sh->entries;
+        ++sh->inserts;
+    } while (0);
+    ngx_shmtx_unlock(&shpool->mutex);
+
+    ctx->cache_key.data = NULL;
+}
+
+void hustdb_ha_read_cache_purge(const char * tb, const char * key, ngx_http_request_t *r)
+{
+    ngx_http_addon_shm_ctx_t * shm = __get_shm_ctx(r);
+    if (!shm || !key)
+    {
+        return;
+    }
+    ngx_str_t cache_key = __make_key(tb, key, r->pool);
+    if (!cache_key.data)
+    {
+        return;
+    }
+    uint32_t hash = ngx_crc32_short(cache_key.data, cache_key.len);
+
+    ngx_slab_pool_t * shpool = shm->shpool;
+    hustdb_ha_read_cache_sh_t * sh = shm->sh;
+
+    ngx_shmtx_lock(&shpool->mutex);
+    ++sh->gens[hash % READ_CACHE_STRIPES];
+    hustdb_ha_read_cache_node_t * node = __lookup(&cache_key, hash, sh);
+    if (node)
+    {
+        __delete_node(node, shpool, sh);
+        ++sh->purges;
+    }
+    ngx_shmtx_unlock(&shpool->mutex);
+}
+
+void hustdb_ha_read_cache_purge_table(const char * tb, ngx_http_request_t *r)
+{
+    ngx_http_addon_shm_ctx_t * shm = __get_shm_ctx(r);
+    if (!shm || !tb)
+    {
+        return;
+    }
+    size_t tb_len = strlen(tb);
+
+    ngx_slab_pool_t * shpool = shm->shpool;
+    hustdb_ha_read_cache_sh_t * sh = shm->sh;
+
+    ngx_shmtx_lock(&shpool->mutex);
+    // the fields of a table are spread over every stripe
+    size_t i = 0;
+    for (i = 0; i < READ_CACHE_STRIPES; ++i)
+    {
+        ++sh->gens[i];
+    }
+    ngx_queue_t * q = ngx_queue_head(&sh->lru);
+    while (q != ngx_queue_sentinel(&sh->lru))
+    {
+        hustdb_ha_read_cache_node_t * node = ngx_queue_data(q, hustdb_ha_read_cache_node_t, queue);
+        q = ngx_queue_next(q);
+        if (node->sn.str.len > tb_len && '\n' == node->sn.str.data[tb_len]
+            && 0 == ngx_memcmp(node->sn.str.data, tb, tb_len))
+        {
+            __delete_node(node, shpool, sh);
+            ++sh->purges;
+        }
+    }
+    ngx_shmtx_unlock(&shpool->mutex);
+}
+
+ngx_int_t hustdb_ha_read_cache_status_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    if (!mcf)
+    {
+        return NGX_ERROR;
+    }
+    hustdb_ha_read_cache_sh_t stat;
+    ngx_memzero(&stat, sizeof(hustdb_ha_read_cache_sh_t));
+    ngx_http_addon_shm_ctx_t * shm = __get_shm_ctx(r);
+    if (shm)
+    {
+        hustdb_ha_read_cache_sh_t * sh = shm->sh;
+        ngx_shmtx_lock(&shm->shpool->mutex);
+        stat.entries = sh->entries;
+        stat.hits = sh->hits;
+        stat.misses = sh->misses;
+        stat.inserts = sh->inserts;
+        stat.evictions = sh->evictions;
+        stat.expired = sh->expired;
+        stat.purges = sh->purges;
+        ngx_shmtx_unlock(&shm->shpool->mutex);
+    }
+    enum { SIZE = 512 };
+    u_char * buf = ngx_palloc(r->pool, SIZE);
+    if (!buf)
+    {
+        return NGX_ERROR;
+    }
+    u_char * last = ngx_snprintf(buf, SIZE,
+        "{\"read_cache\":%s,\"shm_size\":%z,\"ttl\":%i,\"max_value\":%z,\"entries\":%ui,"
+        "\"hits\":%ui,\"misses\":%ui,\"inserts\":%ui,\"evictions\":%ui,\"expired\":%ui,\"purges\":%ui}",
+        shm ? "true" : "false", shm ? mcf->read_cache_shm_size : 0, mcf->read_cache_ttl, mcf->read_cache_max_value,
+        stat.entries, stat.hits, stat.misses, stat.inserts, stat.evictions, stat.expired, stat.purges);
+    ngx_str_t response = { last - buf, buf };
+    return ngx_http_send_response_imp(NGX_HTTP_OK, &response, r);
+}
@@ -52,7 +52,7 @@ static ngx_http_subrequest_peer_t * __get_peer_by_key(ngx_http_request_t *r)
     return ngx_http_get_first_peer(hustdb_ha_get_readlist(key));
 }
 
-static ngx_int_t __start_read(ngx_str_t * backend_uri, ngx_http_request_t *r)
+static ngx_int_t __start_read(ngx_bool_t stream, ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
 	ngx_http_subrequest_peer_t * peer = __get_peer_by_key(r);
 	if (!peer)
@@ -67,6 +67,25 @@ static ngx_int_t __start_read(ngx_str_t * backend_uri, ngx_http_request_t *r)
 	}
 
 	ctx->peer = peer;
+	ngx_int_t rc = hustdb_ha_read_cache_get(backend_uri, ctx, r);
+	if (NGX_DECLINED != rc)
+	{
+	    return rc;
+	}
+	ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+	if (mcf && mcf->coalesce_reads)
+	{
+	    // a coalesced response is fanned out from memory, so it is never streamed
+	    rc = hustdb_ha_coalesce_join(backend_uri, ctx, r);
+	    if (NGX_DECLINED != rc)
+	    {
+	        return rc;
+	    }
+	}
+	else if (stream && !ctx->cache_key.data)
+	{
+	    backend_uri = hustdb_ha_stream_uri(backend_uri, &ctx->base, r);
+	}
 	return ngx_http_gen_subrequest(
 	        backend_uri,
 			r,
@@ -112,14 +131,14 @@ static void __post_handler(ngx_http_request_t *r)
     }
 }
 
-static ngx_int_t __post_read(ngx_bool_t key_in_body, ngx_str_t * backend_uri, ngx_http_request_t *r)
+static ngx_int_t __post_read(ngx_bool_t stream, ngx_bool_t key_in_body, ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
     hustdb_ha_ctx_t * ctx = __create_ctx(r);
     if (!ctx)
     {
         return NGX_ERROR;
     }
-    ctx->base.backend_uri = backend_uri;
+    ctx->base.backend_uri = stream ? hustdb_ha_stream_uri(backend_uri, &ctx->base, r) : backend_uri;
     ctx->key_in_body = key_in_body;
 
     ngx_int_t rc = ngx_http_read_client_request_body(r, __post_handler);
@@ -131,6 +150,7 @@ static ngx_int_t __post_read(ngx_bool_t key_in_body, ngx_str_t * backend_uri, ng
 }
 
 ngx_int_t hustdb_ha_read_handler(
+    ngx_bool_t stream,
     ngx_bool_t read_body,
     ngx_bool_t key_in_body,
     hustdb_ha_check_parameter_t check_parameter,
@@ -148,15 +168,24 @@ ngx_int_t hustdb_ha_read_handler(
         {
             return NGX_ERROR;
         }
-	    return read_body ? __post_read(key_in_body, backend_uri, r) : __start_read(backend_uri, r);
+	    return read_body ? __post_read(stream, key_in_body, backend_uri, r) : __start_read(stream, backend_uri, r);
 	}
 	if (NGX_HTTP_OK != r->headers_out.status)
 	{
 		ctx->peer = ngx_http_get_next_peer(ctx->peer);
-		return ctx->peer ? ngx_http_run_subrequest(
-				r, &ctx->base, ctx->peer->peer) : hustdb_ha_send_response(
-						NGX_HTTP_NOT_FOUND, NULL, NULL, r);
+		if (ctx->peer)
+		{
+		    return ngx_http_run_subrequest(r, &ctx->base, ctx->peer->peer);
+		}
+		hustdb_ha_coalesce_leave(NGX_HTTP_NOT_FOUND, NULL, NULL, ctx);
+		return hustdb_ha_send_response(NGX_HTTP_NOT_FOUND, NULL, NULL, r);
+	}
+	if (ctx->base.streamed)
+	{
+	    return ngx_http_send_special(r, NGX_HTTP_LAST);
 	}
+	hustdb_ha_read_cache_put(&ctx->version, &ctx->base.response, ctx, r);
+	hustdb_ha_coalesce_leave(NGX_HTTP_OK, &ctx->version, &ctx->base.response, ctx);
 	return hustdb_ha_send_response(NGX_HTTP_OK, &ctx->version, &ctx->base.response, r);
 }
 
@@ -253,7 +282,7 @@ static ngx_int_t __on_subrequest_complete(ngx_http_request_t * r, void * data, n
         ctx->base.response.data = r->upstream->buffer.pos;
         ctx->keys = hustdb_ha_get_keys_from_header(r);
     }
-    return ngx_http_finish_subrequest(r);
+    return ngx_http_stream_subrequest_finish(r, rc);
 }
 
 static void __zkeys_post_body_handler(ngx_http_request_t *r)
@@ -305,7 +334,7 @@ ngx_int_t hustdb_ha_zread_keys_handler(
         }
         ngx_http_set_addon_module_ctx(r, ctx);
         memset(ctx, 0, sizeof(zkeys_ctx_t));
-        ctx->base.backend_uri = backend_uri;
+        ctx->base.backend_uri = hustdb_ha_stream_uri(backend_uri, &ctx->base, r);
 
         ngx_int_t rc = ngx_http_read_client_request_body(r, __zkeys_post_body_handler);
         if ( rc >= NGX_HTTP_SPECIAL_RESPONSE )
@@ -321,6 +350,10 @@ ngx_int_t hustdb_ha_zread_keys_handler(
                 r, &ctx->base, ctx->peer->peer) : hustdb_ha_send_response(
                         NGX_HTTP_NOT_FOUND, NULL, NULL, r);
     }
+    if (ctx->base.streamed)
+    {
+        return ngx_http_send_special(r, NGX_HTTP_LAST);
+    }
     if (ctx->keys)
     {
         if (!hustdb_ha_add_keys_to_header(ctx->keys, r))
@@ -0,0 +1,1430 @@
+#include "hustdb_ha_handler_inner.h"
+#include "hustdb_ha_utils_inner.h"
+
+// scatter-gather over several backends: one in-memory subrequest per backend
+// is started at once, the parent runs again when the last one is done.
+//
+// keys / hkeys / smembers: every backend is scanned, an item is returned by
+//   the first alive peer of its readlist only, so the two replicas of a
+//   key do not both report it.
+// zrangebyrank / zrangebyscore: the replicas of the table are merged by
+//   (score, member), members of one score are not in the same order on both.
+//
+// the composite cursor holds one offset per backend, "-1" for a backend that
+// is done; "0" starts a scan and is returned once every backend is done.
+// a zset cursor also holds the last (score, member) returned, see __merge_by_score.
+
+typedef struct hustdb_ha_scatter_ctx_s hustdb_ha_scatter_ctx_t;
+
+typedef struct
+{
+    ngx_http_subrequest_ctx_t base;
+    hustdb_ha_scatter_ctx_t * scatter;
+    ngx_http_upstream_rr_peer_t * peer;
+    int offset;
+    ngx_bool_t started;
+    ngx_bool_t done;
+    ngx_uint_t status;
+    cJSON * json;
+    cJSON * cur;
+    int count;
+    int consumed;
+} hustdb_ha_scatter_peer_t;
+
+struct hustdb_ha_scatter_ctx_s
+{
+    hustdb_ha_scatter_peer_t * peers;
+    size_t size;
+    size_t pending;
+    int page_size;
+    ngx_bool_t zset;
+    ngx_bool_t noval;
+    ngx_bool_t finished;
+    // the bound of a zset cursor: bmode 'M' up to (bscore, bmember), 'A' every
+    // member of bscore, 'R' the run of bscore is paged on the first replica
+    ngx_bool_t bound;
+    char bmode;
+    int64_t bscore;
+    const char * bmember;
+};
+
+typedef struct
+{
+    ngx_str_t * arr;
+    size_t size;
+    size_t len;
+} hustdb_ha_scatter_items_t;
+
+static const ngx_str_t CURSOR_KEY = ngx_string("Cursor");
+
+ngx_bool_t hustdb_ha_has_cursor(ngx_http_request_t *r)
+{
+    return NULL != ngx_http_get_param_val(&r->args, "cursor", r->pool);
+}
+
+static ngx_int_t __on_subrequest_complete(ngx_http_request_t * r, void * data, ngx_int_t rc)
+{
+    hustdb_ha_scatter_peer_t * peer = data;
+    // a subrequest that was not the active one is finalized twice
+    if (!peer || peer->done)
+    {
+        return NGX_OK;
+    }
+    peer->done = true;
+    peer->status = r->headers_out.status;
+    ngx_http_post_subrequest_handler(r, &peer->base, rc);
+    if (--peer->scatter->pending > 0)
+    {
+        // the parent runs again for the last one only
+        r->parent->write_event_handler = ngx_http_request_empty_handler;
+    }
+    return NGX_OK;
+}
+
+static ngx_bool_t __parse_bound(const char * pos, hustdb_ha_scatter_ctx_t * ctx, ngx_pool_t * pool)
+{
+    char * end = NULL;
+    ctx->bscore = strtoll(pos, &end, 10);
+    if (end == pos || ':' != *end)
+    {
+        return false;
+    }
+    ctx->bmode = *++end;
+    if ('M' != ctx->bmode && 'A' != ctx->bmode && 'R' != ctx->bmode)
+    {
+        return false;
+    }
+    pos = ++end;
+    // members are base64, the bound is sent back in a header
+    size_t len = strspn(pos, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=");
+    if ('\0' != pos[len] || ('M' == ctx->bmode && len < 1) || ('A' == ctx->bmode && len > 0))
+    {
+        return false;
+    }
+    char * member = ngx_palloc(pool, len + 1);
+    if (!member)
+    {
+        return false;
+    }
+    memcpy(member, pos, len + 1);
+    ctx->bmember = member;
+    ctx->bound = true;
+    return true;
+}
+
+static ngx_bool_t __parse_cursor(const char * cursor, hustdb_ha_scatter_ctx_t * ctx, ngx_pool_t * pool)
+{
+    size_t i = 0;
+    if (0 == strcmp(cursor, "0"))
+    {
+        for (i = 0; i < ctx->size; ++i)
+        {
+            ctx->peers[i].offset = 0;
+        }
+        return true;
+    }
+    const char * pos = cursor;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        char * end = NULL;
+        long offset = strtol(pos, &end, 10);
+        if (end == pos || (offset < 0 && -1 != offset) || (offset >= 0 && !hustdb_ha_check_export(offset, 0)))
+        {
+            return false;
+        }
+        ctx->peers[i].offset = (int) offset;
+        if (i + 1 < ctx->size)
+        {
+            if (',' != *end)
+            {
+                return false;
+            }
+            ++end;
+        }
+        pos = end;
+    }
+    if (ctx->zset && ':' == *pos)
+    {
+        return __parse_bound(pos + 1, ctx, pool);
+    }
+    return '\0' == *pos;
+}
+
+static hustdb_ha_scatter_ctx_t * __create_ctx(ngx_bool_t zset, size_t size, ngx_http_request_t *r)
+{
+    char * cursor = ngx_http_get_param_val(&r->args, "cursor", r->pool);
+    char * page_size = ngx_http_get_param_val(&r->args, "size", r->pool);
+    if (!cursor || !page_size || size < 1)
+    {
+        return NULL;
+    }
+
+    hustdb_ha_scatter_ctx_t * ctx = ngx_pcalloc(r->pool, sizeof(hustdb_ha_scatter_ctx_t));
+    if (!ctx)
+    {
+        return NULL;
+    }
+    ctx->peers = ngx_pcalloc(r->pool, size * sizeof(hustdb_ha_scatter_peer_t));
+    if (!ctx->peers)
+    {
+        return NULL;
+    }
+    ctx->size = size;
+    ctx->zset = zset;
+    ctx->page_size = atoi(page_size);
+    if (ctx->page_size < 1 || !hustdb_ha_check_export(0, ctx->page_size))
+    {
+        return NULL;
+    }
+    if (!__parse_cursor(cursor, ctx, r->pool))
+    {
+        return NULL;
+    }
+
+    char * noval = ngx_http_get_param_val(&r->args, "noval", r->pool);
+    ctx->noval = !noval || 0 == strcmp(noval, "true") || 0 == strcmp(noval, "1");
+
+    size_t i = 0;
+    for (i = 0; i < size; ++i)
+    {
+        ctx->peers[i].scatter = ctx;
+    }
+    ngx_http_set_addon_module_ctx(r, ctx);
+    return ctx;
+}
+
+static hustdb_ha_scatter_ctx_t * __create_keys_ctx(ngx_http_request_t *r)
+{
+    size_t size = hustdb_ha_get_peer_array_count();
+    hustdb_ha_scatter_ctx_t * ctx = __create_ctx(false, size, r);
+    if (!ctx)
+    {
+        return NULL;
+    }
+    size_t i = 0;
+    for (i = 0; i < size; ++i)
+    {
+        ctx->peers[i].peer = hustdb_ha_get_peer_item(i);
+    }
+    return ctx;
+}
+
+static hustdb_ha_scatter_ctx_t * __create_zkeys_ctx(ngx_http_request_t *r)
+{
+    char * tb = ngx_http_get_param_val(&r->args, "tb", r->pool);
+    if (!tb)
+    {
+        return NULL;
+    }
+    ngx_http_subrequest_peer_t * readlist = hustdb_ha_get_readlist(tb);
+    size_t size = 0;
+    ngx_http_subrequest_peer_t * it = readlist;
+    for (it = readlist; it; it = it->next)
+    {
+        ++size;
+    }
+    hustdb_ha_scatter_ctx_t * ctx = __create_ctx(true, size, r);
+    if (!ctx)
+    {
+        return NULL;
+    }
+    size_t i = 0;
+    for (it = readlist; it; it = it->next)
+    {
+        ctx->peers[i++].peer = it->peer;
+    }
+    return ctx;
+}
+
+static ngx_str_t __make_args(ngx_bool_t zset, int offset, ngx_http_request_t *r)
+{
+    static ngx_str_t CURSOR = ngx_string("cursor");
+    static ngx_str_t OFFSET = ngx_string("offset");
+    static ngx_str_t NOVAL = ngx_string("noval");
+
+    ngx_str_t args = ngx_http_remove_param(&r->args, &CURSOR, r->pool);
+    args = ngx_http_remove_param(&args, &OFFSET, r->pool);
+    if (zset)
+    {
+        // the score is needed to merge, it is dropped again for noval
+        args = ngx_http_remove_param(&args, &NOVAL, r->pool);
+    }
+
+    ngx_str_t result = ngx_null_string;
+    result.data = ngx_palloc(r->pool, args.len + 64);
+    if (!result.data)
+    {
+        return result;
+    }
+    u_char * end = ngx_sprintf(result.data, "%V%soffset=%d%s", &args,
+        args.len > 0 ? "&" : "", offset, zset ? "&noval=false" : "");
+    result.len = end - result.data;
+    return result;
+}
+
+static ngx_int_t __scatter(ngx_str_t * backend_uri, ngx_http_request_t *r, hustdb_ha_scatter_ctx_t * ctx)
+{
+    size_t started = 0;
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (peer->offset < 0 || !ngx_http_peer_is_alive(peer->peer))
+        {
+            continue;
+        }
+        if (ctx->page_size > 0)
+        {
+            peer->base.args = __make_args(ctx->zset, peer->offset, r);
+            if (!peer->base.args.data)
+            {
+                continue;
+            }
+        }
+        if (NGX_OK != ngx_http_init_subrequest(backend_uri, r, &peer->base, __on_subrequest_complete) ||
+            NGX_OK != ngx_http_start_subrequest(r, &peer->base, peer->peer))
+        {
+            continue;
+        }
+        peer->started = true;
+        ++started;
+    }
+    if (started < 1)
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+    }
+    ctx->pending = started;
+    // every subrequest holds the main request by itself, this is for NGX_DONE
+    r->main->count++;
+    return NGX_DONE;
+}
+
+static char * __make_cstr(const ngx_str_t * str, ngx_pool_t * pool)
+{
+    char * data = ngx_palloc(pool, str->len + 1);
+    if (!data)
+    {
+        return NULL;
+    }
+    memcpy(data, str->data, str->len);
+    data[str->len] = '\0';
+    return data;
+}
+
+static ngx_bool_t __parse_response(hustdb_ha_scatter_peer_t * peer, ngx_http_request_t *r)
+{
+    char * data = __make_cstr(&peer->base.response, r->pool);
+    if (!data)
+    {
+        return false;
+    }
+    peer->json = cJSON_Parse(data);
+    if (!peer->json || cJSON_Array != peer->json->type)
+    {
+        return false;
+    }
+    peer->cur = peer->json->child;
+    peer->count = cJSON_GetArraySize(peer->json);
+    return true;
+}
+
+static void __free_json(hustdb_ha_scatter_ctx_t * ctx)
+{
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        if (ctx->peers[i].json)
+        {
+            cJSON_Delete(ctx->peers[i].json);
+            ctx->peers[i].json = NULL;
+        }
+    }
+}
+
+static ngx_bool_t __ok(hustdb_ha_scatter_peer_t * peer)
+{
+    return peer->json && NGX_HTTP_OK == peer->status;
+}
+
+// parses the responses; a keys scan can not skip a backend that is alive
+// but failed, the items it owns would be lost
+static ngx_bool_t __gather(ngx_bool_t strict, hustdb_ha_scatter_ctx_t * ctx, ngx_http_request_t *r)
+{
+    size_t ok = 0;
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (!peer->started)
+        {
+            continue;
+        }
+        if (NGX_HTTP_OK == peer->status && __parse_response(peer, r))
+        {
+            ++ok;
+            continue;
+        }
+        if (strict && ngx_http_peer_is_alive(peer->peer))
+        {
+            return false;
+        }
+    }
+    return ok > 0;
+}
+
+static ngx_bool_t __append_item(cJSON * item, hustdb_ha_scatter_items_t * items, ngx_http_request_t *r)
+{
+    char * json = cJSON_PrintUnformatted(item);
+    if (!json)
+    {
+        return false;
+    }
+    ngx_str_t tmp = { strlen(json), (u_char *) json };
+    items->arr[items->size] = ngx_http_make_str(&tmp, r->pool);
+    free(json);
+    if (!items->arr[items->size].data)
+    {
+        return false;
+    }
+    items->len += items->arr[items->size].len;
+    ++items->size;
+    return true;
+}
+
+static ngx_bool_t __is_owner(cJSON * item, ngx_http_upstream_rr_peer_t * peer, ngx_http_request_t *r)
+{
+    cJSON * key = cJSON_GetObjectItem(item, "key");
+    if (!key || cJSON_String != key->type)
+    {
+        return false;
+    }
+
+    // zset items are placed by table, everything else by key
+    cJSON * ty = cJSON_GetObjectItem(item, "ty");
+    cJSON * tb = cJSON_GetObjectItem(item, "tb");
+    ngx_http_subrequest_peer_t * owner = NULL;
+    if (ty && tb && cJSON_String == ty->type && cJSON_String == tb->type && 0 == strcmp(ty->valuestring, "Z"))
+    {
+        owner = ngx_http_get_first_peer(hustdb_ha_get_readlist(tb->valuestring));
+        return owner && owner->peer == peer;
+    }
+
+    ngx_str_t src = { strlen(key->valuestring), (u_char *) key->valuestring };
+    ngx_str_t dst = { 0, ngx_palloc(r->pool, ngx_base64_decoded_length(src.len) + 1) };
+    if (!dst.data || NGX_OK != ngx_decode_base64(&dst, &src))
+    {
+        return false;
+    }
+    dst.data[dst.len] = '\0';
+
+    owner = ngx_http_get_first_peer(hustdb_ha_get_readlist((const char *) dst.data));
+    return owner && owner->peer == peer;
+}
+
+static ngx_bool_t __merge_owned(hustdb_ha_scatter_ctx_t * ctx, hustdb_ha_scatter_items_t * items, ngx_http_request_t *r)
+{
+    size_t i = 0;
+    for (i = 0; i < ctx->size && (int) items->size < ctx->page_size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (!__ok(peer))
+        {
+            continue;
+        }
+        for (; peer->cur && (int) items->size < ctx->page_size; peer->cur = peer->cur->next)
+        {
+            ++peer->consumed;
+            if (__is_owner(peer->cur, peer->peer, r) && !__append_item(peer->cur, items, r))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static int64_t __get_score(cJSON * item)
+{
+    cJSON * val = cJSON_GetObjectItem(item, "val");
+    if (!val || cJSON_String != val->type)
+    {
+        return 0;
+    }
+    return strtoll(val->valuestring, NULL, 10);
+}
+
+static const char * __get_member(cJSON * item)
+{
+    cJSON * key = cJSON_GetObjectItem(item, "key");
+    return (key && cJSON_String == key->type) ? key->valuestring : "";
+}
+
+static int __cmp_zitem(const void * a, const void * b)
+{
+    cJSON * x = *(cJSON **) a;
+    cJSON * y = *(cJSON **) b;
+    int64_t sx = __get_score(x);
+    int64_t sy = __get_score(y);
+    if (sx != sy)
+    {
+        return sx < sy ? -1 : 1;
+    }
+    return strcmp(__get_member(x), __get_member(y));
+}
+
+// whether an item was not returned by an earlier page
+static ngx_bool_t __after_bound(cJSON * item, hustdb_ha_scatter_ctx_t * ctx)
+{
+    if (!ctx->bound)
+    {
+        return true;
+    }
+    int64_t score = __get_score(item);
+    if (score != ctx->bscore)
+    {
+        return score > ctx->bscore;
+    }
+    return 'A' != ctx->bmode && strcmp(__get_member(item), ctx->bmember) > 0;
+}
+
+static ngx_bool_t __append_zitem(cJSON * item, hustdb_ha_scatter_ctx_t * ctx, hustdb_ha_scatter_items_t * items, ngx_http_request_t *r)
+{
+    // the score is kept on the item, the cursor is built from it
+    cJSON * val = ctx->noval ? cJSON_DetachItemFromObject(item, "val") : NULL;
+    ngx_bool_t rc = __append_item(item, items, r);
+    if (val)
+    {
+        cJSON_AddItemToObject(item, "val", val);
+    }
+    return rc;
+}
+
+// the offset of a replica only moves past the items that are below the bound
+// as a whole, the items of bscore are filtered by member on the next page
+static void __set_consumed(hustdb_ha_scatter_ctx_t * ctx)
+{
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (!__ok(peer))
+        {
+            continue;
+        }
+        int below = 0;
+        ngx_bool_t all = true;
+        cJSON * it = peer->json->child;
+        for (it = peer->json->child; it; it = it->next)
+        {
+            if (__after_bound(it, ctx))
+            {
+                all = false;
+                break;
+            }
+            if (__get_score(it) < ctx->bscore)
+            {
+                ++below;
+            }
+        }
+        peer->consumed = all ? peer->count : below;
+    }
+}
+
+// a run of one score that fills the page of every replica can not be cut by
+// member: it is paged on the first replica alone, in the order of that one
+static ngx_bool_t __merge_run(hustdb_ha_scatter_ctx_t * ctx, hustdb_ha_scatter_items_t * items, ngx_http_request_t *r)
+{
+    size_t i = 0;
+    for (i = 0; i < ctx->size && !__ok(&ctx->peers[i]); ++i)
+    {
+    }
+    if (i >= ctx->size)
+    {
+        return true;
+    }
+    hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+    peer->consumed = 0;
+    cJSON * it = peer->json->child;
+    for (it = peer->json->child; it; it = it->next)
+    {
+        int64_t score = __get_score(it);
+        if (score > ctx->bscore)
+        {
+            break;
+        }
+        ++peer->consumed;
+        // bmember is where the run started, the members up to it were returned
+        if (score < ctx->bscore || strcmp(__get_member(it), ctx->bmember) <= 0)
+        {
+            continue;
+        }
+        if (!__append_zitem(it, ctx, items, r))
+        {
+            return false;
+        }
+    }
+    if (it || peer->count < ctx->page_size)
+    {
+        ctx->bmode = 'A';
+    }
+    return true;
+}
+
+// merge of the replicas by (score, member). a replica whose page is full may
+// hold more items of the last score of its page; the items below the highest
+// such score are complete on some replica, so only those are merged. the
+// cursor keeps the last (score, member) returned, that bound is the same on
+// both replicas whatever order they keep the members of one score in.
+static ngx_bool_t __merge_by_score(hustdb_ha_scatter_ctx_t * ctx, hustdb_ha_scatter_items_t * items, ngx_http_request_t *r)
+{
+    ngx_bool_t run = ctx->bound && 'R' == ctx->bmode;
+    if (run)
+    {
+        if (!__merge_run(ctx, items, r))
+        {
+            return false;
+        }
+        if ('R' == ctx->bmode)
+        {
+            return true;
+        }
+        // the run is done, the rest of the page is merged
+    }
+
+    ngx_bool_t found = false;
+    ngx_bool_t complete = false;
+    ngx_bool_t full = false;
+    int64_t limit = 0;
+    size_t total = 0;
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (!__ok(peer))
+        {
+            continue;
+        }
+        found = true;
+        total += peer->count;
+        if (peer->count < ctx->page_size)
+        {
+            complete = true;
+            continue;
+        }
+        int64_t tmp = __get_score(cJSON_GetArrayItem(peer->json, peer->count - 1));
+        if (!full || tmp > limit)
+        {
+            limit = tmp;
+        }
+        full = true;
+    }
+    if (!found)
+    {
+        return true;
+    }
+
+    cJSON ** arr = ngx_palloc(r->pool, (total + 1) * sizeof(cJSON *));
+    if (!arr)
+    {
+        return false;
+    }
+    size_t size = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (!__ok(peer))
+        {
+            continue;
+        }
+        cJSON * it = peer->json->child;
+        for (it = peer->json->child; it; it = it->next)
+        {
+            if (__after_bound(it, ctx) && (complete || __get_score(it) < limit))
+            {
+                arr[size++] = it;
+            }
+        }
+    }
+    qsort(arr, size, sizeof(cJSON *), __cmp_zitem);
+
+    cJSON * last = NULL;
+    for (i = 0; i < size && (int) items->size < ctx->page_size; ++i)
+    {
+        if (last && 0 == __cmp_zitem(&last, &arr[i]))
+        {
+            continue;
+        }
+        if (!__append_zitem(arr[i], ctx, items, r))
+        {
+            return false;
+        }
+        last = arr[i];
+    }
+
+    if (last)
+    {
+        ctx->bound = true;
+        ctx->bmode = 'M';
+        ctx->bscore = __get_score(last);
+        ngx_str_t member = { strlen(__get_member(last)), (u_char *) __get_member(last) };
+        ctx->bmember = __make_cstr(&member, r->pool);
+        if (!ctx->bmember)
+        {
+            return false;
+        }
+        __set_consumed(ctx);
+        return true;
+    }
+    if (complete)
+    {
+        ctx->finished = true;
+        return true;
+    }
+
+    if (run)
+    {
+        return true;
+    }
+    // every replica is full with one score, the bound can not move by member
+    if (!ctx->bound || ctx->bscore != limit || 'M' != ctx->bmode)
+    {
+        ctx->bmember = "";
+    }
+    ctx->bound = true;
+    ctx->bmode = 'R';
+    ctx->bscore = limit;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        ctx->peers[i].consumed = 0;
+    }
+    return __merge_run(ctx, items, r);
+}
+
+static ngx_bool_t __add_cursor(hustdb_ha_scatter_ctx_t * ctx, ngx_http_request_t *r)
+{
+    size_t bound_len = ctx->bound ? NGX_INT64_LEN + strlen(ctx->bmember) + 4 : 0;
+    ngx_str_t cursor = ngx_null_string;
+    cursor.data = ngx_palloc(r->pool, ctx->size * NGX_INT_T_LEN + bound_len + 1);
+    if (!cursor.data)
+    {
+        return false;
+    }
+    u_char * pos = cursor.data;
+    ngx_bool_t finished = true;
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        int offset = -1;
+        if (!ctx->finished && __ok(peer) && (peer->consumed < peer->count || peer->count >= ctx->page_size))
+        {
+            offset = peer->offset + peer->consumed;
+            finished = false;
+        }
+        pos = ngx_sprintf(pos, (i > 0) ? ",%d" : "%d", offset);
+    }
+    if (!finished && ctx->bound)
+    {
+        pos = ngx_sprintf(pos, ":%L:%c%s", ctx->bscore, ctx->bmode, 'A' == ctx->bmode ? "" : ctx->bmember);
+    }
+    cursor.len = finished ? 1 : (size_t) (pos - cursor.data);
+    if (finished)
+    {
+        cursor.data[0] = '0';
+    }
+    return ngx_http_add_field_to_headers_out(&CURSOR_KEY, &cursor, r);
+}
+
+static ngx_int_t __send_items(hustdb_ha_scatter_items_t * items, ngx_http_request_t *r)
+{
+    ngx_str_t response = ngx_null_string;
+    response.data = ngx_palloc(r->pool, items->len + items->size + 2);
+    if (!response.data)
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+    }
+    u_char * pos = response.data;
+    *pos++ = '[';
+    size_t i = 0;
+    for (i = 0; i < items->size; ++i)
+    {
+        if (i > 0)
+        {
+            *pos++ = ',';
+        }
+        pos = ngx_cpymem(pos, items->arr[i].data, items->arr[i].len);
+    }
+    *pos++ = ']';
+    response.len = pos - response.data;
+
+    ngx_str_t keys = ngx_null_string;
+    keys.data = ngx_palloc(r->pool, NGX_INT_T_LEN);
+    if (!keys.data)
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+    }
+    keys.len = ngx_sprintf(keys.data, "%uz", items->size) - keys.data;
+    if (!hustdb_ha_add_keys_to_header(&keys, r))
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+    }
+    return ngx_http_send_response_imp(NGX_HTTP_OK, &response, r);
+}
+
+static ngx_int_t __finish(ngx_bool_t zset, hustdb_ha_scatter_ctx_t * ctx, ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_items_t items = { NULL, 0, 0 };
+    ngx_bool_t rc = false;
+    do
+    {
+        if (!__gather(!zset, ctx, r))
+        {
+            break;
+        }
+        items.arr = ngx_palloc(r->pool, ctx->page_size * ctx->size * sizeof(ngx_str_t));
+        if (!items.arr)
+        {
+            break;
+        }
+        if (!(zset ? __merge_by_score(ctx, &items, r) : __merge_owned(ctx, &items, r)))
+        {
+            break;
+        }
+        if (!__add_cursor(ctx, r))
+        {
+            break;
+        }
+        rc = true;
+    } while (0);
+
+    __free_json(ctx);
+    return rc ? __send_items(&items, r) : ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+}
+
+ngx_int_t hustdb_ha_scatter_keys_handler(
+    hustdb_ha_check_parameter_t check_parameter,
+    ngx_str_t * backend_uri,
+    ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (!ctx)
+    {
+        if (check_parameter && !check_parameter(backend_uri, r))
+        {
+            return NGX_ERROR;
+        }
+        ctx = __create_keys_ctx(r);
+        if (!ctx)
+        {
+            return NGX_ERROR;
+        }
+        return __scatter(backend_uri, r, ctx);
+    }
+    return __finish(false, ctx, r);
+}
+
+ngx_int_t hustdb_ha_scatter_zkeys_handler(
+    hustdb_ha_check_parameter_t check_parameter,
+    ngx_str_t * backend_uri,
+    ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (!ctx)
+    {
+        if (check_parameter && !check_parameter(backend_uri, r))
+        {
+            return NGX_ERROR;
+        }
+        ctx = __create_zkeys_ctx(r);
+        if (!ctx)
+        {
+            return NGX_ERROR;
+        }
+        return __scatter(backend_uri, r, ctx);
+    }
+    return __finish(true, ctx, r);
+}
+
+static void __sum_object(cJSON * dst, cJSON * src)
+{
+    cJSON * it = src->child;
+    for (it = src->child; it; it = it->next)
+    {
+        cJSON * item = cJSON_GetObjectItem(dst, it->string);
+        if (!item)
+        {
+            cJSON_AddItemToObject(dst, it->string, cJSON_Duplicate(it, 1));
+        }
+        else if (cJSON_Number == it->type && cJSON_Number == item->type)
+        {
+            item->valuedouble += it->valuedouble;
+            item->valueint = (item->valuedouble > INT_MAX) ? INT_MAX : (int) item->valuedouble;
+        }
+        else if (cJSON_Object == it->type && cJSON_Object == item->type)
+        {
+            __sum_object(item, it);
+        }
+    }
+}
+
+static ngx_bool_t __str_item_eq(cJSON * a, cJSON * b, const char * key)
+{
+    cJSON * x = cJSON_GetObjectItem(a, key);
+    cJSON * y = cJSON_GetObjectItem(b, key);
+    if (!x || !y || cJSON_String != x->type || cJSON_String != y->type)
+    {
+        return false;
+    }
+    return 0 == strcmp(x->valuestring, y->valuestring);
+}
+
+static cJSON * __find_stat(cJSON * stats, cJSON * item)
+{
+    cJSON * it = stats->child;
+    for (it = stats->child; it; it = it->next)
+    {
+        if (cJSON_GetObjectItem(item, "TOTALIZE"))
+        {
+            if (cJSON_GetObjectItem(it, "TOTALIZE"))
+            {
+                return it;
+            }
+            continue;
+        }
+        if (__str_item_eq(it, item, "table") && __str_item_eq(it, item, "type"))
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static void __halve_object(cJSON * obj)
+{
+    cJSON * it = obj->child;
+    for (it = obj->child; it; it = it->next)
+    {
+        if (cJSON_Number == it->type)
+        {
+            it->valuedouble = (double) ((int64_t) it->valuedouble / 2);
+            it->valueint = (it->valuedouble > INT_MAX) ? INT_MAX : (int) it->valuedouble;
+        }
+        else if (cJSON_Object == it->type || cJSON_Array == it->type)
+        {
+            __halve_object(it);
+        }
+    }
+}
+
+static ngx_bool_t __holds(hustdb_ha_bucket_t * bucket, ngx_http_upstream_rr_peer_t * peer)
+{
+    ngx_http_subrequest_peer_t * it = bucket->readlist;
+    for (it = bucket->readlist; it; it = it->next)
+    {
+        if (it->peer == peer)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void __mark(hustdb_ha_scatter_peer_t * peer, ngx_bool_t * covered, ngx_bool_t val)
+{
+    size_t i = 0;
+    hustdb_ha_bucket_t * bucket = NULL;
+    for (i = 0; (bucket = hustdb_ha_get_bucket(i)); ++i)
+    {
+        if (__holds(bucket, peer->peer))
+        {
+            covered[i] = val;
+        }
+    }
+}
+
+static ngx_bool_t __clear(hustdb_ha_scatter_peer_t * peer, ngx_bool_t * covered)
+{
+    size_t i = 0;
+    hustdb_ha_bucket_t * bucket = NULL;
+    for (i = 0; (bucket = hustdb_ha_get_bucket(i)); ++i)
+    {
+        if (covered[i] && __holds(bucket, peer->peer))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// picks backends that hold every bucket exactly once, each key then counts once
+static ngx_bool_t __cover(hustdb_ha_scatter_ctx_t * ctx, ngx_bool_t * covered, ngx_bool_t * chosen)
+{
+    size_t i = 0;
+    hustdb_ha_bucket_t * bucket = NULL;
+    for (i = 0; (bucket = hustdb_ha_get_bucket(i)) && covered[i]; ++i)
+    {
+    }
+    if (!bucket)
+    {
+        return true;
+    }
+    size_t j = 0;
+    for (j = 0; j < ctx->size; ++j)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[j];
+        if (chosen[j] || !__ok(peer) || !__holds(bucket, peer->peer) || !__clear(peer, covered))
+        {
+            continue;
+        }
+        __mark(peer, covered, true);
+        chosen[j] = true;
+        if (__cover(ctx, covered, chosen))
+        {
+            return true;
+        }
+        chosen[j] = false;
+        __mark(peer, covered, false);
+    }
+    return false;
+}
+
+static ngx_int_t __finish_stat(hustdb_ha_scatter_ctx_t * ctx, ngx_http_request_t *r)
+{
+    cJSON * stats = NULL;
+    ngx_str_t response = ngx_null_string;
+    do
+    {
+        if (!__gather(true, ctx, r))
+        {
+            break;
+        }
+        stats = cJSON_CreateArray();
+        if (!stats)
+        {
+            break;
+        }
+        size_t buckets = 0;
+        while (hustdb_ha_get_bucket(buckets))
+        {
+            ++buckets;
+        }
+        ngx_bool_t * covered = ngx_pcalloc(r->pool, (buckets + 1) * sizeof(ngx_bool_t));
+        ngx_bool_t * chosen = ngx_pcalloc(r->pool, ctx->size * sizeof(ngx_bool_t));
+        if (!covered || !chosen)
+        {
+            break;
+        }
+        // every key is on two backends. without a set of backends that holds
+        // each bucket once (an odd ring, or a backend is down), all of them
+        // are summed and halved
+        ngx_bool_t exact = buckets > 0 && __cover(ctx, covered, chosen);
+        size_t i = 0;
+        for (i = 0; i < ctx->size; ++i)
+        {
+            if (!__ok(&ctx->peers[i]) || (exact && !chosen[i]))
+            {
+                continue;
+            }
+            cJSON * it = ctx->peers[i].json->child;
+            for (it = ctx->peers[i].json->child; it; it = it->next)
+            {
+                cJSON * stat = __find_stat(stats, it);
+                if (stat)
+                {
+                    __sum_object(stat, it);
+                }
+                else
+                {
+                    cJSON_AddItemToArray(stats, cJSON_Duplicate(it, 1));
+                }
+            }
+        }
+        if (!exact)
+        {
+            __halve_object(stats);
+        }
+        char * json = cJSON_PrintUnformatted(stats);
+        if (!json)
+        {
+            break;
+        }
+        ngx_str_t tmp = { strlen(json), (u_char *) json };
+        response = ngx_http_make_str(&tmp, r->pool);
+        free(json);
+    } while (0);
+
+    if (stats)
+    {
+        cJSON_Delete(stats);
+    }
+    __free_json(ctx);
+    return response.data ? ngx_http_send_response_imp(
+        NGX_HTTP_OK, &response, r) : ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+}
+
+// one peer per backend, the request is passed on as it is
+static hustdb_ha_scatter_ctx_t * __create_all_ctx(ngx_http_request_t *r)
+{
+    size_t size = hustdb_ha_get_peer_array_count();
+    hustdb_ha_scatter_ctx_t * ctx = ngx_pcalloc(r->pool, sizeof(hustdb_ha_scatter_ctx_t));
+    if (!ctx || size < 1)
+    {
+        return NULL;
+    }
+    ctx->peers = ngx_pcalloc(r->pool, size * sizeof(hustdb_ha_scatter_peer_t));
+    if (!ctx->peers)
+    {
+        return NULL;
+    }
+    ctx->size = size;
+    size_t i = 0;
+    for (i = 0; i < size; ++i)
+    {
+        ctx->peers[i].scatter = ctx;
+        ctx->peers[i].peer = hustdb_ha_get_peer_item(i);
+    }
+    ngx_http_set_addon_module_ctx(r, ctx);
+    return ctx;
+}
+
+ngx_int_t hustdb_ha_scatter_stat_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (!ctx)
+    {
+        ctx = __create_all_ctx(r);
+        if (!ctx)
+        {
+            return NGX_ERROR;
+        }
+        return __scatter(backend_uri, r, ctx);
+    }
+    return __finish_stat(ctx, r);
+}
+
+static cJSON * __find_hotkey(cJSON * hotkeys, cJSON * item)
+{
+    cJSON * it = hotkeys->child;
+    for (it = hotkeys->child; it; it = it->next)
+    {
+        if (__str_item_eq(it, item, "op") && __str_item_eq(it, item, "table") && __str_item_eq(it, item, "key"))
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static int __cmp_hotkey(const void * a, const void * b)
+{
+    cJSON * x = cJSON_GetObjectItem(*(cJSON **) a, "qps");
+    cJSON * y = cJSON_GetObjectItem(*(cJSON **) b, "qps");
+    double qx = x ? x->valuedouble : 0;
+    double qy = y ? y->valuedouble : 0;
+    return qx < qy ? 1 : (qx > qy ? -1 : 0);
+}
+
+// the rates of an item are added up over the backends, the hottest n are kept
+static ngx_bool_t __merge_hotkeys(cJSON * hotkeys, int n, ngx_str_t * response, ngx_http_request_t *r)
+{
+    int size = cJSON_GetArraySize(hotkeys);
+    cJSON ** arr = ngx_palloc(r->pool, (size + 1) * sizeof(cJSON *));
+    if (!arr)
+    {
+        return false;
+    }
+    int i = 0;
+    cJSON * it = hotkeys->child;
+    for (it = hotkeys->child; it; it = it->next)
+    {
+        arr[i++] = it;
+    }
+    qsort(arr, size, sizeof(cJSON *), __cmp_hotkey);
+
+    cJSON * top = cJSON_CreateArray();
+    if (!top)
+    {
+        return false;
+    }
+    for (i = 0; i < size && (n <= 0 || i < n); ++i)
+    {
+        cJSON_AddItemToArray(top, cJSON_Duplicate(arr[i], 1));
+    }
+    char * json = cJSON_PrintUnformatted(top);
+    cJSON_Delete(top);
+    if (!json)
+    {
+        return false;
+    }
+    ngx_str_t tmp = { strlen(json), (u_char *) json };
+    *response = ngx_http_make_str(&tmp, r->pool);
+    free(json);
+    return NULL != response->data;
+}
+
+static ngx_int_t __finish_hotkeys(hustdb_ha_scatter_ctx_t * ctx, ngx_http_request_t *r)
+{
+    cJSON * hotkeys = NULL;
+    ngx_str_t response = ngx_null_string;
+    do
+    {
+        // a dead or failing backend only leaves its share out
+        if (!__gather(false, ctx, r))
+        {
+            break;
+        }
+        hotkeys = cJSON_CreateArray();
+        if (!hotkeys)
+        {
+            break;
+        }
+        size_t i = 0;
+        for (i = 0; i < ctx->size; ++i)
+        {
+            if (!__ok(&ctx->peers[i]))
+            {
+                continue;
+            }
+            cJSON * it = ctx->peers[i].json->child;
+            for (it = ctx->peers[i].json->child; it; it = it->next)
+            {
+                cJSON * hotkey = __find_hotkey(hotkeys, it);
+                if (hotkey)
+                {
+                    __sum_object(hotkey, it);
+                }
+                else
+                {
+                    cJSON_AddItemToArray(hotkeys, cJSON_Duplicate(it, 1));
+                }
+            }
+        }
+        char * n = ngx_http_get_param_val(&r->args, "n", r->pool);
+        __merge_hotkeys(hotkeys, n ? atoi(n) : 0, &response, r);
+    } while (0);
+
+    if (hotkeys)
+    {
+        cJSON_Delete(hotkeys);
+    }
+    __free_json(ctx);
+    return response.data ? ngx_http_send_response_imp(
+        NGX_HTTP_OK, &response, r) : ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+}
+
+ngx_int_t hustdb_ha_scatter_hotkeys_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (!ctx)
+    {
+        ctx = __create_all_ctx(r);
+        if (!ctx)
+        {
+            return NGX_ERROR;
+        }
+        return __scatter(backend_uri, r, ctx);
+    }
+    return __finish_hotkeys(ctx, r);
+}
+
+// a drop is not synced: every backend holding the table has to take it,
+// a dead one fails the request, which is safe to repeat since a backend
+// that already dropped the table answers 404
+static ngx_int_t __finish_drop(hustdb_ha_scatter_ctx_t * ctx, ngx_http_request_t *r)
+{
+    size_t dropped = 0;
+    ngx_uint_t status = NGX_HTTP_OK;
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (!peer->started)
+        {
+            status = NGX_HTTP_INTERNAL_SERVER_ERROR;
+        }
+        else if (NGX_HTTP_OK == peer->status)
+        {
+            ++dropped;
+        }
+        else if (NGX_HTTP_NOT_FOUND != peer->status && NGX_HTTP_INTERNAL_SERVER_ERROR != status)
+        {
+            status = peer->status;
+        }
+    }
+    if (dropped > 0)
+    {
+        hustdb_ha_read_cache_purge_table(ngx_http_get_param_val(&r->args, "tb", r->pool), r);
+    }
+    if (NGX_HTTP_OK == status && dropped < 1)
+    {
+        status = NGX_HTTP_NOT_FOUND;
+    }
+    return ngx_http_send_response_imp(status, NULL, r);
+}
+
+ngx_int_t hustdb_ha_scatter_drop_handler(ngx_bool_t zset, ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (ctx)
+    {
+        return __finish_drop(ctx, r);
+    }
+    char * tb = ngx_http_get_param_val(&r->args, "tb", r->pool);
+    if (!tb)
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_BAD_REQUEST, NULL, r);
+    }
+    // a zset lives on the replicas of its table, the others on every backend
+    ngx_http_subrequest_peer_t * readlist = zset ? hustdb_ha_get_readlist(tb) : NULL;
+    size_t size = zset ? 0 : hustdb_ha_get_peer_array_count();
+    ngx_http_subrequest_peer_t * it = readlist;
+    for (it = readlist; it; it = it->next)
+    {
+        ++size;
+    }
+    ctx = ngx_pcalloc(r->pool, sizeof(hustdb_ha_scatter_ctx_t));
+    if (!ctx || size < 1)
+    {
+        return NGX_ERROR;
+    }
+    ctx->peers = ngx_pcalloc(r->pool, size * sizeof(hustdb_ha_scatter_peer_t));
+    if (!ctx->peers)
+    {
+        return NGX_ERROR;
+    }
+    ctx->size = size;
+    ctx->zset = zset;
+    size_t i = 0;
+    size_t alive = 0;
+    for (i = 0; i < size; ++i)
+    {
+        ctx->peers[i].scatter = ctx;
+        ctx->peers[i].peer = zset ? readlist->peer : hustdb_ha_get_peer_item(i);
+        readlist = zset ? readlist->next : NULL;
+        if (ngx_http_peer_is_alive(ctx->peers[i].peer))
+        {
+            ++alive;
+        }
+    }
+    if (alive < 1)
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_INTERNAL_SERVER_ERROR, NULL, r);
+    }
+    ngx_http_set_addon_module_ctx(r, ctx);
+    return __scatter(backend_uri, r, ctx);
+}
+
+// zremrangebyscore / zremrangebyrank / zpopmin run on every replica of the
+// table at once, each removes the same members as long as the replicas agree.
+// a dead replica is passed to its partner as host, which then leaves a zrem
+// binlog for every member it removes. the members of the first replica that
+// succeeded are returned; a replica that is alive but failed is only logged.
+static ngx_int_t __finish_zremrange(hustdb_ha_scatter_ctx_t * ctx, ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_peer_t * ok = NULL;
+    ngx_uint_t status = NGX_HTTP_NOT_FOUND;
+    size_t failed = 0;
+    size_t i = 0;
+    for (i = 0; i < ctx->size; ++i)
+    {
+        hustdb_ha_scatter_peer_t * peer = &ctx->peers[i];
+        if (!peer->started)
+        {
+            continue;
+        }
+        if (NGX_HTTP_OK == peer->status)
+        {
+            ok = ok ? ok : peer;
+            continue;
+        }
+        if (failed++ < 1 && peer->status > 0)
+        {
+            status = peer->status;
+        }
+    }
+    if (!ok)
+    {
+        return ngx_http_send_response_imp(status, NULL, r);
+    }
+    if (failed > 0)
+    {
+        ngx_log_error(NGX_LOG_WARN, r->connection->log, 0, "[hustdb_ha][zremrange] replicas of %s may differ",
+            ngx_http_get_param_val(&r->args, "tb", r->pool));
+    }
+    return ngx_http_send_response_imp(NGX_HTTP_OK, &ok->base.response, r);
+}
+
+static ngx_str_t __make_zremrange_args(ngx_http_upstream_rr_peer_t * dead, ngx_http_request_t *r)
+{
+    static ngx_str_t HOST = ngx_string("host");
+
+    ngx_str_t args = ngx_http_remove_param(&r->args, &HOST, r->pool);
+    if (!dead || !args.data)
+    {
+        return args;
+    }
+    ngx_str_t result = ngx_null_string;
+    result.data = ngx_palloc(r->pool, args.len + dead->server.len + sizeof("&host="));
+    if (!result.data)
+    {
+        return result;
+    }
+    result.len = ngx_sprintf(result.data, "%V&host=%V", &args, &dead->server) - result.data;
+    return result;
+}
+
+ngx_int_t hustdb_ha_scatter_zremrange_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    hustdb_ha_scatter_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (ctx)
+    {
+        return __finish_zremrange(ctx, r);
+    }
+    char * tb = ngx_http_get_param_val(&r->args, "tb", r->pool);
+    if (!tb)
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_BAD_REQUEST, NULL, r);
+    }
+    ngx_http_subrequest_peer_t * readlist = hustdb_ha_get_readlist(tb);
+    size_t size = 0;
+    ngx_http_subrequest_peer_t * it = readlist;
+    for (it = readlist; it; it = it->next)
+    {
+        ++size;
+    }
+    ctx = ngx_pcalloc(r->pool, sizeof(hustdb_ha_scatter_ctx_t));
+    if (!ctx || size < 1)
+    {
+        return NGX_ERROR;
+    }
+    ctx->peers = ngx_pcalloc(r->pool, size * sizeof(hustdb_ha_scatter_peer_t));
+    if (!ctx->peers)
+    {
+        return NGX_ERROR;
+    }
+    ctx->size = size;
+    ctx->zset = true;
+    ngx_http_upstream_rr_peer_t * dead = NULL;
+    size_t i = 0;
+    for (i = 0, it = readlist; it; ++i, it = it->next)
+    {
+        ctx->peers[i].scatter = ctx;
+        ctx->peers[i].peer = it->peer;
+        if (!ngx_http_peer_is_alive(it->peer))
+        {
+            dead = it->peer;
+        }
+    }
+    for (i = 0; i < size; ++i)
+    {
+        // only a single dead replica can be handed over, a table has two
+        ctx->peers[i].base.args = __make_zremrange_args(
+            ctx->peers[i].peer == dead ? NULL : dead, r);
+        if (!ctx->peers[i].base.args.data)
+        {
+            return NGX_ERROR;
+        }
+    }
+    ngx_http_set_addon_module_ctx(r, ctx);
+    return __scatter(backend_uri, r, ctx);
+}
@@ -33,6 +33,7 @@ typedef struct
 {
     ngx_str_t public_pem_full_path;
     ngx_shm_zone_t * zone; // data => ngx_http_addon_shm_ctx_t => hustdb_ha_shctx_t
+    ngx_shm_zone_t * read_cache_zone; // NULL unless read_cache_shm_size is set
     ngx_http_upstream_rr_peer_t * sync_peer;
     ngx_str_t sync_status_args;
     // generated
@@ -59,6 +60,16 @@ typedef struct
     ngx_str_t sync_user;
     ngx_str_t sync_passwd;
     ngx_str_t binlog_uri;
+    ngx_str_t stream_prefix;
+    ngx_bool_t coalesce_reads;
+    ssize_t read_cache_shm_size;
+    ngx_int_t read_cache_ttl;
+    ssize_t read_cache_max_value;
+    ngx_bool_t write_admission;
+    ngx_int_t write_admission_latency;
+    ngx_int_t write_admission_max_limit;
+    ngx_int_t write_admission_queue_size;
+    ngx_int_t write_admission_queue_timeout;
 } ngx_http_hustdb_ha_main_conf_t;
 
 void * hustdb_ha_get_module_main_conf(ngx_http_request_t * r);
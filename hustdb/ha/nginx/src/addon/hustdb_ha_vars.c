@@ -40,3 +40,8 @@ const char * hustdb_ha_get_peer_item_uri(size_t index)
 {
     return (const char *) g_peer_array.arr[index]->server.data;
 }
+
+ngx_http_upstream_rr_peer_t * hustdb_ha_get_peer_item(size_t index)
+{
+    return ngx_http_get_peer_by_index(&g_peer_array, index);
+}
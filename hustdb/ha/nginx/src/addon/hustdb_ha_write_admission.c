@@ -0,0 +1,425 @@
+#include "hustdb_ha_write_inner.h"
+
+// with write_admission on, every backend gets a concurrency limit for writes,
+// kept per worker and adjusted by AIMD: a master1 / master2 subrequest that
+// answers within write_admission_latency raises the limit of its backend by
+// 1 / limit, a slower or failed one cuts it by a quarter, at most once per
+// write_admission_latency. a write holds a slot on both backends of its pair
+// until each has answered. writes that do not fit wait in a fifo for
+// write_admission_queue_timeout; when the queue is full or the wait is over
+// they are shed with 503 and a Retry-After header instead of piling up.
+
+struct hustdb_ha_write_limit_s
+{
+    ngx_http_upstream_rr_peer_t * peer;
+    double limit;
+    ngx_uint_t inflight;
+    ngx_uint_t waiting;
+    ngx_msec_t latency;
+    ngx_msec_t last_decrease;
+    ngx_uint_t decreases;
+};
+
+struct hustdb_ha_write_waiter_s
+{
+    ngx_queue_t queue;
+    ngx_http_request_t * r;
+    hustdb_ha_write_ctx_t * ctx;
+    ngx_event_t timer;
+    ngx_bool_t queued;
+    ngx_bool_t admitted;
+};
+
+typedef struct
+{
+    ngx_uint_t admitted;
+    ngx_uint_t waited;
+    ngx_uint_t shed;
+    ngx_uint_t shed_timeout;
+    ngx_uint_t queued;
+} hustdb_ha_write_admission_stat_t;
+
+enum { HUSTDB_HA_WRITE_INITIAL_LIMIT = 16 };
+
+static hustdb_ha_write_limit_t * g_limits = NULL;
+static size_t g_limits_size = 0;
+static ngx_queue_t g_waiters;
+static hustdb_ha_write_admission_stat_t g_stat = { 0, 0, 0, 0, 0 };
+
+ngx_bool_t hustdb_ha_init_write_admission(ngx_http_hustdb_ha_main_conf_t * mcf, ngx_pool_t * pool)
+{
+    if (mcf->write_admission_latency <= 0)
+    {
+        mcf->write_admission_latency = 50;
+    }
+    if (mcf->write_admission_max_limit <= 0)
+    {
+        mcf->write_admission_max_limit = 128;
+    }
+    if (NGX_CONF_UNSET == mcf->write_admission_queue_size)
+    {
+        mcf->write_admission_queue_size = 1024;
+    }
+    if (NGX_CONF_UNSET == mcf->write_admission_queue_timeout)
+    {
+        mcf->write_admission_queue_timeout = 100;
+    }
+    ngx_queue_init(&g_waiters);
+
+    ngx_http_upstream_rr_peers_t * peers = ngx_http_get_backends();
+    if (!peers || peers->number < 1)
+    {
+        return false;
+    }
+    g_limits = ngx_pcalloc(pool, sizeof(hustdb_ha_write_limit_t) * peers->number);
+    if (!g_limits)
+    {
+        return false;
+    }
+    double limit = ngx_min(HUSTDB_HA_WRITE_INITIAL_LIMIT, mcf->write_admission_max_limit);
+    ngx_http_upstream_rr_peer_t * peer = peers->peer;
+    for (g_limits_size = 0; g_limits_size < peers->number && peer; ++g_limits_size, peer = peer->next)
+    {
+        g_limits[g_limits_size].peer = peer;
+        g_limits[g_limits_size].limit = limit;
+    }
+    return true;
+}
+
+static hustdb_ha_write_limit_t * __find_limit(ngx_http_subrequest_peer_t * peer)
+{
+    if (!peer)
+    {
+        return NULL;
+    }
+    size_t i = 0;
+    for (i = 0; i < g_limits_size; ++i)
+    {
+        if (peer->peer == g_limits[i].peer)
+        {
+            return g_limits + i;
+        }
+    }
+    return NULL;
+}
+
+static ngx_bool_t __fits(hustdb_ha_write_limit_t * limit)
+{
+    return !limit || limit->inflight < (ngx_uint_t) limit->limit;
+}
+
+static void __release(hustdb_ha_write_limit_t ** slot)
+{
+    if (*slot)
+    {
+        --(*slot)->inflight;
+        *slot = NULL;
+    }
+}
+
+static void __dequeue(hustdb_ha_write_waiter_t * waiter)
+{
+    ngx_queue_remove(&waiter->queue);
+    waiter->queued = false;
+    --g_stat.queued;
+    if (waiter->timer.timer_set)
+    {
+        ngx_del_timer(&waiter->timer);
+    }
+    hustdb_ha_write_limit_t ** slots = waiter->ctx->slots;
+    if (slots[0])
+    {
+        --slots[0]->waiting;
+    }
+    if (slots[1])
+    {
+        --slots[1]->waiting;
+    }
+}
+
+static void __wake(hustdb_ha_write_waiter_t * waiter)
+{
+    __dequeue(waiter);
+    ngx_connection_t * c = waiter->r->connection;
+    if (c && c->write)
+    {
+        ngx_post_event(c->write, &ngx_posted_events);
+    }
+}
+
+// lets in the waiters that fit now, a waiter for a slow backend does not hold
+// back the ones behind it for other backends
+static void __drain()
+{
+    ngx_queue_t * q = ngx_queue_head(&g_waiters);
+    while (q != ngx_queue_sentinel(&g_waiters))
+    {
+        ngx_queue_t * next = ngx_queue_next(q);
+        hustdb_ha_write_waiter_t * waiter = ngx_queue_data(q, hustdb_ha_write_waiter_t, queue);
+        hustdb_ha_write_limit_t ** slots = waiter->ctx->slots;
+        if (__fits(slots[0]) && __fits(slots[1]))
+        {
+            // taken here, so that the next waiters see them
+            if (slots[0])
+            {
+                ++slots[0]->inflight;
+            }
+            if (slots[1])
+            {
+                ++slots[1]->inflight;
+            }
+            waiter->admitted = true;
+            __wake(waiter);
+        }
+        q = next;
+    }
+}
+
+static void __cleanup(void * data)
+{
+    hustdb_ha_write_ctx_t * ctx = data;
+    hustdb_ha_write_waiter_t * waiter = ctx->waiter;
+    if (waiter && waiter->queued)
+    {
+        __dequeue(waiter);
+    }
+    if (waiter && !waiter->admitted)
+    {
+        ctx->slots[0] = NULL;
+        ctx->slots[1] = NULL;
+    }
+    __release(&ctx->slots[0]);
+    __release(&ctx->slots[1]);
+    __drain();
+}
+
+static ngx_int_t __run(ngx_http_request_t *r, hustdb_ha_write_ctx_t * ctx)
+{
+    ctx->sent = ngx_current_msec;
+    return ngx_http_gen_subrequest(
+        ctx->base.base.backend_uri,
+        r,
+        ctx->base.peer->peer,
+        &ctx->base.base,
+        hustdb_ha_on_subrequest_complete);
+}
+
+static ngx_int_t __shed(ngx_http_request_t *r)
+{
+    static ngx_str_t RETRY_AFTER_KEY = ngx_string("Retry-After");
+    static ngx_str_t RETRY_AFTER_VAL = ngx_string("1");
+    ++g_stat.shed;
+    ngx_http_add_field_to_headers_out(&RETRY_AFTER_KEY, &RETRY_AFTER_VAL, r);
+    return hustdb_ha_send_response(NGX_HTTP_SERVICE_UNAVAILABLE, NULL, NULL, r);
+}
+
+static void __waiter_handler(ngx_http_request_t *r)
+{
+    hustdb_ha_write_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (!ctx || !ctx->waiter || ctx->waiter->queued)
+    {
+        return;
+    }
+    r->write_event_handler = ngx_http_request_empty_handler;
+    if (!ctx->waiter->admitted)
+    {
+        ++g_stat.shed_timeout;
+        ngx_http_finalize_request(r, __shed(r));
+        return;
+    }
+    ++g_stat.admitted;
+    // as if returned by the content handler: NGX_DONE drops the count taken
+    // by the subrequest
+    ngx_http_finalize_request(r, __run(r, ctx));
+}
+
+static void __on_timeout(ngx_event_t * ev)
+{
+    hustdb_ha_write_waiter_t * waiter = ev->data;
+    if (waiter->queued)
+    {
+        __wake(waiter);
+    }
+}
+
+static ngx_int_t __wait(ngx_http_request_t *r, hustdb_ha_write_ctx_t * ctx, ngx_msec_t timeout)
+{
+    hustdb_ha_write_waiter_t * waiter = ngx_pcalloc(r->pool, sizeof(hustdb_ha_write_waiter_t));
+    if (!waiter)
+    {
+        ctx->slots[0] = NULL;
+        ctx->slots[1] = NULL;
+        return __shed(r);
+    }
+    waiter->r = r;
+    waiter->ctx = ctx;
+    waiter->queued = true;
+    waiter->timer.handler = __on_timeout;
+    waiter->timer.data = waiter;
+    waiter->timer.log = r->connection->log;
+    ngx_add_timer(&waiter->timer, timeout);
+    ngx_queue_insert_tail(&g_waiters, &waiter->queue);
+    if (ctx->slots[0])
+    {
+        ++ctx->slots[0]->waiting;
+    }
+    if (ctx->slots[1])
+    {
+        ++ctx->slots[1]->waiting;
+    }
+    ctx->waiter = waiter;
+    r->write_event_handler = __waiter_handler;
+    ++r->main->count;
+    ++g_stat.waited;
+    ++g_stat.queued;
+    return NGX_DONE;
+}
+
+ngx_int_t hustdb_ha_admit_write(ngx_http_request_t *r, hustdb_ha_write_ctx_t * ctx)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    if (!mcf || !mcf->write_admission || !g_limits)
+    {
+        return __run(r, ctx);
+    }
+    ngx_pool_cleanup_t * cln = ngx_pool_cleanup_add(r->pool, 0);
+    if (!cln)
+    {
+        return __run(r, ctx);
+    }
+    cln->handler = __cleanup;
+    cln->data = ctx;
+
+    // slots[0] is master1 and slots[1] master2, as hustdb_ha_write_sample
+    // picks them by state: with master1 down the write starts at master2,
+    // a dead master2 is not sent to and holds nothing
+    hustdb_ha_write_limit_t ** slots = ctx->slots;
+    ngx_http_subrequest_peer_t * master2 = ctx->base.peer->next;
+    if (STATE_WRITE_MASTER2 == ctx->state)
+    {
+        slots[0] = NULL;
+        slots[1] = __find_limit(ctx->base.peer);
+    }
+    else
+    {
+        slots[0] = __find_limit(ctx->base.peer);
+        slots[1] = (master2 && ngx_http_peer_is_alive(master2->peer)) ? __find_limit(master2) : NULL;
+    }
+    ngx_bool_t waiting = (slots[0] && slots[0]->waiting > 0) || (slots[1] && slots[1]->waiting > 0);
+    if (!waiting && __fits(slots[0]) && __fits(slots[1]))
+    {
+        if (slots[0])
+        {
+            ++slots[0]->inflight;
+        }
+        if (slots[1])
+        {
+            ++slots[1]->inflight;
+        }
+        ++g_stat.admitted;
+        return __run(r, ctx);
+    }
+    if (mcf->write_admission_queue_timeout > 0 && g_stat.queued < (ngx_uint_t) mcf->write_admission_queue_size)
+    {
+        return __wait(r, ctx, mcf->write_admission_queue_timeout);
+    }
+    slots[0] = NULL;
+    slots[1] = NULL;
+    return __shed(r);
+}
+
+static void __update_limit(
+    ngx_uint_t status,
+    ngx_msec_t latency,
+    ngx_http_hustdb_ha_main_conf_t * mcf,
+    hustdb_ha_write_limit_t * limit)
+{
+    limit->latency = (limit->latency * 7 + latency) / 8;
+    // 0 and 5xx: the backend could not be reached or gave up
+    ngx_bool_t failed = (status < NGX_HTTP_OK || status >= NGX_HTTP_INTERNAL_SERVER_ERROR);
+    if (!failed && latency <= (ngx_msec_t) mcf->write_admission_latency)
+    {
+        limit->limit += 1.0 / limit->limit;
+        if (limit->limit > mcf->write_admission_max_limit)
+        {
+            limit->limit = mcf->write_admission_max_limit;
+        }
+        return;
+    }
+    if (ngx_current_msec - limit->last_decrease < (ngx_msec_t) mcf->write_admission_latency)
+    {
+        return;
+    }
+    limit->last_decrease = ngx_current_msec;
+    ++limit->decreases;
+    limit->limit *= 0.75;
+    if (limit->limit < 1)
+    {
+        limit->limit = 1;
+    }
+}
+
+void hustdb_ha_write_sample(ngx_http_request_t *r, hustdb_ha_write_ctx_t * ctx)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    if (!mcf || !mcf->write_admission)
+    {
+        return;
+    }
+    hustdb_ha_write_limit_t ** slot = NULL;
+    if (STATE_WRITE_MASTER1 == ctx->state)
+    {
+        slot = &ctx->slots[0];
+    }
+    else if (STATE_WRITE_MASTER2 == ctx->state)
+    {
+        slot = &ctx->slots[1];
+    }
+    if (!slot || !*slot)
+    {
+        return;
+    }
+    __update_limit(r->headers_out.status, ngx_current_msec - ctx->sent, mcf, *slot);
+    __release(slot);
+    // master2 is sent right after this, in the same event
+    ctx->sent = ngx_current_msec;
+    __drain();
+}
+
+ngx_int_t hustdb_ha_write_admission_status_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = hustdb_ha_get_module_main_conf(r);
+    if (!mcf)
+    {
+        return NGX_ERROR;
+    }
+    enum { HEAD_SIZE = 256, BACKEND_SIZE = 256 };
+    size_t size = HEAD_SIZE;
+    size_t i = 0;
+    for (i = 0; i < g_limits_size; ++i)
+    {
+        size += BACKEND_SIZE + g_limits[i].peer->name.len;
+    }
+    u_char * buf = ngx_palloc(r->pool, size);
+    if (!buf)
+    {
+        return NGX_ERROR;
+    }
+    u_char * end = buf + size;
+    u_char * last = ngx_snprintf(buf, end - buf,
+        "{\"write_admission\":%s,\"pid\":%P,\"admitted\":%ui,\"waited\":%ui,\"shed\":%ui,\"shed_timeout\":%ui,"
+        "\"queued\":%ui,\"backends\":[",
+        mcf->write_admission ? "true" : "false", ngx_pid, g_stat.admitted, g_stat.waited, g_stat.shed,
+        g_stat.shed_timeout, g_stat.queued);
+    for (i = 0; i < g_limits_size; ++i)
+    {
+        hustdb_ha_write_limit_t * limit = g_limits + i;
+        last = ngx_snprintf(last, end - last,
+            "%s{\"backend\":\"%V\",\"limit\":%.1f,\"inflight\":%ui,\"waiting\":%ui,\"latency_ms\":%M,\"decreases\":%ui}",
+            i > 0 ? "," : "", &limit->peer->name, limit->limit, limit->inflight, limit->waiting,
+            limit->latency, limit->decreases);
+    }
+    last = ngx_snprintf(last, end - last, "]}");
+    ngx_str_t response = { last - buf, buf };
+    return ngx_http_send_response_imp(NGX_HTTP_OK, &response, r);
+}
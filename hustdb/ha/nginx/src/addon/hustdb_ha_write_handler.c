@@ -46,12 +46,7 @@ static void __post_handler(ngx_http_request_t *r)
         return;
     }
 
-    ngx_http_gen_subrequest(
-        ctx->base.base.backend_uri,
-        r,
-        ctx->base.peer->peer,
-        &ctx->base.base,
-        hustdb_ha_on_subrequest_complete);
+    hustdb_ha_admit_write(r, ctx);
 }
 
 ngx_int_t hustdb_ha_start_post(
@@ -118,12 +113,7 @@ ngx_int_t hustdb_ha_start_del(
         return NGX_ERROR;
     }
 
-    return ngx_http_gen_subrequest(
-            ctx->base.base.backend_uri,
-            r,
-            ctx->base.peer->peer,
-            &ctx->base.base,
-            hustdb_ha_on_subrequest_complete);
+    return hustdb_ha_admit_write(r, ctx);
 }
 
 static ngx_bool_t __match_method(uint8_t methods[], size_t size, uint8_t method)
@@ -139,6 +129,15 @@ static ngx_bool_t __match_method(uint8_t methods[], size_t size, uint8_t method)
     return false;
 }
 
+// methods whose keys may be held by the read cache
+static uint8_t CACHED_METHODS[] = {
+    HUSTDB_METHOD_PUT,
+    HUSTDB_METHOD_DEL,
+    HUSTDB_METHOD_HSET,
+    HUSTDB_METHOD_HDEL
+};
+static size_t CACHED_METHODS_SIZE = sizeof(CACHED_METHODS) / sizeof(uint8_t);
+
 static ngx_bool_t __skip_not_found_error(uint8_t method, ngx_uint_t status)
 {
     if (NGX_HTTP_NOT_FOUND != status)
@@ -309,6 +308,12 @@ ngx_int_t hustdb_ha_write_handler(
     {
         return start_write(support_post_only, key_in_body, has_tb, backend_uri, r);
     }
+    if (__match_method(CACHED_METHODS, CACHED_METHODS_SIZE, method))
+    {
+        // on every backend reply, so that no read overlapping the write is kept
+        hustdb_ha_read_cache_purge(has_tb ? ctx->base.tb : NULL, ctx->base.key, r);
+    }
+    hustdb_ha_write_sample(r, ctx);
     return __switch_state(method, has_tb, r, ctx);
 }
 
@@ -347,12 +352,7 @@ static void __post_body_handler(ngx_http_request_t *r)
         return;
     }
 
-    ngx_http_gen_subrequest(
-        ctx->base.base.backend_uri,
-        r,
-        ctx->base.peer->peer,
-        &ctx->base.base,
-        hustdb_ha_on_subrequest_complete);
+    hustdb_ha_admit_write(r, ctx);
 }
 
 static ngx_int_t __start_zwrite(ngx_str_t * backend_uri, ngx_http_request_t *r)
@@ -387,5 +387,6 @@ ngx_int_t hustdb_ha_zwrite_handler(
     {
         return __start_zwrite(backend_uri, r);
     }
+    hustdb_ha_write_sample(r, ctx);
     return __switch_state(method, true, r, ctx);
 }
@@ -10,6 +10,9 @@ typedef enum
     STATE_WRITE_BINLOG
 } hustdb_write_state_t;
 
+typedef struct hustdb_ha_write_limit_s hustdb_ha_write_limit_t;
+typedef struct hustdb_ha_write_waiter_s hustdb_ha_write_waiter_t;
+
 typedef struct
 {
     hustdb_ha_ctx_t base;
@@ -19,6 +22,11 @@ typedef struct
     ngx_http_subrequest_peer_t * error_peer;
     ngx_http_subrequest_peer_t * health_peer;
     uint32_t ttl;
+
+    // write_admission: the slots held on master1 and master2
+    hustdb_ha_write_limit_t * slots[2];
+    hustdb_ha_write_waiter_t * waiter;
+    ngx_msec_t sent;
 } hustdb_ha_write_ctx_t;
 
 hustdb_ha_write_ctx_t * hustdb_ha_create_write_ctx(ngx_http_request_t *r);
@@ -51,4 +59,10 @@ ngx_int_t hustdb_ha_write_sync_data(
 
 ngx_bool_t hustdb_ha_add_sync_head(const ngx_str_t * server, ngx_http_request_t *r);
 
+// sends the master1 subrequest of ctx if its backends have room, otherwise
+// parks r (NGX_DONE) or sheds it with 503
+ngx_int_t hustdb_ha_admit_write(ngx_http_request_t *r, hustdb_ha_write_ctx_t * ctx);
+// feeds the answer of master1 / master2 back to the limit of its backend
+void hustdb_ha_write_sample(ngx_http_request_t *r, hustdb_ha_write_ctx_t * ctx);
+
 #endif // __hustdb_ha_write_inner_20161013162328_h__
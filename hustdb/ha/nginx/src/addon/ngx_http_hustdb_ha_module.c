@@ -33,6 +33,16 @@ static char * ngx_http_sync_status_uri(ngx_conf_t * cf, ngx_command_t * cmd, voi
 static char * ngx_http_sync_user(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_sync_passwd(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_binlog_uri(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_stream_prefix(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_coalesce_reads(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_read_cache_shm_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_read_cache_ttl(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_read_cache_max_value(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_write_admission(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_write_admission_latency(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_write_admission_max_limit(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_write_admission_queue_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_write_admission_queue_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static void * ngx_http_hustdb_ha_create_main_conf(ngx_conf_t *cf);
 static char * ngx_http_hustdb_ha_init_main_conf(ngx_conf_t * cf, void * conf);
 static ngx_int_t ngx_http_hustdb_ha_postconfiguration(ngx_conf_t * cf);
@@ -109,6 +119,11 @@ static ngx_http_request_item_t hustdb_ha_handler_dict[] =
         ngx_string("/hustdb/hkeys"),
         hustdb_ha_hkeys_handler
     },
+    {
+        ngx_string("/hdrop"),
+        ngx_string("/hustdb/hdrop"),
+        hustdb_ha_hdrop_handler
+    },
     {
         ngx_string("/sadd"),
         ngx_string("/hustdb/sadd"),
@@ -134,6 +149,11 @@ static ngx_http_request_item_t hustdb_ha_handler_dict[] =
         ngx_string("/hustdb/smembers"),
         hustdb_ha_smembers_handler
     },
+    {
+        ngx_string("/sdrop"),
+        ngx_string("/hustdb/sdrop"),
+        hustdb_ha_sdrop_handler
+    },
     {
         ngx_string("/file_count"),
         ngx_string("/hustdb/file_count"),
@@ -149,6 +169,11 @@ static ngx_http_request_item_t hustdb_ha_handler_dict[] =
         ngx_string("/hustdb/stat_all"),
         hustdb_ha_stat_all_handler
     },
+    {
+        ngx_string("/hotkeys"),
+        ngx_string("/hustdb/hotkeys"),
+        hustdb_ha_hotkeys_handler
+    },
     {
         ngx_string("/peer_count"),
         ngx_null_string,
@@ -164,6 +189,21 @@ static ngx_http_request_item_t hustdb_ha_handler_dict[] =
         ngx_null_string,
         hustdb_ha_sync_alive_handler
     },
+    {
+        ngx_string("/coalesce_status"),
+        ngx_null_string,
+        hustdb_ha_coalesce_status_handler
+    },
+    {
+        ngx_string("/read_cache_status"),
+        ngx_null_string,
+        hustdb_ha_read_cache_status_handler
+    },
+    {
+        ngx_string("/write_admission_status"),
+        ngx_null_string,
+        hustdb_ha_write_admission_status_handler
+    },
     {
         ngx_string("/get_table"),
         ngx_null_string,
@@ -209,6 +249,26 @@ static ngx_http_request_item_t hustdb_ha_handler_dict[] =
         ngx_string("/hustdb/zrangebyscore"),
         hustdb_ha_zrangebyscore_handler
     },
+    {
+        ngx_string("/zdrop"),
+        ngx_string("/hustdb/zdrop"),
+        hustdb_ha_zdrop_handler
+    },
+    {
+        ngx_string("/zremrangebyscore"),
+        ngx_string("/hustdb/zremrangebyscore"),
+        hustdb_ha_zremrangebyscore_handler
+    },
+    {
+        ngx_string("/zremrangebyrank"),
+        ngx_string("/hustdb/zremrangebyrank"),
+        hustdb_ha_zremrangebyrank_handler
+    },
+    {
+        ngx_string("/zpopmin"),
+        ngx_string("/hustdb/zpopmin"),
+        hustdb_ha_zpopmin_handler
+    },
     {
         ngx_string("/cache/exist"),
         ngx_string("/hustcache/exist"),
@@ -355,6 +415,16 @@ static ngx_command_t ngx_http_hustdb_ha_commands[] =
     APPEND_MCF_ITEM("sync_user", ngx_http_sync_user),
     APPEND_MCF_ITEM("sync_passwd", ngx_http_sync_passwd),
     APPEND_MCF_ITEM("binlog_uri", ngx_http_binlog_uri),
+    APPEND_MCF_ITEM("stream_prefix", ngx_http_stream_prefix),
+    APPEND_MCF_ITEM("coalesce_reads", ngx_http_coalesce_reads),
+    APPEND_MCF_ITEM("read_cache_shm_size", ngx_http_read_cache_shm_size),
+    APPEND_MCF_ITEM("read_cache_ttl", ngx_http_read_cache_ttl),
+    APPEND_MCF_ITEM("read_cache_max_value", ngx_http_read_cache_max_value),
+    APPEND_MCF_ITEM("write_admission", ngx_http_write_admission),
+    APPEND_MCF_ITEM("write_admission_latency", ngx_http_write_admission_latency),
+    APPEND_MCF_ITEM("write_admission_max_limit", ngx_http_write_admission_max_limit),
+    APPEND_MCF_ITEM("write_admission_queue_size", ngx_http_write_admission_queue_size),
+    APPEND_MCF_ITEM("write_admission_queue_timeout", ngx_http_write_admission_queue_timeout),
     ngx_null_command
 };
 
@@ -695,6 +765,162 @@ static char * ngx_http_binlog_uri(ngx_conf_t * cf, ngx_command_t * cmd, void * c
     return NGX_CONF_OK;
 }
 
+static char * ngx_http_stream_prefix(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_stream_prefix error";
+    }
+    ngx_str_t * arr = cf->args->elts;
+    mcf->stream_prefix = ngx_http_make_str(&arr[1], cf->pool);
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_coalesce_reads(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_coalesce_reads error";
+    }
+    int val = ngx_http_get_flag_slot(cf);
+    if (NGX_ERROR == val)
+    {
+        return "ngx_http_coalesce_reads error";
+    }
+    mcf->coalesce_reads = val;
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_read_cache_shm_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_read_cache_shm_size error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->read_cache_shm_size = ngx_parse_size(&value[1]);
+    if (NGX_ERROR == mcf->read_cache_shm_size)
+    {
+        return "ngx_http_read_cache_shm_size error";
+    }
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_read_cache_ttl(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_read_cache_ttl error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->read_cache_ttl = ngx_parse_time(&value[1], 0);
+    if (NGX_ERROR == mcf->read_cache_ttl)
+    {
+        return "ngx_http_read_cache_ttl error";
+    }
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_read_cache_max_value(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_read_cache_max_value error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->read_cache_max_value = ngx_parse_size(&value[1]);
+    if (NGX_ERROR == mcf->read_cache_max_value)
+    {
+        return "ngx_http_read_cache_max_value error";
+    }
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_write_admission(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_write_admission error";
+    }
+    int val = ngx_http_get_flag_slot(cf);
+    if (NGX_ERROR == val)
+    {
+        return "ngx_http_write_admission error";
+    }
+    mcf->write_admission = val;
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_write_admission_latency(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_write_admission_latency error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->write_admission_latency = ngx_parse_time(&value[1], 0);
+    if (NGX_ERROR == mcf->write_admission_latency)
+    {
+        return "ngx_http_write_admission_latency error";
+    }
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_write_admission_max_limit(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_write_admission_max_limit error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->write_admission_max_limit = ngx_atoi(value[1].data, value[1].len);
+    if (NGX_ERROR == mcf->write_admission_max_limit)
+    {
+        return "ngx_http_write_admission_max_limit error";
+    }
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_write_admission_queue_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_write_admission_queue_size error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->write_admission_queue_size = ngx_atoi(value[1].data, value[1].len);
+    if (NGX_ERROR == mcf->write_admission_queue_size)
+    {
+        return "ngx_http_write_admission_queue_size error";
+    }
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_write_admission_queue_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustdb_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_write_admission_queue_timeout error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->write_admission_queue_timeout = ngx_parse_time(&value[1], 0);
+    if (NGX_ERROR == mcf->write_admission_queue_timeout)
+    {
+        return "ngx_http_write_admission_queue_timeout error";
+    }
+    return NGX_CONF_OK;
+}
+
 static char *ngx_http_hustdb_ha(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
     ngx_http_core_loc_conf_t * clcf = ngx_http_conf_get_module_loc_conf(
@@ -751,7 +977,15 @@ static void ngx_http_hustdb_ha_exit_master(ngx_cycle_t * cycle)
 
 static void * ngx_http_hustdb_ha_create_main_conf(ngx_conf_t *cf)
 {
-    return ngx_pcalloc(cf->pool, sizeof(ngx_http_hustdb_ha_main_conf_t));
+    ngx_http_hustdb_ha_main_conf_t * mcf = ngx_pcalloc(cf->pool, sizeof(ngx_http_hustdb_ha_main_conf_t));
+    if (!mcf)
+    {
+        return NULL;
+    }
+    // 0 is meaningful for both: no queue / no wait
+    mcf->write_admission_queue_size = NGX_CONF_UNSET;
+    mcf->write_admission_queue_timeout = NGX_CONF_UNSET;
+    return mcf;
 }
 
 static ngx_int_t ngx_http_addon_init_shm_ctx(ngx_slab_pool_t * shpool, void * sh)
@@ -785,7 +1019,7 @@ static ngx_bool_t __init_fetch(ngx_conf_t * cf, ngx_http_hustdb_ha_main_conf_t *
         return false;
     }
     mcf->sync_peer = peers->peer;
-    ngx_http_fetch_essential_conf_t ecf = { mcf->fetch_req_pool_size, mcf->keepalive_cache_size, mcf->connection_cache_size, cf, peers };
+    ngx_http_fetch_essential_conf_t ecf = { mcf->fetch_req_pool_size, mcf->keepalive_cache_size, false, mcf->connection_cache_size, cf, peers };
     ngx_http_fetch_upstream_conf_t ucf = {
         mcf->fetch_connect_timeout,
         mcf->fetch_send_timeout,
@@ -824,6 +1058,15 @@ static ngx_bool_t __init_addon(ngx_conf_t * cf, ngx_http_hustdb_ha_main_conf_t *
     mcf->zone = ngx_http_addon_init_shm(cf, &mcf->hustdb_ha_shm_name, mcf->hustdb_ha_shm_size,
         sizeof(hustdb_ha_shctx_t), ngx_http_addon_init_shm_ctx, &ngx_http_hustdb_ha_module);
 
+    if (mcf->read_cache_shm_size > 0)
+    {
+        mcf->read_cache_zone = hustdb_ha_init_read_cache(cf, mcf, &ngx_http_hustdb_ha_module);
+        if (!mcf->read_cache_zone)
+        {
+            return false;
+        }
+    }
+
     hustdb_ha_init_peer_count(cf->pool);
     if (!hustdb_ha_init_peer_dict())
     {
@@ -845,6 +1088,11 @@ static ngx_bool_t __init_addon(ngx_conf_t * cf, ngx_http_hustdb_ha_main_conf_t *
         return false;
     }
 
+    if (mcf->write_admission && !hustdb_ha_init_write_admission(mcf, cf->pool))
+    {
+        return false;
+    }
+
     mcf->public_pem_full_path = ngx_http_get_conf_path(cf->cycle, &mcf->public_pem);
 
     ngx_str_t table_path = ngx_http_get_conf_path(cf->cycle, &mcf->hustdbtable_file);
@@ -2,6 +2,27 @@
 #include "ngx_http_fetch_cache.h"
 // reference: ngx_http_upstream_keepalive_module
 
+// counters of one backend, kept per worker process
+typedef struct
+{
+    ngx_str_t * name;
+    struct sockaddr * sockaddr;
+    socklen_t socklen;
+    ngx_uint_t idle;
+    ngx_uint_t active;
+    ngx_uint_t peak;
+    ngx_uint_t limit;
+    ngx_msec_t window;
+    ngx_uint_t reused;
+    ngx_uint_t connects;
+    ngx_uint_t connect_errors;
+    ngx_uint_t connected;
+    ngx_msec_t connect_time;
+    ngx_msec_t connect_max;
+    ngx_uint_t evicted;
+    ngx_uint_t trimmed;
+} ngx_http_fetch_keepalive_stat_t;
+
 typedef struct
 {
     ngx_http_upstream_rr_peer_data_t rrp;
@@ -9,16 +30,113 @@ typedef struct
     ngx_http_fetch_addr_t addr;
     ngx_http_upstream_t * upstream;
     void * data;
+    ngx_http_fetch_keepalive_stat_t * stat;
+    ngx_flag_t counted;
+    ngx_flag_t fresh;
 } ngx_http_fetch_keepalive_peer_ctx_t;
 
+// in adaptive mode the idle limit of a backend follows the highest number of
+// concurrent fetches seen in the last window: it grows at once and shrinks by
+// half of the gap per window
+enum { NGX_HTTP_FETCH_KEEPALIVE_WINDOW = 1000 };
+
 static ngx_queue_t g_cache = { 0, 0 };
 static ngx_queue_t g_free = { 0, 0 };
-
-ngx_int_t ngx_http_fetch_keepalive_init(size_t keepalive, ngx_conf_t *cf)
+static size_t g_cache_size = 0;
+static ngx_flag_t g_adaptive = 0;
+static ngx_http_fetch_keepalive_stat_t * g_stats = NULL;
+static size_t g_stats_size = 0;
+
+ngx_int_t ngx_http_fetch_keepalive_init(
+    size_t keepalive,
+    ngx_flag_t adaptive,
+    ngx_http_upstream_rr_peers_t * peers,
+    ngx_conf_t *cf)
 {
+    g_cache_size = keepalive;
+    g_adaptive = adaptive;
+    g_stats_size = peers ? peers->number : 0;
+    if (g_stats_size > 0)
+    {
+        g_stats = ngx_pcalloc(cf->pool, sizeof(ngx_http_fetch_keepalive_stat_t) * g_stats_size);
+        if (!g_stats)
+        {
+            return NGX_ERROR;
+        }
+        ngx_http_upstream_rr_peer_t * peer = peers->peer;
+        size_t i = 0;
+        for (i = 0; i < g_stats_size && peer; ++i, peer = peer->next)
+        {
+            g_stats[i].name = &peer->name;
+            g_stats[i].sockaddr = peer->sockaddr;
+            g_stats[i].socklen = peer->socklen;
+            g_stats[i].limit = adaptive ? 1 : keepalive;
+        }
+        g_stats_size = i;
+    }
     return ngx_http_fetch_upstream_cache_init(keepalive, cf->pool, &g_cache, &g_free);
 }
 
+static ngx_http_fetch_keepalive_stat_t * __find_stat(struct sockaddr * sockaddr, socklen_t socklen)
+{
+    size_t i = 0;
+    for (i = 0; i < g_stats_size; ++i)
+    {
+        if (0 == ngx_memn2cmp((u_char *) g_stats[i].sockaddr, (u_char *) sockaddr, g_stats[i].socklen, socklen))
+        {
+            return g_stats + i;
+        }
+    }
+    return NULL;
+}
+
+static void ngx_http_fetch_keepalive_close(ngx_connection_t *c);
+
+static void __trim(ngx_http_fetch_keepalive_stat_t * stat)
+{
+    // the oldest idle connections are at the tail of the cache
+    ngx_queue_t * q = ngx_queue_last(&g_cache);
+    while (stat->idle > stat->limit && q != ngx_queue_sentinel(&g_cache))
+    {
+        ngx_queue_t * prev = ngx_queue_prev(q);
+        ngx_http_fetch_keepalive_cache_t * item = ngx_queue_data(q, ngx_http_fetch_keepalive_cache_t, queue);
+        if (0 == ngx_memn2cmp((u_char *) &item->sockaddr, (u_char *) stat->sockaddr, item->socklen, stat->socklen))
+        {
+            ++stat->trimmed;
+            ngx_http_fetch_keepalive_close(item->connection);
+            ngx_http_fetch_upstream_reuse_cache(item, &g_free);
+        }
+        q = prev;
+    }
+}
+
+static void __update_limit(ngx_http_fetch_keepalive_stat_t * stat)
+{
+    if (!g_adaptive)
+    {
+        return;
+    }
+    if (stat->peak > stat->limit)
+    {
+        stat->limit = ngx_min(stat->peak, g_cache_size);
+    }
+    if (ngx_current_msec - stat->window < NGX_HTTP_FETCH_KEEPALIVE_WINDOW)
+    {
+        return;
+    }
+    stat->window = ngx_current_msec;
+    if (stat->peak < stat->limit)
+    {
+        stat->limit -= (stat->limit - stat->peak + 1) / 2;
+        if (stat->limit < 1)
+        {
+            stat->limit = 1;
+        }
+    }
+    stat->peak = stat->active;
+    __trim(stat);
+}
+
 static ngx_int_t __get_peer(ngx_peer_connection_t *pc, void *data)
 {
     ngx_http_fetch_keepalive_peer_ctx_t * ctx = data;
@@ -34,7 +152,28 @@ static ngx_int_t __get_peer(ngx_peer_connection_t *pc, void *data)
         ctx->addr.peer->conns++;
     }
 
+    ngx_http_fetch_keepalive_stat_t * stat = ctx->stat;
     ngx_connection_t * c = ngx_http_fetch_upstream_reuse_connection(pc, &g_cache, &g_free);
+    if (stat)
+    {
+        ctx->counted = 1;
+        ctx->fresh = !c;
+        ++stat->active;
+        if (stat->active > stat->peak)
+        {
+            stat->peak = stat->active;
+        }
+        if (c)
+        {
+            --stat->idle;
+            ++stat->reused;
+        }
+        else
+        {
+            ++stat->connects;
+        }
+        __update_limit(stat);
+    }
     if (c)
     {
         c->idle = 0;
@@ -58,10 +197,54 @@ static void ngx_http_fetch_keepalive_dummy_handler(ngx_event_t *ev)
 
 static void ngx_http_fetch_keepalive_close(ngx_connection_t *c)
 {
+    ngx_http_fetch_keepalive_cache_t * item = c->data;
+    ngx_http_fetch_keepalive_stat_t * stat = __find_stat((struct sockaddr *) &item->sockaddr, item->socklen);
+    if (stat && stat->idle > 0)
+    {
+        --stat->idle;
+    }
     ngx_destroy_pool(c->pool);
     ngx_close_connection(c);
 }
 
+static void __evict(ngx_connection_t *c)
+{
+    ngx_http_fetch_keepalive_cache_t * item = c->data;
+    ngx_http_fetch_keepalive_stat_t * stat = __find_stat((struct sockaddr *) &item->sockaddr, item->socklen);
+    if (stat)
+    {
+        ++stat->evicted;
+    }
+    ngx_http_fetch_keepalive_close(c);
+}
+
+static void __count_free(ngx_http_fetch_keepalive_peer_ctx_t * ctx)
+{
+    ngx_http_fetch_keepalive_stat_t * stat = ctx->stat;
+    if (!ctx->counted)
+    {
+        return;
+    }
+    ctx->counted = 0;
+    --stat->active;
+    if (!ctx->fresh)
+    {
+        return;
+    }
+    ngx_http_upstream_state_t * state = ctx->upstream->state;
+    if (!state || (ngx_msec_t) -1 == state->connect_time)
+    {
+        ++stat->connect_errors;
+        return;
+    }
+    ++stat->connected;
+    stat->connect_time += state->connect_time;
+    if (state->connect_time > stat->connect_max)
+    {
+        stat->connect_max = state->connect_time;
+    }
+}
+
 static void ngx_http_fetch_keepalive_close_handler(ngx_event_t *ev)
 {
     ngx_connection_t *c = NULL;
@@ -104,6 +287,8 @@ static void __free_peer(ngx_peer_connection_t *pc, void *data, ngx_uint_t state)
     ngx_http_upstream_t * u = ctx->upstream;
     ngx_connection_t * c = pc->connection;
 
+    __count_free(ctx);
+
     do
     {
         if ((state & NGX_PEER_FAILED) || !c
@@ -124,12 +309,17 @@ static void __free_peer(ngx_peer_connection_t *pc, void *data, ngx_uint_t state)
         {
             break;
         }
+        if (g_adaptive && ctx->stat && ctx->stat->idle >= ctx->stat->limit)
+        {
+            ++ctx->stat->trimmed;
+            break;
+        }
         if (NGX_OK != ngx_handle_read_event(c->read, 0))
         {
             break;
         }
 
-        item = ngx_http_fetch_upstream_get_free_connection(ngx_http_fetch_keepalive_close, &g_cache, &g_free);
+        item = ngx_http_fetch_upstream_get_free_connection(__evict, &g_cache, &g_free);
 
         item->connection = c;
 
@@ -157,6 +347,11 @@ static void __free_peer(ngx_peer_connection_t *pc, void *data, ngx_uint_t state)
         item->socklen = pc->socklen;
         ngx_memcpy(&item->sockaddr, pc->sockaddr, pc->socklen);
 
+        if (ctx->stat)
+        {
+            ++ctx->stat->idle;
+        }
+
         if (c->read->ready)
         {
             ngx_http_fetch_keepalive_close_handler(c->read);
@@ -189,6 +384,9 @@ ngx_int_t ngx_http_fetch_init_keepalive_peer(
     ctx->r = r;
     ctx->upstream = r->upstream;
     ctx->data = r->upstream->peer.data;
+    ctx->stat = __find_stat(addr->sockaddr, addr->socklen);
+    ctx->counted = 0;
+    ctx->fresh = 0;
 
     r->upstream->peer.data = ctx;
 
@@ -210,3 +408,39 @@ ngx_int_t ngx_http_fetch_init_keepalive_peer(
 
     return NGX_OK;
 }
+
+ngx_int_t ngx_http_fetch_keepalive_status(ngx_pool_t * pool, ngx_str_t * status)
+{
+    enum { HEAD_SIZE = 128, PEER_SIZE = 512 };
+    size_t size = HEAD_SIZE + g_stats_size * PEER_SIZE;
+    size_t i = 0;
+    for (i = 0; i < g_stats_size; ++i)
+    {
+        size += g_stats[i].name->len;
+    }
+    u_char * buf = ngx_palloc(pool, size);
+    if (!buf)
+    {
+        return NGX_ERROR;
+    }
+    u_char * end = buf + size;
+    u_char * last = ngx_snprintf(buf, end - buf, "{\"adaptive\":%s,\"pid\":%P,\"keepalive_cache_size\":%uz,\"peers\":[",
+        g_adaptive ? "true" : "false", ngx_pid, g_cache_size);
+    for (i = 0; i < g_stats_size; ++i)
+    {
+        ngx_http_fetch_keepalive_stat_t * stat = g_stats + i;
+        ngx_uint_t total = stat->reused + stat->connects;
+        last = ngx_snprintf(last, end - last,
+            "%s{\"peer\":\"%V\",\"idle\":%ui,\"active\":%ui,\"limit\":%ui,\"reused\":%ui,\"connects\":%ui,"
+            "\"connect_errors\":%ui,\"reuse_ratio\":%.3f,\"connect_avg_ms\":%M,\"connect_max_ms\":%M,"
+            "\"evicted\":%ui,\"trimmed\":%ui}",
+            i > 0 ? "," : "", stat->name, stat->idle, stat->active, stat->limit, stat->reused, stat->connects,
+            stat->connect_errors, total > 0 ? (double) stat->reused / total : 0.0,
+            stat->connected > 0 ? stat->connect_time / stat->connected : 0, stat->connect_max,
+            stat->evicted, stat->trimmed);
+    }
+    last = ngx_snprintf(last, end - last, "]}");
+    status->data = buf;
+    status->len = last - buf;
+    return NGX_OK;
+}
@@ -672,14 +672,15 @@ void ngx_http_post_body_handler(ngx_http_request_t * r, ngx_http_post_body_cb cb
     ngx_http_finalize_request(r, rc);
 }
 
-ngx_int_t ngx_http_run_subrequest(
+ngx_int_t ngx_http_start_subrequest(
         ngx_http_request_t *r,
         ngx_http_subrequest_ctx_t * ctx,
         ngx_http_upstream_rr_peer_t * peer)
 {
     ngx_http_request_t * psr;
     ngx_str_t * args = ctx->args.data ? &ctx->args : (r->args.len > 0 ? &r->args : NULL);
-    ngx_int_t ret = ngx_http_subrequest(r, &ctx->uri, args, &psr, ctx->subrequest, NGX_HTTP_SUBREQUEST_IN_MEMORY);
+    ngx_int_t ret = ngx_http_subrequest(r, &ctx->uri, args, &psr, ctx->subrequest,
+        ctx->stream ? 0 : NGX_HTTP_SUBREQUEST_IN_MEMORY);
 
     if (!psr)
     {
@@ -687,20 +688,35 @@ ngx_int_t ngx_http_run_subrequest(
     }
 
     ngx_http_set_addon_module_ctx(psr, peer);
+    if (ctx->stream)
+    {
+        ngx_http_set_ctx(psr, ctx, ngx_http_stream_filter_module);
+    }
 
     if (NGX_OK != ret)
     {
         return NGX_HTTP_INTERNAL_SERVER_ERROR;
     }
+    return NGX_OK;
+}
 
+ngx_int_t ngx_http_run_subrequest(
+        ngx_http_request_t *r,
+        ngx_http_subrequest_ctx_t * ctx,
+        ngx_http_upstream_rr_peer_t * peer)
+{
+    ngx_int_t rc = ngx_http_start_subrequest(r, ctx, peer);
+    if (NGX_OK != rc)
+    {
+        return rc;
+    }
     r->main->count++;
     return NGX_DONE;
 }
 
-ngx_int_t ngx_http_gen_subrequest(
+ngx_int_t ngx_http_init_subrequest(
         ngx_str_t * backend_uri,
         ngx_http_request_t *r,
-        ngx_http_upstream_rr_peer_t * peer,
         ngx_http_subrequest_ctx_t * ctx,
         ngx_http_post_subrequest_pt handler)
 {
@@ -717,7 +733,21 @@ ngx_int_t ngx_http_gen_subrequest(
     ctx->uri.len = backend_uri->len;
     ctx->response.data = NULL;
     ctx->response.len = 0;
+    return NGX_OK;
+}
 
+ngx_int_t ngx_http_gen_subrequest(
+        ngx_str_t * backend_uri,
+        ngx_http_request_t *r,
+        ngx_http_upstream_rr_peer_t * peer,
+        ngx_http_subrequest_ctx_t * ctx,
+        ngx_http_post_subrequest_pt handler)
+{
+    ngx_int_t rc = ngx_http_init_subrequest(backend_uri, r, ctx, handler);
+    if (NGX_OK != rc)
+    {
+        return rc;
+    }
     return ngx_http_run_subrequest(r, ctx, peer);
 }
 
@@ -74,12 +74,31 @@ typedef struct
     ngx_str_t args;
     ngx_str_t * backend_uri;
     ngx_str_t response;
+    ngx_bool_t stream; // pass the body of a 200 to the client instead of keeping it in response
+    ngx_bool_t streamed; // the headers of r->main have been sent by ngx_http_stream_filter_module
 } ngx_http_subrequest_ctx_t;
 
+extern ngx_module_t ngx_http_stream_filter_module;
+
+// ngx_http_finish_subrequest for the handler of a subrequest that may stream:
+// NGX_ERROR, which terminates r->main, if it failed after r->main sent its headers
+ngx_int_t ngx_http_stream_subrequest_finish(ngx_http_request_t * r, ngx_int_t rc);
+
 ngx_int_t ngx_http_run_subrequest(
         ngx_http_request_t *r,
         ngx_http_subrequest_ctx_t * ctx,
         ngx_http_upstream_rr_peer_t * peer);
+// ngx_http_run_subrequest without taking r->main for the NGX_DONE of the handler:
+// a handler that starts several subrequests at once takes it a single time
+ngx_int_t ngx_http_start_subrequest(
+        ngx_http_request_t *r,
+        ngx_http_subrequest_ctx_t * ctx,
+        ngx_http_upstream_rr_peer_t * peer);
+ngx_int_t ngx_http_init_subrequest(
+        ngx_str_t * backend_uri,
+        ngx_http_request_t *r,
+        ngx_http_subrequest_ctx_t * ctx,
+        ngx_http_post_subrequest_pt handler);
 ngx_int_t ngx_http_gen_subrequest(
         ngx_str_t * backend_uri,
         ngx_http_request_t *r,
@@ -20,15 +20,15 @@ typedef struct
 
 static hustmq_ha_stat_buffer_t g_hustmq_ha_stat_buffer;
 
-static ngx_bool_t __decode_json_array(const char * input, void * obj_val)
+static ngx_bool_t __decode_json_array(char * input, size_t len, ngx_pool_t * pool, void * obj_val)
 {
-    return cjson_load_hustmqhamessagequeuearray(input, obj_val);
+    return hustmqha_load_message_queue_array(input, len, pool, obj_val);
 }
 
-static ngx_bool_t __set_backend_stat_item(ngx_http_request_t * r, backend_stat_item_t * it)
+static ngx_bool_t __set_backend_stat_item(ngx_http_request_t * r, ngx_pool_t * pool, backend_stat_item_t * it)
 {
     HustmqHaMessageQueueArray arr;
-    if (!hustmq_ha_decode_json_array(r, __decode_json_array, &arr))
+    if (!hustmq_ha_decode_json_array(r, pool, __decode_json_array, &arr))
     {
         return false;
     }
@@ -40,24 +40,37 @@ static ngx_bool_t __set_backend_stat_item(ngx_http_request_t * r, backend_stat_i
     return true;
 }
 
+static void __refresh_stat_buffer(ngx_http_hustmq_ha_main_conf_t * conf, backend_stat_array_t * backend_stats)
+{
+    hustmq_ha_merge_queue_dict(&g_hustmq_ha_stat_buffer.queue_dict, conf->pool,
+            &g_hustmq_ha_stat_buffer.queue_array);
+    g_hustmq_ha_stat_buffer.json_encode_ok = hustmqha_serialize_message_queue_array(
+            &g_hustmq_ha_stat_buffer.queue_array, conf->pool, &g_hustmq_ha_stat_buffer.buf);
+    hustmq_ha_invoke_evget_handler();
+    hustmq_ha_invoke_evsub_handler();
+}
+
 static void __merge_backend_stats(ngx_http_hustmq_ha_main_conf_t * conf, backend_stat_array_t * backend_stats)
 {
     if (backend_stats->size > 0)
     {
         hustmq_ha_update_queue_dict(conf->status_cache, backend_stats, conf->pool, &g_hustmq_ha_stat_buffer.queue_dict);
-        hustmq_ha_merge_queue_dict(&g_hustmq_ha_stat_buffer.queue_dict, conf->pool,
-                &g_hustmq_ha_stat_buffer.queue_array);
-        g_hustmq_ha_stat_buffer.json_encode_ok = hustmqha_serialize_message_queue_array(
-                &g_hustmq_ha_stat_buffer.queue_array, conf->pool, &g_hustmq_ha_stat_buffer.buf);
-        hustmq_ha_dispose_backend_stat_array(backend_stats);
-        hustmq_ha_invoke_evget_handler();
-        hustmq_ha_invoke_evsub_handler();
+        __refresh_stat_buffer(conf, backend_stats);
+    }
+}
+
+static void __patch_backend_stats(ngx_http_hustmq_ha_main_conf_t * conf, backend_stat_array_t * backend_stats)
+{
+    if (backend_stats->size > 0)
+    {
+        hustmq_ha_patch_queue_dict(backend_stats, conf->pool, &g_hustmq_ha_stat_buffer.queue_dict);
+        __refresh_stat_buffer(conf, backend_stats);
     }
 }
 
 ngx_int_t hustmq_ha_init_stat_buffer(ngx_http_hustmq_ha_main_conf_t * mcf)
 {
-    if (NGX_OK != hustmq_ha_init_fetch_cache(mcf, __set_backend_stat_item, __merge_backend_stats))
+    if (NGX_OK != hustmq_ha_init_fetch_cache(mcf, __set_backend_stat_item, __merge_backend_stats, __patch_backend_stats))
     {
         return NGX_ERROR;
     }
@@ -87,7 +100,7 @@ ngx_int_t hustmq_ha_stat_all_handler(ngx_str_t * backend_uri, ngx_http_request_t
 {
 	ngx_str_t tmp;
 	tmp.data = (u_char *)g_hustmq_ha_stat_buffer.buf.buf;
-	tmp.len = strlen(g_hustmq_ha_stat_buffer.buf.buf);
+	tmp.len = g_hustmq_ha_stat_buffer.buf.len;
 
 	return g_hustmq_ha_stat_buffer.json_encode_ok ? ngx_http_send_response_imp(
 			NGX_HTTP_OK, &tmp, r) : ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
@@ -150,7 +163,7 @@ static ngx_int_t post_autost_subrequest_handler(ngx_http_request_t *r, void *dat
 {
     r->parent->write_event_handler = ngx_http_core_run_phases;
     hustmq_ha_autost_ctx_t * ctx = data;
-    if (__set_backend_stat_item(r, ctx->backend_stats.arr + ctx->backend_stats.size))
+    if (__set_backend_stat_item(r, r->pool, ctx->backend_stats.arr + ctx->backend_stats.size))
     {
         ++ctx->backend_stats.size;
     }
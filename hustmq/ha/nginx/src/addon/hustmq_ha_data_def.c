@@ -6,15 +6,15 @@ static const char * QUEUE_ITEM_JSON_FORMAT = "{\
 \"ready\":[%d,%d,%d],\
 \"max\":%d,\
 \"lock\":%d,\
-\"si\":%d,\
-\"ci\":%d,\
-\"tm\":%d,\
+\"si\":%ud,\
+\"ci\":%ud,\
+\"tm\":%T,\
 \"unacked\":%d,\
 \"timeout\":%d\
 }";
 
-typedef ngx_bool_t (*serialize_item_t)(void * obj_val, char * json_val);
-typedef size_t (*dump_item_t)(void * obj_val, size_t index, char * json_val);
+// returns the end of the item, last if it did not fit, NULL if it is invalid
+typedef u_char * (*dump_item_t)(void * arr, size_t index, u_char * pos, u_char * last);
 
 static ngx_bool_t __update_buffer(size_t size, size_t item_size, ngx_pool_t * pool, hustmq_ha_buffer_t * buf)
 {
@@ -26,6 +26,7 @@ static ngx_bool_t __update_buffer(size_t size, size_t item_size, ngx_pool_t * po
 	{
 		return true;
 	}
+	char * old = buf->buf;
 	buf->items = size * 2;
 	buf->max_size = item_size * buf->items;
 	buf->buf = ngx_palloc(pool, buf->max_size);
@@ -33,30 +34,17 @@ static ngx_bool_t __update_buffer(size_t size, size_t item_size, ngx_pool_t * po
 	{
 		return false;
 	}
+	ngx_pfree(pool, old);
 	return true;
 }
 
-static ngx_bool_t __serialize_one_arr(void * obj_val, serialize_item_t serialize_item, char * json_val)
-{
-	if (!obj_val || !json_val)
-	{
-		return false;
-	}
-	sprintf(json_val, "[");
-	if (!serialize_item(obj_val, json_val + 1))
-	{
-		return false;
-	}
-	strcat(json_val, "]");
-	return true;
-}
-
+// the items are written one after another straight into the buffer, if it
+// turns out to be too small it is doubled and the array written again
 static ngx_bool_t __serialize_array_base(
 		void * arr,
 		size_t size,
 		ngx_pool_t * pool,
 		size_t item_size,
-		serialize_item_t serialize_item,
 		dump_item_t dump_item,
 		hustmq_ha_buffer_t * json_val)
 {
@@ -64,47 +52,45 @@ static ngx_bool_t __serialize_array_base(
 	{
 		return false;
 	}
-	if (size < 1)
-	{
-		sprintf(json_val->buf, "[]");
-		return true;
-	}
-
-	if (1 == size)
-	{
-		return __serialize_one_arr(arr, serialize_item, json_val->buf);
-	}
-
-	if (!__update_buffer(size, item_size, pool, json_val))
-	{
-		return false;
-	}
-
-	sprintf(json_val->buf, "[");
-	size_t offset = 1;
-	size_t i = 0;
-	for (i = 0; i < size; ++i)
+	size_t items = size;
+	for (;;)
 	{
-		size_t len = dump_item(arr, i, json_val->buf + offset);
-		if (len < 1)
+		if (!__update_buffer(items, item_size, pool, json_val))
 		{
 			return false;
 		}
-		strcat(json_val->buf, i == size - 1 ? "]" : ",");
-		offset += (len + 1);
+		u_char * pos = (u_char *) json_val->buf;
+		u_char * last = pos + json_val->max_size - 1;
+		*pos++ = '[';
+		size_t i = 0;
+		for (i = 0; i < size && pos < last; ++i)
+		{
+			if (i > 0)
+			{
+				*pos++ = ',';
+			}
+			pos = dump_item(arr, i, pos, last);
+			if (!pos)
+			{
+				return false;
+			}
+		}
+		if (pos < last)
+		{
+			*pos++ = ']';
+			*pos = '\0';
+			json_val->len = pos - (u_char *) json_val->buf;
+			return true;
+		}
+		items = json_val->items + 1;
 	}
-	return true;
 }
 
-static void __dump_message_queue_item_imp(hustmq_ha_message_queue_item_t * obj_val, char * json_val)
+static u_char * __dump_message_queue_item_imp(hustmq_ha_message_queue_item_t * obj_val, u_char * pos, u_char * last)
 {
-	if (!obj_val || !json_val)
-	{
-		return;
-	}
-	sprintf(json_val, QUEUE_ITEM_JSON_FORMAT,
+	return ngx_snprintf(pos, last - pos, QUEUE_ITEM_JSON_FORMAT,
 			obj_val->queue,
-			obj_val->base.type,
+			(int) obj_val->base.type,
 			obj_val->base.ready[0],
 			obj_val->base.ready[1],
 			obj_val->base.ready[2],
@@ -119,32 +105,19 @@ static void __dump_message_queue_item_imp(hustmq_ha_message_queue_item_t * obj_v
 
 ngx_bool_t hustmqha_serialize_message_queue_item(hustmq_ha_message_queue_item_t * obj_val, char * json_val)
 {
-	if (!obj_val || !obj_val->queue || !obj_val->base.ready || !json_val)
+	if (!obj_val || !obj_val->queue || !json_val)
 	{
 		return false;
 	}
-	__dump_message_queue_item_imp(obj_val, json_val);
+	u_char * last = __dump_message_queue_item_imp(obj_val, (u_char *) json_val, (u_char *) json_val + HUSTMQ_HA_QUEUE_ITEM_SIZE - 1);
+	*last = '\0';
 	return true;
 }
 
-static ngx_bool_t __serialize_message_queue_item(void * obj_val, char * json_val)
+static u_char * __dump_message_queue_item(void * arr, size_t index, u_char * pos, u_char * last)
 {
-	return hustmqha_serialize_message_queue_item(obj_val, json_val);
-}
-
-static size_t __dump_message_queue_item(void * obj_val, size_t index, char * json_val)
-{
-	if (!obj_val)
-	{
-		return 0;
-	}
-	hustmq_ha_message_queue_item_t * it = (hustmq_ha_message_queue_item_t *)obj_val + index;
-	if (!it || !it->queue || !it->base.ready || !json_val)
-	{
-		return 0;
-	}
-	__dump_message_queue_item_imp(it, json_val);
-	return strlen(json_val);
+	hustmq_ha_message_queue_item_t * it = (hustmq_ha_message_queue_item_t *)arr + index;
+	return it->queue ? __dump_message_queue_item_imp(it, pos, last) : NULL;
 }
 
 ngx_bool_t hustmqha_serialize_message_queue_array(hustmq_ha_message_queue_array_t * obj_val, ngx_pool_t * pool, hustmq_ha_buffer_t * json_val)
@@ -154,55 +127,199 @@ ngx_bool_t hustmqha_serialize_message_queue_array(hustmq_ha_message_queue_array_
 			obj_val->size,
 			pool,
 			HUSTMQ_HA_QUEUE_ITEM_SIZE,
-			__serialize_message_queue_item,
 			__dump_message_queue_item,
 			json_val) : false;
 }
 
-static void __dump_worker_item_imp(hustmq_worker_t * obj_val, char * json_val)
+static u_char * __dump_worker_item(void * arr, size_t index, u_char * pos, u_char * last)
 {
-	if (!obj_val || !json_val)
+	hustmq_worker_t * it = (hustmq_worker_t *)arr + index;
+	return it->worker ? ngx_snprintf(pos, last - pos, "{\"w\":\"%s\",\"t\":%d}", it->worker, it->time) : NULL;
+}
+
+ngx_bool_t hustmqha_serialize_worker_array(hustmq_worker_array_t * obj_val, ngx_pool_t * pool, hustmq_ha_buffer_t * json_val)
+{
+	return obj_val ? __serialize_array_base(
+			obj_val->arr,
+			obj_val->size,
+			pool,
+			HUSTMQ_HA_WORKER_SIZE,
+			__dump_worker_item,
+			json_val) : false;
+}
+
+typedef struct
+{
+	const char * name;
+	size_t val;
+	size_t has;
+} int_field_t;
+
+#define INT_FIELD(type, name) { #name, offsetof(type, name), offsetof(type, json_has_##name) }
+
+static const int_field_t MESSAGE_QUEUE_INT_FIELDS[] = {
+	INT_FIELD(HustmqHaMessageQueue, type),
+	INT_FIELD(HustmqHaMessageQueue, max),
+	INT_FIELD(HustmqHaMessageQueue, lock),
+	INT_FIELD(HustmqHaMessageQueue, si),
+	INT_FIELD(HustmqHaMessageQueue, ci),
+	INT_FIELD(HustmqHaMessageQueue, tm),
+	INT_FIELD(HustmqHaMessageQueue, unacked),
+	INT_FIELD(HustmqHaMessageQueue, timeout)
+};
+static const size_t MESSAGE_QUEUE_INT_FIELDS_SIZE = sizeof(MESSAGE_QUEUE_INT_FIELDS) / sizeof(int_field_t);
+
+static const int_field_t WORKER_INT_FIELDS[] = {
+	INT_FIELD(HustmqWorker, t)
+};
+static const size_t WORKER_INT_FIELDS_SIZE = sizeof(WORKER_INT_FIELDS) / sizeof(int_field_t);
+
+// -1: key is not in fields
+static int __load_int_field(json_reader_t * reader, const json_str_t * key, const int_field_t * fields, size_t size, void * obj_val)
+{
+	size_t i = 0;
+	for (i = 0; i < size; ++i)
 	{
-		return;
+		if (json_key_eq(key, fields[i].name))
+		{
+			json_bool_t * has = (json_bool_t *) ((u_char *) obj_val + fields[i].has);
+			*has = json_read_integer(reader, (json_int_t *) ((u_char *) obj_val + fields[i].val));
+			return *has;
+		}
 	}
-	static const char * WORKER_JSON_FORMAT = "{\"w\":\"%s\",\"t\":%d}";
-	sprintf(json_val, WORKER_JSON_FORMAT, obj_val->worker, obj_val->time);
+	return -1;
 }
 
-static ngx_bool_t __serialize_worker_item(void * obj_val, char * json_val)
+static ngx_bool_t __load_message_queue(json_reader_t * reader, ngx_pool_t * pool, void * item)
 {
-	hustmq_worker_t * item = obj_val;
-	if (!item || !item->worker || !json_val)
+	HustmqHaMessageQueue * obj_val = item;
+	if (!json_read_begin_object(reader))
 	{
 		return false;
 	}
-	__dump_worker_item_imp(item, json_val);
-	return true;
+	json_str_t key;
+	size_t index = 0;
+	int rc = 0;
+	while ((rc = json_read_next_field(reader, index++, &key)) > 0)
+	{
+		if (json_key_eq(&key, "queue"))
+		{
+			obj_val->json_has_queue = json_read_string(reader, &obj_val->queue);
+			rc = obj_val->json_has_queue;
+		}
+		else if (json_key_eq(&key, "ready"))
+		{
+			obj_val->ready.arr = ngx_palloc(pool, HUSTMQ_HA_READY_SIZE * sizeof(json_int_t));
+			obj_val->json_has_ready = obj_val->ready.arr && json_read_integer_array(
+				reader, obj_val->ready.arr, HUSTMQ_HA_READY_SIZE, &obj_val->ready.size);
+			rc = obj_val->json_has_ready;
+		}
+		else
+		{
+			rc = __load_int_field(reader, &key, MESSAGE_QUEUE_INT_FIELDS, MESSAGE_QUEUE_INT_FIELDS_SIZE, obj_val);
+			if (rc < 0)
+			{
+				rc = json_skip_value(reader);
+			}
+		}
+		if (!rc)
+		{
+			return false;
+		}
+	}
+	return 0 == rc && obj_val->json_has_queue;
 }
 
-static size_t __dump_worker_item(void * obj_val, size_t index, char * json_val)
+static ngx_bool_t __load_worker(json_reader_t * reader, ngx_pool_t * pool, void * item)
+{
+	HustmqWorker * obj_val = item;
+	if (!json_read_begin_object(reader))
+	{
+		return false;
+	}
+	json_str_t key;
+	size_t index = 0;
+	int rc = 0;
+	while ((rc = json_read_next_field(reader, index++, &key)) > 0)
+	{
+		if (json_key_eq(&key, "w"))
+		{
+			obj_val->json_has_w = json_read_string(reader, &obj_val->w);
+			rc = obj_val->json_has_w;
+		}
+		else
+		{
+			rc = __load_int_field(reader, &key, WORKER_INT_FIELDS, WORKER_INT_FIELDS_SIZE, obj_val);
+			if (rc < 0)
+			{
+				rc = json_skip_value(reader);
+			}
+		}
+		if (!rc)
+		{
+			return false;
+		}
+	}
+	return 0 == rc && obj_val->json_has_w;
+}
+
+typedef ngx_bool_t (*load_item_t)(json_reader_t * reader, ngx_pool_t * pool, void * item);
+
+static ngx_bool_t __load_array_base(
+		char * input,
+		size_t len,
+		ngx_pool_t * pool,
+		size_t item_size,
+		load_item_t load_item,
+		void ** arr,
+		size_t * size)
 {
-	if (!obj_val)
+	if (!input || !pool)
+	{
+		return false;
+	}
+	json_reader_t reader;
+	json_reader_init(&reader, input, len);
+	if (!json_read_begin_array(&reader))
 	{
-		return 0;
+		return false;
 	}
-	hustmq_worker_t * it = (hustmq_worker_t *)obj_val + index;
-	if (!it || !it->worker || !json_val)
+	ngx_array_t items;
+	if (NGX_OK != ngx_array_init(&items, pool, 16, item_size))
 	{
 		return false;
 	}
-	__dump_worker_item_imp(it, json_val);
-	return strlen(json_val);
+	int rc = 0;
+	while ((rc = json_read_next_item(&reader, items.nelts)) > 0)
+	{
+		void * item = ngx_array_push(&items);
+		if (!item)
+		{
+			return false;
+		}
+		memset(item, 0, item_size);
+		if (!load_item(&reader, pool, item))
+		{
+			return false;
+		}
+	}
+	if (rc < 0 || !json_reader_eof(&reader))
+	{
+		return false;
+	}
+	*arr = items.nelts > 0 ? items.elts : NULL;
+	*size = items.nelts;
+	return true;
 }
 
-ngx_bool_t hustmqha_serialize_worker_array(hustmq_worker_array_t * obj_val, ngx_pool_t * pool, hustmq_ha_buffer_t * json_val)
+ngx_bool_t hustmqha_load_message_queue_array(char * input, size_t len, ngx_pool_t * pool, HustmqHaMessageQueueArray * obj_val)
 {
-	return obj_val ? __serialize_array_base(
-			obj_val->arr,
-			obj_val->size,
-			pool,
-			HUSTMQ_HA_WORKER_SIZE,
-			__serialize_worker_item,
-			__dump_worker_item,
-			json_val) : false;
+	return obj_val ? __load_array_base(input, len, pool, sizeof(HustmqHaMessageQueue),
+			__load_message_queue, (void **) &obj_val->arr, &obj_val->size) : false;
+}
+
+ngx_bool_t hustmqha_load_worker_array(char * input, size_t len, ngx_pool_t * pool, HustmqWorkerArray * obj_val)
+{
+	return obj_val ? __load_array_base(input, len, pool, sizeof(HustmqWorker),
+			__load_worker, (void **) &obj_val->arr, &obj_val->size) : false;
 }
@@ -2,10 +2,12 @@
 #define __hustmq_ha_data_def_20150605185936_h__
 
 #include "hustmq_ha_utils.h"
+#include "json_reader.h"
 
 typedef struct
 {
 	char * buf;
+	size_t len;
 	size_t items;
 	size_t max_size;
 } hustmq_ha_buffer_t;
@@ -58,4 +60,55 @@ typedef struct
 
 ngx_bool_t hustmqha_serialize_worker_array(hustmq_worker_array_t * obj_val, ngx_pool_t * pool, hustmq_ha_buffer_t * json_val);
 
+// an item of /hustmq/stat_all
+typedef struct
+{
+    json_int_t type;
+    json_str_t queue;
+    IntegerArray ready;
+    json_int_t max;
+    json_int_t lock;
+    json_int_t si;
+    json_int_t ci;
+    json_int_t tm;
+    json_int_t unacked;
+    json_int_t timeout;
+    json_bool_t json_has_type;
+    json_bool_t json_has_queue;
+    json_bool_t json_has_ready;
+    json_bool_t json_has_max;
+    json_bool_t json_has_lock;
+    json_bool_t json_has_si;
+    json_bool_t json_has_ci;
+    json_bool_t json_has_tm;
+    json_bool_t json_has_unacked;
+    json_bool_t json_has_timeout;
+} HustmqHaMessageQueue;
+
+typedef struct
+{
+    HustmqHaMessageQueue * arr;
+    size_t size;
+} HustmqHaMessageQueueArray;
+
+// an item of /hustmq/worker
+typedef struct
+{
+    json_str_t w;
+    json_int_t t;
+    json_bool_t json_has_w;
+    json_bool_t json_has_t;
+} HustmqWorker;
+
+typedef struct
+{
+    HustmqWorker * arr;
+    size_t size;
+} HustmqWorkerArray;
+
+// input is parsed in place ( see json_reader.h ), the arrays are allocated
+// from pool and need no dispose
+ngx_bool_t hustmqha_load_message_queue_array(char * input, size_t len, ngx_pool_t * pool, HustmqHaMessageQueueArray * obj_val);
+ngx_bool_t hustmqha_load_worker_array(char * input, size_t len, ngx_pool_t * pool, HustmqWorkerArray * obj_val);
+
 #endif // __hustmq_ha_data_def_20150605185936_h__
@@ -63,19 +63,22 @@ static ngx_queue_t g_free_ctx = { 0, 0 };
 static ngx_event_t g_ev_event;
 static ngx_http_hustmq_ha_main_conf_t * g_mcf = NULL;
 static hustmq_ha_merge_backend_stats_t g_merge = NULL;
+static hustmq_ha_merge_backend_stats_t g_patch = NULL;
 static hustmq_ha_set_backend_stat_item_t g_set = NULL;
 
 ngx_int_t hustmq_ha_init_fetch_cache(
     ngx_http_hustmq_ha_main_conf_t * mcf,
     hustmq_ha_set_backend_stat_item_t set,
-    hustmq_ha_merge_backend_stats_t merge)
+    hustmq_ha_merge_backend_stats_t merge,
+    hustmq_ha_merge_backend_stats_t patch)
 {
-    if (!mcf || !set || !merge)
+    if (!mcf || !set || !merge || !patch)
     {
         return NGX_ERROR;
     }
     g_mcf = mcf;
     g_merge = merge;
+    g_patch = patch;
     g_set = set;
     return __init_cache(
         mcf->fetch_req_pool_size * ngx_http_get_backend_count(),
@@ -107,7 +110,7 @@ static ngx_int_t __post_upstream(ngx_http_request_t * r, void * data, ngx_int_t
         return NGX_OK;
     }
 
-    if (NGX_OK == rc && g_set(r, ctx->backend_stats.arr + ctx->backend_stats.size))
+    if (NGX_OK == rc && g_set(r, ctx->pool, ctx->backend_stats.arr + ctx->backend_stats.size))
     {
         ++ctx->backend_stats.size;
     }
@@ -235,3 +238,121 @@ void hustmq_ha_invoke_autost(ngx_log_t * log)
         ngx_add_timer(&g_ev_event, g_mcf->autost_interval);
     }
 }
+
+// every worker keeps one long-poll open on each backend ( see /hustmq/watch ),
+// the backend answers as soon as a queue becomes ready or empty, so the
+// evget / evsub waiters are woken without waiting for the next autost
+
+#define WATCH_RETRY_INTERVAL 1000
+
+typedef struct
+{
+    ngx_http_upstream_rr_peer_t * peer;
+    ngx_event_t ev;
+    uint64_t seq;
+} watch_ctx_t;
+
+static const ngx_str_t WATCH_SEQ = ngx_string("Seq");
+static watch_ctx_t * g_watch_ctx = NULL;
+
+static ngx_int_t __post_watch(ngx_http_request_t * r, void * data, ngx_int_t rc)
+{
+    watch_ctx_t * ctx = data;
+    ngx_msec_t delay = WATCH_RETRY_INTERVAL;
+
+    if (NGX_OK == rc && r->upstream)
+    {
+        ngx_str_t * seq = ngx_http_find_head_value(&r->upstream->headers_in.headers, &WATCH_SEQ);
+        if (seq)
+        {
+            off_t val = ngx_atoof(seq->data, seq->len);
+            if (NGX_ERROR != val)
+            {
+                ctx->seq = (uint64_t) val;
+            }
+        }
+
+        if (NGX_HTTP_OK == r->headers_out.status)
+        {
+            backend_stat_item_t item;
+            backend_stat_array_t arr = { &item, 0, 1 };
+            if (g_set(r, r->pool, &item))
+            {
+                arr.size = 1;
+                g_patch(g_mcf, &arr);
+            }
+            delay = 0;
+        }
+        else if (NGX_HTTP_NOT_FOUND == r->headers_out.status)
+        {
+            delay = 0; // the long-poll timed out with nothing to report
+        }
+    }
+
+    // the next watch is issued from the timer, not from inside the upstream finalizer
+    ngx_add_timer(&ctx->ev, delay);
+    return NGX_OK;
+}
+
+static void __fetch_watch(ngx_event_t * ev)
+{
+    watch_ctx_t * ctx = ev->data;
+
+    static ngx_http_fetch_header_t headers[] = {
+        { ngx_string("Connection"), ngx_string("Keep-Alive") },
+        { ngx_string("Content-Type"), ngx_string("text/plain") }
+    };
+    static size_t headers_len = sizeof(headers) / sizeof(ngx_http_fetch_header_t);
+    ngx_http_auth_basic_key_t auth = { g_mcf->username, g_mcf->password  };
+
+    u_char buf[64];
+    u_char * last = ngx_snprintf(buf, sizeof(buf), "seq=%uL&timeout=%i",
+        ctx->seq, g_mcf->watch_timeout / 1000);
+    ngx_str_t args = { last - buf, buf };
+
+    ngx_http_upstream_rr_peer_t * peer = ctx->peer;
+    ngx_http_fetch_args_t fetch_args = {
+        NGX_HTTP_GET,
+        { peer->sockaddr, peer->socklen, &peer->name, peer },
+        g_mcf->watch_uri,
+        args,
+        { headers, headers_len },
+        ngx_null_string,
+        { NULL, NULL },
+        { __post_watch, ctx }
+    };
+    if (NGX_OK != ngx_http_fetch(&fetch_args, &auth))
+    {
+        ngx_http_fetch_log("ngx_http_fetch::__fetch_watch ngx_http_fetch fail");
+        ngx_add_timer(&ctx->ev, WATCH_RETRY_INTERVAL);
+    }
+}
+
+void hustmq_ha_invoke_watch(ngx_log_t * log)
+{
+    if (!g_mcf->watch_uri.data || g_mcf->watch_timeout < 1000)
+    {
+        return;
+    }
+
+    size_t count = ngx_http_get_backend_count();
+    g_watch_ctx = ngx_pcalloc(g_mcf->pool, count * sizeof(watch_ctx_t));
+    if (!g_watch_ctx)
+    {
+        return;
+    }
+
+    ngx_http_upstream_rr_peers_t * peers = ngx_http_get_backends();
+    ngx_http_upstream_rr_peer_t * peer = peers->peer;
+    size_t i = 0;
+    for (i = 0; peer && i < count; peer = peer->next, ++i)
+    {
+        watch_ctx_t * ctx = g_watch_ctx + i;
+        ctx->peer = peer;
+        ctx->seq = 0;
+        ctx->ev.handler = __fetch_watch;
+        ctx->ev.log = log;
+        ctx->ev.data = ctx;
+        ngx_add_timer(&ctx->ev, 0);
+    }
+}
@@ -17,17 +17,23 @@ typedef struct
 	ngx_str_t * peer_name;
 	ngx_str_t * ack_token;
 	ngx_bool_t ack;
+	ngx_http_upstream_rr_peers_t * peers;
+	u_char * tried;
+	u_char * preferred;
 } hustmq_ha_get_ctx_t;
 
-static ngx_bool_t __check_peer(hustmq_ha_queue_dict_t * dict, ngx_str_t * queue, ngx_http_upstream_rr_peer_t * peer)
+static hustmq_ha_queue_item_t * __get_queue_item(hustmq_ha_queue_dict_t * dict, ngx_str_t * queue, ngx_http_upstream_rr_peer_t * peer)
 {
     hustmq_ha_queue_value_t * queue_val = hustmq_ha_queue_dict_get(dict, (const char *)queue->data);
 	if (!queue_val)
 	{
-		return false;
+		return NULL;
 	}
+	return hustmq_ha_host_dict_get(queue_val, (const char *)peer->name.data);
+}
 
-	hustmq_ha_queue_item_t * queue_item = hustmq_ha_host_dict_get(queue_val, (const char *)peer->name.data);
+static ngx_bool_t __check_peer(hustmq_ha_queue_item_t * queue_item, ngx_http_upstream_rr_peer_t * peer)
+{
 	if (!queue_item)
 	{
 		return false;
@@ -40,32 +46,114 @@ static ngx_bool_t __check_peer(hustmq_ha_queue_dict_t * dict, ngx_str_t * queue,
 	return ngx_http_peer_is_alive(peer);
 }
 
-static ngx_http_upstream_rr_peer_t * __next_peer(hustmq_ha_queue_dict_t * dict, ngx_str_t * queue, ngx_http_upstream_rr_peer_t * peer)
+// weighted random on the cached ready count, so that every backend is drained
+// in proportion to its depth instead of the first one taking all the gets.
+// peers holding only unacked messages are picked when nothing else is left.
+static ngx_http_upstream_rr_peer_t * __select_peer_imp(
+    hustmq_ha_queue_dict_t * dict,
+    ngx_str_t * queue,
+    ngx_http_upstream_rr_peers_t * peers,
+    u_char * tried,
+    const u_char * preferred)
 {
-	if (!peer)
+	ngx_uint_t total = 0;
+	ngx_uint_t count = 0;
+	ngx_uint_t i = 0;
+	ngx_http_upstream_rr_peer_t * peer = NULL;
+	for (peer = peers->peer, i = 0; peer && i < peers->number; peer = peer->next, ++i)
 	{
-		return NULL;
+		if (tried[i] || (preferred && !preferred[i]))
+		{
+			continue;
+		}
+		hustmq_ha_queue_item_t * queue_item = __get_queue_item(dict, queue, peer);
+		if (!__check_peer(queue_item, peer))
+		{
+			continue;
+		}
+		int ready = hustmq_ha_get_ready_sum(queue_item->base.ready, HUSTMQ_HA_READY_SIZE);
+		total += ready > 0 ? ready : 0;
+		++count;
 	}
-	if (!dict->dict.ref)
+	if (count < 1)
 	{
-		return ngx_http_next_peer(peer);
+		return NULL;
 	}
-	do
+
+	ngx_uint_t pos = (ngx_uint_t) ngx_random() % (total > 0 ? total : count);
+	for (peer = peers->peer, i = 0; peer && i < peers->number; peer = peer->next, ++i)
 	{
-		peer = peer->next;
-		if (!peer)
+		if (tried[i] || (preferred && !preferred[i]))
 		{
-			return NULL;
+			continue;
 		}
-		if (__check_peer(dict, queue, peer))
+		hustmq_ha_queue_item_t * queue_item = __get_queue_item(dict, queue, peer);
+		if (!__check_peer(queue_item, peer))
 		{
+			continue;
+		}
+		ngx_uint_t weight = 1;
+		if (total > 0)
+		{
+			int ready = hustmq_ha_get_ready_sum(queue_item->base.ready, HUSTMQ_HA_READY_SIZE);
+			weight = ready > 0 ? ready : 0;
+		}
+		if (pos < weight)
+		{
+			tried[i] = 1;
 			return peer;
 		}
-	} while(peer->next);
+		pos -= weight;
+	}
 	return NULL;
 }
 
-static ngx_http_upstream_rr_peer_t * __first_peer(hustmq_ha_queue_dict_t * dict, ngx_str_t * queue, ngx_http_upstream_rr_peer_t * peer)
+// with queue_ring_replicas the preferred set of the queue is drained first,
+// the other backends only hold what spilled over
+static ngx_http_upstream_rr_peer_t * __select_peer(
+    hustmq_ha_queue_dict_t * dict,
+    ngx_str_t * queue,
+    ngx_http_upstream_rr_peers_t * peers,
+    u_char * tried,
+    const u_char * preferred)
+{
+	ngx_http_upstream_rr_peer_t * peer = preferred ? __select_peer_imp(dict, queue, peers, tried, preferred) : NULL;
+	return peer ? peer : __select_peer_imp(dict, queue, peers, tried, NULL);
+}
+
+static u_char * __build_preferred(ngx_str_t * queue, ngx_http_upstream_rr_peers_t * peers, ngx_http_request_t *r)
+{
+	ngx_http_hustmq_ha_main_conf_t * conf = hustmq_ha_get_module_main_conf(r);
+	if (!conf || conf->queue_ring_replicas < 1)
+	{
+		return NULL;
+	}
+	size_t replicas = conf->queue_ring_replicas;
+	ngx_uint_t * indexes = ngx_palloc(r->pool, replicas * sizeof(ngx_uint_t));
+	u_char * preferred = ngx_pcalloc(r->pool, peers->number);
+	if (!indexes || !preferred)
+	{
+		return NULL;
+	}
+	size_t count = hustmq_ha_ring_lookup(queue, indexes, replicas);
+	size_t i = 0;
+	for (i = 0; i < count; ++i)
+	{
+		if (indexes[i] < peers->number)
+		{
+			preferred[indexes[i]] = 1;
+		}
+	}
+	return preferred;
+}
+
+static ngx_http_upstream_rr_peer_t * __next_peer(
+    hustmq_ha_queue_dict_t * dict,
+    ngx_str_t * queue,
+    ngx_http_upstream_rr_peers_t * peers,
+    ngx_http_upstream_rr_peer_t * peer,
+    u_char * tried,
+    const u_char * preferred)
 {
 	if (!peer)
 	{
@@ -73,13 +161,43 @@ static ngx_http_upstream_rr_peer_t * __first_peer(hustmq_ha_queue_dict_t * dict,
 	}
 	if (!dict->dict.ref)
 	{
-		return ngx_http_first_peer(peer);
+		return ngx_http_next_peer(peer);
+	}
+	return __select_peer(dict, queue, peers, tried, preferred);
+}
+
+static ngx_http_upstream_rr_peer_t * __first_peer(
+    hustmq_ha_queue_dict_t * dict,
+    ngx_str_t * queue,
+    ngx_http_upstream_rr_peers_t * peers,
+    u_char * tried,
+    const u_char * preferred)
+{
+	if (!peers->peer)
+	{
+		return NULL;
+	}
+	if (!dict->dict.ref)
+	{
+		return ngx_http_first_peer(peers->peer);
+	}
+	return __select_peer(dict, queue, peers, tried, preferred);
+}
+
+// the backend has just told us the queue is empty there, so its cached ready
+// count is stale. clear it until the next autost refresh brings a new one,
+// which keeps the following gets ( and the retries of this one ) away from it.
+static void __penalize_empty_peer(hustmq_ha_queue_dict_t * dict, ngx_str_t * queue, ngx_http_upstream_rr_peer_t * peer)
+{
+	if (!peer || !dict->dict.ref)
+	{
+		return;
 	}
-	if (__check_peer(dict, queue, peer))
+	hustmq_ha_queue_item_t * queue_item = __get_queue_item(dict, queue, peer);
+	if (queue_item)
 	{
-		return peer;
+		memset(queue_item->base.ready, 0, sizeof(queue_item->base.ready));
 	}
-	return __next_peer(dict, queue, peer);
 }
 
 static ngx_int_t __post_subrequest_handler(ngx_http_request_t * r, void * data, ngx_int_t rc)
@@ -129,7 +247,14 @@ static ngx_int_t __first_get_handler(ngx_str_t * backend_uri, ngx_http_request_t
 		return NGX_ERROR;
 	}
 
-	ngx_http_upstream_rr_peer_t * peer = __first_peer(queue_dict, &queue, peers->peer);
+	u_char * tried = ngx_pcalloc(r->pool, peers->number);
+	if (!tried)
+	{
+		return NGX_ERROR;
+	}
+
+	u_char * preferred = __build_preferred(&queue, peers, r);
+	ngx_http_upstream_rr_peer_t * peer = __first_peer(queue_dict, &queue, peers, tried, preferred);
 	if (!peer)
 	{
 		return NGX_ERROR;
@@ -145,6 +270,9 @@ static ngx_int_t __first_get_handler(ngx_str_t * backend_uri, ngx_http_request_t
 	ctx->queue_dict = queue_dict;
 	ctx->queue = queue;
 	ctx->ack = ack;
+	ctx->peers = peers;
+	ctx->tried = tried;
+	ctx->preferred = preferred;
 
 	ctx->peer = peer;
 	return ngx_http_gen_subrequest(backend_uri, r, ctx->peer,
@@ -178,7 +306,11 @@ ngx_int_t hustmq_ha_get_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 	}
 	if (NGX_HTTP_OK != r->headers_out.status)
 	{
-		ctx->peer = __next_peer(ctx->queue_dict, &ctx->queue, ctx->peer);
+		if (NGX_HTTP_NOT_FOUND == r->headers_out.status)
+		{
+			__penalize_empty_peer(ctx->queue_dict, &ctx->queue, ctx->peer);
+		}
+		ctx->peer = __next_peer(ctx->queue_dict, &ctx->queue, ctx->peers, ctx->peer, ctx->tried, ctx->preferred);
 		return ctx->peer ? ngx_http_run_subrequest(r, &ctx->base, ctx->peer) : NGX_ERROR;
 	}
 	if (!__add_response_headers(ctx, r))
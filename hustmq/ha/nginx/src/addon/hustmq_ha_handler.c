@@ -12,6 +12,16 @@ ngx_int_t hustmq_ha_version_handler(ngx_str_t * backend_uri, ngx_http_request_t
     return ngx_http_send_response_imp(r->headers_out.status, &version, r);
 }
 
+ngx_int_t hustmq_ha_fetch_status_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
+{
+    ngx_str_t response = { 0, NULL };
+    if (NGX_OK != ngx_http_fetch_status(r->pool, &response))
+    {
+        return NGX_ERROR;
+    }
+    return ngx_http_send_response_imp(NGX_HTTP_OK, &response, r);
+}
+
 static ngx_bool_t __check_lock_request(ngx_http_request_t *r, hustmq_ha_queue_dict_t * queue_dict, ngx_str_t * queue)
 {
     char * val = ngx_http_get_param_val(&r->args, "on", r->pool);
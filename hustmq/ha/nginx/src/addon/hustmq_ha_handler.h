@@ -24,5 +24,6 @@ ngx_int_t hustmq_ha_do_get_handler(ngx_str_t * backend_uri, ngx_http_request_t *
 ngx_int_t hustmq_ha_do_post_handler(ngx_str_t * backend_uri, ngx_http_request_t *r);
 ngx_int_t hustmq_ha_do_get_status_handler(ngx_str_t * backend_uri, ngx_http_request_t *r);
 ngx_int_t hustmq_ha_do_post_status_handler(ngx_str_t * backend_uri, ngx_http_request_t *r);
+ngx_int_t hustmq_ha_fetch_status_handler(ngx_str_t * backend_uri, ngx_http_request_t *r);
 
 #endif // __hustmq_ha_handler_20150601202210_h__
@@ -6,6 +6,15 @@ static ngx_http_peer_dict_t g_peer_dict;
 static ngx_http_subrequest_peer_t * g_peer_list = NULL;
 static ngx_http_upstream_rr_peer_t ** g_hash_table = NULL;
 
+typedef struct
+{
+    uint32_t hash;
+    ngx_uint_t index; // position of the peer in g_hash_table
+} hustmq_ha_ring_node_t;
+
+static hustmq_ha_ring_node_t * g_ring = NULL;
+static size_t g_ring_size = 0;
+
 static ngx_bool_t __inconsistent(const hustmq_ha_idx_t * host_item, const hustmq_ha_idx_t * merge_item)
 {
     if (!host_item || !merge_item)
@@ -170,6 +179,92 @@ ngx_bool_t hustmq_ha_init_hash(ngx_pool_t * pool, ngx_http_upstream_rr_peers_t *
     return true;
 }
 
+static int __cmp_ring_node(const void * a, const void * b)
+{
+    uint32_t x = ((const hustmq_ha_ring_node_t *) a)->hash;
+    uint32_t y = ((const hustmq_ha_ring_node_t *) b)->hash;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// every backend is placed vnodes times on the ring, at the hash of "name#i".
+// the ring only depends on the backend names, so all the ha instances agree
+// on it and adding or removing a backend only moves the queues next to it
+ngx_bool_t hustmq_ha_init_ring(ngx_pool_t * pool, ngx_http_upstream_rr_peers_t * peers, ngx_uint_t vnodes)
+{
+    if (!pool || !peers || !g_hash_table || vnodes < 1)
+    {
+        return false;
+    }
+    size_t backends = ngx_http_get_backend_count();
+    g_ring = ngx_palloc(pool, backends * vnodes * sizeof(hustmq_ha_ring_node_t));
+    if (!g_ring)
+    {
+        return false;
+    }
+    g_ring_size = 0;
+    size_t i = 0;
+    for (i = 0; i < backends; ++i)
+    {
+        ngx_str_t * name = &g_hash_table[i]->name;
+        ngx_uint_t v = 0;
+        for (v = 0; v < vnodes; ++v)
+        {
+            u_char buf[NGX_SOCKADDR_STRLEN + NGX_INT_T_LEN + 1];
+            u_char * last = ngx_snprintf(buf, sizeof(buf), "%V#%ui", name, v);
+            g_ring[g_ring_size].hash = ngx_murmur_hash2(buf, last - buf);
+            g_ring[g_ring_size].index = i;
+            ++g_ring_size;
+        }
+    }
+    ngx_qsort(g_ring, g_ring_size, sizeof(hustmq_ha_ring_node_t), __cmp_ring_node);
+    return true;
+}
+
+size_t hustmq_ha_ring_lookup(ngx_str_t * queue, ngx_uint_t * indexes, size_t size)
+{
+    if (!g_ring || g_ring_size < 1 || !queue || !indexes)
+    {
+        return 0;
+    }
+    uint32_t hash = ngx_murmur_hash2(queue->data, queue->len);
+    size_t lo = 0;
+    size_t hi = g_ring_size;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (g_ring[mid].hash < hash)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    size_t count = 0;
+    size_t step = 0;
+    for (step = 0; step < g_ring_size && count < size; ++step)
+    {
+        ngx_uint_t index = g_ring[(lo + step) % g_ring_size].index;
+        size_t i = 0;
+        while (i < count && indexes[i] != index)
+        {
+            ++i;
+        }
+        if (i == count)
+        {
+            indexes[count++] = index;
+        }
+    }
+    return count;
+}
+
+ngx_http_upstream_rr_peer_t * hustmq_ha_get_peer_by_index(ngx_uint_t index)
+{
+    return index < ngx_http_get_backend_count() ? g_hash_table[index] : NULL;
+}
+
 ngx_http_upstream_rr_peer_t * hustmq_ha_get_peer(ngx_str_t * queue)
 {
     ngx_uint_t hash = ngx_hash_key(queue->data, queue->len);
@@ -8,6 +8,12 @@ ngx_bool_t hustmq_ha_init_peer_dict(ngx_http_upstream_rr_peers_t * peers);
 ngx_bool_t hustmq_ha_init_peer_list(ngx_pool_t * pool, ngx_http_upstream_rr_peers_t * peers);
 ngx_bool_t hustmq_ha_init_hash(ngx_pool_t * pool, ngx_http_upstream_rr_peers_t * peers);
 ngx_http_upstream_rr_peer_t * hustmq_ha_get_peer(ngx_str_t * queue);
+ngx_bool_t hustmq_ha_init_ring(ngx_pool_t * pool, ngx_http_upstream_rr_peers_t * peers, ngx_uint_t vnodes);
+// walks the ring clockwise from the hash of queue, writes the first size
+// distinct backends to indexes ( positions in the upstream ) and returns
+// how many were written
+size_t hustmq_ha_ring_lookup(ngx_str_t * queue, ngx_uint_t * indexes, size_t size);
+ngx_http_upstream_rr_peer_t * hustmq_ha_get_peer_by_index(ngx_uint_t index);
 ngx_str_t hustmq_ha_encode_ack_peer(ngx_str_t * peer_name, ngx_pool_t * pool);
 ngx_http_upstream_rr_peer_t * hustmq_ha_decode_ack_peer(ngx_str_t * ack_peer, ngx_pool_t * pool);
 ngx_http_subrequest_peer_t * hustmq_ha_build_pub_peer_list(hustmq_ha_queue_ctx_t * queue_ctx, ngx_pool_t * pool);
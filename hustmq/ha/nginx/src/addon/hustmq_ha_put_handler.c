@@ -188,6 +188,163 @@ static ngx_int_t __put_by_queue_hash(ngx_str_t * backend_uri, ngx_http_request_t
     return ngx_http_send_response_imp(NGX_HTTP_OK, &ctx->base.response, r);
 }
 
+typedef struct
+{
+    ngx_http_subrequest_ctx_t base;
+    ngx_http_upstream_rr_peer_t ** peers;
+    size_t size;
+    size_t index;
+} hustmq_ha_ring_put_ctx_t;
+
+// a backend of the preferred set is full once it holds its share of max
+static ngx_bool_t __ring_peer_full(hustmq_ha_queue_value_t * queue_val, ngx_http_upstream_rr_peer_t * peer, ngx_int_t replicas)
+{
+    hustmq_ha_queue_item_t * item = hustmq_ha_host_dict_get(queue_val, (const char *)peer->name.data);
+    if (!item)
+    {
+        return false;
+    }
+    if (item->base.lock)
+    {
+        return true;
+    }
+    if (item->base.max < 1)
+    {
+        return false;
+    }
+    int share = item->base.max / replicas;
+    int sum = hustmq_ha_get_ready_sum(item->base.ready, HUSTMQ_HA_READY_SIZE);
+    return sum >= (share > 0 ? share : 1);
+}
+
+// the order in which the backends are tried: the live members of the
+// preferred set that are not full ( rotated so that they share the puts ),
+// then the rest of the ring in ring order, then the full ones
+static size_t __build_ring_peers(
+    ngx_str_t * queue,
+    ngx_int_t replicas,
+    ngx_http_upstream_rr_peer_t ** peers,
+    ngx_http_request_t *r)
+{
+    static ngx_uint_t rotate = 0;
+
+    size_t backends = ngx_http_get_backend_count();
+    ngx_uint_t * indexes = ngx_palloc(r->pool, backends * sizeof(ngx_uint_t));
+    ngx_http_upstream_rr_peer_t ** full = ngx_palloc(r->pool, backends * sizeof(ngx_http_upstream_rr_peer_t *));
+    if (!indexes || !full)
+    {
+        return 0;
+    }
+    size_t count = hustmq_ha_ring_lookup(queue, indexes, backends);
+    hustmq_ha_queue_value_t * queue_val = hustmq_ha_queue_dict_get(hustmq_ha_get_queue_dict(), (const char *)queue->data);
+
+    size_t size = 0;
+    size_t full_size = 0;
+    size_t preferred = 0;
+    size_t i = 0;
+    for (i = 0; i < count; ++i)
+    {
+        ngx_http_upstream_rr_peer_t * peer = hustmq_ha_get_peer_by_index(indexes[i]);
+        if (!peer || !ngx_http_peer_is_alive(peer))
+        {
+            continue;
+        }
+        if (queue_val && __ring_peer_full(queue_val, peer, replicas))
+        {
+            full[full_size++] = peer;
+            continue;
+        }
+        peers[size++] = peer;
+        if (i < (size_t) replicas)
+        {
+            ++preferred;
+        }
+    }
+    if (preferred > 1)
+    {
+        size_t shift = rotate++ % preferred;
+        size_t k = 0;
+        for (k = 0; k < shift; ++k)
+        {
+            ngx_http_upstream_rr_peer_t * first = peers[0];
+            memmove(peers, peers + 1, (preferred - 1) * sizeof(ngx_http_upstream_rr_peer_t *));
+            peers[preferred - 1] = first;
+        }
+    }
+    for (i = 0; i < full_size; ++i)
+    {
+        peers[size++] = full[i];
+    }
+    return size;
+}
+
+static void __on_ring_body_received(ngx_http_request_t * r)
+{
+    hustmq_ha_ring_put_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    --r->main->count;
+    ngx_http_gen_subrequest(ctx->base.backend_uri, r, ctx->peers[0],
+        &ctx->base, ngx_http_post_subrequest_handler);
+}
+
+static ngx_int_t __first_ring_put(ngx_str_t * backend_uri, ngx_int_t replicas, ngx_http_request_t *r)
+{
+    ngx_str_t queue = hustmq_ha_get_queue(r);
+    if (!queue.data)
+    {
+        return NGX_ERROR;
+    }
+
+    hustmq_ha_queue_dict_t * queue_dict = hustmq_ha_get_queue_dict();
+    if (!queue_dict)
+    {
+        return NGX_ERROR;
+    }
+
+    if (queue_dict->dict.ref && !hustmq_ha_put_queue_item_check(queue_dict, &queue))
+    {
+        return ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
+    }
+
+    hustmq_ha_ring_put_ctx_t * ctx = ngx_pcalloc(r->pool, sizeof(hustmq_ha_ring_put_ctx_t));
+    if (!ctx)
+    {
+        return NGX_ERROR;
+    }
+    ctx->peers = ngx_palloc(r->pool, ngx_http_get_backend_count() * sizeof(ngx_http_upstream_rr_peer_t *));
+    if (!ctx->peers)
+    {
+        return NGX_ERROR;
+    }
+    ctx->size = __build_ring_peers(&queue, replicas, ctx->peers, r);
+    if (ctx->size < 1)
+    {
+        return NGX_ERROR;
+    }
+    ngx_http_set_addon_module_ctx(r, ctx);
+    ctx->base.backend_uri = backend_uri;
+
+    ngx_int_t rc = ngx_http_read_client_request_body(r, __on_ring_body_received);
+    if ( rc >= NGX_HTTP_SPECIAL_RESPONSE )
+    {
+        return rc;
+    }
+    return NGX_DONE;
+}
+
+static ngx_int_t __put_by_ring(ngx_str_t * backend_uri, ngx_int_t replicas, ngx_http_request_t *r)
+{
+    hustmq_ha_ring_put_ctx_t * ctx = ngx_http_get_addon_module_ctx(r);
+    if (!ctx)
+    {
+        return __first_ring_put(backend_uri, replicas, r);
+    }
+    if (NGX_HTTP_OK != r->headers_out.status)
+    {
+        return (++ctx->index < ctx->size) ? ngx_http_run_subrequest(r, &ctx->base, ctx->peers[ctx->index]) : NGX_ERROR;
+    }
+    return ngx_http_send_response_imp(NGX_HTTP_OK, &ctx->base.response, r);
+}
+
 ngx_int_t hustmq_ha_put_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
 {
     ngx_http_hustmq_ha_main_conf_t * conf = hustmq_ha_get_module_main_conf(r);
@@ -195,5 +352,9 @@ ngx_int_t hustmq_ha_put_handler(ngx_str_t * backend_uri, ngx_http_request_t *r)
     {
         return NGX_ERROR;
     }
+    if (conf->queue_ring_replicas > 0)
+    {
+        return __put_by_ring(backend_uri, conf->queue_ring_replicas, r);
+    }
     return conf->queue_hash ? __put_by_queue_hash(backend_uri, r) : __put_by_round_robin(backend_uri, r);
 }
@@ -136,7 +136,7 @@ ngx_int_t hustmq_ha_handler_base(ngx_str_t * backend_uri, ngx_http_request_t *r,
 	return NGX_HTTP_OK == ctx->result ? ngx_http_send_response_imp(NGX_HTTP_OK, NULL, r) : NGX_ERROR;
 }
 
-ngx_bool_t hustmq_ha_decode_json_array(ngx_http_request_t *r, decode_json_array_t decode, void * arr)
+ngx_bool_t hustmq_ha_decode_json_array(ngx_http_request_t *r, ngx_pool_t * pool, decode_json_array_t decode, void * arr)
 {
 	if (NGX_HTTP_OK != r->headers_out.status)
 	{
@@ -150,18 +150,12 @@ ngx_bool_t hustmq_ha_decode_json_array(ngx_http_request_t *r, decode_json_array_
 		return false;
 	}
 
-	u_char * end = response.data + response.len;
-
-	if (!end)
+	char * input = ngx_pnalloc(pool, response.len);
+	if (!input)
 	{
 		return false;
 	}
+	memcpy(input, response.data, response.len);
 
-	u_char end_val = *end;
-
-	*end = '\0';
-	ngx_bool_t rc = decode((const char *)response.data, arr);
-	*end = end_val;
-
-	return rc;
+	return decode(input, response.len, pool, arr);
 }
@@ -25,8 +25,9 @@ ngx_int_t hustmq_ha_handler_base(
 		check_request_pt checker,
 		ngx_http_post_subrequest_pt handler);
 
-typedef ngx_bool_t (*decode_json_array_t)(const char * input, void * obj_val);
-ngx_bool_t hustmq_ha_decode_json_array(ngx_http_request_t *r, decode_json_array_t decode, void * arr);
+typedef ngx_bool_t (*decode_json_array_t)(char * input, size_t len, ngx_pool_t * pool, void * obj_val);
+// the response is copied to pool and decoded there, arr lives as long as pool
+ngx_bool_t hustmq_ha_decode_json_array(ngx_http_request_t *r, ngx_pool_t * pool, decode_json_array_t decode, void * arr);
 
 void hustmq_ha_init_evget_handler(ngx_log_t * log);
 void hustmq_ha_invoke_evget_handler();
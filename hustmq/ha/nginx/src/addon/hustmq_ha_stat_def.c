@@ -20,19 +20,6 @@ hustmq_ha_queue_value_t * hustmq_ha_queue_dict_get(hustmq_ha_queue_dict_t * dict
     return val ? *val : 0;
 }
 
-void hustmq_ha_dispose_backend_stat_array(backend_stat_array_t * arr)
-{
-	if (!arr || !arr->arr)
-	{
-		return;
-	}
-	size_t i = 0;
-	for(i = 0; i < arr->size; ++i)
-	{
-		cjson_dispose_hustmqhamessagequeuearray(&(arr->arr + i)->arr);
-	}
-}
-
 static void __update_queue_data(const HustmqHaMessageQueue * src, hustmq_ha_queue_base_t * dst)
 {
     dst->valid = true;
@@ -240,6 +227,21 @@ void hustmq_ha_update_queue_dict(ngx_bool_t status_cache, const backend_stat_arr
     }
 }
 
+void hustmq_ha_patch_queue_dict(const backend_stat_array_t * arr, ngx_pool_t * pool, hustmq_ha_queue_dict_t * queue_dict)
+{
+	if (!arr || !arr->arr || !pool || !queue_dict)
+	{
+		return;
+	}
+
+	size_t i = 0;
+	for (i = 0; i < arr->size; ++i)
+	{
+		backend_stat_item_t * it = arr->arr + i;
+		__update_queue_dict(it->host, &it->arr, pool, queue_dict);
+	}
+}
+
 static void __merge_type(hustmq_queue_type_t src, hustmq_queue_type_t * dst)
 {
     if (dst && HUSTMQ_PUSH_QUEUE == src)
@@ -16,8 +16,6 @@ typedef struct
 	size_t max_size;
 } backend_stat_array_t;
 
-void hustmq_ha_dispose_backend_stat_array(backend_stat_array_t * arr);
-
 typedef struct
 {
     hustmq_ha_queue_base_t base;
@@ -47,6 +45,8 @@ typedef struct
 } hustmq_ha_queue_ctx_t;
 
 void hustmq_ha_update_queue_dict(ngx_bool_t status_cache, const backend_stat_array_t * arr, ngx_pool_t * pool, hustmq_ha_queue_dict_t * queue_dict);
+// applies the queues of a watch reply, the queues not in arr are left as they are
+void hustmq_ha_patch_queue_dict(const backend_stat_array_t * arr, ngx_pool_t * pool, hustmq_ha_queue_dict_t * queue_dict);
 ngx_bool_t hustmq_ha_merge_queue_dict(
         hustmq_ha_queue_dict_t * queue_dict,
         ngx_pool_t * pool,
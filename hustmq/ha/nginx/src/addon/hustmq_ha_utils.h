@@ -6,8 +6,7 @@
 #include <ngx_http_addon_def.h>
 #include <ngx_http_utils_module.h>
 #include <ngx_http_fetch.h>
-#include "message_queue_def.h"
-#include "worker_def.h"
+#include "cjson_serialization.h"
 
 #undef HUSTMQ_HA_QUEUE_SIZE
 #define HUSTMQ_HA_QUEUE_SIZE      64
@@ -34,6 +33,8 @@ typedef struct
     ngx_str_t prefix;
     ssize_t max_queue_size;
     ngx_bool_t queue_hash;
+    ngx_int_t queue_ring_replicas;
+    ngx_int_t queue_ring_vnodes;
     ngx_int_t long_polling_timeout;
     ngx_int_t subscribe_timeout;
     ngx_int_t publish_timeout;
@@ -41,6 +42,7 @@ typedef struct
     ngx_bool_t status_cache;
     ssize_t fetch_req_pool_size;
     ngx_int_t keepalive_cache_size;
+    ngx_bool_t keepalive_cache_adaptive;
     ngx_int_t connection_cache_size;
     ngx_str_t autost_uri;
     ngx_str_t username;
@@ -51,6 +53,8 @@ typedef struct
     ngx_int_t fetch_timeout;
     ssize_t fetch_buffer_size;
     ngx_int_t autost_interval;
+    ngx_str_t watch_uri;
+    ngx_int_t watch_timeout;
     ngx_int_t do_post_cache_size;
     ngx_int_t do_get_cache_size;
     ssize_t max_do_task_body_size;
@@ -10,19 +10,6 @@ static hustmq_worker_item_t * hustmq_worker_dict_get(hustmq_worker_dict_t * dict
     return val ? *val : 0;
 }
 
-void hustmq_ha_dispose_hustmq_workers_array(hustmq_workers_array_t * arr)
-{
-	if (!arr || !arr->arr)
-	{
-		return;
-	}
-	size_t i = 0;
-	for(i = 0; i < arr->size; ++i)
-	{
-		cjson_dispose_hustmqworkerarray(arr->arr + i);
-	}
-}
-
 static void __reset_worker_dict_status(hustmq_worker_dict_t * worker_dict)
 {
 	if (!worker_dict)
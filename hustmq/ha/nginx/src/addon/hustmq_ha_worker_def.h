@@ -10,8 +10,6 @@ typedef struct
 	size_t max_size;
 } hustmq_workers_array_t;
 
-void hustmq_ha_dispose_hustmq_workers_array(hustmq_workers_array_t * arr);
-
 typedef struct
 {
     char worker[HUSTMQ_HA_WORKER_SIZE + 1];
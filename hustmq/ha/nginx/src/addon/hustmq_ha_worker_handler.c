@@ -85,13 +85,12 @@ ngx_int_t hustmq_ha_worker_handler(ngx_str_t * backend_uri, ngx_http_request_t *
 		hustmq_ha_update_worker_dict(&ctx->workers, conf->pool, &g_hustmq_worker_buffer.worker_dict);
 		hustmq_ha_merge_worker_dict(&g_hustmq_worker_buffer.worker_dict, conf->pool, &g_hustmq_worker_buffer.worker_array);
 		ngx_bool_t rc = hustmqha_serialize_worker_array(&g_hustmq_worker_buffer.worker_array, conf->pool, &g_hustmq_worker_buffer.workers_buf);
-		hustmq_ha_dispose_hustmq_workers_array(&ctx->workers);
 
 		if (rc)
 		{
 			ngx_str_t tmp;
 			tmp.data = (u_char *)g_hustmq_worker_buffer.workers_buf.buf;
-			tmp.len = strlen(g_hustmq_worker_buffer.workers_buf.buf);
+			tmp.len = g_hustmq_worker_buffer.workers_buf.len;
 
 			return ngx_http_send_response_imp(NGX_HTTP_OK, &tmp, r);
 		}
@@ -99,9 +98,9 @@ ngx_int_t hustmq_ha_worker_handler(ngx_str_t * backend_uri, ngx_http_request_t *
 	return ngx_http_send_response_imp(NGX_HTTP_NOT_FOUND, NULL, r);
 }
 
-static ngx_bool_t __decode_json_array(const char * input, void * obj_val)
+static ngx_bool_t __decode_json_array(char * input, size_t len, ngx_pool_t * pool, void * obj_val)
 {
-	return cjson_load_hustmqworkerarray(input, obj_val);
+	return hustmqha_load_worker_array(input, len, pool, obj_val);
 }
 
 static ngx_int_t post_worker_subrequest_handler(ngx_http_request_t *r, void *data, ngx_int_t rc)
@@ -109,7 +108,7 @@ static ngx_int_t post_worker_subrequest_handler(ngx_http_request_t *r, void *dat
 	r->parent->write_event_handler = ngx_http_core_run_phases;
 
 	HustmqWorkerArray arr;
-	if (!hustmq_ha_decode_json_array(r, __decode_json_array, &arr))
+	if (!hustmq_ha_decode_json_array(r, r->pool, __decode_json_array, &arr))
 	{
 		return NGX_OK;
 	}
@@ -15,6 +15,8 @@ static void ngx_http_hustmq_ha_exit_process(ngx_cycle_t * cycle);
 static void ngx_http_hustmq_ha_exit_master(ngx_cycle_t * cycle);
 static char * ngx_http_max_queue_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_queue_hash(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_queue_ring_replicas(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_queue_ring_vnodes(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_long_polling_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_subscribe_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_publish_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
@@ -22,6 +24,7 @@ static char * ngx_http_max_timer_count(ngx_conf_t * cf, ngx_command_t * cmd, voi
 static char * ngx_http_status_cache(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_fetch_req_pool_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_keepalive_cache_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_keepalive_cache_adaptive(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_connection_cache_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_autost_uri(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_username(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
@@ -32,6 +35,8 @@ static char * ngx_http_fetch_read_timeout(ngx_conf_t * cf, ngx_command_t * cmd,
 static char * ngx_http_fetch_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_fetch_buffer_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_autost_interval(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_watch_uri(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
+static char * ngx_http_watch_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_do_post_cache_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_do_get_cache_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
 static char * ngx_http_max_do_task_body_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf);
@@ -145,6 +150,11 @@ static ngx_http_request_item_t hustmq_ha_handler_dict[] =
         ngx_string("/do_post_status"),
         ngx_null_string,
         hustmq_ha_do_post_status_handler
+    },
+    {
+        ngx_string("/fetch_status"),
+        ngx_null_string,
+        hustmq_ha_fetch_status_handler
     }
 };
 
@@ -204,6 +214,8 @@ static ngx_command_t ngx_http_hustmq_ha_commands[] =
     },
     APPEND_MCF_ITEM("max_queue_size", ngx_http_max_queue_size),
     APPEND_MCF_ITEM("queue_hash", ngx_http_queue_hash),
+    APPEND_MCF_ITEM("queue_ring_replicas", ngx_http_queue_ring_replicas),
+    APPEND_MCF_ITEM("queue_ring_vnodes", ngx_http_queue_ring_vnodes),
     APPEND_MCF_ITEM("long_polling_timeout", ngx_http_long_polling_timeout),
     APPEND_MCF_ITEM("subscribe_timeout", ngx_http_subscribe_timeout),
     APPEND_MCF_ITEM("publish_timeout", ngx_http_publish_timeout),
@@ -211,6 +223,7 @@ static ngx_command_t ngx_http_hustmq_ha_commands[] =
     APPEND_MCF_ITEM("status_cache", ngx_http_status_cache),
     APPEND_MCF_ITEM("fetch_req_pool_size", ngx_http_fetch_req_pool_size),
     APPEND_MCF_ITEM("keepalive_cache_size", ngx_http_keepalive_cache_size),
+    APPEND_MCF_ITEM("keepalive_cache_adaptive", ngx_http_keepalive_cache_adaptive),
     APPEND_MCF_ITEM("connection_cache_size", ngx_http_connection_cache_size),
     APPEND_MCF_ITEM("autost_uri", ngx_http_autost_uri),
     APPEND_MCF_ITEM("username", ngx_http_username),
@@ -221,6 +234,8 @@ static ngx_command_t ngx_http_hustmq_ha_commands[] =
     APPEND_MCF_ITEM("fetch_timeout", ngx_http_fetch_timeout),
     APPEND_MCF_ITEM("fetch_buffer_size", ngx_http_fetch_buffer_size),
     APPEND_MCF_ITEM("autost_interval", ngx_http_autost_interval),
+    APPEND_MCF_ITEM("watch_uri", ngx_http_watch_uri),
+    APPEND_MCF_ITEM("watch_timeout", ngx_http_watch_timeout),
     APPEND_MCF_ITEM("do_post_cache_size", ngx_http_do_post_cache_size),
     APPEND_MCF_ITEM("do_get_cache_size", ngx_http_do_get_cache_size),
     APPEND_MCF_ITEM("max_do_task_body_size", ngx_http_max_do_task_body_size),
@@ -291,6 +306,38 @@ static char * ngx_http_queue_hash(ngx_conf_t * cf, ngx_command_t * cmd, void * c
     return NGX_CONF_OK;
 }
 
+static char * ngx_http_queue_ring_replicas(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_queue_ring_replicas error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->queue_ring_replicas = ngx_atoi(value[1].data, value[1].len);
+    if (NGX_ERROR == mcf->queue_ring_replicas)
+    {
+        return "ngx_http_queue_ring_replicas error";
+    }
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_queue_ring_vnodes(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_queue_ring_vnodes error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->queue_ring_vnodes = ngx_atoi(value[1].data, value[1].len);
+    if (NGX_ERROR == mcf->queue_ring_vnodes || mcf->queue_ring_vnodes < 1)
+    {
+        return "ngx_http_queue_ring_vnodes error";
+    }
+    return NGX_CONF_OK;
+}
+
 static char * ngx_http_long_polling_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
 {
     ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
@@ -410,6 +457,22 @@ static char * ngx_http_keepalive_cache_size(ngx_conf_t * cf, ngx_command_t * cmd
     return NGX_CONF_OK;
 }
 
+static char * ngx_http_keepalive_cache_adaptive(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_keepalive_cache_adaptive error";
+    }
+    int val = ngx_http_get_flag_slot(cf);
+    if (NGX_ERROR == val)
+    {
+        return "ngx_http_keepalive_cache_adaptive error";
+    }
+    mcf->keepalive_cache_adaptive = val;
+    return NGX_CONF_OK;
+}
+
 static char * ngx_http_connection_cache_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
 {
     ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
@@ -568,6 +631,34 @@ static char * ngx_http_autost_interval(ngx_conf_t * cf, ngx_command_t * cmd, voi
     return NGX_CONF_OK;
 }
 
+static char * ngx_http_watch_uri(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_watch_uri error";
+    }
+    ngx_str_t * arr = cf->args->elts;
+    mcf->watch_uri = ngx_http_make_str(&arr[1], cf->pool);
+    return NGX_CONF_OK;
+}
+
+static char * ngx_http_watch_timeout(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
+{
+    ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
+    if (!mcf || 2 != cf->args->nelts)
+    {
+        return "ngx_http_watch_timeout error";
+    }
+    ngx_str_t * value = cf->args->elts;
+    mcf->watch_timeout = ngx_parse_time(&value[1], 0);
+    if (NGX_ERROR == mcf->watch_timeout)
+    {
+        return "ngx_http_watch_timeout error";
+    }
+    return NGX_CONF_OK;
+}
+
 static char * ngx_http_do_post_cache_size(ngx_conf_t * cf, ngx_command_t * cmd, void * conf)
 {
     ngx_http_hustmq_ha_main_conf_t * mcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_hustmq_ha_module);
@@ -694,6 +785,7 @@ static ngx_int_t ngx_http_hustmq_ha_init_process(ngx_cycle_t * cycle)
     }
     // TODO: initialize in worker process
     hustmq_ha_invoke_autost(cycle->log);
+    hustmq_ha_invoke_watch(cycle->log);
     return NGX_OK;
 }
 
@@ -747,8 +839,19 @@ static ngx_bool_t __init_addon(ngx_conf_t * cf, ngx_http_hustmq_ha_main_conf_t *
     {
         return false;
     }
+    if (mcf->queue_ring_replicas > 0)
+    {
+        if (mcf->queue_ring_vnodes < 1)
+        {
+            mcf->queue_ring_vnodes = 160;
+        }
+        if (!hustmq_ha_init_ring(cf->pool, peers, mcf->queue_ring_vnodes))
+        {
+            return false;
+        }
+    }
 
-    ngx_http_fetch_essential_conf_t ecf = { mcf->fetch_req_pool_size, mcf->keepalive_cache_size, mcf->connection_cache_size, cf, peers };
+    ngx_http_fetch_essential_conf_t ecf = { mcf->fetch_req_pool_size, mcf->keepalive_cache_size, mcf->keepalive_cache_adaptive, mcf->connection_cache_size, cf, peers };
     ngx_http_fetch_upstream_conf_t ucf = {
         mcf->fetch_connect_timeout,
         mcf->fetch_send_timeout,
@@ -0,0 +1,416 @@
+#include "json_reader.h"
+#include <limits.h>
+
+#define JSON_IS_DIGIT(c) ('0' <= (c) && (c) <= '9')
+
+static void __skip_ws(json_reader_t * reader)
+{
+    while (reader->pos < reader->end)
+    {
+        char c = *reader->pos;
+        if (' ' != c && '\t' != c && '\n' != c && '\r' != c)
+        {
+            break;
+        }
+        ++reader->pos;
+    }
+}
+
+static json_bool_t __consume(json_reader_t * reader, char c)
+{
+    __skip_ws(reader);
+    if (reader->pos >= reader->end || c != *reader->pos)
+    {
+        return false;
+    }
+    ++reader->pos;
+    return true;
+}
+
+void json_reader_init(json_reader_t * reader, char * input, size_t len)
+{
+    reader->pos = input;
+    reader->end = input + len;
+}
+
+json_bool_t json_reader_eof(json_reader_t * reader)
+{
+    __skip_ws(reader);
+    return reader->pos >= reader->end;
+}
+
+json_bool_t json_read_begin_array(json_reader_t * reader)
+{
+    return __consume(reader, '[');
+}
+
+json_bool_t json_read_begin_object(json_reader_t * reader)
+{
+    return __consume(reader, '{');
+}
+
+static int __next(json_reader_t * reader, size_t index, char close)
+{
+    __skip_ws(reader);
+    if (reader->pos >= reader->end)
+    {
+        return -1;
+    }
+    if (close == *reader->pos)
+    {
+        ++reader->pos;
+        return 0;
+    }
+    if (index > 0)
+    {
+        if (',' != *reader->pos)
+        {
+            return -1;
+        }
+        ++reader->pos;
+    }
+    return 1;
+}
+
+int json_read_next_item(json_reader_t * reader, size_t index)
+{
+    return __next(reader, index, ']');
+}
+
+int json_read_next_field(json_reader_t * reader, size_t index, json_str_t * key)
+{
+    int rc = __next(reader, index, '}');
+    if (rc < 1)
+    {
+        return rc;
+    }
+    if (!json_read_string(reader, key) || !__consume(reader, ':'))
+    {
+        return -1;
+    }
+    return 1;
+}
+
+static int __hex(char c)
+{
+    if (JSON_IS_DIGIT(c))
+    {
+        return c - '0';
+    }
+    if ('a' <= c && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if ('A' <= c && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static json_bool_t __read_hex4(json_reader_t * reader, unsigned int * code)
+{
+    if (reader->end - reader->pos < 4)
+    {
+        return false;
+    }
+    *code = 0;
+    int i = 0;
+    for (i = 0; i < 4; ++i)
+    {
+        int val = __hex(*reader->pos++);
+        if (val < 0)
+        {
+            return false;
+        }
+        *code = (*code << 4) | val;
+    }
+    return true;
+}
+
+static char * __put_utf8(char * out, unsigned int code)
+{
+    if (code < 0x80)
+    {
+        *out++ = (char) code;
+    }
+    else if (code < 0x800)
+    {
+        *out++ = (char) (0xC0 | (code >> 6));
+        *out++ = (char) (0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000)
+    {
+        *out++ = (char) (0xE0 | (code >> 12));
+        *out++ = (char) (0x80 | ((code >> 6) & 0x3F));
+        *out++ = (char) (0x80 | (code & 0x3F));
+    }
+    else
+    {
+        *out++ = (char) (0xF0 | (code >> 18));
+        *out++ = (char) (0x80 | ((code >> 12) & 0x3F));
+        *out++ = (char) (0x80 | ((code >> 6) & 0x3F));
+        *out++ = (char) (0x80 | (code & 0x3F));
+    }
+    return out;
+}
+
+static json_bool_t __read_unicode(json_reader_t * reader, char ** out)
+{
+    unsigned int code = 0;
+    if (!__read_hex4(reader, &code))
+    {
+        return false;
+    }
+    if (code >= 0xD800 && code <= 0xDBFF && reader->end - reader->pos >= 6
+        && '\\' == reader->pos[0] && 'u' == reader->pos[1])
+    {
+        char * pos = reader->pos;
+        unsigned int low = 0;
+        reader->pos += 2;
+        if (__read_hex4(reader, &low) && low >= 0xDC00 && low <= 0xDFFF)
+        {
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        else
+        {
+            reader->pos = pos;
+        }
+    }
+    // the escape is never shorter than its utf-8 form, so out stays behind pos
+    *out = __put_utf8(*out, code);
+    return true;
+}
+
+json_bool_t json_read_string(json_reader_t * reader, json_str_t * val)
+{
+    if (!__consume(reader, '"'))
+    {
+        return false;
+    }
+    char * start = reader->pos;
+    char * out = start;
+    while (reader->pos < reader->end)
+    {
+        char c = *reader->pos++;
+        if ('"' == c)
+        {
+            *out = '\0';
+            val->buf = start;
+            val->len = out - start;
+            return true;
+        }
+        if ('\\' != c)
+        {
+            *out++ = c;
+            continue;
+        }
+        if (reader->pos >= reader->end)
+        {
+            return false;
+        }
+        c = *reader->pos++;
+        switch (c)
+        {
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case '"':
+        case '\\':
+        case '/':
+            *out++ = c;
+            break;
+        case 'u':
+            if (!__read_unicode(reader, &out))
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+json_bool_t json_read_integer(json_reader_t * reader, json_int_t * val)
+{
+    __skip_ws(reader);
+    char * p = reader->pos;
+    json_bool_t neg = false;
+    if (p < reader->end && '-' == *p)
+    {
+        neg = true;
+        ++p;
+    }
+    if (p >= reader->end || !JSON_IS_DIGIT(*p))
+    {
+        return false;
+    }
+    // same result as cJSON's valueint: the number is read as a double and truncated
+    double num = 0;
+    while (p < reader->end && JSON_IS_DIGIT(*p))
+    {
+        num = num * 10 + (*p++ - '0');
+    }
+    if (p < reader->end && '.' == *p)
+    {
+        double scale = 0.1;
+        for (++p; p < reader->end && JSON_IS_DIGIT(*p); ++p)
+        {
+            num += (*p - '0') * scale;
+            scale /= 10;
+        }
+    }
+    if (p < reader->end && ('e' == *p || 'E' == *p))
+    {
+        ++p;
+        json_bool_t eneg = false;
+        if (p < reader->end && ('+' == *p || '-' == *p))
+        {
+            eneg = ('-' == *p);
+            ++p;
+        }
+        int e = 0;
+        for (; p < reader->end && JSON_IS_DIGIT(*p); ++p)
+        {
+            if (e < 400)
+            {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        while (e-- > 0)
+        {
+            num = eneg ? num / 10 : num * 10;
+        }
+    }
+    if (neg)
+    {
+        num = -num;
+    }
+    reader->pos = p;
+    *val = num >= INT_MAX ? INT_MAX : (num <= INT_MIN ? INT_MIN : (json_int_t) num);
+    return true;
+}
+
+json_bool_t json_read_integer_array(json_reader_t * reader, json_int_t * arr, size_t max_size, size_t * size)
+{
+    if (!json_read_begin_array(reader))
+    {
+        return false;
+    }
+    size_t index = 0;
+    for (;;)
+    {
+        int rc = json_read_next_item(reader, index);
+        if (rc < 0)
+        {
+            return false;
+        }
+        if (0 == rc)
+        {
+            break;
+        }
+        if (index < max_size ? !json_read_integer(reader, arr + index) : !json_skip_value(reader))
+        {
+            return false;
+        }
+        ++index;
+    }
+    *size = index < max_size ? index : max_size;
+    return true;
+}
+
+static json_bool_t __skip_string(json_reader_t * reader)
+{
+    ++reader->pos;
+    while (reader->pos < reader->end)
+    {
+        char c = *reader->pos++;
+        if ('"' == c)
+        {
+            return true;
+        }
+        if ('\\' == c)
+        {
+            ++reader->pos;
+        }
+    }
+    return false;
+}
+
+static json_bool_t __skip_literal(json_reader_t * reader, const char * literal)
+{
+    size_t len = strlen(literal);
+    if ((size_t) (reader->end - reader->pos) < len || 0 != memcmp(reader->pos, literal, len))
+    {
+        return false;
+    }
+    reader->pos += len;
+    return true;
+}
+
+json_bool_t json_skip_value(json_reader_t * reader)
+{
+    __skip_ws(reader);
+    if (reader->pos >= reader->end)
+    {
+        return false;
+    }
+    char c = *reader->pos;
+    if ('"' == c)
+    {
+        return __skip_string(reader);
+    }
+    if ('[' == c || '{' == c)
+    {
+        // brackets are only counted, not matched against each other
+        size_t depth = 0;
+        while (reader->pos < reader->end)
+        {
+            c = *reader->pos;
+            if ('"' == c)
+            {
+                if (!__skip_string(reader))
+                {
+                    return false;
+                }
+                continue;
+            }
+            ++reader->pos;
+            if ('[' == c || '{' == c)
+            {
+                ++depth;
+            }
+            else if ((']' == c || '}' == c) && 0 == --depth)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    if ('-' == c || JSON_IS_DIGIT(c))
+    {
+        json_int_t tmp;
+        return json_read_integer(reader, &tmp);
+    }
+    return __skip_literal(reader, "true") || __skip_literal(reader, "false") || __skip_literal(reader, "null");
+}
+
+json_bool_t json_key_eq(const json_str_t * key, const char * name)
+{
+    size_t len = strlen(name);
+    return key->len == len && 0 == memcmp(key->buf, name, len);
+}
@@ -0,0 +1,37 @@
+#ifndef __json_reader_20261018223012_h__
+#define __json_reader_20261018223012_h__
+
+#include "cjson_serialization_base.h"
+
+// a pull reader working on the input buffer itself: nothing is allocated,
+// strings are unescaped in place and terminated with '\0', so the buffer
+// must be writable and must outlive the values read from it
+
+typedef struct
+{
+    char * pos;
+    char * end;
+} json_reader_t;
+
+void json_reader_init(json_reader_t * reader, char * input, size_t len);
+// true if only whitespace is left
+json_bool_t json_reader_eof(json_reader_t * reader);
+
+json_bool_t json_read_begin_array(json_reader_t * reader);
+json_bool_t json_read_begin_object(json_reader_t * reader);
+
+// index is the number of items already read from the current array or
+// object, returns 1 if one more follows, 0 if the closing bracket has been
+// consumed and -1 on malformed input
+int json_read_next_item(json_reader_t * reader, size_t index);
+int json_read_next_field(json_reader_t * reader, size_t index, json_str_t * key);
+
+json_bool_t json_read_string(json_reader_t * reader, json_str_t * val);
+json_bool_t json_read_integer(json_reader_t * reader, json_int_t * val);
+// reads at most max_size items, the others are skipped
+json_bool_t json_read_integer_array(json_reader_t * reader, json_int_t * arr, size_t max_size, size_t * size);
+json_bool_t json_skip_value(json_reader_t * reader);
+
+json_bool_t json_key_eq(const json_str_t * key, const char * name);
+
+#endif // __json_reader_20261018223012_h__
@@ -227,7 +227,8 @@ ngx_int_t ngx_http_fetch_init_conf(
     {
         return NGX_ERROR;
     }
-    return ngx_http_fetch_keepalive_init(essential_conf->keepalive_cache_size, cf);
+    return ngx_http_fetch_keepalive_init(
+        essential_conf->keepalive_cache_size, essential_conf->keepalive_adaptive, essential_conf->peers, cf);
 }
 
 static ngx_int_t __init_request(const ngx_http_fetch_args_t * args, ngx_http_request_t *r)
@@ -298,3 +299,12 @@ ngx_int_t ngx_http_fetch(const ngx_http_fetch_args_t * args, const ngx_http_auth
     };
     return ngx_http_fetch_init_upstream(&upstream_data);
 }
+
+ngx_int_t ngx_http_fetch_status(ngx_pool_t * pool, ngx_str_t * status)
+{
+    if (!pool || !status)
+    {
+        return NGX_ERROR;
+    }
+    return ngx_http_fetch_keepalive_status(pool, status);
+}
@@ -7,6 +7,9 @@ typedef struct
 {
     size_t request_pool_size;
     size_t keepalive_cache_size;
+    // size the idle connections of each peer from its observed concurrency,
+    // keepalive_cache_size is then the upper bound of the whole cache
+    ngx_flag_t keepalive_adaptive;
     size_t connection_cache_size;
     ngx_conf_t * cf;
     ngx_http_upstream_rr_peers_t * peers;
@@ -49,4 +52,7 @@ ngx_int_t ngx_http_fetch_init_conf(
 
 ngx_int_t ngx_http_fetch(const ngx_http_fetch_args_t * args, const ngx_http_auth_basic_key_t * auth);
 
+// per peer keepalive counters of the current worker process as json
+ngx_int_t ngx_http_fetch_status(ngx_pool_t * pool, ngx_str_t * status);
+
 #endif // __ngx_http_fetch_20151224133408_h__
@@ -0,0 +1,149 @@
+#include "ngx_http_utils_module.h"
+
+static ngx_int_t ngx_http_stream_filter_init(ngx_conf_t * cf);
+
+static ngx_http_module_t ngx_http_stream_filter_module_ctx =
+{
+    NULL, // ngx_int_t (*preconfiguration)(ngx_conf_t *cf);
+    ngx_http_stream_filter_init, // ngx_int_t (*postconfiguration)(ngx_conf_t *cf);
+    NULL, // void *(*create_main_conf)(ngx_conf_t *cf);
+    NULL, // char *(*init_main_conf)(ngx_conf_t *cf, void *conf);
+    NULL, // void * (*create_srv_conf)(ngx_conf_t *cf);
+    NULL, // char * (*merge_srv_conf)(ngx_conf_t *cf, void *prev, void *conf);
+    NULL, // void * (*create_loc_conf)(ngx_conf_t *cf);
+    NULL // char * (*merge_loc_conf)(ngx_conf_t *cf, void *prev, void *conf);
+};
+
+ngx_module_t ngx_http_stream_filter_module =
+{
+    NGX_MODULE_V1,
+    &ngx_http_stream_filter_module_ctx,
+    NULL,
+    NGX_HTTP_MODULE,
+    NULL, // ngx_int_t (*init_master)(ngx_log_t *log);
+    NULL, // ngx_int_t (*init_module)(ngx_cycle_t *cycle);
+    NULL, // ngx_int_t (*init_process)(ngx_cycle_t *cycle);
+    NULL, // ngx_int_t (*init_thread)(ngx_cycle_t *cycle);
+    NULL, // void (*exit_thread)(ngx_cycle_t *cycle);
+    NULL, // void (*exit_process)(ngx_cycle_t *cycle);
+    NULL, // void (*exit_master)(ngx_cycle_t *cycle);
+    NGX_MODULE_V1_PADDING
+};
+
+static ngx_http_output_header_filter_pt ngx_http_next_header_filter;
+static ngx_http_output_body_filter_pt ngx_http_next_body_filter;
+
+static ngx_bool_t __copy_headers(ngx_http_request_t * sr, ngx_http_request_t * r)
+{
+    ngx_list_part_t * part = &sr->headers_out.headers.part;
+    ngx_table_elt_t * header = part->elts;
+    ngx_uint_t i = 0;
+    for (i = 0; /* void */; ++i)
+    {
+        if (i >= part->nelts)
+        {
+            if (!part->next)
+            {
+                break;
+            }
+            part = part->next;
+            header = part->elts;
+            i = 0;
+        }
+        if (0 == header[i].hash)
+        {
+            continue;
+        }
+        ngx_table_elt_t * h = ngx_list_push(&r->headers_out.headers);
+        if (!h)
+        {
+            return false;
+        }
+        *h = header[i];
+    }
+    return true;
+}
+
+// the first 200 of a stream subrequest becomes the response of r->main:
+// its headers are sent at once and its body is passed on by the postpone
+// filter as it arrives. any other status is dropped so that the caller
+// can try the next peer. a failure after that can not be retried, see
+// ngx_http_stream_subrequest_finish.
+static ngx_int_t ngx_http_stream_header_filter(ngx_http_request_t * r)
+{
+    ngx_http_subrequest_ctx_t * ctx = ngx_http_get_module_ctx(r, ngx_http_stream_filter_module);
+    if (!ctx || r == r->main || NGX_HTTP_OK != r->headers_out.status || r->main->header_sent)
+    {
+        return ngx_http_next_header_filter(r);
+    }
+
+    ngx_http_request_t * mr = r->main;
+    if (!__copy_headers(r, mr))
+    {
+        return NGX_ERROR;
+    }
+
+    static ngx_str_t type = ngx_string("text/plain");
+    mr->headers_out.status = NGX_HTTP_OK;
+    mr->headers_out.content_type = type;
+    mr->headers_out.content_length_n = r->headers_out.content_length_n;
+
+    ctx->streamed = true;
+
+    ngx_int_t rc = ngx_http_send_header(mr);
+    if (NGX_ERROR == rc || rc > NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+    return ngx_http_next_header_filter(r);
+}
+
+static ngx_int_t ngx_http_stream_body_filter(ngx_http_request_t * r, ngx_chain_t * in)
+{
+    ngx_http_subrequest_ctx_t * ctx = ngx_http_get_module_ctx(r, ngx_http_stream_filter_module);
+    if (!ctx || r == r->main)
+    {
+        return ngx_http_next_body_filter(r, in);
+    }
+    if (ctx->streamed && NGX_HTTP_OK == r->headers_out.status)
+    {
+        return ngx_http_next_body_filter(r, in);
+    }
+
+    ngx_chain_t * cl = in;
+    for (cl = in; cl; cl = cl->next)
+    {
+        cl->buf->pos = cl->buf->last;
+        cl->buf->file_pos = cl->buf->file_last;
+    }
+    return NGX_OK;
+}
+
+ngx_int_t ngx_http_stream_subrequest_finish(ngx_http_request_t * r, ngx_int_t rc)
+{
+    ngx_http_subrequest_ctx_t * ctx = ngx_http_get_module_ctx(r, ngx_http_stream_filter_module);
+    if (!ctx || !ctx->streamed)
+    {
+        return ngx_http_finish_subrequest(r);
+    }
+    // the upstream finalizes an error after its headers with the rc of a
+    // flush, so a body that is not fully read is a failure as well
+    if (NGX_ERROR == rc || rc >= NGX_HTTP_SPECIAL_RESPONSE || (r->upstream && r->upstream->length > 0))
+    {
+        // part of the body is already sent: terminate r->main, which closes
+        // the connection, rather than end the response as if it were complete
+        return NGX_ERROR;
+    }
+    return ngx_http_finish_subrequest(r);
+}
+
+static ngx_int_t ngx_http_stream_filter_init(ngx_conf_t * cf)
+{
+    ngx_http_next_header_filter = ngx_http_top_header_filter;
+    ngx_http_top_header_filter = ngx_http_stream_header_filter;
+
+    ngx_http_next_body_filter = ngx_http_top_body_filter;
+    ngx_http_top_body_filter = ngx_http_stream_body_filter;
+
+    return NGX_OK;
+}
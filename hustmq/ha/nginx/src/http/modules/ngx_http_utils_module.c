@@ -679,7 +679,8 @@ ngx_int_t ngx_http_run_subrequest(
 {
     ngx_http_request_t * psr;
     ngx_str_t * args = ctx->args.data ? &ctx->args : (r->args.len > 0 ? &r->args : NULL);
-    ngx_int_t ret = ngx_http_subrequest(r, &ctx->uri, args, &psr, ctx->subrequest, NGX_HTTP_SUBREQUEST_IN_MEMORY);
+    ngx_int_t ret = ngx_http_subrequest(r, &ctx->uri, args, &psr, ctx->subrequest,
+        ctx->stream ? 0 : NGX_HTTP_SUBREQUEST_IN_MEMORY);
 
     if (!psr)
     {
@@ -687,6 +688,10 @@ ngx_int_t ngx_http_run_subrequest(
     }
 
     ngx_http_set_addon_module_ctx(psr, peer);
+    if (ctx->stream)
+    {
+        ngx_http_set_ctx(psr, ctx, ngx_http_stream_filter_module);
+    }
 
     if (NGX_OK != ret)
     {